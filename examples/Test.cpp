@@ -178,7 +178,8 @@ int main()
         // Rendering
         cx::BeginCamera(camera);
 
-        cx::GetDefaultShader()->SetUniform("u_CameraPos", { camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z });
+        static constexpr cx::UniformId u_CameraPos("u_CameraPos"); // Hashed at compile time
+        cx::GetDefaultShader()->SetUniform(u_CameraPos, { camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z });
 
         static float elapsed = 0.0f;
         elapsed += cx::GetFrameTime();
@@ -0,0 +1,118 @@
+#include "Image.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Times ImageOperations::Apply() on a 3840x2160 RGBA image: each resize filter, the orientation and color edits on their own, and a
+// resize + tint + flip chain applied as one ImageOperations against the same edits applied one at a time. Prints the median of each case.
+// Only the CPU image code is used, so it needs no window or renderer.
+
+static constexpr int s_width = 3840;
+static constexpr int s_height = 2160;
+static constexpr int s_channels = 4;
+static constexpr int s_iterations = 10;
+
+static std::vector<uint8_t> MakeSourceImage()
+{
+    // Gradients with some high frequency detail, so the filters have something to work on
+    std::vector<uint8_t> pixels(size_t(s_width) * s_height * s_channels);
+    for (int y = 0; y < s_height; y++)
+    {
+        for (int x = 0; x < s_width; x++)
+        {
+            uint8_t* p = &pixels[(size_t(y) * s_width + x) * s_channels];
+            p[0] = static_cast<uint8_t>(x * 255 / (s_width - 1));
+            p[1] = static_cast<uint8_t>(y * 255 / (s_height - 1));
+            p[2] = static_cast<uint8_t>(((x / 4) ^ (y / 4)) & 1 ? 230 : 25);
+            p[3] = static_cast<uint8_t>(128 + (x + y) % 128);
+        }
+    }
+    return pixels;
+}
+
+// Runs edit on a fresh copy of the source once to warm up, then s_iterations times, and returns the median in milliseconds.
+// Copying the source isn't timed.
+static double Time(const std::vector<uint8_t>& source, const std::function<bool(std::vector<uint8_t>&, int&, int&)>& edit)
+{
+    std::vector<double> times;
+    for (int i = 0; i <= s_iterations; i++)
+    {
+        std::vector<uint8_t> pixels = source;
+        int width = s_width;
+        int height = s_height;
+
+        auto start = std::chrono::steady_clock::now();
+        bool applied = edit(pixels, width, height);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (!applied)
+            return -1.0;
+        if (i > 0)
+            times.push_back(ms);
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void Report(const std::string& name, double ms)
+{
+    std::cout << std::left << std::setw(44) << name << std::right;
+    if (ms < 0.0)
+        std::cout << "failed" << std::endl;
+    else
+        std::cout << std::setw(9) << ms << " ms" << std::setw(10) << (double(s_width) * s_height / 1000.0) / ms << " MPix/s" << std::endl;
+}
+
+static void RunCase(const std::vector<uint8_t>& source, const std::string& name, const cx::ImageOperations& operations)
+{
+    Report(name, Time(source, [&](std::vector<uint8_t>& pixels, int& width, int& height)
+    {
+        return operations.Apply(pixels, width, height, s_channels, true);
+    }));
+}
+
+int main()
+{
+    std::vector<uint8_t> source = MakeSourceImage();
+
+    std::cout << "ImageOperations::Apply() on " << s_width << "x" << s_height << " RGBA, median of " << s_iterations << " runs, "
+        << cx::GetJobWorkerCount() << " job workers" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    // Resizing to half size
+    RunCase(source, "Resize 1920x1080 nearest", cx::ImageOperations().Resize(1920, 1080, cx::ResizeFilter::Nearest));
+    RunCase(source, "Resize 1920x1080 bilinear", cx::ImageOperations().Resize(1920, 1080, cx::ResizeFilter::Bilinear));
+    RunCase(source, "Resize 1920x1080 bicubic", cx::ImageOperations().Resize(1920, 1080, cx::ResizeFilter::Bicubic));
+    RunCase(source, "Resize 1920x1080 lanczos", cx::ImageOperations().Resize(1920, 1080, cx::ResizeFilter::Lanczos));
+
+    // Single edits
+    RunCase(source, "Flip vertical", cx::ImageOperations().FlipVertical());
+    RunCase(source, "Flip horizontal", cx::ImageOperations().FlipHorizontal());
+    RunCase(source, "Rotate 90", cx::ImageOperations().Rotate90());
+    RunCase(source, "Grayscale", cx::ImageOperations().Grayscale());
+    RunCase(source, "Invert", cx::ImageOperations().Invert());
+    RunCase(source, "Tint", cx::ImageOperations().Tint(cx::Color(255, 200, 150, 255)));
+
+    // A chain in one Apply() against the same edits applied one at a time
+    cx::ImageOperations resize = cx::ImageOperations().Resize(1920, 1080, cx::ResizeFilter::Bilinear);
+    cx::ImageOperations tint = cx::ImageOperations().Tint(cx::Color(255, 200, 150, 255));
+    cx::ImageOperations flip = cx::ImageOperations().FlipHorizontal();
+
+    RunCase(source, "Resize + tint + flip, fused", cx::ImageOperations(resize).Then(tint).Then(flip));
+    Report("Resize + tint + flip, one at a time", Time(source, [&](std::vector<uint8_t>& pixels, int& width, int& height)
+    {
+        return resize.Apply(pixels, width, height, s_channels, true)
+            && tint.Apply(pixels, width, height, s_channels, true)
+            && flip.Apply(pixels, width, height, s_channels, true);
+    }));
+
+    cx::ShutdownJobSystem();
+
+    return 0;
+}
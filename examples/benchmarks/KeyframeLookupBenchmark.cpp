@@ -0,0 +1,110 @@
+#include "Animation.h"
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compares keyframe lookups on a 30 second clip with 3,600 keys per channel: the linear scan the animator used to do, Animator's
+// binary search, and its binary search with a playback cursor. Times normal playback at a fixed 60 Hz step and random seeks.
+// Only the lookup functions are used, so it needs no window or renderer.
+
+static constexpr float s_clipLength = 30.0f;
+static constexpr int s_keyCount = 3600; // 120 keys per second, like mocap
+static constexpr int s_channelCount = 64;
+static constexpr float s_timeStep = 1.0f / 60.0f;
+static constexpr int s_loops = 4;
+
+// The lookup Animator used before it had the binary search
+static int FindKeyframeIndexLinear(const std::vector<float>& times, float time)
+{
+    if (times.empty())
+        return -1;
+
+    for (size_t i = 0; i < times.size() - 1; ++i)
+    {
+        if (time >= times[i] && time < times[i + 1])
+            return static_cast<int>(i);
+    }
+
+    if (time >= times.back())
+        return static_cast<int>(times.size()) - 1;
+
+    return 0;
+}
+
+// Looks up every channel at every time and returns the nanoseconds per lookup. The indices are summed into checksum.
+template<typename Lookup>
+static double Time(const std::vector<std::vector<float>>& channels, const std::vector<float>& times, int64_t& checksum, Lookup lookup)
+{
+    checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (float time : times)
+    {
+        for (size_t c = 0; c < channels.size(); c++)
+            checksum += lookup(c, time);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return ns / (double(times.size()) * channels.size());
+}
+
+static void RunCase(const std::string& name, const std::vector<std::vector<float>>& channels, const std::vector<float>& times)
+{
+    std::vector<int> cursors(channels.size(), 0);
+    int64_t linearSum = 0;
+    int64_t binarySum = 0;
+    int64_t cursorSum = 0;
+
+    double linear = Time(channels, times, linearSum, [&](size_t c, float time) { return FindKeyframeIndexLinear(channels[c], time); });
+    double binary = Time(channels, times, binarySum, [&](size_t c, float time) { return cx::Animator::FindKeyframeIndex(channels[c], time); });
+    double cursor = Time(channels, times, cursorSum, [&](size_t c, float time) { return cx::Animator::FindKeyframeIndex(channels[c], time, cursors[c]); });
+
+    std::cout << name << " (" << times.size() * channels.size() << " lookups)" << std::endl;
+    std::cout << "  Linear:          " << std::setw(9) << linear << " ns/lookup" << std::endl;
+    std::cout << "  Binary search:   " << std::setw(9) << binary << " ns/lookup" << std::endl;
+    std::cout << "  Binary + cursor: " << std::setw(9) << cursor << " ns/lookup" << std::endl;
+
+    if (binarySum != linearSum || cursorSum != linearSum)
+        std::cout << "  Results differ from the linear scan!" << std::endl;
+}
+
+int main()
+{
+    // Evenly spaced keys with a little jitter, a separate array per channel like a loaded clip
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> jitter(-0.25f, 0.25f);
+    const float keySpacing = s_clipLength / (s_keyCount - 1);
+
+    std::vector<std::vector<float>> channels(s_channelCount);
+    for (std::vector<float>& times : channels)
+    {
+        times.resize(s_keyCount);
+        for (int k = 0; k < s_keyCount; k++)
+            times[k] = (k + (k > 0 && k < s_keyCount - 1 ? jitter(random) : 0.0f)) * keySpacing;
+    }
+
+    // Looping playback at the fixed step, and the same number of random seeks
+    std::vector<float> playback;
+    for (int loop = 0; loop < s_loops; loop++)
+    {
+        for (float time = 0.0f; time < s_clipLength; time += s_timeStep)
+            playback.push_back(time);
+    }
+
+    std::uniform_real_distribution<float> seekTime(0.0f, s_clipLength);
+    std::vector<float> seeks(playback.size());
+    for (float& time : seeks)
+        time = seekTime(random);
+
+    std::cout << s_channelCount << " channels, " << s_keyCount << " keys each over " << s_clipLength << " seconds" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    RunCase("Playback at 60 Hz, looping " + std::to_string(s_loops) + " times", channels, playback);
+    RunCase("Random seeks", channels, seeks);
+
+    return 0;
+}
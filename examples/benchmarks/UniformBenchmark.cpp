@@ -0,0 +1,95 @@
+#include "Cryonix.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Sets 64 material shader parameters and applies them every frame for 10,000 frames, printing the average cost of each block of
+// 1,000 frames. Setting a parameter that already exists overwrites it, so the cost should stay flat from the first block to the last.
+// Runs on the headless window and the Null renderer with a fixed time step, so it needs no GPU or display.
+
+static constexpr int s_paramCount = 64;
+static constexpr int s_frameCount = 10000;
+static constexpr int s_blockSize = 1000;
+
+int main()
+{
+    cx::Config config;
+    config.windowTitle = "Cryonix Uniform Benchmark";
+    config.windowWidth = 1280;
+    config.windowHeight = 720;
+    config.renderingAPI = cx::Null;
+    config.windowBackend = cx::WindowBackend::Headless;
+    config.fixedTimeStep = 1.0f / 60.0f;
+    config.audioEnabled = false;
+
+    if (!cx::Init(config))
+    {
+        std::cerr << "Failed to initialize Cryonix!" << std::endl;
+        return -1;
+    }
+
+    cx::GetHeadlessWindow()->SetFrameLimit(s_frameCount);
+
+    cx::Shader* shader = cx::LoadDefaultShader("shaders/vs_default.bin", "shaders/fs_default.bin");
+    if (!shader->IsValid())
+    {
+        std::cerr << "Failed to load the default shader!" << std::endl;
+        cx::Shutdown();
+        return -1;
+    }
+
+    cx::Material material;
+    material.SetShader(shader);
+
+    std::vector<cx::UniformId> params;
+    for (int i = 0; i < s_paramCount; i++)
+        params.push_back(cx::UniformId::Intern("u_BenchParam" + std::to_string(i)));
+
+    std::cout << "Setting and applying " << s_paramCount << " params per frame for " << s_frameCount << " frames" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    double blockMicroseconds = 0.0;
+    double firstBlock = 0.0;
+    double lastBlock = 0.0;
+    int frame = 0;
+
+    while (!cx::ShouldClose())
+    {
+        cx::Update();
+        cx::BeginFrame();
+
+        // Every value changes every frame, the worst case for the table
+        float time = static_cast<float>(cx::GetTime());
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < s_paramCount; i++)
+        {
+            float value[4] = { time, static_cast<float>(i), 0.0f, 1.0f };
+            material.SetShaderParam(params[i], value);
+        }
+        material.ApplyShaderUniforms();
+        blockMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        cx::EndFrame();
+
+        if (++frame % s_blockSize == 0)
+        {
+            double average = blockMicroseconds / s_blockSize;
+            if (frame == s_blockSize)
+                firstBlock = average;
+            lastBlock = average;
+
+            std::cout << "Frames " << std::setw(5) << frame - s_blockSize + 1 << " - " << std::setw(5) << frame << ": " << average << " us/frame" << std::endl;
+            blockMicroseconds = 0.0;
+        }
+    }
+
+    if (firstBlock > 0.0)
+        std::cout << "Last block / first block: " << lastBlock / firstBlock << std::endl;
+
+    cx::Shutdown();
+
+    return 0;
+}
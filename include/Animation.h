@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <deque>
 #include "Mesh.h"
 #include <functional>
 
@@ -25,6 +26,11 @@ namespace cx
         std::unordered_map<std::string, int> boneMap;
         std::vector<Matrix4> finalMatrices;
 
+        // Bone indices ordered so every parent comes before its children, with the parent of each entry alongside.
+        // Built by Flatten(), which runs once the hierarchy is known so evaluation is a single linear pass.
+        std::vector<int> evaluationOrder;
+        std::vector<int> evaluationParents;
+
         int FindBoneIndex(std::string_view name) const
         {
             auto it = boneMap.find(name.data());
@@ -34,32 +40,16 @@ namespace cx
             return -1;
         }
 
-        void ComputeBoneMatrix(int index, const Matrix4& parentTransform)
-        {
-            Bone& bone = bones[index];
-
-            Matrix4 globalTransform = parentTransform * bone.localTransform;
-
-            finalMatrices[index] = globalTransform * bone.inverseBindMatrix;
-
-            for (int child : bone.children)
-                ComputeBoneMatrix(child, globalTransform);
-        }
-
-
-        void UpdateFinalMatrices()
-        {
-            if (bones.empty())
-                return;
+        /// Rebuilds the children lists and the evaluation order from the bones' parent indices. Call again after changing the hierarchy.
+        void Flatten();
+        bool IsFlattened() const { return evaluationOrder.size() == bones.size(); }
 
-            finalMatrices.resize(bones.size());
+        /// Computes model space transforms from per-bone local transforms in one pass over the evaluation order.
+        /// When skinningMatrices is given it also receives global * inverseBindMatrix for every bone.
+        void ComputeGlobalTransforms(const Matrix4* localTransforms, Matrix4* globalTransforms, Matrix4* skinningMatrices = nullptr) const;
 
-            for (size_t i = 0; i < bones.size(); ++i)
-            {
-                if (bones[i].parentIndex == -1)
-                    ComputeBoneMatrix((int)i, Matrix4::Identity());
-            }
-        }
+        /// Computes finalMatrices from the bones' own local transforms
+        void UpdateFinalMatrices();
     };
 
     enum class AnimationInterpolation
@@ -405,7 +395,7 @@ namespace cx
         void EvaluateLayeredStates(float deltaTime, Animator* animator, std::vector<std::shared_ptr<Mesh>>& meshes);
 
         bool CheckTransitionConditions(const AnimationTransition& transition);
-        void StartTransition(const AnimationTransition& transition);
+        void StartTransition(const AnimationTransition& transition, Animator* animator);
     };
 
     struct AnimationLayer
@@ -492,6 +482,38 @@ namespace cx
         void SortEvents();
     };
 
+    // Local-space skeleton pose stored as structure of arrays so blending can process several bones per SIMD instruction.
+    // The arrays are padded to a multiple of 4 bones, the padding holds identity transforms.
+    struct Pose
+    {
+        std::vector<float> tx, ty, tz;
+        std::vector<float> rx, ry, rz, rw;
+        std::vector<float> sx, sy, sz;
+
+        size_t Size() const { return m_count; }
+        size_t PaddedSize() const { return tx.size(); }
+        bool Empty() const { return m_count == 0; }
+
+        // Resizing keeps existing bones, new bones start as identity
+        void Resize(size_t count);
+        void SetIdentity(size_t count);
+
+        void SetBone(size_t index, const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+        void SetTranslation(size_t index, const Vector3& t) { tx[index] = t.x; ty[index] = t.y; tz[index] = t.z; }
+        void SetRotation(size_t index, const Quaternion& r) { rx[index] = r.x; ry[index] = r.y; rz[index] = r.z; rw[index] = r.w; }
+        void SetScale(size_t index, const Vector3& s) { sx[index] = s.x; sy[index] = s.y; sz[index] = s.z; }
+
+        Vector3 GetTranslation(size_t index) const { return Vector3(tx[index], ty[index], tz[index]); }
+        Quaternion GetRotation(size_t index) const { return Quaternion(rx[index], ry[index], rz[index], rw[index]); }
+        Vector3 GetScale(size_t index) const { return Vector3(sx[index], sy[index], sz[index]); }
+
+        // Composes translation * rotation * scale for one bone
+        Matrix4 GetMatrix(size_t index) const;
+
+    private:
+        size_t m_count = 0;
+    };
+
     class Animator
     {
         friend class AnimationStateMachine;
@@ -522,7 +544,7 @@ namespace cx
         void SetLooping(bool loop) { m_loop = loop; }
         bool IsLooping() const { return m_loop; }
 
-        void SetLocalTransforms(const std::vector<Matrix4>& transforms) { m_localTransforms = transforms; }
+        void SetLocalTransforms(const std::vector<Matrix4>& transforms);
         const std::vector<Matrix4>& GetLocalTransforms() const { return m_localTransforms; }
 
         // Multi-layer animation
@@ -556,7 +578,7 @@ namespace cx
         void SetLayerTimeScale(int layerIndex, float scale);
 
         // Additive animations
-        void SetAdditiveReferenceClip(AnimationClip* clip) { m_additiveRefClip = clip; }
+        void SetAdditiveReferenceClip(AnimationClip* clip) { m_additiveRefClip = clip; m_additiveBasePose.Resize(0); }
         AnimationClip* GetAdditiveReferenceClip() const { return m_additiveRefClip; }
 
         // Root Motion
@@ -570,6 +592,12 @@ namespace cx
         void SetEventCallback(AnimationEventCallback callback) { m_eventCallback = callback; }
         void ClearEventCallback() { m_eventCallback = nullptr; }
 
+        /// While deferring, animation events, state callbacks and morph weight changes are queued instead of applied, so Update() only
+        /// touches this animator and its skeleton and can run on a worker thread. FlushDeferredCallbacks() applies the queue in order.
+        void SetDeferCallbacks(bool defer) { m_deferCallbacks = defer; }
+        bool IsDeferringCallbacks() const { return m_deferCallbacks; }
+        void FlushDeferredCallbacks();
+
         // IK System
         int AddIKChain(IKSolverType type, const std::vector<int>& boneIndices);
         void RemoveIKChain(int chainIndex);
@@ -598,11 +626,29 @@ namespace cx
         const std::vector<Matrix4>& GetNodeTransforms() const { return m_nodeTransforms; }
         Matrix4 GetNodeTransform(int nodeIndex) const;
 
+        // Keyframe lookup
+        /// Binary search for the last key at or before time. Returns -1 if there are no keys.
+        static int FindKeyframeIndex(const std::vector<float>& times, float time);
+        /// Same as above, but searches forward from the cursor first, which is cheap during playback. The cursor is updated with the result.
+        static int FindKeyframeIndex(const std::vector<float>& times, float time, int& cursor);
+
     private:
         Skeleton* m_skeleton;
         AnimationClip* m_currentClip;
-        std::vector<Matrix4> m_boneMatrices;
+        std::vector<Matrix4> m_boneMatrices; // Skinning matrices
         std::vector<Matrix4> m_localTransforms;
+        std::vector<Matrix4> m_globalTransforms; // Model space bone transforms, shared by IK and GetBoneWorldPosition()
+
+        // Poses. Blending works on these, m_localTransforms is only built from the final pose.
+        Pose m_restPose;
+        Pose m_localPose;
+        Pose m_additiveBasePose;
+
+        // Scratch poses handed out by AcquirePose(). Callers restore m_posePoolUsed when done, so nested blend tree
+        // evaluation reuses the same buffers every frame. A deque keeps references stable while it grows.
+        std::deque<Pose> m_posePool;
+        size_t m_posePoolUsed = 0;
+        std::vector<float> m_blendWeights;
 
         std::vector<Matrix4> m_nodeTransforms;
         std::unordered_map<int, Matrix4> m_animatedNodeTransforms;
@@ -616,7 +662,6 @@ namespace cx
         float m_blendParameter;
         float m_blendParameterY;
         AnimationClip* m_additiveRefClip;
-        std::vector<Matrix4> m_additiveBaseTransforms;
         int m_nextLayerId;
 
         // Root Motion
@@ -629,6 +674,8 @@ namespace cx
         // Animation Events
         AnimationEventCallback m_eventCallback;
         std::vector<FiredEvent> m_firedEvents;
+        std::vector<std::function<void()>> m_deferredCallbacks;
+        bool m_deferCallbacks = false;
 
         // IK System
         std::vector<IKChain> m_ikChains;
@@ -638,37 +685,42 @@ namespace cx
         // State Machine
         AnimationStateMachine* m_stateMachine;
 
+        // Keyframe lookup cursors
+        std::unordered_map<const AnimationClip*, std::vector<int>> m_keyframeCursors;
+
         float m_currentTime;
         float m_speed;
         bool m_playing;
         bool m_paused;
         bool m_loop;
 
-        struct BoneTransform
-        {
-            Vector3 translation;
-            Quaternion rotation;
-            Vector3 scale;
-            bool hasTranslation = false;
-            bool hasRotation = false;
-            bool hasScale = false;
-        };
-
         int GetLayerIndex(int layerId) const;
         void UpdateLayers(float deltaTime, std::vector<std::shared_ptr<Mesh>>& meshes);
         void UpdateCrossfade(float deltaTime);
         void UpdateBlendTree(float deltaTime);
-        void SampleAnimationToBoneTransforms(AnimationClip* clip, float time, std::vector<BoneTransform>& transforms);
-        void BlendBoneTransformsToMatrices(const std::vector<BoneTransform>& from, const std::vector<BoneTransform>& to, float weight, std::vector<Matrix4>& result);
-        void BlendBoneTransforms(const std::vector<Matrix4>& from, const std::vector<Matrix4>& to, float weight, std::vector<Matrix4>& result, int layerId = -1);
-        void ApplyAdditiveAnimation(const std::vector<Matrix4>& additive, std::vector<Matrix4>& result);
-        void SampleAnimationToBuffer(AnimationClip* clip, float time, std::vector<Matrix4>& buffer);
-        void EvaluateBlendTree(BlendTreeNode* node, float time, std::vector<Matrix4>& result);
+        const Pose& GetRestPose();
+        Pose& AcquirePose();
+        bool SampleAnimationToPose(AnimationClip* clip, float time, Pose& pose);
+        void BlendPoses(const Pose& from, const Pose& to, float weight, Pose& result, int layerId = -1);
+        void BlendPosesWeighted(const Pose* const* poses, const float* weights, size_t count, Pose& result);
+        void ApplyAdditivePose(const Pose& additive, Pose& result);
+        bool EvaluateBlendTree(BlendTreeNode* node, float time, Pose& result);
+        void PoseToLocalTransforms(const Pose& pose);
         Matrix4 BlendMatrices(const Matrix4& a, const Matrix4& b, float t);
 
         // Root motion, IK, and events
         void UpdateRootMotion(AnimationClip* clip, float deltaTime);
         void ProcessAnimationEvents(AnimationClip* clip, float prevTime, float currentTime);
+
+        // Runs the callback now, or queues it when callbacks are deferred
+        template<typename Callback>
+        void DispatchCallback(Callback&& callback)
+        {
+            if (m_deferCallbacks)
+                m_deferredCallbacks.emplace_back(std::forward<Callback>(callback));
+            else
+                callback();
+        }
         Quaternion ApplyJointConstraint(const Quaternion& rotation, const JointConstraint& constraint);
         void SortIKChainsByDependency();
         bool HasIKChainDependency(int chainA, int chainB) const;
@@ -681,17 +733,22 @@ namespace cx
         void SetBoneWorldPosition(int boneIndex, const Vector3& position);
 
         void CalculateBoneTransforms();
+        // Refreshes m_globalTransforms only, for solvers that need world positions between steps
+        void UpdateGlobalTransforms();
         void SampleAnimation(float time);
         void SampleNodeAnimation(float time);
         void SampleMorphWeights(float time, std::vector<std::shared_ptr<Mesh>>& meshes);
-        Vector3 InterpolateTranslation(const AnimationChannel& channel, float time) const;
-        Quaternion InterpolateRotation(const AnimationChannel& channel, float time) const;
-        Vector3 InterpolateScale(const AnimationChannel& channel, float time) const;
 
-        Vector3 InterpolateNodeTranslation(const NodeAnimationChannel& channel, float time) const;
-        Quaternion InterpolateNodeRotation(const NodeAnimationChannel& channel, float time) const;
-        Vector3 InterpolateNodeScale(const NodeAnimationChannel& channel, float time) const;
+        // The interpolators take the keyframe index from FindKeyframeIndex(), resolved once per channel
+        Vector3 InterpolateTranslation(const AnimationChannel& channel, float time, int index) const;
+        Quaternion InterpolateRotation(const AnimationChannel& channel, float time, int index) const;
+        Vector3 InterpolateScale(const AnimationChannel& channel, float time, int index) const;
+
+        Vector3 InterpolateNodeTranslation(const NodeAnimationChannel& channel, float time, int index) const;
+        Quaternion InterpolateNodeRotation(const NodeAnimationChannel& channel, float time, int index) const;
+        Vector3 InterpolateNodeScale(const NodeAnimationChannel& channel, float time, int index) const;
 
-        int FindKeyframeIndex(const std::vector<float>& times, float time) const;
+        // Per-clip playback cursors, indexed by bone channels, then node channels, then morph weight channels
+        std::vector<int>& GetKeyframeCursors(const AnimationClip* clip);
     };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #define NOMINMAX
 #include "miniaudio/include/miniaudio.h"
+#include "AudioEffects.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -24,6 +25,33 @@ namespace cx
         ma_format format = ma_format_f32;
         unsigned int bufferSizeInFrames = 0; // 0 = auto
         ma_device_type deviceType = ma_device_type_playback;
+        unsigned int maxVoices = 64; // Sounds that can play at once. When all are busy, PlaySound() steals the least important one.
+        ma_format decodedFormat = ma_format_s16; // What decoded sounds and streams are kept as. ma_format_unknown keeps each file's own format.
+        size_t soundCacheBudget = 256 * 1024 * 1024; // Bytes the sound cache may hold. Sounds no longer loaded are evicted, least recently used first, to stay under it.
+        size_t streamThreshold = 4 * 1024 * 1024; // AUDIO_STORAGE_AUTO streams files bigger than this, in bytes on disk
+    };
+
+    // How a sound loaded from a file is kept in memory
+    enum AudioStorage
+    {
+        AUDIO_STORAGE_AUTO = 0, // Decoded, or streamed if the file is bigger than AudioConfig::streamThreshold
+        AUDIO_STORAGE_DECODED, // Decoded up front into AudioConfig::decodedFormat. The cheapest to play.
+        AUDIO_STORAGE_COMPRESSED, // Keeps the file's bytes and decodes while playing, for long sounds that play often
+        AUDIO_STORAGE_STREAM // Read from disk while playing, so only a couple of pages per playing voice are in memory
+    };
+
+    // Memory used by the sound cache
+    struct AudioCacheStats
+    {
+        size_t decodedBytes = 0; // PCM of decoded sounds
+        size_t compressedBytes = 0; // File data of compressed sounds
+        size_t streamingBytes = 0; // Page buffers of the voices set up to stream
+        size_t unusedBytes = 0; // The part of decodedBytes and compressedBytes no loaded sound uses, which is evicted first
+        unsigned int fileCount = 0;
+        unsigned int loadingCount = 0; // Still decoding from LoadSoundAsync()
+        unsigned int hits = 0; // Loads that found the file already cached
+        unsigned int misses = 0;
+        unsigned int evictions = 0;
     };
 
     // 3D Audio listener configuration
@@ -71,19 +99,14 @@ namespace cx
         ma_positioning positioning = ma_positioning_relative;
     };
 
-    // Audio effects
-    enum AudioEffect
+    // Mix buses created by InitAudioDevice(). Custom buses get the ids after these.
+    enum AudioBusId
     {
-        AUDIO_EFFECT_NONE = 0,
-        AUDIO_EFFECT_REVERB,
-        AUDIO_EFFECT_ECHO,
-        AUDIO_EFFECT_LOWPASS,
-        AUDIO_EFFECT_HIGHPASS,
-        AUDIO_EFFECT_BANDPASS,
-        AUDIO_EFFECT_NOTCH,
-        AUDIO_EFFECT_PEAKING,
-        AUDIO_EFFECT_LOSHELF,
-        AUDIO_EFFECT_HISHELF
+        AUDIO_BUS_MASTER = 0,
+        AUDIO_BUS_SFX,
+        AUDIO_BUS_MUSIC,
+        AUDIO_BUS_VOICE,
+        AUDIO_BUS_UI
     };
 
     // Sound structure
@@ -97,13 +120,14 @@ namespace cx
         unsigned int sampleRate = 0;
         unsigned int channels = 0;
         bool ownsData = false; // Track if we need to delete pcmData
+        bool cached = false; // Loaded from a file, so its data is in the sound cache rather than audioBuffer
+        unsigned int id = 0; // Shared by copies, links them to the same voices and settings
     };
 
     // Music stream structure
     struct Music
     {
         ma_sound sound;
-        ma_decoder* decoder = nullptr; // Separate decoder for queries
         bool valid = false;
         bool isPlaying = false;
         bool isPaused = false;
@@ -113,8 +137,9 @@ namespace cx
         float pitch = 1.0f;
         float pan = 0.5f;
         bool looping = false;
-        std::string filePath; // Store for decoder queries
+        std::string filePath;
         std::function<void()> onFinishCallback = nullptr;
+        int bus = AUDIO_BUS_MUSIC;
     };
 
     // Audio stream for custom PCM data
@@ -130,44 +155,6 @@ namespace cx
         unsigned int bufferSizeInFrames = 0;
     };
 
-    // Echo effect parameters
-    struct EchoEffect
-    {
-        std::vector<float> delayBuffer;
-        size_t writePos = 0;
-        unsigned int delaySamples = 0;
-        float feedback = 0.5f;
-        float wetDry = 0.5f;
-    };
-
-    // Reverb effect parameters
-    struct ReverbEffect
-    {
-        std::vector<float> combBuffers[4];
-        size_t combWritePos[4] = { 0, 0, 0, 0 };
-        std::vector<float> allpassBuffers[2];
-        size_t allpassWritePos[2] = { 0, 0 };
-        float roomSize = 0.5f;
-        float damping = 0.5f;
-        float wetDry = 0.3f;
-    };
-
-    // Audio processor for effects
-    struct AudioProcessor
-    {
-        ma_lpf lpf;
-        ma_hpf hpf;
-        ma_bpf bpf;
-        ma_notch2 notch;
-        ma_peak2 peak;
-        ma_loshelf2 loshelf;
-        ma_hishelf2 hishelf;
-        EchoEffect echo;
-        ReverbEffect reverb;
-        AudioEffect activeEffect = AUDIO_EFFECT_NONE;
-        bool enabled = false;
-    };
-
     // Core Audio System Functions
     bool InitAudioDevice();
     bool InitAudioDeviceEx(const AudioConfig& config);
@@ -182,11 +169,22 @@ namespace cx
     bool SetAudioDevice(int index);
 
     // Sound Loading/Unloading
-    Sound LoadSound(const std::string& fileName);
+    /// Files load through the sound cache, so loading a path again shares its data instead of decoding it again.
+    /// A path keeps the storage it was first loaded with while it stays cached.
+    Sound LoadSound(const std::string& fileName, AudioStorage storage = AUDIO_STORAGE_AUTO);
+    /// Returns straight away and decodes on a background thread. PlaySound() skips the sound until IsSoundReady().
+    /// Its frameCount, sampleRate and channels are left at 0 unless the path was already cached.
+    Sound LoadSoundAsync(const std::string& fileName, AudioStorage storage = AUDIO_STORAGE_AUTO);
     Sound LoadSoundFromWave(const void* data, unsigned int frameCount, unsigned int sampleRate, unsigned int channels, ma_format format = ma_format_f32);
     bool IsSoundReady(const Sound& sound);
     void UnloadSound(Sound& sound);
 
+    // Sound Cache
+    AudioCacheStats GetAudioCacheStats();
+    void SetAudioCacheBudget(size_t bytes);
+    /// Evicts every cached file that no loaded sound uses, regardless of the budget
+    void TrimAudioCache();
+
     // Sound Playback
     void PlaySound(const Sound& sound);
     void PlaySoundMulti(const Sound& sound);
@@ -195,11 +193,44 @@ namespace cx
     void ResumeSound(const Sound& sound);
     bool IsSoundPlaying(const Sound& sound);
 
-    // Sound Properties
+    // Sound Properties. They apply to the sound's playing voices and to the ones it plays later.
     void SetSoundVolume(const Sound& sound, float volume);
     void SetSoundPitch(const Sound& sound, float pitch);
     void SetSoundPan(const Sound& sound, float pan);
 
+    // Sound Voices
+    /// When every voice is busy, PlaySound() steals one from the lowest priority sound, then the farthest, then the oldest.
+    /// A sound never steals from a higher priority one, so its play is dropped instead. Defaults to 0.
+    void SetSoundPriority(const Sound& sound, int priority);
+    /// Voices playing or paused, across all sounds
+    unsigned int GetActiveVoiceCount();
+
+    // Mix Buses. Master has SFX, Music, Voice and UI under it. Sounds play into SFX and music streams into Music until moved.
+    // A bus's volume, mute, effects and voice limit cover everything routed into it, including its nested buses.
+    /// Returns the new bus's id, or -1 if the name is taken or the parent doesn't exist. Buses last until the audio device shuts down.
+    int CreateAudioBus(const std::string& name, int parent = AUDIO_BUS_MASTER);
+    /// Returns -1 if there's no bus with the name
+    int GetAudioBus(const std::string& name);
+    void SetAudioBusVolume(int bus, float volume);
+    float GetAudioBusVolume(int bus);
+    void SetAudioBusMuted(int bus, bool muted);
+    bool IsAudioBusMuted(int bus);
+    /// The peak level of the bus's last processed block, after its volume and ducking
+    float GetAudioBusLevel(int bus);
+    /// Caps the voices playing into the bus and the buses under it. A sound played into a full bus steals one of its voices, following
+    /// SetSoundPriority()'s rules, or is dropped. 0 removes the limit.
+    void SetAudioBusVoiceLimit(int bus, unsigned int maxVoices);
+    unsigned int GetAudioBusVoiceCount(int bus);
+    int AddAudioBusEffect(int bus, AudioEffect effect, float param1 = 1000.0f, float param2 = 1.0f);
+    void SetAudioBusEffectParameters(int bus, int index, float param1, float param2);
+    void SetAudioBusEffectEnabled(int bus, int index, bool enabled);
+    void RemoveAudioBusEffects(int bus);
+    /// Lowers the bus to duckedVolume while the sidechain bus's level is above threshold, such as Music ducking under Voice.
+    /// Runs on the audio thread, fading over attack seconds and recovering over release seconds. A sidechain of -1 turns it off.
+    void SetAudioBusDucking(int bus, int sidechainBus, float duckedVolume = 0.3f, float threshold = 0.01f, float attack = 0.05f, float release = 0.5f);
+    void SetSoundBus(const Sound& sound, int bus);
+    void SetMusicBus(Music& music, int bus);
+
     // Music Loading/Unloading
     Music LoadMusicStream(const std::string& fileName);
     bool IsMusicReady(const Music& music);
@@ -270,18 +301,36 @@ namespace cx
     void SetMusicDopplerFactor(Music& music, float factor);
     void SetMusicPositioning(Music& music, ma_positioning mode);
 
-    // Audio Effects Processing
+    // Audio Effects Processing. Each sound and music stream has a chain of effects, applied in the order they were added.
+    // A sound's voices are mixed before its chain, so the cost doesn't grow with how many are playing. See AudioEffect for the parameters.
+    /// Replaces the sound's effects with this one
     void SetSoundEffect(const Sound& sound, AudioEffect effect, float param1 = 1000.0f, float param2 = 1.0f);
+    /// Appends an effect and returns its index in the chain, or -1 if it couldn't be created
+    int AddSoundEffect(const Sound& sound, AudioEffect effect, float param1 = 1000.0f, float param2 = 1.0f);
+    /// Lock-free, so parameters can be animated every frame
+    void SetSoundEffectParameters(const Sound& sound, int index, float param1, float param2);
+    void SetSoundEffectEnabled(const Sound& sound, int index, bool enabled);
+    /// Removes all the sound's effects
     void RemoveSoundEffect(const Sound& sound);
     void SetMusicEffect(Music& music, AudioEffect effect, float param1 = 1000.0f, float param2 = 1.0f);
+    int AddMusicEffect(Music& music, AudioEffect effect, float param1 = 1000.0f, float param2 = 1.0f);
+    void SetMusicEffectParameters(Music& music, int index, float param1, float param2);
+    void SetMusicEffectEnabled(Music& music, int index, bool enabled);
     void RemoveMusicEffect(Music& music);
 
-    // Audio Recording
+    // Audio Recording. The capture callback only copies into preallocated ring buffers, so recordings of any length use constant memory.
+    /// Captured audio is pulled with ReadRecordedAudio(). Frames are dropped while its buffer, about 2 seconds, is full.
     bool StartAudioRecording(unsigned int sampleRate = 44100, unsigned int channels = 2);
+    /// Also streams the recording to a WAV file from a background thread as it's captured. The file is finished by StopAudioRecording().
+    bool StartAudioRecordingToFile(const std::string& fileName, unsigned int sampleRate = 44100, unsigned int channels = 2);
+    /// Frames captured before the stop can still be read until the next recording starts.
     void StopAudioRecording();
     bool IsRecordingAudio();
-    std::vector<float> GetRecordedAudio();
-    void SaveRecordedAudio(const std::string& fileName);
+    /// Frames waiting to be read
+    unsigned int GetRecordedAudioAvailable();
+    /// Copies up to maxFrames interleaved f32 frames, oldest first, into frames. Returns how many were copied.
+    unsigned int ReadRecordedAudio(float* frames, unsigned int maxFrames);
+    unsigned int GetRecordingChannels();
 
     // Waveform Generation
     Sound GenerateSoundWave(int waveType, float frequency, float duration, unsigned int sampleRate = 44100);
@@ -0,0 +1,103 @@
+#pragma once
+
+#define NOMINMAX
+#include "miniaudio/include/miniaudio.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace cx
+{
+    // Audio effects
+    enum AudioEffect
+    {
+        AUDIO_EFFECT_NONE = 0,
+        AUDIO_EFFECT_REVERB, // param1 = room size (0 to 1), param2 = damping (0 to 1)
+        AUDIO_EFFECT_ECHO, // param1 = delay in seconds, param2 = feedback (0 to 0.95)
+        AUDIO_EFFECT_LOWPASS, // param1 = cutoff frequency
+        AUDIO_EFFECT_HIGHPASS, // param1 = cutoff frequency
+        AUDIO_EFFECT_BANDPASS, // param1 = center frequency
+        AUDIO_EFFECT_NOTCH, // param1 = frequency, param2 = Q
+        AUDIO_EFFECT_PEAKING, // param1 = frequency, param2 = gain in dB
+        AUDIO_EFFECT_LOSHELF, // param1 = frequency, param2 = gain in dB
+        AUDIO_EFFECT_HISHELF // param1 = frequency, param2 = gain in dB
+    };
+
+    // Echo effect state. The delay line holds interleaved frames and is sized when the effect is added.
+    struct EchoEffect
+    {
+        std::vector<float> delayBuffer;
+        size_t writePos = 0; // In frames
+        unsigned int delayFrames = 0;
+        float feedback = 0.5f;
+        float wetDry = 0.5f;
+    };
+
+    // Freeverb style reverb: 8 damped combs in parallel into 4 allpasses in series, with separate delay lines per channel.
+    // Odd channels' delays are spread a little longer so stereo output stays wide.
+    struct ReverbEffect
+    {
+        static constexpr int CombCount = 8;
+        static constexpr int AllpassCount = 4;
+
+        struct Channel
+        {
+            std::vector<float> combBuffers[CombCount];
+            size_t combPos[CombCount] = {};
+            float combFilterStore[CombCount] = {};
+            std::vector<float> allpassBuffers[AllpassCount];
+            size_t allpassPos[AllpassCount] = {};
+        };
+
+        std::vector<Channel> channels;
+        float roomSize = 0.5f;
+        float damping = 0.5f;
+        float wetDry = 0.3f;
+    };
+
+    /// Effects processed in order on the audio thread, each one a node in the engine's node graph. Sources attach to GetInput() and the
+    /// last effect outputs into the chain's output node. Changing an effect's parameters is lock-free and takes effect on the next block.
+    /// Adding and removing effects relinks nodes, which can wait for the audio thread to finish its current block.
+    class AudioEffectChain
+    {
+    public:
+        AudioEffectChain(ma_node_graph* graph, ma_node* output, ma_uint32 channels, ma_uint32 sampleRate);
+        ~AudioEffectChain();
+        AudioEffectChain(const AudioEffectChain&) = delete;
+        AudioEffectChain& operator=(const AudioEffectChain&) = delete;
+
+        bool IsValid() const { return m_valid; }
+
+        /// Where sources attach. Stays the same as effects are added and removed.
+        ma_node* GetInput() { return &m_input; }
+        ma_node* GetOutput() const { return m_output; }
+        void SetOutput(ma_node* output);
+
+        /// Appends an effect. Returns its index, or -1 if it couldn't be created.
+        int Add(AudioEffect effect, float param1, float param2);
+        void Remove(int index);
+        void Clear();
+
+        int GetCount() const { return static_cast<int>(m_effects.size()); }
+        AudioEffect GetType(int index) const;
+
+        /// Lock-free, safe to call every frame
+        void SetParameters(int index, float param1, float param2);
+        /// A disabled effect passes its input through untouched
+        void SetEnabled(int index, bool enabled);
+
+        struct EffectNode;
+
+    private:
+        ma_node_graph* m_graph = nullptr;
+        ma_node* m_output = nullptr;
+        ma_node_base m_input;
+        ma_uint32 m_channels = 0;
+        ma_uint32 m_sampleRate = 0;
+        bool m_valid = false;
+        std::vector<std::unique_ptr<EffectNode>> m_effects;
+
+        /// The chain's input for -1
+        ma_node* GetNode(int index);
+    };
+}
@@ -25,6 +25,12 @@ namespace cx
         Vulkan,
     };
 
+    enum class WindowBackend
+    {
+        Native, // The platform window (GLFW)
+        Headless, // No OS window. Fixed virtual size and scripted input, for CI benchmarks and soak tests
+    };
+
     struct Config
     {
         std::string windowTitle = "Cryonix Application";
@@ -34,6 +40,11 @@ namespace cx
         bool windowVSync = false;
         bool windowFullscreen = false;
         RenderingAPI renderingAPI = DirectX11;
+        /// Use WindowBackend::Headless together with RenderingAPI::Null to run without a GPU or display
+        WindowBackend windowBackend = WindowBackend::Native;
+
+        /// When greater than 0, cx::Update() advances time by exactly this many seconds each frame instead of using the wall clock. Useful for deterministic tests and benchmarks.
+        float fixedTimeStep = 0.0f;
 
         int msaaSamples = 4;
         bool debugRenderer = false;
@@ -8,12 +8,16 @@
 #include "Renderer.h"
 #include "Model.h";
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "loaders/ModelLoader.h"
 #include "Shader.h"
 #include "Audio.h"
+#include "AudioEffects.h"
 #include "Camera.h"
 #include "Camera2D.h"
+#include "SpriteBatch.h"
 #include "Primitives.h"
+#include "JobSystem.h"
 
 namespace cx
 {
@@ -62,4 +66,6 @@ namespace cx
     // Misc
     const Config& GetConfig();
     Window* GetWindow();
+    /// The window when config.windowBackend is WindowBackend::Headless, for scripting input and frame limits. nullptr otherwise.
+    HeadlessWindow* GetHeadlessWindow();
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Maths.h"
+#include <cstdint>
+#include <vector>
+
+namespace cx
+{
+    // CPU image processing on 8 bit pixels with 1 to 4 channels in tightly packed rows. Filtering runs on bx's simd128 (SSE or NEON)
+    // and large images are split into row bands on the job pool.
+
+    enum class MipFilter
+    {
+        Box, // Averages the texels each mip texel covers. Fastest.
+        Kaiser // Kaiser windowed sinc. Keeps minified detail sharper with less aliasing.
+    };
+
+    struct MipGenerationOptions
+    {
+        MipFilter filter = MipFilter::Box;
+        bool isNormalMap = false; // Renormalizes each mip's xyz so filtered normals don't shorten
+        bool useJobPool = true; // Filters large levels on the job pool
+    };
+
+    enum class ResizeFilter
+    {
+        Nearest,
+        Bilinear,
+        Bicubic, // Catmull-Rom
+        Lanczos // 3 lobes. Sharpest, can ring around hard edges.
+    };
+
+    /// The number of levels in a full mip chain, down to 1x1
+    int GetMipCount(int width, int height);
+
+    /// Builds the full mip chain, level 0 first and tightly packed, the layout createTexture2D() expects with hasMips.
+    /// Color textures are converted to linear before filtering and alpha is always filtered as is. Returns an empty vector for unsupported input.
+    std::vector<uint8_t> GenerateMipChain(const uint8_t* pixels, int width, int height, int channels, bool isColorTexture, const MipGenerationOptions& options = MipGenerationOptions());
+
+    /// Resamples to newWidth x newHeight. Color images are filtered in linear space, alpha as is. Returns an empty vector for unsupported input.
+    std::vector<uint8_t> ResizeImage(const uint8_t* pixels, int width, int height, int channels, int newWidth, int newHeight,
+        ResizeFilter filter = ResizeFilter::Bilinear, bool isColorTexture = true);
+
+    /// A chain of edits applied with at most one resample and one pass over the pixels. Flips and rotations fold into a single remap and
+    /// the color edits into a single per-pixel transform, applied after any resize. A chain of resizes resamples once, straight to the last size.
+    class ImageOperations
+    {
+    public:
+        ImageOperations& Resize(int width, int height, ResizeFilter filter = ResizeFilter::Bilinear);
+        ImageOperations& FlipVertical();
+        ImageOperations& FlipHorizontal();
+        ImageOperations& Rotate90(bool clockwise = true);
+        /// Only affects images with at least 3 channels
+        ImageOperations& Grayscale();
+        /// Inverts the color channels, leaving alpha alone
+        ImageOperations& Invert();
+        /// Multiplies the color channels. Only affects images with at least 3 channels.
+        ImageOperations& Tint(const Color& color);
+
+        /// Appends another chain, as if its operations had been called on this one
+        ImageOperations& Then(const ImageOperations& next);
+
+        bool IsEmpty() const { return !m_resize && IsIdentityOrientation() && m_colorOps.empty(); }
+        void Clear() { *this = ImageOperations(); }
+
+        /// Runs the chain on pixels, replacing them and updating width and height. Returns false for unsupported input, leaving everything unchanged.
+        bool Apply(std::vector<uint8_t>& pixels, int& width, int& height, int channels, bool isColorTexture) const;
+
+    private:
+        enum class ColorOp
+        {
+            Grayscale,
+            Invert,
+            Tint
+        };
+
+        // Maps output pixel directions to source pixel directions. Each flip or rotation multiplies it on the right.
+        int m_orientation[4] = { 1, 0, 0, 1 };
+        bool m_resize = false;
+        int m_resizeWidth = 0; // In the source's orientation
+        int m_resizeHeight = 0;
+        ResizeFilter m_resizeFilter = ResizeFilter::Bilinear;
+        std::vector<std::pair<ColorOp, Color>> m_colorOps;
+
+        bool IsIdentityOrientation() const { return m_orientation[0] == 1 && m_orientation[1] == 0 && m_orientation[2] == 0 && m_orientation[3] == 1; }
+        bool SwapsAxes() const { return m_orientation[0] == 0; }
+        void Orient(int xx, int xy, int yx, int yy);
+    };
+}
@@ -90,5 +90,6 @@ namespace cx
         static void UpdateMouseWheel(float delta);
 
         friend class WindowsWindow;
+        friend class HeadlessWindow;
     };
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace cx
+{
+    // Work-stealing job pool shared by the engine's parallel systems. It starts on first use with one worker per CPU core,
+    // minus one for the calling thread, and is stopped by cx::Shutdown().
+
+    /// Calls func(begin, end) for consecutive ranges covering [0, count) on the job pool and returns once every range is done.
+    /// The calling thread works through ranges too, so this may be called from inside a job. A grainSize of 0 picks the range size automatically.
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& func);
+
+    /// Queues func to run once on a worker thread and returns immediately. These jobs are never picked up by threads waiting in ParallelFor(),
+    /// so long running work like file loading doesn't stall them. Runs func on the calling thread when there are no workers.
+    /// Jobs that haven't started when the job system shuts down are dropped.
+    void RunJobAsync(std::function<void()> func);
+
+    /// The number of worker threads, not counting the thread calling ParallelFor()
+    int GetJobWorkerCount();
+
+    /// Stops and joins the workers. Must not be called while a ParallelFor() is running.
+    void ShutdownJobSystem();
+}
@@ -72,19 +72,21 @@ namespace cx
 
         // Shader parameter management
         /// Sets shader float uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const float v);
+        void SetShaderParam(UniformId id, const float v);
         /// Sets shader int uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const int v);
+        void SetShaderParam(UniformId id, const int v);
         /// Sets shader vector2 (float[2]) uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const float(&v2)[2]);
+        void SetShaderParam(UniformId id, const float(&v2)[2]);
         /// Sets shader vector3 (float[3]) uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const float(&v3)[3]);
+        void SetShaderParam(UniformId id, const float(&v3)[3]);
         /// Sets shader vector4/quaternion (float[4]) uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const float(&v4)[4]);
+        void SetShaderParam(UniformId id, const float(&v4)[4]);
         /// Sets shader matrix (float[16]) uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, const float(&m4)[16]);
+        void SetShaderParam(UniformId id, const float(&m4)[16]);
         /// Sets shader texture uniforms only for this material. Use SetUniform() for global shader uniforms.
-        void SetShaderParam(std::string_view name, Texture* texture);
+        void SetShaderParam(UniformId id, Texture* texture);
+        /// Removes a shader parameter set with SetShaderParam()
+        void RemoveShaderParam(UniformId id);
 
         /// Applies the material shader parameters to the shader uniforms. WARNING: This should be only used internally.
         void ApplyShaderUniforms();
@@ -92,9 +94,25 @@ namespace cx
         /// Applies PBR material maps and properties to shader uniforms. WARNING: This should be only used internally.
         void ApplyPBRUniforms();
 
+        /// Changes whenever anything the material binds changes, including a material map's or texture parameter's texture being recreated.
+        /// The renderer skips re-applying a material whose version matches the one it last bound.
+        uint32_t GetVersion();
+
         // Clear all material data
         void Clear();
 
+        /// The PBR flags and properties, baked as vec4s. Shaders that declare u_MaterialBlock[5] receive it in one uniform,
+        /// otherwise each vec4 is sent to its own uniform (u_MaterialFlags0, u_MaterialFlags1, u_Albedo, u_EmissiveParams, u_MaterialProps).
+        enum MaterialBlockVec4
+        {
+            MaterialFlags0,     // hasAlbedo, hasNormal, hasMetallic, hasRoughness
+            MaterialFlags1,     // hasMetallicRoughness, hasAO, hasEmissive, hasOpacity
+            AlbedoColor,        // Albedo color
+            EmissiveParams,     // Emissive color, unused
+            MaterialProps,      // Metallic, roughness, AO, unused
+            MaterialBlockSize
+        };
+
     private:
         Shader* m_shader = nullptr;
 
@@ -109,31 +127,32 @@ namespace cx
         float m_ao = 1.0f;
 
         std::unordered_map<std::string, MaterialParam> m_UserParams;
-        std::vector<ShaderUniform> m_ShaderParams;
-
-        bgfx::UniformHandle m_hMaterialFlags0 = BGFX_INVALID_HANDLE;
-        bgfx::UniformHandle m_hMaterialFlags1 = BGFX_INVALID_HANDLE;
-        bgfx::UniformHandle m_hAlbedo = BGFX_INVALID_HANDLE;
-        bgfx::UniformHandle m_hEmissiveParams = BGFX_INVALID_HANDLE;
-        bgfx::UniformHandle m_hMaterialProps = BGFX_INVALID_HANDLE;
-        bgfx::UniformHandle m_hSamplerAlbedo = BGFX_INVALID_HANDLE;
-
-        uint8_t m_stageAlbedo = 255;
-        bgfx::UniformHandle m_hSamplerNormal = BGFX_INVALID_HANDLE;
-        uint8_t m_stageNormal = 255;
-        bgfx::UniformHandle m_hSamplerMetallic = BGFX_INVALID_HANDLE;
-        uint8_t m_stageMetallic = 255;
-        bgfx::UniformHandle m_hSamplerRoughness = BGFX_INVALID_HANDLE;
-        uint8_t m_stageRoughness = 255;
-        bgfx::UniformHandle m_hSamplerMetallicRoughness = BGFX_INVALID_HANDLE;
-        uint8_t m_stageMetallicRoughness = 255;
-        bgfx::UniformHandle m_hSamplerAO = BGFX_INVALID_HANDLE;
-        uint8_t m_stageAO = 255;
-        bgfx::UniformHandle m_hSamplerEmissive = BGFX_INVALID_HANDLE;
-        uint8_t m_stageEmissive = 255;
-        bgfx::UniformHandle m_hSamplerHeight = BGFX_INVALID_HANDLE;
-        uint8_t m_stageHeight = 255;
-        bgfx::UniformHandle m_hSamplerOpacity = BGFX_INVALID_HANDLE;
-        uint8_t m_stageOpacity = 255;
+        ShaderUniformTable m_ShaderParams;
+
+        // Baked uniforms. Every setter bumps m_version, and the next apply rebakes if m_bakedVersion is behind.
+        struct BakedMap
+        {
+            uint8_t stage;
+            bgfx::UniformHandle sampler;
+            Texture* texture;
+            bgfx::TextureHandle handle; // The texture's handle when baked, to notice recreated textures
+        };
+
+        uint32_t m_version = 1;
+        uint32_t m_bakedVersion = 0;
+        float m_uniformBlock[MaterialBlockSize][4] = {};
+        std::array<BakedMap, static_cast<size_t>(MaterialMapType::Count)> m_bakedMaps = {};
+        size_t m_bakedMapCount = 0;
+
+        // Uniform handles, owned by the shader
+        bgfx::UniformHandle m_hMaterialBlock = BGFX_INVALID_HANDLE;
+        std::array<bgfx::UniformHandle, MaterialBlockSize> m_hBlockUniforms = {};
+        std::array<bgfx::UniformHandle, static_cast<size_t>(MaterialMapType::Count)> m_hSamplers = {};
+        std::array<uint8_t, static_cast<size_t>(MaterialMapType::Count)> m_samplerStages = {};
+        bool m_uniformHandlesCached = false;
+
+        void MarkChanged() { ++m_version; }
+        void CacheUniformHandles();
+        void BakeUniforms();
     };
 }
\ No newline at end of file
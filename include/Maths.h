@@ -86,6 +86,13 @@ namespace cx
         Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
     };
 
+    struct Rect
+    {
+        float x, y, width, height;
+        Rect() : x(0), y(0), width(0), height(0) {}
+        Rect(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
+    };
+
     struct Matrix4;
 
     struct Quaternion
@@ -191,6 +198,51 @@ namespace cx
         }
     };
 
+    struct BoundingBox
+    {
+        Vector3 min;
+        Vector3 max;
+
+        BoundingBox() : min(INFINITY, INFINITY, INFINITY), max(-INFINITY, -INFINITY, -INFINITY) {} // Empty until a point is added
+        BoundingBox(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+        bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+        Vector3 GetCenter() const { return (min + max) * 0.5f; }
+        Vector3 GetExtents() const { return (max - min) * 0.5f; }
+
+        void Expand(const Vector3& point);
+        void Expand(const BoundingBox& box);
+
+        /// Returns the box that encloses this box after the transform
+        BoundingBox Transform(const Matrix4& transform) const;
+    };
+
+    struct BoundingSphere
+    {
+        Vector3 center;
+        float radius = -1.0f; // Negative when empty
+
+        BoundingSphere() = default;
+        BoundingSphere(const Vector3& center, float radius) : center(center), radius(radius) {}
+
+        bool IsValid() const { return radius >= 0.0f; }
+
+        /// Returns the sphere that encloses this sphere after the transform, using the transform's largest axis scale
+        BoundingSphere Transform(const Matrix4& transform) const;
+    };
+
+    /// The six planes of a view volume, pointing inwards. Each plane is (normal.xyz, distance) so points inside satisfy dot(normal, p) + distance >= 0.
+    struct Frustum
+    {
+        Vector4 planes[6]; // Left, right, bottom, top, near, far
+
+        /// Extracts the planes from a projection * view matrix. homogeneousDepth is true when clip space depth is -1 to 1, otherwise 0 to 1.
+        static Frustum FromMatrix(const Matrix4& viewProjection, bool homogeneousDepth);
+
+        bool Intersects(const BoundingBox& box) const;
+        bool Intersects(const BoundingSphere& sphere) const;
+    };
+
     struct Color
     {
         unsigned char r, g, b, a;
@@ -25,6 +25,66 @@ namespace cx
         }
     };
 
+    enum class PositionEncoding
+    {
+        Float,          // 3x float
+        Quantized16     // 4x snorm16 relative to the mesh bounds. Dequantized through the draw transform, so shaders don't need changes. Ignored for skinned and morphed meshes.
+    };
+
+    enum class NormalEncoding
+    {
+        Float,          // Normal 3x float, tangent 4x float
+        Snorm16,        // Normal and tangent as 4x snorm16. Read directly by shaders.
+        Octahedral16,   // Normal as 2x snorm16 octahedral, tangent as 4x snorm16 (octahedral xy, handedness, 0). Requires decoding in the shader.
+        Packed1010102   // Normal and tangent as 10:10:10:2 unorm (xyz * 0.5 + 0.5, handedness in w). Requires decoding in the shader. Falls back to Snorm16 if unsupported.
+    };
+
+    enum class TexCoordEncoding
+    {
+        Float,
+        Half            // Falls back to Float if unsupported
+    };
+
+    enum class BoneWeightEncoding
+    {
+        Float,
+        Unorm8,
+        Unorm16         // Stored as positive snorm16 (15 bits of precision) since bgfx has no unsigned 16-bit attribute type
+    };
+
+    /// Describes how a mesh is packed into its GPU vertex buffer. The CPU side always keeps the full Vertex data.
+    /// Meshes that aren't skinned keep zeroed uint8 skinning streams for shaders that declare them, and the second UV set is dropped if it is unused.
+    /// Shaders can read u_VertexDecode.x to know the normal encoding (the NormalEncoding value).
+    struct VertexFormat
+    {
+        PositionEncoding position = PositionEncoding::Float;
+        NormalEncoding normal = NormalEncoding::Float;
+        TexCoordEncoding texCoord = TexCoordEncoding::Float;
+        BoneWeightEncoding boneWeights = BoneWeightEncoding::Float;
+        bool compactBoneIndices = false; // uint8 bone indices when the mesh references fewer than 256 bones, otherwise int16
+
+        /// Full precision floats for every stream
+        static VertexFormat Full() { return VertexFormat(); }
+
+        /// Compact encodings that existing shaders can read without changes
+        static VertexFormat Compact()
+        {
+            VertexFormat format;
+            format.position = PositionEncoding::Quantized16;
+            format.normal = NormalEncoding::Snorm16;
+            format.texCoord = TexCoordEncoding::Half;
+            format.boneWeights = BoneWeightEncoding::Unorm8;
+            format.compactBoneIndices = true;
+            return format;
+        }
+    };
+
+    /// Morph targets are blended in the vertex shader when the shader supports it (see Shader::SupportsGPUMorphTargets()).
+    /// The deltas of every target are uploaded once into an RGBA32F texture, u_MorphDeltas, with 3 texels per vertex per target
+    /// (position, normal, tangent) at texel (target * vertexCount + vertex) * 3 + attribute, wrapped at u_MorphParams.z texels per row.
+    /// Only targets with a non-zero weight are sent: u_MorphWeights and u_MorphIndices hold up to MaxGPUMorphTargets weights and
+    /// target indices, 4 per vec4, and u_MorphParams.x is how many are used (0 when the draw has no morphing).
+    /// Otherwise the morphed vertices are computed on the CPU into a double-buffered dynamic vertex buffer, only when the weights change.
     struct MorphTarget
     {
         std::vector<Vector3> positionDeltas;
@@ -50,18 +110,62 @@ namespace cx
         void Upload();
         void Destroy();
 
+        /// Local space bounds, computed when the vertices are set or uploaded. They include the furthest reach of the morph targets,
+        /// assuming weights between 0 and 1. Call ComputeBounds() after editing the vertices through GetVertices() without re-uploading.
+        const BoundingBox& GetBounds() const { return m_bounds; }
+        const BoundingSphere& GetBoundingSphere() const { return m_boundingSphere; }
+        void ComputeBounds();
+
+        /// Conservative bounds of the skinned mesh posed by the given skinning matrices. Every vertex lies within the bind pose
+        /// bounds of the bones influencing it, so the union of those boxes after each bone's transform encloses the posed mesh.
+        BoundingBox GetSkinnedBounds(const std::vector<Matrix4>& boneMatrices) const;
+
+        /// Sets the GPU vertex format. Takes effect on the next Upload().
+        void SetVertexFormat(const VertexFormat& format) { m_vertexFormat = format; m_uploaded = false; }
+        const VertexFormat& GetVertexFormat() const { return m_vertexFormat; }
+
+        /// The vertex format used by meshes created after this call
+        static void SetDefaultVertexFormat(const VertexFormat& format) { s_defaultVertexFormat = format; }
+        static const VertexFormat& GetDefaultVertexFormat() { return s_defaultVertexFormat; }
+
+        /// Size in bytes of one vertex in the uploaded vertex buffer
+        uint32_t GetVertexStride() const { return m_layout.getStride(); }
+        const bgfx::VertexLayout& GetVertexLayout() const { return m_layout; }
+
+        /// Returns true if the uploaded positions are quantized. The dequantization transform must then be applied after the model transform.
+        bool HasQuantizedPositions() const { return m_quantizedPositions; }
+        const Matrix4& GetDequantizationTransform() const { return m_dequantization; }
+
+        /// The normal encoding that was actually uploaded, after capability fallbacks
+        NormalEncoding GetUploadedNormalEncoding() const { return m_uploadedNormalEncoding; }
+
         bgfx::VertexBufferHandle GetVertexBuffer() const { return m_vbh; }
         bgfx::IndexBufferHandle GetIndexBuffer() const { return m_ibh; }
         void UpdateBuffer();
         bool IsValid() const { return bgfx::isValid(m_vbh) && bgfx::isValid(m_ibh); }
 
-        void SetMorphTargets(const std::vector<MorphTarget>& targets) { m_dynamic = true; m_morphTargets = targets; }
-        void SetMorphWeights(const std::vector<float>& weights) { m_morphWeights = weights; }
+        /// Binds the vertex buffer for the next draw. With useMorphedVertices, the CPU morphed buffer is bound if ApplyMorphTargets() produced one.
+        void BindVertexBuffer(bool useMorphedVertices = false) const;
+
+        static constexpr uint32_t MaxGPUMorphTargets = 128; // Most targets with a non-zero weight that can be blended in a single GPU draw
+
+        void SetMorphTargets(const std::vector<MorphTarget>& targets);
+        void SetMorphWeights(const std::vector<float>& weights);
         const std::vector<MorphTarget>& GetMorphTargets() const { return m_morphTargets; }
         const std::vector<float>& GetMorphWeights() const { return m_morphWeights; }
         bool HasMorphTargets() const { return !m_morphTargets.empty(); }
+
+        /// CPU fallback. Writes the morphed vertices into the dynamic vertex buffer. Does nothing unless the weights changed since the last call.
         void ApplyMorphTargets();
 
+        /// Uploads the morph target deltas into the GPU delta texture if they changed. Returns false if the texture couldn't be created.
+        bool UploadMorphTargets();
+        bgfx::TextureHandle GetMorphTexture() const { return m_morphTexture; }
+        uint16_t GetMorphTextureWidth() const { return m_morphTextureWidth; }
+
+        /// Writes the weights and target indices of the targets with a non-zero weight, up to maxCount of each. Returns the total number of them.
+        uint32_t GetActiveMorphTargets(float* weights, float* indices, uint32_t maxCount) const;
+
         void SetMaterial(Material* material);
         Material* GetMaterial() { return m_material; }
 
@@ -77,8 +181,39 @@ namespace cx
         std::vector<MorphTarget> m_morphTargets;
         std::vector<float> m_morphWeights;
         bool m_dynamic = false;
+        bool m_hasTexCoord1 = false;
+
+        // GPU morph targets
+        bgfx::TextureHandle m_morphTexture = BGFX_INVALID_HANDLE;
+        uint16_t m_morphTextureWidth = 0;
+        bool m_morphTextureDirty = true;
+
+        // CPU morph fallback. The buffers alternate once per frame so an update never touches the buffer the previous frame drew with.
+        bgfx::DynamicVertexBufferHandle m_morphVertexBuffers[2] = { BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE };
+        int m_morphVertexBuffer = -1; // The buffer holding the latest morphed vertices, -1 when the static buffer is drawn
+        int m_morphWriteBuffer = -1; // The buffer last written, kept while the static buffer is drawn
+        uint32_t m_morphWriteFrame = 0; // Renderer frame of the last write
+        bool m_morphWeightsDirty = true;
+        std::vector<Vertex> m_morphedVertices;
+
+        // Bounds
+        BoundingBox m_bounds;
+        BoundingSphere m_boundingSphere;
+        std::vector<BoundingBox> m_boneBounds; // Bind pose bounds of the vertices each bone influences, indexed by bone
         bool m_uploaded;
         bool m_skinned;
         Material* m_material;
+
+        // GPU vertex format
+        static VertexFormat s_defaultVertexFormat;
+        VertexFormat m_vertexFormat;
+        bgfx::VertexLayout m_layout;
+        NormalEncoding m_uploadedNormalEncoding = NormalEncoding::Float;
+        bool m_quantizedPositions = false;
+        Matrix4 m_dequantization;
+
+        std::vector<uint8_t> PackVertices(const std::vector<Vertex>& vertices, const VertexFormat& format, bool hasSkin, bool hasTexCoord1);
+        const bgfx::Memory* BuildVertexMemory(const std::vector<Vertex>& vertices);
+        void DestroyMorphBuffers();
     };
 }
\ No newline at end of file
@@ -135,4 +135,10 @@ namespace cx
 
         void MarkTransformDirty() { m_transformDirty = true; }
     };
+
+    /// Updates the animations of many models in parallel on the job pool. Animation events, state callbacks and morph weight changes
+    /// are deferred and applied on the calling thread, in model order, before this returns. A model may only appear once per call.
+    /// Models sharing a Skeleton update one after another in model order, as they would in a loop calling UpdateAnimation().
+    void UpdateAnimations(Model* const* models, size_t count, float deltaTime);
+    void UpdateAnimations(const std::vector<Model*>& models, float deltaTime);
 }
\ No newline at end of file
@@ -31,12 +31,14 @@ namespace cx
         int triangles = 0;
         int vertices = 0;
         int indicies = 0;
-        int textureBinds = 0;
-        int shaderSwitches = 0;
+        int textureBinds = 0; // Material textures bound. Draws that reuse the previous draw's unchanged material don't rebind them.
+        int shaderSwitches = 0; // Draws that use a different shader than the previous draw
         float cpuTime = 0.0f;
         float gpuTime = 0.0f;
         int textureMemoryUsed = 0.0f;
         int gpuMemoryUsed = 0.0f;
+        int culledObjects = 0; // Meshes and instances rejected by frustum culling
+        int visibleObjects = 0; // Meshes and instances that passed frustum culling
     };
 
     struct ProfileMarker
@@ -60,6 +62,15 @@ namespace cx
         // Blend mode
         BlendMode currentBlendMode = BlendMode::None;
 
+        // Frustum culling. The frustum comes from the view transform of the current view.
+        bool frustumCullingEnabled = true;
+        bool hasViewFrustum = false;
+        Frustum viewFrustum;
+
+        // Texture streaming. Pixels covered per world unit at a distance of one, or overall for orthographic views.
+        bool perspectiveView = true;
+        float viewPixelScale = 0.0f;
+
         // Statistics
         DrawStats drawStats;
         std::chrono::steady_clock::time_point frameStartTime;
@@ -70,7 +81,13 @@ namespace cx
         std::vector<ProfileMarker> profileMarkers;
         std::chrono::steady_clock::time_point currentMarkerStart;
         std::string currentMarkerName;
-        Shader* lastShader;
+        Shader* lastShader; // Shader of the last submitted draw, used to count shader switches
+
+        // Deferred draw queue
+        bool drawQueueEnabled = false;
+
+        // Views switched to sequential mode this frame, put back to bgfx's default mode by BeginFrame()
+        std::vector<uint16_t> sequentialViews;
     };
     extern RendererState* s_renderer;
 
@@ -83,12 +100,22 @@ namespace cx
         const std::vector<Matrix4>* boneMatrices;
         bool isSkinned;
 
+        // Persistent GPU instance data. This survives Clear() so unchanged transforms are not re-uploaded every frame.
+        bgfx::DynamicVertexBufferHandle instanceBuffer;
+        uint32_t instanceCapacity;
+        std::vector<Matrix4> uploadedTransforms; // Mirror of the data in instanceBuffer, used to find the dirty range
+        Matrix4 uploadedDequantization; // The mesh's dequantization transform when uploadedTransforms was written
+        uint32_t lastSubmitFrame;
+
         InstanceBatch()
             : mesh(nullptr)
             , material(nullptr)
             , shader(nullptr)
             , boneMatrices(nullptr)
             , isSkinned(false)
+            , instanceBuffer(BGFX_INVALID_HANDLE)
+            , instanceCapacity(0)
+            , lastSubmitFrame(UINT32_MAX)
         {
             transforms.reserve(64);
         }
@@ -142,7 +169,9 @@ namespace cx
     void DrawModel(Model* model, const Vector3& position, const Vector3& rotation, const Vector3& scale);
     void DrawModel(Model* model);
 
-    /// Draws instanced meshes. This is automatically called from EndInstancing();
+    /// Draws instanced meshes with a single submit per mesh, material and shader.
+    /// Instance transforms are kept in a persistent GPU buffer and only the range that changed since the last draw is uploaded.
+    /// This is automatically called from SubmitInstances();
     void DrawMeshInstanced(Mesh* mesh, const std::vector<Matrix4>& transforms, const std::vector<Matrix4>* boneMatrices = nullptr);
 
     /// Add a model to the instance batch with specified a transform
@@ -161,6 +190,18 @@ namespace cx
     void SetDepthTest(bool enabled);
     void SetWireframe(bool enabled);
 
+    /// Records DrawMesh() and DrawModel() calls and submits them at EndFrame(), sorted by view, blending, shader, material, mesh and depth.
+    /// Opaque draws go front-to-back, alpha blended draws back-to-front, and uniforms and textures are only rebound when the material changes.
+    /// Views that receive queued draws are switched to sequential mode for the frame so bgfx keeps the sorted order. Bone palettes are copied
+    /// when drawn, but material and shader uniforms and textures are read at EndFrame(), so every queued draw of a material uses its last values.
+    /// Disabled by default.
+    void SetDrawQueueEnabled(bool enabled);
+    bool IsDrawQueueEnabled();
+
+    /// Skips models, meshes and instances outside the current camera's view. Enabled by default.
+    void SetFrustumCulling(bool enabled);
+    bool IsFrustumCullingEnabled();
+
     int GetViewWidth();
     int GetViewHeight();
 
@@ -169,6 +210,14 @@ namespace cx
     // Blend Mode
     void SetBlendMode(BlendMode mode);
     BlendMode GetBlendMode();
+    /// The bgfx state bits for a blend mode
+    uint64_t GetBlendState(BlendMode mode);
+
+    /// Makes the next mesh draw re-apply its material. Call after submitting draws that don't keep their bindings. WARNING: This should only be used internally!
+    void InvalidateBoundMaterial();
+    /// Switches the view to sequential mode until the next BeginFrame(), which puts it back to the default mode. bgfx applies a view's mode
+    /// to the whole frame, so everything drawn into the view this frame keeps submission order. WARNING: This should only be used internally!
+    void SetViewSequentialForFrame(uint16_t viewId);
 
     // Performance Stats
     void ResetDrawStats();
@@ -178,6 +227,8 @@ namespace cx
     int GetIndexCount();
     int GetTextureBindCount();
     int GetShaderSwitchCount();
+    int GetCulledObjectCount();
+    int GetVisibleObjectCount();
     float GetCPUFrameTime();
     float GetGPUFrameTime();
     const DrawStats& GetDrawStats();
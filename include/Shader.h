@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
 #include <unordered_map>
 #include <cstdint>
 #include "Texture.h"
@@ -19,20 +21,85 @@ namespace cx
         Sampler
     };
 
+    using ShaderUniformValue = std::variant<
+        float,
+        int,
+        std::array<float, 2>,
+        std::array<float, 3>,
+        std::array<float, 4>,
+        std::array<float, 16>,
+        Texture*>;
+
+    /// Identifies a uniform by name and its FNV-1a hash. Constructing one from a string literal in a constexpr variable hashes the name
+    /// at compile time, e.g. static constexpr UniformId u_CameraPos("u_CameraPos"). Ids made from a string only reference it,
+    /// so use Intern() for names built at runtime that need to outlive the string.
+    class UniformId
+    {
+    public:
+        constexpr UniformId() = default;
+        constexpr UniformId(const char* name) : m_name(name), m_hash(Hash(m_name)) {}
+        constexpr UniformId(std::string_view name) : m_name(name), m_hash(Hash(name)) {}
+        UniformId(const std::string& name) : UniformId(std::string_view(name)) {}
+
+        /// Returns an id whose name is stored for the lifetime of the program
+        static UniformId Intern(std::string_view name);
+
+        static constexpr uint32_t Hash(std::string_view name)
+        {
+            uint32_t hash = 2166136261u;
+            for (char c : name)
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        constexpr std::string_view GetName() const { return m_name; }
+        constexpr uint32_t GetHash() const { return m_hash; }
+
+        bool operator==(const UniformId& other) const { return m_hash == other.m_hash && m_name == other.m_name; }
+        bool operator!=(const UniformId& other) const { return !(*this == other); }
+
+    private:
+        std::string_view m_name;
+        uint32_t m_hash = 0;
+    };
+
     struct ShaderUniform
     {
-        std::string name;
+        UniformId id; // Interned
         UniformType type;
-        std::variant<
-            float,
-            int,
-            std::array<float, 2>,
-            std::array<float, 3>,
-            std::array<float, 4>,
-            std::array<float, 16>,
-            Texture*> value;
+        ShaderUniformValue value;
         bgfx::UniformHandle cachedUniform = BGFX_INVALID_HANDLE;
         uint8_t cachedStage = 255;
+        uint16_t appliedTexture = bgfx::kInvalidHandle; // The texture's handle when last applied, to notice recreated textures
+    };
+
+    /// A small table of uniform values keyed by UniformId. Setting a name that is already in the table overwrites its value in place,
+    /// so values updated every frame don't grow it, and each entry's bgfx handle is only resolved the first time it is applied.
+    class ShaderUniformTable
+    {
+    public:
+        /// Returns true if the value was added or changed
+        bool Set(UniformId id, UniformType type, const ShaderUniformValue& value);
+        bool Remove(UniformId id);
+        ShaderUniform* Find(UniformId id);
+
+        /// Forgets the resolved handles, e.g. when the uniforms should be applied to a different shader
+        void ResetHandles();
+        /// True if a texture applied from the table has been recreated, streamed or finished loading since, so its handle changed
+        bool HasChangedTextures() const;
+        void Clear() { m_uniforms.clear(); }
+
+        size_t Size() const { return m_uniforms.size(); }
+        bool Empty() const { return m_uniforms.empty(); }
+
+        std::vector<ShaderUniform>::iterator begin() { return m_uniforms.begin(); }
+        std::vector<ShaderUniform>::iterator end() { return m_uniforms.end(); }
+
+    private:
+        std::vector<ShaderUniform> m_uniforms;
     };
 
     class Shader
@@ -54,14 +121,24 @@ namespace cx
         void Destroy();
         bool IsValid() const;
 
+        /// True if the vertex shader blends morph targets itself, detected by it declaring u_MorphWeights. See MorphTarget in Mesh.h.
+        bool SupportsGPUMorphTargets() const;
+
+        /// True if the shader declares u_MaterialBlock[5], which then receives every material's packed PBR uniforms in one call
+        bool UsesPackedMaterialBlock() const;
+
+        /// Changes whenever a global uniform is set, a texture uniform's texture is recreated, or the shader is reloaded.
+        /// The renderer skips re-applying uniforms while it matches.
+        uint32_t GetVersion();
+
         // Uniform setters
-        void SetUniform(std::string_view name, const float v);
-        void SetUniform(std::string_view name, const int v);
-        void SetUniform(std::string_view name, const float(&v2)[2]);
-        void SetUniform(std::string_view name, const float(&v3)[3]);
-        void SetUniform(std::string_view name, const float(&v4)[4]);
-        void SetUniform(std::string_view name, const float(&m4)[16]);
-        void SetUniform(std::string_view name, Texture* texture);
+        void SetUniform(UniformId id, const float v);
+        void SetUniform(UniformId id, const int v);
+        void SetUniform(UniformId id, const float(&v2)[2]);
+        void SetUniform(UniformId id, const float(&v3)[3]);
+        void SetUniform(UniformId id, const float(&v4)[4]);
+        void SetUniform(UniformId id, const float(&m4)[16]);
+        void SetUniform(UniformId id, Texture* texture);
 
         //bool HasUniform(std::string_view name) const;
 
@@ -74,21 +151,22 @@ namespace cx
 
     private:
         ShaderImpl* m_impl;
-        std::vector<ShaderUniform> m_Uniforms;
-        std::unordered_map<std::string, size_t> m_UniformIndices;
+        ShaderUniformTable m_Uniforms;
+        uint32_t m_version = 1;
 
         void* LoadShaderFile(std::string_view path) const;
 
-        bgfx::UniformHandle GetOrCreateUniform(std::string_view name, UniformType type, uint16_t num) const;
-        bgfx::UniformHandle GetOrCreateSamplerUniform(std::string_view name) const;
-        uint8_t GetSamplerStage(std::string_view name) const;
-        void SetUniformInternal(std::string_view name, const float v) const;
-        void SetUniformInternal(std::string_view name, const int v) const;
-        void SetUniformInternal(std::string_view name, const float(&v2)[2]) const;
-        void SetUniformInternal(std::string_view name, const float(&v3)[3]) const;
-        void SetUniformInternal(std::string_view name, const float(&v4)[4]) const;
-        void SetUniformInternal(std::string_view name, const float(&m4)[16]) const;
-        void SetUniformInternal(std::string_view name, const Texture* texture) const;
+        bgfx::UniformHandle GetOrCreateUniform(UniformId id, UniformType type, uint16_t num) const;
+        bgfx::UniformHandle GetOrCreateSamplerUniform(UniformId id) const;
+        uint8_t GetSamplerStage(UniformId id) const;
+        void ApplyUniformTable(ShaderUniformTable& uniforms) const;
+        void SetUniformInternal(UniformId id, const float v) const;
+        void SetUniformInternal(UniformId id, const int v) const;
+        void SetUniformInternal(UniformId id, const float(&v2)[2]) const;
+        void SetUniformInternal(UniformId id, const float(&v3)[3]) const;
+        void SetUniformInternal(UniformId id, const float(&v4)[4]) const;
+        void SetUniformInternal(UniformId id, const float(&m4)[16]) const;
+        void SetUniformInternal(UniformId id, const Texture* texture) const;
     };
 
     extern Shader* s_defaultShader;
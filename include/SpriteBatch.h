@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Maths.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include <bgfx.h>
+#include <vector>
+
+namespace cx
+{
+    enum class SpriteSortMode
+    {
+        Texture, // Sorts each layer by blend mode and texture for the fewest draw calls. Sprites in a layer may draw in any order.
+        Deferred // Keeps the draw order within each layer, merging only consecutive sprites that share a texture and blend mode
+    };
+
+    /// Records sprites and shapes between Begin() and End(), then draws them from transient vertex and index buffers with one submit
+    /// per run of sprites sharing a texture and blend mode. Positions are in the current view's space, which for Camera2D has Y pointing up,
+    /// so a sprite's position is its bottom left corner and the top edge shows the image's first row.
+    /// The shader receives a_position (vec3), a_texcoord0 (vec2) and a_color0 (vec4, the tint), and samples the texture from u_SpriteTexture.
+    class SpriteBatch
+    {
+    public:
+        SpriteBatch();
+        ~SpriteBatch();
+        SpriteBatch(const SpriteBatch&) = delete;
+        SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+        void SetShader(Shader* shader) { m_shader = shader; }
+        Shader* GetShader() const { return m_shader; }
+
+        /// Starts recording into the current view, so call it after BeginCamera()
+        void Begin(SpriteSortMode sortMode = SpriteSortMode::Texture);
+        /// Sorts and submits everything recorded since Begin(). The view is switched to sequential mode for the rest of the frame so layers keep
+        /// their order, which also stops bgfx sorting other draws in it that frame. Give sprites their own camera when they share a frame with meshes.
+        void End();
+
+        /// Applies to the draws that follow. Defaults to Alpha.
+        void SetBlendMode(BlendMode mode) { m_blendMode = mode; }
+        BlendMode GetBlendMode() const { return m_blendMode; }
+        /// Lower layers draw first. Applies to the draws that follow. Defaults to 0.
+        void SetLayer(int layer) { m_layer = layer; }
+        int GetLayer() const { return m_layer; }
+
+        // Textures
+        void DrawTexture(Texture* texture, const Vector2& position, const Color& tint = Color::White());
+        void DrawTexture(Texture* texture, const Vector2& position, float rotation, float scale, const Color& tint = Color::White());
+        /// Draws the part of the texture in source, in texels from its top left. A negative width or height flips it.
+        void DrawTextureRec(Texture* texture, const Rect& source, const Vector2& position, const Color& tint = Color::White());
+        /// Draws source stretched over dest, rotated counter-clockwise in degrees around origin, which is relative to dest's position
+        void DrawTexturePro(Texture* texture, const Rect& source, const Rect& dest, const Vector2& origin, float rotation, const Color& tint = Color::White());
+
+        // Atlas regions. Sprites from the same page batch together.
+        void DrawRegion(const TextureAtlas& atlas, const AtlasRegion& region, const Vector2& position, const Color& tint = Color::White());
+        void DrawRegion(const TextureAtlas& atlas, const AtlasRegion& region, const Rect& dest, const Vector2& origin, float rotation, const Color& tint = Color::White());
+
+        // Shapes
+        void DrawRectangle(const Rect& rect, const Color& color);
+        void DrawRectangle(const Rect& rect, const Vector2& origin, float rotation, const Color& color);
+        void DrawLine(const Vector2& start, const Vector2& end, float thickness, const Color& color);
+        /// segments is picked from the radius when 0
+        void DrawCircle(const Vector2& center, float radius, const Color& color, int segments = 0);
+
+        /// Sprites and shapes recorded since Begin()
+        size_t GetRecordedCount() const { return m_items.size(); }
+
+    private:
+        struct SpriteVertex
+        {
+            float x, y, z;
+            float u, v;
+            uint32_t color; // RGBA8
+        };
+
+        struct SpriteItem
+        {
+            uint64_t key;
+            uint32_t firstVertex;
+            uint32_t firstIndex;
+            uint16_t vertexCount;
+            uint16_t indexCount;
+            bgfx::TextureHandle texture;
+            BlendMode blendMode;
+        };
+
+        Shader* m_shader = nullptr;
+        SpriteSortMode m_sortMode = SpriteSortMode::Texture;
+        BlendMode m_blendMode = BlendMode::Alpha;
+        int m_layer = 0;
+        uint16_t m_viewId = 0;
+
+        std::vector<SpriteItem> m_items;
+        std::vector<SpriteVertex> m_vertices;
+        std::vector<uint16_t> m_indices; // Relative to the item's first vertex
+        std::vector<uint32_t> m_order;
+        bgfx::VertexLayout m_layout;
+        bgfx::UniformHandle m_textureSampler = BGFX_INVALID_HANDLE;
+
+        SpriteVertex* AddItem(bgfx::TextureHandle texture, uint16_t vertexCount, uint16_t indexCount, uint16_t*& outIndices);
+        void AddQuad(bgfx::TextureHandle texture, const Vector2 (&corners)[4], float u0, float v0, float u1, float v1, const Color& color);
+        void AddQuad(bgfx::TextureHandle texture, const Rect& dest, const Vector2& origin, float rotation, float u0, float v0, float u1, float v1, const Color& color);
+        void Flush();
+    };
+}
@@ -3,10 +3,48 @@
 #include <bgfx.h>
 #include <vector>
 #include <string>
+#include <memory>
 #include "Maths.h"
+#include "Image.h"
 
 namespace cx
 {
+    struct TextureStreamingState;
+    struct AsyncTextureLoad;
+    struct DecodedImage;
+    class Texture;
+
+    /// The 1x1 texture an async load shows until its upload, chosen so the material looks as it would without the map
+    enum class TexturePlaceholder
+    {
+        White, // Color, AO and opacity maps, and metallic and roughness maps, which scale the material's own values
+        Black, // Emissive and height maps, so nothing glows or is displaced
+        FlatNormal, // Normal maps
+        Count
+    };
+
+    /// Returned by the async texture loads. The texture can be used right away and shows a placeholder until its upload,
+    /// which happens at the start of a frame after decoding finishes on the job pool.
+    class TextureHandleFuture
+    {
+    public:
+        TextureHandleFuture() = default;
+
+        Texture* GetTexture() const { return m_texture; }
+        bool IsValid() const { return m_load != nullptr; }
+        /// True once the decoded image has replaced the placeholder
+        bool IsReady() const;
+        /// True if decoding or uploading failed. The texture keeps showing the placeholder.
+        bool HasFailed() const;
+
+    private:
+        friend class Texture;
+        TextureHandleFuture(Texture* texture, std::shared_ptr<AsyncTextureLoad> load);
+
+        Texture* m_texture = nullptr;
+        std::shared_ptr<AsyncTextureLoad> m_load;
+    };
+
     class Texture
     {
     public:
@@ -15,17 +53,48 @@ namespace cx
         /// Called once per frame to process async readback operations. WARNING: This should only be used internally!
         static void ProcessPendingReadbacks(uint32_t currentFrame);
 
+        /// Called once per frame to apply finished mip loads, request the mips last frame's draws needed and evict over the budget. WARNING: This should only be used internally!
+        static void UpdateStreaming(uint32_t currentFrame);
+        static bool HasStreamedTextures();
+
+        /// Called once per frame to upload textures that finished decoding. WARNING: This should only be used internally!
+        static void ProcessAsyncUploads();
+
+        /// The texture async loads show until they are uploaded
+        static Texture* GetPlaceholderTexture(TexturePlaceholder placeholder);
+
         Texture();
         ~Texture();
 
         // Loading functions
         bool LoadFromFile(std::string_view path, bool isColorTexture = true);
-        bool LoadFromMemory(const void* data, int width, int height, int channels, bool isColorTexture = true);
+        /// Builds the full mip chain on the CPU when mipOptions is set. Color textures are filtered in linear space.
+        bool LoadFromMemory(const void* data, int width, int height, int channels, bool isColorTexture = true, const MipGenerationOptions* mipOptions = nullptr);
+        /// Decodes an image file already in memory. PNG, JPG and the other formats stb_image reads become RGBA8, KTX2 is transcoded with its mips
+        /// to the best compressed format the GPU supports (BC7, ASTC, BC3/BC1 or ETC2, RGBA8 if none) and DDS, KTX and other container formats keep their stored format.
+        /// When mipOptions is set, 8 bit images stored without mips get a generated chain.
+        bool LoadFromEncodedMemory(const void* data, size_t size, bool isColorTexture = true, const MipGenerationOptions* mipOptions = nullptr);
+
+        /// Loads the file like LoadFromFile(), decoding it on the job pool. The texture shows the given placeholder until it's uploaded at the start of a later frame.
+        /// Mips requested with mipOptions are generated on the job pool too.
+        TextureHandleFuture LoadAsync(std::string_view path, bool isColorTexture = true, const MipGenerationOptions* mipOptions = nullptr,
+            TexturePlaceholder placeholder = TexturePlaceholder::White);
+        /// Decodes the image like LoadFromEncodedMemory() on the job pool. The texture shows the given placeholder until it's uploaded at the start of a later frame.
+        TextureHandleFuture LoadFromEncodedMemoryAsync(std::vector<uint8_t> data, bool isColorTexture = true, const MipGenerationOptions* mipOptions = nullptr,
+            TexturePlaceholder placeholder = TexturePlaceholder::White);
+        bool IsLoading() const { return m_asyncLoadId != 0; }
+        /// Loads a file that stores a full mip chain (DDS, KTX) with only its small mips resident. Larger mips are loaded on the job pool
+        /// as draws show the texture larger on screen, and dropped again, least recently used first, when over SetTextureStreamingBudget().
+        /// GetWidth() and GetHeight() report the resident size. Files without a full mip chain are loaded whole, like LoadFromFile().
+        bool LoadStreamed(std::string_view path, bool isColorTexture = true);
 
         // Creation functions
         bool CreateEmpty(int width, int height, int channels = 4, bool isColorTexture = true);
         bool CreateSolidColor(int width, int height, const Color& color);
         bool CreateCheckerboard(int width, int height, int checkerSize = 8, const Color& color1 = Color::White(), const Color& color2 = Color::Black());
+        /// Creates a texture without mips whose pixels are uploaded later with UpdateRegion() or SetPixelData(). The GPU only allows
+        /// updating textures created without initial data, so use this for textures that change after creation.
+        bool CreateDynamic(int width, int height, int channels = 4, bool isColorTexture = true);
 
         // Save functions
         /// Save texture to file. Supports PNG, JPG, TGA, and BMP.
@@ -38,6 +107,8 @@ namespace cx
         // Pixel data access
         bool GetPixelData(std::vector<uint8_t>& outData);
         bool SetPixelData(const void* data, int channels);
+        /// Replaces a rectangle of a CreateDynamic() texture with tightly packed pixels in the texture's channel count
+        bool UpdateRegion(int x, int y, int width, int height, const void* data);
         Color GetPixel(int x, int y);
         void SetPixel(int x, int y, const Color& color);
         bool IsCacheReady() const { return m_cachePixelData && !m_cachedPixelData.empty(); }
@@ -52,17 +123,26 @@ namespace cx
         bool IsColorTexture() const { return m_isColorTexture; }
         bool IsValid() const { return bgfx::isValid(m_handle); }
         bool HasMipmaps() const { return m_hasMipmaps; }
+        bool IsStreamed() const { return m_streaming != nullptr; }
+        /// The most detailed mip on the GPU, counted from the file's full size. Always 0 for textures that aren't streamed.
+        int GetResidentMip() const;
+
+        /// Records that a draw showed this texture across screenPixels pixels. WARNING: This should only be used internally!
+        void NoteStreamingUsage(float screenPixels);
         float GetAspectRatio() const { return m_width > 0 ? (float)m_width / m_height : 0.0f; }
 
-        // Texture operations
-        bool Resize(int newWidth, int newHeight);
-        bool GenerateMipmaps();
+        // Texture operations. Each one is a single pass over the pixels and one upload, use ApplyOperations() to chain several into one.
+        bool Resize(int newWidth, int newHeight, ResizeFilter filter = ResizeFilter::Bilinear);
+        /// Rebuilds the texture with a full mip chain filtered from its pixels. Later pixel edits keep the mips up to date.
+        bool GenerateMipmaps(const MipGenerationOptions& options = MipGenerationOptions());
         bool FlipVertical();
         bool FlipHorizontal();
         bool Rotate90(bool clockwise = true);
         bool Grayscale();
         bool Invert();
         bool ApplyTint(const Color& color);
+        /// Runs the whole chain with one pass over the pixels and one upload. Like the single operations, it's queued until the pixel cache is loaded.
+        bool ApplyOperations(const ImageOperations& operations);
 
         // Utility functions
         void Destroy();
@@ -71,24 +151,13 @@ namespace cx
         bool LoadPixelDataToCache();
 
     private:
-        enum class PendingOpType
-        {
-            Resize,
-            FlipVertical,
-            FlipHorizontal,
-            Rotate90CW,
-            Rotate90CCW,
-            Grayscale,
-            Invert,
-            ApplyTint,
-            SetPixel
-        };
-
+        // An edit made before the readback finished. Consecutive image operations share one entry so they run as a single pass.
         struct PendingOperation
         {
-            PendingOpType type;
-            int param1;
-            int param2;
+            ImageOperations operations;
+            bool isSetPixel = false;
+            int x = 0;
+            int y = 0;
             Color color;
         };
 
@@ -113,13 +182,44 @@ namespace cx
         bool m_cachePixelData;
         std::vector<uint8_t> m_cachedPixelData;
         bool m_readbackPending;
+        TextureStreamingState* m_streaming;
+        uint64_t m_asyncLoadId; // 0 unless an async load is in flight
+        bool m_showsPlaceholder; // m_handle belongs to the placeholder texture
+        MipGenerationOptions m_mipOptions; // How the mips were generated, used to rebuild them when the pixels change
 
         bool UpdateTextureFromCache();
         bgfx::TextureFormat::Enum ChannelsToFormat(int channels) const;
         bool EnsureCacheLoaded();
-        void QueueOperation(PendingOpType type, int param1 = 0, int param2 = 0, const Color& color = Color());
-        bool ExecuteOperation(const PendingOperation& op);
+        void QueueOperations(const ImageOperations& operations);
+        void QueueSetPixel(int x, int y, const Color& color);
+        void WritePixel(int x, int y, const Color& color);
+        bool CommitCache(bool sizeChanged);
         bgfx::TextureHandle CreateStagingTexture();
         static int GetFormatChannels(bgfx::TextureFormat::Enum format);
+
+        bool UploadDecodedImage(DecodedImage& image, bool isColorTexture);
+        TextureHandleFuture StartAsyncLoad(std::shared_ptr<AsyncTextureLoad> load);
+        void CancelAsyncLoad();
+
+        bool SetResidentMips(int firstMip, const std::vector<uint8_t>& mipData);
+        void ReleaseStreaming();
+        static bool MakeStreamingRoom(uint64_t bytes, uint32_t lastFrame);
+    };
+
+    struct TextureStreamingStats
+    {
+        uint64_t budgetBytes = 0;
+        uint64_t residentBytes = 0; // GPU memory used by streamed textures
+        uint64_t pendingBytes = 0; // Extra GPU memory the loads in flight will use
+        uint32_t streamedTextures = 0;
+        uint32_t fullyResidentTextures = 0;
+        uint32_t pendingLoads = 0;
+        uint32_t mipLoads = 0; // Mips streamed in since startup
+        uint32_t evictions = 0; // Textures dropped back to their small mips since startup
     };
+
+    /// Sets how much GPU memory streamed textures may use. Defaults to 512 MB.
+    void SetTextureStreamingBudget(uint64_t bytes);
+    uint64_t GetTextureStreamingBudget();
+    TextureStreamingStats GetTextureStreamingStats();
 }
\ No newline at end of file
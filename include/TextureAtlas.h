@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Maths.h"
+#include "Texture.h"
+#include "Material.h"
+#include "Mesh.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cx
+{
+    enum class AtlasPacking
+    {
+        MaxRects, // Tracks every free rectangle and picks the tightest fit. Packs densest.
+        Skyline // Tracks the top edge of the packed images. Faster to insert, wastes more space with mixed sizes.
+    };
+
+    struct TextureAtlasOptions
+    {
+        AtlasPacking packing = AtlasPacking::MaxRects;
+        int initialPageSize = 512; // Pages start at this size and double as they fill
+        int maxPageSize = 4096; // Also capped by the GPU's max texture size
+        int padding = 1; // Texels around each image, filled with its edge texels so filtering doesn't pick up its neighbours
+        bool isColorTexture = true;
+    };
+
+    /// Where an image was packed. UVs have their origin at the page's top left.
+    struct AtlasRegion
+    {
+        int page = -1;
+        int x = 0; // Texels on the page, without the padding
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        Vector2 uvMin;
+        Vector2 uvMax;
+
+        bool IsValid() const { return page >= 0; }
+    };
+
+    /// Packs small images into a few large RGBA8 pages so sprites drawn from the same page share one texture and material.
+    /// Images can be added at any time. A full page first doubles in size, up to maxPageSize, before a new page is started.
+    /// Growing a page moves the UVs of every region on it, which GetVersion() reports.
+    class TextureAtlas
+    {
+    public:
+        TextureAtlas(const TextureAtlasOptions& options = TextureAtlasOptions());
+        ~TextureAtlas();
+        TextureAtlas(const TextureAtlas&) = delete;
+        TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+        /// Packs an image with 1 to 4 channels and uploads it. Adding a name that's already packed returns its region without packing again.
+        /// Returns nullptr if the image can't fit on a page. The region pointer stays valid until Clear() or Load().
+        const AtlasRegion* Add(std::string_view name, const void* pixels, int width, int height, int channels);
+        /// Packs an 8 bit texture. Returns nullptr until its pixel data is cached, which takes a few frames unless it's already loaded (see Texture::LoadPixelDataToCache()).
+        const AtlasRegion* Add(std::string_view name, Texture& texture);
+        /// Packs an image file that stb_image can decode
+        const AtlasRegion* AddFromFile(std::string_view name, std::string_view path);
+
+        const AtlasRegion* GetRegion(std::string_view name) const;
+        bool Contains(std::string_view name) const { return GetRegion(name) != nullptr; }
+        size_t GetRegionCount() const { return m_regions.size(); }
+
+        int GetPageCount() const { return static_cast<int>(m_pages.size()); }
+        Texture* GetPageTexture(int page) const;
+        /// A material using the default shader with the page as its albedo map. Draws sharing it skip rebinding its textures.
+        Material* GetPageMaterial(int page) const;
+        /// The fraction of the page's area covered by packed images, including their padding
+        float GetPageOccupancy(int page) const;
+
+        /// Changes whenever a page grows, since that moves the UVs of its regions
+        uint32_t GetVersion() const { return m_version; }
+        const TextureAtlasOptions& GetOptions() const { return m_options; }
+
+        /// A quad in the XY plane showing the region, using the page material, for drawing with Camera2D.
+        /// The UVs are baked in, so rebuild it if GetVersion() changes.
+        Mesh GenSpriteMesh(std::string_view name, float width, float height, bool centered = true) const;
+
+        /// Writes the pages, the packing state and the regions, so Load() restores the atlas without packing again and more images can still be added
+        bool Save(std::string_view path) const;
+        /// Replaces the atlas with one written by Save(), including its options
+        bool Load(std::string_view path);
+
+        void Clear();
+
+    private:
+        struct PackRect
+        {
+            int x, y, width, height;
+        };
+
+        struct SkylineNode
+        {
+            int x, y, width;
+        };
+
+        struct Page
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<uint8_t> pixels; // RGBA8, kept to grow and save the page
+            std::vector<PackRect> freeRects; // MaxRects
+            std::vector<SkylineNode> skyline; // Skyline
+            int64_t usedArea = 0;
+            std::unique_ptr<Texture> texture;
+            std::unique_ptr<Material> material;
+        };
+
+        TextureAtlasOptions m_options;
+        std::vector<std::unique_ptr<Page>> m_pages;
+        std::unordered_map<std::string, AtlasRegion> m_regions;
+        uint32_t m_version = 1;
+
+        int GetMaxPageSize() const;
+        Page* CreatePage(int width, int height);
+        bool UploadPage(Page& page);
+        bool Grow(int pageIndex);
+        void UpdateRegionUVs(int pageIndex);
+
+        bool Insert(Page& page, int width, int height, PackRect& outRect);
+        bool FindMaxRectsPosition(const Page& page, int width, int height, PackRect& outRect) const;
+        void PlaceMaxRects(Page& page, const PackRect& rect);
+        bool FindSkylinePosition(const Page& page, int width, int height, PackRect& outRect, size_t& outNode) const;
+        void PlaceSkyline(Page& page, const PackRect& rect, size_t node);
+    };
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Config.h"
+#include "Input.h"
 #include <string>
+#include <vector>
 
 struct GLFWwindow;
 
@@ -38,7 +40,7 @@ namespace cx
         virtual void GetMonitorPosition(int monitor, int& x, int& y) const = 0;
         virtual std::string GetMonitorName(int monitor) const = 0;
 
-        static Window* Create();
+        static Window* Create(const Config& config);
     };
 
 #ifdef PLATFORM_WINDOWS
@@ -85,4 +87,80 @@ namespace cx
         int m_height;
     };
 #endif
+
+    /// A window backend with no OS window. It reports a fixed virtual size and feeds scripted input into Input, so the
+    /// framework can run on machines without a display (CI, build farms, soak tests). Pair with RenderingAPI::Null.
+    class HeadlessWindow : public Window
+    {
+    public:
+        struct ScriptedInputEvent
+        {
+            enum class Type
+            {
+                Key,
+                MouseButton,
+                MousePosition,
+                MouseWheel
+            };
+
+            int frame = 0; // Frame on which the event is applied (counted in PollEvents() calls)
+            Type type = Type::Key;
+            int code = 0; // KeyCode or MouseButton
+            bool pressed = false;
+            float x = 0.0f; // Mouse x, or wheel delta
+            float y = 0.0f;
+        };
+
+        HeadlessWindow();
+        ~HeadlessWindow() override;
+
+        bool Init(const Config& config) override;
+        void PollEvents() override;
+        bool ShouldClose() const override;
+        void Shutdown() override;
+
+        void* GetNativeWindowHandle() const override;
+        void GetWindowSize(int& width, int& height) const override;
+        void SetWindowTitle(std::string_view title) override;
+        bool IsFullscreen() const override;
+        bool IsHidden() const override;
+        bool IsMinimized() const override;
+        bool IsMaximized() const override;
+        bool IsFocused() const override;
+        void ToggleFullscreen() override;
+        void Maximize() override;
+        void Minimize() override;
+        void Restore() override;
+        void SetOpacity(float opacity) override;
+        void SetIcon(std::string_view iconPath) override;
+        int GetMonitorCount() const override;
+        int GetCurrentMonitor() const override;
+        void GetMonitorSize(int monitor, int& width, int& height) const override;
+        int GetMonitorRefreshRate(int monitor) const override;
+        void GetMonitorPosition(int monitor, int& x, int& y) const override;
+        std::string GetMonitorName(int monitor) const override;
+
+        // Scripted input. Events are applied in PollEvents() once their frame is reached.
+        void QueueInputEvent(const ScriptedInputEvent& event);
+        void QueueKey(int frame, KeyCode key, bool pressed);
+        void QueueMouseButton(int frame, MouseButton button, bool pressed);
+        void QueueMousePosition(int frame, float x, float y);
+        void QueueMouseWheel(int frame, float delta);
+        void ClearInputScript();
+
+        /// Makes ShouldClose() return true once this many frames have been polled. 0 = run until RequestClose().
+        void SetFrameLimit(int frames) { m_frameLimit = frames; }
+        void RequestClose() { m_shouldClose = true; }
+        int GetPolledFrameCount() const { return m_frame; }
+
+    private:
+        std::vector<ScriptedInputEvent> m_inputScript; // Sorted by frame
+        size_t m_nextEvent;
+        int m_frame;
+        int m_frameLimit;
+        bool m_shouldClose;
+        int m_width;
+        int m_height;
+        std::string m_title;
+    };
 }
\ No newline at end of file
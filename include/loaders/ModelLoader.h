@@ -10,6 +10,20 @@ namespace cx
     Model* LoadModel(std::string_view filePath, bool mergeMeshes = true);
     Model* CloneModel(const Model* model);
 
+    /// When enabled, model loaders decode their textures in parallel on the job pool instead of one by one during the load.
+    /// The textures show a placeholder until they're uploaded at the start of a later frame. Disabled by default.
+    void SetAsyncTextureLoading(bool enabled);
+    bool IsAsyncTextureLoadingEnabled();
+
+    /// When enabled, model loaders build full mip chains on the CPU for textures stored without them, using the options given.
+    /// Normal maps are renormalized regardless of options.isNormalMap. Disabled by default.
+    void SetTextureMipGeneration(bool enabled, const MipGenerationOptions& options = MipGenerationOptions());
+    bool IsTextureMipGenerationEnabled();
+    /// The options for a texture of the given type, or nullptr when mip generation is disabled
+    const MipGenerationOptions* GetTextureMipGenerationOptions(bool isNormalMap);
+    /// What an async loaded texture of the given map type shows until it's uploaded
+    TexturePlaceholder GetTexturePlaceholder(MaterialMapType type);
+
     AnimationClip* LoadAnimation(std::string_view filePath, size_t animationIndex = 0);
     AnimationClip* LoadAnimation(std::string_view filePath, std::string_view animationName);
     std::vector<AnimationClip*> LoadAnimations(std::string_view filePath);
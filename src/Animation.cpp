@@ -3,9 +3,127 @@
 #include <iostream>
 #include <functional>
 #include <map>
+#include <cstdint>
+#include <bx/simd_t.h>
 
 namespace cx
 {
+    // Multiplies two affine matrices, skipping the constant bottom row
+    static void MultiplyAffine(const Matrix4& a, const Matrix4& b, Matrix4& result)
+    {
+        for (int col = 0; col < 3; ++col)
+        {
+            const float b0 = b.m[col * 4 + 0];
+            const float b1 = b.m[col * 4 + 1];
+            const float b2 = b.m[col * 4 + 2];
+
+            result.m[col * 4 + 0] = a.m[0] * b0 + a.m[4] * b1 + a.m[8] * b2;
+            result.m[col * 4 + 1] = a.m[1] * b0 + a.m[5] * b1 + a.m[9] * b2;
+            result.m[col * 4 + 2] = a.m[2] * b0 + a.m[6] * b1 + a.m[10] * b2;
+            result.m[col * 4 + 3] = 0.0f;
+        }
+
+        result.m[12] = a.m[0] * b.m[12] + a.m[4] * b.m[13] + a.m[8] * b.m[14] + a.m[12];
+        result.m[13] = a.m[1] * b.m[12] + a.m[5] * b.m[13] + a.m[9] * b.m[14] + a.m[13];
+        result.m[14] = a.m[2] * b.m[12] + a.m[6] * b.m[13] + a.m[10] * b.m[14] + a.m[14];
+        result.m[15] = 1.0f;
+    }
+
+    void Skeleton::Flatten()
+    {
+        const int boneCount = static_cast<int>(bones.size());
+
+        for (Bone& bone : bones)
+            bone.children.clear();
+
+        for (int i = 0; i < boneCount; ++i)
+        {
+            int parent = bones[i].parentIndex;
+            if (parent >= 0 && parent < boneCount && parent != i)
+                bones[parent].children.push_back(i);
+        }
+
+        evaluationOrder.clear();
+        evaluationParents.clear();
+        evaluationOrder.reserve(boneCount);
+        evaluationParents.reserve(boneCount);
+
+        // Breadth first from the roots, so the order is also the order the parents get visited in
+        std::vector<bool> visited(boneCount, false);
+        for (int i = 0; i < boneCount; ++i)
+        {
+            int parent = bones[i].parentIndex;
+            if (parent >= 0 && parent < boneCount && parent != i)
+                continue;
+
+            evaluationOrder.push_back(i);
+            visited[i] = true;
+        }
+
+        for (size_t head = 0; head < evaluationOrder.size(); ++head)
+        {
+            for (int child : bones[evaluationOrder[head]].children)
+            {
+                if (!visited[child])
+                {
+                    visited[child] = true;
+                    evaluationOrder.push_back(child);
+                }
+            }
+        }
+
+        // Bones in a parent cycle are never reached from a root, evaluate them as roots instead of leaving them out
+        for (int i = 0; i < boneCount; ++i)
+        {
+            if (!visited[i])
+            {
+                std::cerr << "[WARNING] Skeleton: Bone \"" << bones[i].name << "\" is part of a parent cycle and will be treated as a root" << std::endl;
+                evaluationOrder.push_back(i);
+            }
+        }
+
+        for (int boneIndex : evaluationOrder)
+        {
+            int parent = bones[boneIndex].parentIndex;
+            evaluationParents.push_back(visited[boneIndex] && parent >= 0 && parent < boneCount && parent != boneIndex ? parent : -1);
+        }
+    }
+
+    void Skeleton::ComputeGlobalTransforms(const Matrix4* localTransforms, Matrix4* globalTransforms, Matrix4* skinningMatrices) const
+    {
+        // Parents come first in the order, so their global transform is always ready
+        for (size_t i = 0; i < evaluationOrder.size(); ++i)
+        {
+            const int boneIndex = evaluationOrder[i];
+            const int parent = evaluationParents[i];
+
+            if (parent >= 0)
+                MultiplyAffine(globalTransforms[parent], localTransforms[boneIndex], globalTransforms[boneIndex]);
+            else
+                globalTransforms[boneIndex] = localTransforms[boneIndex];
+
+            if (skinningMatrices)
+                MultiplyAffine(globalTransforms[boneIndex], bones[boneIndex].inverseBindMatrix, skinningMatrices[boneIndex]);
+        }
+    }
+
+    void Skeleton::UpdateFinalMatrices()
+    {
+        if (bones.empty())
+            return;
+
+        if (!IsFlattened())
+            Flatten();
+
+        std::vector<Matrix4> localTransforms(bones.size());
+        std::vector<Matrix4> globalTransforms(bones.size());
+        for (size_t i = 0; i < bones.size(); ++i)
+            localTransforms[i] = bones[i].localTransform;
+
+        finalMatrices.resize(bones.size());
+        ComputeGlobalTransforms(localTransforms.data(), globalTransforms.data(), finalMatrices.data());
+    }
+
     std::vector<AnimationClip*> AnimationClip::s_clips;
 
     AnimationClip::AnimationClip()
@@ -331,7 +449,9 @@ namespace cx
         }
 
         // Evaluate layers in order
-        std::vector<Matrix4> baseTransforms;
+        const size_t poolMark = animator->m_posePoolUsed;
+        Pose& basePose = animator->AcquirePose();
+        Pose& layerPose = animator->AcquirePose();
         bool hasBase = false;
 
         for (auto& pair : activeLayerStates)
@@ -342,21 +462,20 @@ namespace cx
             if (!state)
                 continue;
 
-            std::vector<Matrix4> layerTransforms;
-
             // Sample animation
+            bool sampled = false;
             if (state->blendTree)
-                animator->EvaluateBlendTree(state->blendTree, m_currentStateTime, layerTransforms);
+                sampled = animator->EvaluateBlendTree(state->blendTree, m_currentStateTime, layerPose);
             else if (state->clip)
-                animator->SampleAnimationToBuffer(state->clip, m_currentStateTime, layerTransforms);
+                sampled = animator->SampleAnimationToPose(state->clip, m_currentStateTime, layerPose);
 
-            if (layerTransforms.empty())
+            if (!sampled)
                 continue;
 
             // First layer (base) or replace
             if (!hasBase || layer == 0)
             {
-                baseTransforms = layerTransforms;
+                std::swap(basePose, layerPose);
                 hasBase = true;
             }
             else
@@ -374,28 +493,37 @@ namespace cx
                         // Create a temporary mapping in animator for this blend operation
                         animator->SetBoneMask(maskIt->second, maskLayerId);
 
-                        animator->BlendBoneTransforms(baseTransforms, layerTransforms, layerWeight, baseTransforms, maskLayerId);
+                        animator->BlendPoses(basePose, layerPose, layerWeight, basePose, maskLayerId);
 
                         // Clean up temporary mask
                         animator->ClearBoneMask(maskLayerId);
                     }
                     else
-                        animator->BlendBoneTransforms(baseTransforms, layerTransforms, layerWeight, baseTransforms, -1);
+                        animator->BlendPoses(basePose, layerPose, layerWeight, basePose, -1);
                 }
             }
 
             // Call onUpdate callback
             if (state->onUpdate)
-                state->onUpdate(deltaTime);
+            {
+                animator->DispatchCallback([this, stateId = state->id, deltaTime]()
+                {
+                    AnimationState* updatedState = GetState(stateId);
+                    if (updatedState && updatedState->onUpdate)
+                        updatedState->onUpdate(deltaTime);
+                });
+            }
         }
 
         // Apply final transforms
         if (hasBase)
         {
-            animator->SetLocalTransforms(baseTransforms);
+            animator->PoseToLocalTransforms(basePose);
             animator->CalculateBoneTransforms();
         }
 
+        animator->m_posePoolUsed = poolMark;
+
         // Process morph weights and events
         if (currentState && currentState->clip)
         {
@@ -434,7 +562,14 @@ namespace cx
                 // Call onExit for old state
                 AnimationState* oldState = GetState(m_activeTransition.fromStateId);
                 if (oldState && oldState->onExit)
-                    oldState->onExit();
+                {
+                    animator->DispatchCallback([this, stateId = oldState->id]()
+                    {
+                        AnimationState* exitedState = GetState(stateId);
+                        if (exitedState && exitedState->onExit)
+                            exitedState->onExit();
+                    });
+                }
 
                 // Transition complete
                 m_currentStateId = m_transitionTargetStateId;
@@ -444,7 +579,14 @@ namespace cx
 
                 // Call onEnter for new state
                 if (currentState && currentState->onEnter)
-                    currentState->onEnter();
+                {
+                    animator->DispatchCallback([this, stateId = currentState->id]()
+                    {
+                        AnimationState* enteredState = GetState(stateId);
+                        if (enteredState && enteredState->onEnter)
+                            enteredState->onEnter();
+                    });
+                }
 
                 if (!currentState)
                     return;
@@ -461,22 +603,23 @@ namespace cx
                     if (fromState->layer == toState->layer)
                     {
                         // Same layer
-                        std::vector<Matrix4> fromTransforms;
-                        std::vector<Matrix4> toTransforms;
+                        const size_t poolMark = animator->m_posePoolUsed;
+                        Pose& fromPose = animator->AcquirePose();
+                        Pose& toPose = animator->AcquirePose();
+                        bool hasFrom = false;
+                        bool hasTo = false;
 
                         if (fromState->clip)
-                            animator->SampleAnimationToBuffer(fromState->clip, m_currentStateTime, fromTransforms);
+                            hasFrom = animator->SampleAnimationToPose(fromState->clip, m_currentStateTime, fromPose);
 
                         if (toState->clip)
                         {
                             float toStateTime = m_transitionTime * toState->speed;
-                            animator->SampleAnimationToBuffer(toState->clip, toStateTime, toTransforms);
+                            hasTo = animator->SampleAnimationToPose(toState->clip, toStateTime, toPose);
                         }
 
-                        if (!fromTransforms.empty() && !toTransforms.empty())
+                        if (hasFrom && hasTo)
                         {
-                            std::vector<Matrix4> blendedTransforms;
-
                             // Apply layer mask if exists
                             auto maskIt = m_layerMasks.find(fromState->layer);
                             int layerId = -1; // No mask by default
@@ -487,24 +630,24 @@ namespace cx
                                 animator->SetBoneMask(maskIt->second, layerId);
                             }
 
-                            animator->BlendBoneTransforms(fromTransforms, toTransforms, t, blendedTransforms, layerId);
+                            animator->BlendPoses(fromPose, toPose, t, fromPose, layerId);
 
                             // Apply layer weight
                             float layerWeight = GetLayerWeight(fromState->layer);
                             if (fromState->layer == 0 || layerWeight >= 0.9999f)
-                                animator->m_localTransforms = blendedTransforms;
+                                animator->PoseToLocalTransforms(fromPose);
                             else
                             {
                                 // Blend with base layer
-                                std::vector<Matrix4> currentTransforms = animator->GetLocalTransforms();
-                                animator->BlendBoneTransforms(currentTransforms, blendedTransforms, layerWeight, currentTransforms, layerId);
-                                animator->SetLocalTransforms(currentTransforms);
-
+                                animator->BlendPoses(animator->m_localPose, fromPose, layerWeight, animator->m_localPose, layerId);
+                                animator->PoseToLocalTransforms(animator->m_localPose);
                             }
 
                             animator->CalculateBoneTransforms();
                         }
 
+                        animator->m_posePoolUsed = poolMark;
+
                         // Process events from both states
                         if (fromState->clip && animator->m_eventCallback)
                         {
@@ -540,7 +683,7 @@ namespace cx
 
                 if (CheckTransitionConditions(transition))
                 {
-                    StartTransition(transition);
+                    StartTransition(transition, animator);
                     break;
                 }
             }
@@ -560,7 +703,7 @@ namespace cx
 
                         if (CheckTransitionConditions(transition))
                         {
-                            StartTransition(transition);
+                            StartTransition(transition, animator);
                             break;
                         }
                     }
@@ -665,11 +808,18 @@ namespace cx
         return false;
     }
 
-    void AnimationStateMachine::StartTransition(const AnimationTransition& transition)
+    void AnimationStateMachine::StartTransition(const AnimationTransition& transition, Animator* animator)
     {
         AnimationState* currentState = GetCurrentState();
         if (currentState && currentState->onExit)
-            currentState->onExit();
+        {
+            animator->DispatchCallback([this, stateId = currentState->id]()
+            {
+                AnimationState* exitedState = GetState(stateId);
+                if (exitedState && exitedState->onExit)
+                    exitedState->onExit();
+            });
+        }
 
         m_isTransitioning = true;
         m_activeTransition = transition;
@@ -685,6 +835,359 @@ namespace cx
         return std::min(1.0f, m_transitionTime / m_activeTransition.duration);
     }
 
+    void Pose::Resize(size_t count)
+    {
+        m_count = count;
+
+        const size_t padded = (count + 3) & ~size_t(3);
+        tx.resize(padded, 0.0f);
+        ty.resize(padded, 0.0f);
+        tz.resize(padded, 0.0f);
+        rx.resize(padded, 0.0f);
+        ry.resize(padded, 0.0f);
+        rz.resize(padded, 0.0f);
+        rw.resize(padded, 1.0f);
+        sx.resize(padded, 1.0f);
+        sy.resize(padded, 1.0f);
+        sz.resize(padded, 1.0f);
+    }
+
+    void Pose::SetIdentity(size_t count)
+    {
+        Resize(count);
+
+        std::fill(tx.begin(), tx.end(), 0.0f);
+        std::fill(ty.begin(), ty.end(), 0.0f);
+        std::fill(tz.begin(), tz.end(), 0.0f);
+        std::fill(rx.begin(), rx.end(), 0.0f);
+        std::fill(ry.begin(), ry.end(), 0.0f);
+        std::fill(rz.begin(), rz.end(), 0.0f);
+        std::fill(rw.begin(), rw.end(), 1.0f);
+        std::fill(sx.begin(), sx.end(), 1.0f);
+        std::fill(sy.begin(), sy.end(), 1.0f);
+        std::fill(sz.begin(), sz.end(), 1.0f);
+    }
+
+    void Pose::SetBone(size_t index, const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+    {
+        SetTranslation(index, translation);
+        SetRotation(index, rotation);
+        SetScale(index, scale);
+    }
+
+    Matrix4 Pose::GetMatrix(size_t index) const
+    {
+        // Same result as Translate(t) * FromQuaternion(r) * Scale(s) without the two matrix multiplies
+        const float x = rx[index], y = ry[index], z = rz[index], w = rw[index];
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+
+        Matrix4 result;
+        result.m[0] = (1.0f - 2.0f * (yy + zz)) * sx[index];
+        result.m[1] = 2.0f * (xy + wz) * sx[index];
+        result.m[2] = 2.0f * (xz - wy) * sx[index];
+        result.m[3] = 0.0f;
+
+        result.m[4] = 2.0f * (xy - wz) * sy[index];
+        result.m[5] = (1.0f - 2.0f * (xx + zz)) * sy[index];
+        result.m[6] = 2.0f * (yz + wx) * sy[index];
+        result.m[7] = 0.0f;
+
+        result.m[8] = 2.0f * (xz + wy) * sz[index];
+        result.m[9] = 2.0f * (yz - wx) * sz[index];
+        result.m[10] = (1.0f - 2.0f * (xx + yy)) * sz[index];
+        result.m[11] = 0.0f;
+
+        result.m[12] = tx[index];
+        result.m[13] = ty[index];
+        result.m[14] = tz[index];
+        result.m[15] = 1.0f;
+        return result;
+    }
+
+    // Pose kernels. The SIMD loops handle four bones per iteration through bx's simd128 abstraction (SSE or NEON), bones
+    // left over and poses whose storage isn't 16 byte aligned go through the scalar versions.
+
+    static bool IsSimdAligned(const void* data)
+    {
+        return (reinterpret_cast<uintptr_t>(data) & 15) == 0;
+    }
+
+    static bool IsSimdAligned(const Pose& pose)
+    {
+        return IsSimdAligned(pose.tx.data()) && IsSimdAligned(pose.ty.data()) && IsSimdAligned(pose.tz.data())
+            && IsSimdAligned(pose.rx.data()) && IsSimdAligned(pose.ry.data()) && IsSimdAligned(pose.rz.data()) && IsSimdAligned(pose.rw.data())
+            && IsSimdAligned(pose.sx.data()) && IsSimdAligned(pose.sy.data()) && IsSimdAligned(pose.sz.data());
+    }
+
+    static void BlendPoseBone(const Pose& from, const Pose& to, float weight, Pose& result, size_t i)
+    {
+        result.SetTranslation(i, Vector3::Lerp(from.GetTranslation(i), to.GetTranslation(i), weight));
+        result.SetScale(i, Vector3::Lerp(from.GetScale(i), to.GetScale(i), weight));
+
+        Quaternion a = from.GetRotation(i);
+        Quaternion b = to.GetRotation(i);
+        if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f)
+            b = -b;
+
+        Quaternion r(a.x + (b.x - a.x) * weight, a.y + (b.y - a.y) * weight, a.z + (b.z - a.z) * weight, a.w + (b.w - a.w) * weight);
+        result.SetRotation(i, r.Normalize());
+    }
+
+    // Lerps translation and scale and nlerps rotation along the shortest path, with one weight per bone
+    static void BlendPoseKernel(const Pose& from, const Pose& to, const float* weights, Pose& result)
+    {
+        const size_t count = result.PaddedSize();
+        size_t i = 0;
+
+        if (IsSimdAligned(from) && IsSimdAligned(to) && IsSimdAligned(result) && IsSimdAligned(weights))
+        {
+            using bx::simd128_t;
+            const simd128_t zero = bx::simd_zero<simd128_t>();
+            const simd128_t signBit = bx::simd_isplat<simd128_t>(0x80000000);
+
+            auto lerp = [](const std::vector<float>& a, const std::vector<float>& b, simd128_t w, std::vector<float>& out, size_t index)
+            {
+                const simd128_t va = bx::simd_ld<simd128_t>(&a[index]);
+                const simd128_t vb = bx::simd_ld<simd128_t>(&b[index]);
+                bx::simd_st(&out[index], bx::simd_madd(bx::simd_sub(vb, va), w, va));
+            };
+
+            for (; i + 4 <= count; i += 4)
+            {
+                const simd128_t w = bx::simd_ld<simd128_t>(&weights[i]);
+
+                lerp(from.tx, to.tx, w, result.tx, i);
+                lerp(from.ty, to.ty, w, result.ty, i);
+                lerp(from.tz, to.tz, w, result.tz, i);
+                lerp(from.sx, to.sx, w, result.sx, i);
+                lerp(from.sy, to.sy, w, result.sy, i);
+                lerp(from.sz, to.sz, w, result.sz, i);
+
+                const simd128_t ax = bx::simd_ld<simd128_t>(&from.rx[i]);
+                const simd128_t ay = bx::simd_ld<simd128_t>(&from.ry[i]);
+                const simd128_t az = bx::simd_ld<simd128_t>(&from.rz[i]);
+                const simd128_t aw = bx::simd_ld<simd128_t>(&from.rw[i]);
+                simd128_t bx_ = bx::simd_ld<simd128_t>(&to.rx[i]);
+                simd128_t by = bx::simd_ld<simd128_t>(&to.ry[i]);
+                simd128_t bz = bx::simd_ld<simd128_t>(&to.rz[i]);
+                simd128_t bw = bx::simd_ld<simd128_t>(&to.rw[i]);
+
+                // Flip 'to' into the same hemisphere as 'from' by toggling its sign bits where the dot product is negative
+                const simd128_t dot = bx::simd_madd(ax, bx_, bx::simd_madd(ay, by, bx::simd_madd(az, bz, bx::simd_mul(aw, bw))));
+                const simd128_t flip = bx::simd_and(bx::simd_cmplt(dot, zero), signBit);
+                bx_ = bx::simd_xor(bx_, flip);
+                by = bx::simd_xor(by, flip);
+                bz = bx::simd_xor(bz, flip);
+                bw = bx::simd_xor(bw, flip);
+
+                const simd128_t qx = bx::simd_madd(bx::simd_sub(bx_, ax), w, ax);
+                const simd128_t qy = bx::simd_madd(bx::simd_sub(by, ay), w, ay);
+                const simd128_t qz = bx::simd_madd(bx::simd_sub(bz, az), w, az);
+                const simd128_t qw = bx::simd_madd(bx::simd_sub(bw, aw), w, aw);
+
+                // Both inputs are unit length and in the same hemisphere, so the length can't get close to zero
+                const simd128_t lenSq = bx::simd_madd(qx, qx, bx::simd_madd(qy, qy, bx::simd_madd(qz, qz, bx::simd_mul(qw, qw))));
+                const simd128_t invLen = bx::simd_rsqrt(lenSq);
+                bx::simd_st(&result.rx[i], bx::simd_mul(qx, invLen));
+                bx::simd_st(&result.ry[i], bx::simd_mul(qy, invLen));
+                bx::simd_st(&result.rz[i], bx::simd_mul(qz, invLen));
+                bx::simd_st(&result.rw[i], bx::simd_mul(qw, invLen));
+            }
+        }
+
+        for (; i < count; ++i)
+            BlendPoseBone(from, to, weights[i], result, i);
+    }
+
+    static void BlendPosesWeightedBone(const Pose* const* poses, const float* weights, size_t poseCount, Pose& result, size_t i)
+    {
+        Vector3 t(0.0f, 0.0f, 0.0f);
+        Vector3 s(0.0f, 0.0f, 0.0f);
+        Quaternion r(0.0f, 0.0f, 0.0f, 0.0f);
+        const Quaternion reference = poses[0]->GetRotation(i);
+
+        for (size_t p = 0; p < poseCount; ++p)
+        {
+            const float w = weights[p];
+            t += poses[p]->GetTranslation(i) * w;
+            s += poses[p]->GetScale(i) * w;
+
+            Quaternion q = poses[p]->GetRotation(i);
+            if (reference.x * q.x + reference.y * q.y + reference.z * q.z + reference.w * q.w < 0.0f)
+                q = -q;
+
+            r += Quaternion(q.x * w, q.y * w, q.z * w, q.w * w);
+        }
+
+        result.SetBone(i, t, r.Normalize(), s);
+    }
+
+    // Weighted sum of several poses with one weight per pose. Rotations are aligned to the first pose's hemisphere
+    // before being summed and normalized. 'result' must not be one of the inputs.
+    static void BlendPosesWeightedKernel(const Pose* const* poses, const float* weights, size_t poseCount, Pose& result)
+    {
+        const size_t count = result.PaddedSize();
+        size_t i = 0;
+
+        bool aligned = IsSimdAligned(result);
+        for (size_t p = 0; p < poseCount && aligned; ++p)
+            aligned = IsSimdAligned(*poses[p]);
+
+        if (aligned)
+        {
+            using bx::simd128_t;
+            const simd128_t zero = bx::simd_zero<simd128_t>();
+            const simd128_t signBit = bx::simd_isplat<simd128_t>(0x80000000);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                simd128_t t[3] = { zero, zero, zero };
+                simd128_t s[3] = { zero, zero, zero };
+                simd128_t r[4] = { zero, zero, zero, zero };
+
+                const Pose& first = *poses[0];
+                const simd128_t refX = bx::simd_ld<simd128_t>(&first.rx[i]);
+                const simd128_t refY = bx::simd_ld<simd128_t>(&first.ry[i]);
+                const simd128_t refZ = bx::simd_ld<simd128_t>(&first.rz[i]);
+                const simd128_t refW = bx::simd_ld<simd128_t>(&first.rw[i]);
+
+                for (size_t p = 0; p < poseCount; ++p)
+                {
+                    const Pose& pose = *poses[p];
+                    const simd128_t w = bx::simd_splat<simd128_t>(weights[p]);
+
+                    t[0] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.tx[i]), w, t[0]);
+                    t[1] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.ty[i]), w, t[1]);
+                    t[2] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.tz[i]), w, t[2]);
+                    s[0] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.sx[i]), w, s[0]);
+                    s[1] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.sy[i]), w, s[1]);
+                    s[2] = bx::simd_madd(bx::simd_ld<simd128_t>(&pose.sz[i]), w, s[2]);
+
+                    const simd128_t qx = bx::simd_ld<simd128_t>(&pose.rx[i]);
+                    const simd128_t qy = bx::simd_ld<simd128_t>(&pose.ry[i]);
+                    const simd128_t qz = bx::simd_ld<simd128_t>(&pose.rz[i]);
+                    const simd128_t qw = bx::simd_ld<simd128_t>(&pose.rw[i]);
+
+                    // Negating the weight flips the rotation into the reference hemisphere
+                    const simd128_t dot = bx::simd_madd(refX, qx, bx::simd_madd(refY, qy, bx::simd_madd(refZ, qz, bx::simd_mul(refW, qw))));
+                    const simd128_t signedW = bx::simd_xor(w, bx::simd_and(bx::simd_cmplt(dot, zero), signBit));
+
+                    r[0] = bx::simd_madd(qx, signedW, r[0]);
+                    r[1] = bx::simd_madd(qy, signedW, r[1]);
+                    r[2] = bx::simd_madd(qz, signedW, r[2]);
+                    r[3] = bx::simd_madd(qw, signedW, r[3]);
+                }
+
+                bx::simd_st(&result.tx[i], t[0]);
+                bx::simd_st(&result.ty[i], t[1]);
+                bx::simd_st(&result.tz[i], t[2]);
+                bx::simd_st(&result.sx[i], s[0]);
+                bx::simd_st(&result.sy[i], s[1]);
+                bx::simd_st(&result.sz[i], s[2]);
+
+                const simd128_t lenSq = bx::simd_madd(r[0], r[0], bx::simd_madd(r[1], r[1], bx::simd_madd(r[2], r[2], bx::simd_mul(r[3], r[3]))));
+                const simd128_t invLen = bx::simd_rsqrt(lenSq);
+                bx::simd_st(&result.rx[i], bx::simd_mul(r[0], invLen));
+                bx::simd_st(&result.ry[i], bx::simd_mul(r[1], invLen));
+                bx::simd_st(&result.rz[i], bx::simd_mul(r[2], invLen));
+                bx::simd_st(&result.rw[i], bx::simd_mul(r[3], invLen));
+            }
+        }
+
+        for (; i < count; ++i)
+            BlendPosesWeightedBone(poses, weights, poseCount, result, i);
+    }
+
+    static void AdditivePoseBone(const Pose& reference, const Pose& additive, Pose& result, size_t i)
+    {
+        const Vector3 refS = reference.GetScale(i);
+        const Vector3 addS = additive.GetScale(i);
+
+        result.SetTranslation(i, result.GetTranslation(i) + additive.GetTranslation(i) - reference.GetTranslation(i));
+        result.SetRotation(i, (result.GetRotation(i) * (additive.GetRotation(i) * reference.GetRotation(i).Inverse())).Normalize());
+        result.SetScale(i, Vector3(
+            result.sx[i] * addS.x / (refS.x != 0.0f ? refS.x : 1.0f),
+            result.sy[i] * addS.y / (refS.y != 0.0f ? refS.y : 1.0f),
+            result.sz[i] * addS.z / (refS.z != 0.0f ? refS.z : 1.0f)));
+    }
+
+    // Applies the difference between 'additive' and 'reference' on top of 'result'
+    static void AdditivePoseKernel(const Pose& reference, const Pose& additive, Pose& result)
+    {
+        const size_t count = result.PaddedSize();
+        size_t i = 0;
+
+        if (IsSimdAligned(reference) && IsSimdAligned(additive) && IsSimdAligned(result))
+        {
+            using bx::simd128_t;
+            const simd128_t zero = bx::simd_zero<simd128_t>();
+            const simd128_t one = bx::simd_splat<simd128_t>(1.0f);
+            const simd128_t signBit = bx::simd_isplat<simd128_t>(0x80000000);
+
+            auto addTranslation = [](const std::vector<float>& ref, const std::vector<float>& add, std::vector<float>& out, size_t index)
+            {
+                const simd128_t delta = bx::simd_sub(bx::simd_ld<simd128_t>(&add[index]), bx::simd_ld<simd128_t>(&ref[index]));
+                bx::simd_st(&out[index], bx::simd_add(bx::simd_ld<simd128_t>(&out[index]), delta));
+            };
+
+            auto mulScale = [zero, one](const std::vector<float>& ref, const std::vector<float>& add, std::vector<float>& out, size_t index)
+            {
+                simd128_t divisor = bx::simd_ld<simd128_t>(&ref[index]);
+                divisor = bx::simd_selb(bx::simd_cmpeq(divisor, zero), one, divisor);
+                const simd128_t delta = bx::simd_div(bx::simd_ld<simd128_t>(&add[index]), divisor);
+                bx::simd_st(&out[index], bx::simd_mul(bx::simd_ld<simd128_t>(&out[index]), delta));
+            };
+
+            for (; i + 4 <= count; i += 4)
+            {
+                addTranslation(reference.tx, additive.tx, result.tx, i);
+                addTranslation(reference.ty, additive.ty, result.ty, i);
+                addTranslation(reference.tz, additive.tz, result.tz, i);
+                mulScale(reference.sx, additive.sx, result.sx, i);
+                mulScale(reference.sy, additive.sy, result.sy, i);
+                mulScale(reference.sz, additive.sz, result.sz, i);
+
+                // delta = additive * conjugate(reference), the reference rotations are unit length
+                const simd128_t ax = bx::simd_ld<simd128_t>(&additive.rx[i]);
+                const simd128_t ay = bx::simd_ld<simd128_t>(&additive.ry[i]);
+                const simd128_t az = bx::simd_ld<simd128_t>(&additive.rz[i]);
+                const simd128_t aw = bx::simd_ld<simd128_t>(&additive.rw[i]);
+                const simd128_t bx_ = bx::simd_xor(bx::simd_ld<simd128_t>(&reference.rx[i]), signBit);
+                const simd128_t by = bx::simd_xor(bx::simd_ld<simd128_t>(&reference.ry[i]), signBit);
+                const simd128_t bz = bx::simd_xor(bx::simd_ld<simd128_t>(&reference.rz[i]), signBit);
+                const simd128_t bw = bx::simd_ld<simd128_t>(&reference.rw[i]);
+
+                const simd128_t dx = bx::simd_sub(bx::simd_madd(aw, bx_, bx::simd_madd(ax, bw, bx::simd_mul(ay, bz))), bx::simd_mul(az, by));
+                const simd128_t dy = bx::simd_add(bx::simd_sub(bx::simd_mul(aw, by), bx::simd_mul(ax, bz)), bx::simd_madd(ay, bw, bx::simd_mul(az, bx_)));
+                const simd128_t dz = bx::simd_add(bx::simd_sub(bx::simd_madd(aw, bz, bx::simd_mul(ax, by)), bx::simd_mul(ay, bx_)), bx::simd_mul(az, bw));
+                const simd128_t dw = bx::simd_sub(bx::simd_sub(bx::simd_sub(bx::simd_mul(aw, bw), bx::simd_mul(ax, bx_)), bx::simd_mul(ay, by)), bx::simd_mul(az, bz));
+
+                // result = result * delta
+                const simd128_t rx = bx::simd_ld<simd128_t>(&result.rx[i]);
+                const simd128_t ry = bx::simd_ld<simd128_t>(&result.ry[i]);
+                const simd128_t rz = bx::simd_ld<simd128_t>(&result.rz[i]);
+                const simd128_t rw = bx::simd_ld<simd128_t>(&result.rw[i]);
+
+                const simd128_t qx = bx::simd_sub(bx::simd_madd(rw, dx, bx::simd_madd(rx, dw, bx::simd_mul(ry, dz))), bx::simd_mul(rz, dy));
+                const simd128_t qy = bx::simd_add(bx::simd_sub(bx::simd_mul(rw, dy), bx::simd_mul(rx, dz)), bx::simd_madd(ry, dw, bx::simd_mul(rz, dx)));
+                const simd128_t qz = bx::simd_add(bx::simd_sub(bx::simd_madd(rw, dz, bx::simd_mul(rx, dy)), bx::simd_mul(ry, dx)), bx::simd_mul(rz, dw));
+                const simd128_t qw = bx::simd_sub(bx::simd_sub(bx::simd_sub(bx::simd_mul(rw, dw), bx::simd_mul(rx, dx)), bx::simd_mul(ry, dy)), bx::simd_mul(rz, dz));
+
+                const simd128_t lenSq = bx::simd_madd(qx, qx, bx::simd_madd(qy, qy, bx::simd_madd(qz, qz, bx::simd_mul(qw, qw))));
+                const simd128_t invLen = bx::simd_rsqrt(lenSq);
+                bx::simd_st(&result.rx[i], bx::simd_mul(qx, invLen));
+                bx::simd_st(&result.ry[i], bx::simd_mul(qy, invLen));
+                bx::simd_st(&result.rz[i], bx::simd_mul(qz, invLen));
+                bx::simd_st(&result.rw[i], bx::simd_mul(qw, invLen));
+            }
+        }
+
+        for (; i < count; ++i)
+            AdditivePoseBone(reference, additive, result, i);
+    }
+
     Animator::Animator()
         : m_skeleton(nullptr)
         , m_currentClip(nullptr)
@@ -721,19 +1224,18 @@ namespace cx
             return;
 
         m_localTransforms.resize(m_skeleton->bones.size());
+        m_globalTransforms.resize(m_skeleton->bones.size());
         m_boneMatrices.resize(m_skeleton->bones.size());
 
-        for (auto& bone : m_skeleton->bones)
-            bone.children.clear();
+        if (!m_skeleton->IsFlattened())
+            m_skeleton->Flatten();
 
         for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
-        {
             m_localTransforms[i] = m_skeleton->bones[i].localTransform;
 
-            int parent = m_skeleton->bones[i].parentIndex;
-            if (parent >= 0)
-                m_skeleton->bones[parent].children.push_back((int)i);
-        }
+        m_restPose.Resize(0);
+        m_additiveBasePose.Resize(0);
+        m_localPose = GetRestPose();
 
         CalculateBoneTransforms();
 
@@ -893,92 +1395,129 @@ namespace cx
         }
     }
 
-    void Animator::SampleAnimationToBoneTransforms(AnimationClip* clip, float time, std::vector<BoneTransform>& transforms)
+    const Pose& Animator::GetRestPose()
     {
-        if (!clip || !m_skeleton)
-            return;
-
-        transforms.resize(m_skeleton->bones.size());
-
-        // Initialize all bones with rest pose
-        for (size_t i = 0; i < transforms.size(); ++i)
+        // Decomposed once and then copied into every sampled pose
+        if (m_skeleton && m_restPose.Size() != m_skeleton->bones.size())
         {
-            transforms[i].translation = m_skeleton->bones[i].localTransform.GetTranslation();
-            transforms[i].rotation = m_skeleton->bones[i].localTransform.GetRotation();
-            transforms[i].scale = m_skeleton->bones[i].localTransform.GetScale();
-            transforms[i].hasTranslation = false;
-            transforms[i].hasRotation = false;
-            transforms[i].hasScale = false;
+            m_restPose.Resize(m_skeleton->bones.size());
+            for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
+            {
+                const Matrix4& local = m_skeleton->bones[i].localTransform;
+                m_restPose.SetBone(i, local.GetTranslation(), local.GetRotation(), local.GetScale());
+            }
         }
 
-        // Apply animation data
-        for (const AnimationChannel& channel : clip->GetChannels())
+        return m_restPose;
+    }
+
+    Pose& Animator::AcquirePose()
+    {
+        if (m_posePoolUsed == m_posePool.size())
+            m_posePool.emplace_back();
+
+        return m_posePool[m_posePoolUsed++];
+    }
+
+    bool Animator::SampleAnimationToPose(AnimationClip* clip, float time, Pose& pose)
+    {
+        if (!clip || !m_skeleton)
+            return false;
+
+        // Bones without a channel keep their rest pose
+        pose = GetRestPose();
+
+        const std::vector<AnimationChannel>& channels = clip->GetChannels();
+        std::vector<int>& cursors = GetKeyframeCursors(clip);
+        for (size_t c = 0; c < channels.size(); ++c)
         {
+            const AnimationChannel& channel = channels[c];
             int boneIndex = channel.targetBoneIndex;
-            if (boneIndex < 0 || boneIndex >= static_cast<int>(transforms.size()))
+            if (boneIndex < 0 || boneIndex >= static_cast<int>(pose.Size()))
                 continue;
 
+            // One lookup is shared by the T, R and S tracks
+            int keyIndex = FindKeyframeIndex(channel.times, time, cursors[c]);
+
             if (!channel.translations.empty())
-            {
-                transforms[boneIndex].translation = InterpolateTranslation(channel, time);
-                transforms[boneIndex].hasTranslation = true;
-            }
+                pose.SetTranslation(boneIndex, InterpolateTranslation(channel, time, keyIndex));
 
             if (!channel.rotations.empty())
-            {
-                transforms[boneIndex].rotation = InterpolateRotation(channel, time);
-                transforms[boneIndex].hasRotation = true;
-            }
+                pose.SetRotation(boneIndex, InterpolateRotation(channel, time, keyIndex));
 
             if (!channel.scales.empty())
+                pose.SetScale(boneIndex, InterpolateScale(channel, time, keyIndex));
+        }
+
+        return true;
+    }
+
+    void Animator::BlendPoses(const Pose& from, const Pose& to, float weight, Pose& result, int layerId)
+    {
+        if (from.Size() != to.Size())
+            return;
+
+        // Bones outside the mask get a zero weight, which leaves them at 'from'
+        const size_t padded = from.PaddedSize();
+        const std::vector<int>& mask = GetBoneMask(layerId);
+        if (mask.empty())
+            m_blendWeights.assign(padded, weight);
+        else
+        {
+            m_blendWeights.assign(padded, 0.0f);
+            for (int boneIndex : mask)
             {
-                transforms[boneIndex].scale = InterpolateScale(channel, time);
-                transforms[boneIndex].hasScale = true;
+                if (boneIndex >= 0 && boneIndex < static_cast<int>(from.Size()))
+                    m_blendWeights[boneIndex] = weight;
             }
         }
+
+        // Every bone only reads and writes its own lanes, so 'result' may alias either input
+        result.Resize(from.Size());
+        BlendPoseKernel(from, to, m_blendWeights.data(), result);
     }
 
-    void Animator::BlendBoneTransformsToMatrices(const std::vector<BoneTransform>& from,
-        const std::vector<BoneTransform>& to,
-        float weight,
-        std::vector<Matrix4>& result)
+    void Animator::BlendPosesWeighted(const Pose* const* poses, const float* weights, size_t count, Pose& result)
     {
-        result.resize(from.size());
+        if (count == 0)
+            return;
 
-        for (size_t i = 0; i < from.size(); ++i)
-        {
-            // Blend translation
-            Vector3 blendedTranslation = from[i].translation + (to[i].translation - from[i].translation) * weight;
+        result.Resize(poses[0]->Size());
+        BlendPosesWeightedKernel(poses, weights, count, result);
+    }
 
-            // Blend scale
-            Vector3 blendedScale = from[i].scale + (to[i].scale - from[i].scale) * weight;
+    void Animator::ApplyAdditivePose(const Pose& additive, Pose& result)
+    {
+        if (additive.Size() != result.Size())
+            return;
 
-            // Blend rotation
-            Quaternion fromRot = from[i].rotation;
-            Quaternion toRot = to[i].rotation;
+        // Sample the reference pose once, without a reference clip the additive pose is applied as is
+        if (m_additiveBasePose.Size() != result.Size())
+        {
+            if (!m_additiveRefClip || !SampleAnimationToPose(m_additiveRefClip, 0.0f, m_additiveBasePose))
+                m_additiveBasePose.SetIdentity(result.Size());
+        }
 
-            // Normalize both quaternions
-            fromRot = fromRot.Normalize();
-            toRot = toRot.Normalize();
+        AdditivePoseKernel(m_additiveBasePose, additive, result);
+    }
 
-            // Check dot product for shortest path
-            float dot = fromRot.x * toRot.x + fromRot.y * toRot.y +
-                fromRot.z * toRot.z + fromRot.w * toRot.w;
+    void Animator::PoseToLocalTransforms(const Pose& pose)
+    {
+        m_localTransforms.resize(pose.Size());
+        for (size_t i = 0; i < pose.Size(); ++i)
+            m_localTransforms[i] = pose.GetMatrix(i);
 
-            if (dot < 0.0f)
-            {
-                toRot.x = -toRot.x;
-                toRot.y = -toRot.y;
-                toRot.z = -toRot.z;
-                toRot.w = -toRot.w;
-            }
+        if (&pose != &m_localPose)
+            m_localPose = pose;
+    }
 
-            Quaternion blendedRotation = Quaternion::Slerp(fromRot, toRot, weight);
-            blendedRotation = blendedRotation.Normalize();
+    void Animator::SetLocalTransforms(const std::vector<Matrix4>& transforms)
+    {
+        m_localTransforms = transforms;
 
-            // Construct matrix
-            result[i] = Matrix4::Translate(blendedTranslation) * Matrix4::FromQuaternion(blendedRotation) * Matrix4::Scale(blendedScale);
-        }
+        m_localPose.Resize(transforms.size());
+        for (size_t i = 0; i < transforms.size(); ++i)
+            m_localPose.SetBone(i, transforms[i].GetTranslation(), transforms[i].GetRotation(), transforms[i].GetScale());
     }
 
     int Animator::GetLayerIndex(int layerId) const
@@ -1113,7 +1652,8 @@ namespace cx
 
             if (m_skeleton)
             {
-                SampleAnimationToBuffer(clip, 0.0f, m_localTransforms);
+                SampleAnimationToPose(clip, 0.0f, m_localPose);
+                PoseToLocalTransforms(m_localPose);
                 CalculateBoneTransforms();
 
                 // Initialize root motion tracking for the new clip
@@ -1207,10 +1747,11 @@ namespace cx
         if (!m_skeleton || m_layers.empty())
             return;
 
-        std::vector<Matrix4> finalTransforms(m_skeleton->bones.size());
-        for (size_t i = 0; i < finalTransforms.size(); ++i)
-            finalTransforms[i] = m_skeleton->bones[i].localTransform;
+        // Layers are combined into m_localPose, which starts at the rest pose
+        m_localPose = GetRestPose();
 
+        const size_t poolMark = m_posePoolUsed;
+        Pose& layerPose = AcquirePose();
         bool firstLayer = true;
 
         for (size_t layerIdx = 0; layerIdx < m_layers.size(); ++layerIdx)
@@ -1242,12 +1783,11 @@ namespace cx
                 }
             }
 
-            std::vector<Matrix4> layerTransforms(m_skeleton->bones.size());
-            SampleAnimationToBuffer(layer.clip, layer.currentTime, layerTransforms);
+            SampleAnimationToPose(layer.clip, layer.currentTime, layerPose);
 
             if (firstLayer && layer.blendMode == AnimationBlendMode::Override)
             {
-                finalTransforms = layerTransforms;
+                std::swap(m_localPose, layerPose);
                 firstLayer = false;
             }
             else
@@ -1256,16 +1796,18 @@ namespace cx
                 {
                     case AnimationBlendMode::Override:
                     case AnimationBlendMode::Blend:
-                        BlendBoneTransforms(finalTransforms, layerTransforms, layer.weight, finalTransforms, layer.id);
+                        BlendPoses(m_localPose, layerPose, layer.weight, m_localPose, layer.id);
                         break;
                     case AnimationBlendMode::Additive:
-                        ApplyAdditiveAnimation(layerTransforms, finalTransforms);
+                        ApplyAdditivePose(layerPose, m_localPose);
                         break;
                 }
             }
         }
 
-        m_localTransforms = finalTransforms;
+        m_posePoolUsed = poolMark;
+
+        PoseToLocalTransforms(m_localPose);
         CalculateBoneTransforms();
         SampleMorphWeights(m_layers[0].currentTime, meshes);
     }
@@ -1337,15 +1879,16 @@ namespace cx
                 toTime = toDuration;
         }
 
-        // Sample both animations to TRS format
-        std::vector<BoneTransform> fromTransforms;
-        std::vector<BoneTransform> toTransforms;
+        // Blend both animations as poses, matrices are only built for the result
+        const size_t poolMark = m_posePoolUsed;
+        Pose& toPose = AcquirePose();
 
-        SampleAnimationToBoneTransforms(m_crossfade.fromClip, fromTime, fromTransforms);
-        SampleAnimationToBoneTransforms(m_crossfade.toClip, toTime, toTransforms);
+        SampleAnimationToPose(m_crossfade.fromClip, fromTime, m_localPose);
+        SampleAnimationToPose(m_crossfade.toClip, toTime, toPose);
+        BlendPoses(m_localPose, toPose, t, m_localPose);
+        m_posePoolUsed = poolMark;
 
-        // Blend and convert to matrices
-        BlendBoneTransformsToMatrices(fromTransforms, toTransforms, t, m_localTransforms);
+        PoseToLocalTransforms(m_localPose);
 
         // Calculate final bone matrices
         CalculateBoneTransforms();
@@ -1375,166 +1918,27 @@ namespace cx
         if (!m_blendTreeRoot || !m_skeleton)
             return;
 
-        EvaluateBlendTree(m_blendTreeRoot, deltaTime, m_localTransforms);
-        CalculateBoneTransforms();
-    }
-
-    void Animator::BlendBoneTransforms(const std::vector<Matrix4>& from, const std::vector<Matrix4>& to, float weight, std::vector<Matrix4>& result, int layerId)
-    {
-        if (result.size() != from.size())
-            result.resize(from.size());
+        if (EvaluateBlendTree(m_blendTreeRoot, deltaTime, m_localPose))
+            PoseToLocalTransforms(m_localPose);
 
-        // Get bone mask for this layer
-        const auto& mask = GetBoneMask(layerId);
-        bool hasMask = !mask.empty();
-
-        for (size_t i = 0; i < from.size(); ++i)
-        {
-            // Check if a mask is being used
-            if (hasMask)
-            {
-                bool isMasked = std::find(mask.begin(), mask.end(), static_cast<int>(i)) != mask.end();
-                if (!isMasked)
-                {
-                    result[i] = from[i];
-                    continue;
-                }
-            }
-
-            // Decompose both matrices
-            Vector3 transFrom = from[i].GetTranslation();
-            Vector3 transTo = to[i].GetTranslation();
-            Quaternion rotFrom = from[i].GetRotation();
-            Quaternion rotTo = to[i].GetRotation();
-            Vector3 scaleFrom = from[i].GetScale();
-            Vector3 scaleTo = to[i].GetScale();
-
-            // Ensure shortest path for quaternion interpolation
-            float dot = rotFrom.x * rotTo.x + rotFrom.y * rotTo.y + rotFrom.z * rotTo.z + rotFrom.w * rotTo.w;
-            if (dot < 0.0f)
-            {
-                rotTo.x = -rotTo.x;
-                rotTo.y = -rotTo.y;
-                rotTo.z = -rotTo.z;
-                rotTo.w = -rotTo.w;
-            }
-
-            // Blend components
-            Vector3 trans = transFrom + (transTo - transFrom) * weight;
-            Quaternion rot = Quaternion::Slerp(rotFrom, rotTo, weight);
-            Vector3 scale = scaleFrom + (scaleTo - scaleFrom) * weight;
-
-            // Reconstruct matrix
-            result[i] = Matrix4::Translate(trans) * Matrix4::FromQuaternion(rot) * Matrix4::Scale(scale);
-        }
-    }
-    void Animator::ApplyAdditiveAnimation(const std::vector<Matrix4>& additive, std::vector<Matrix4>& result)
-    {
-        // If we don't have a reference pose, sample it once
-        if (m_additiveBaseTransforms.empty() && m_additiveRefClip)
-            SampleAnimationToBuffer(m_additiveRefClip, 0.0f, m_additiveBaseTransforms);
-
-        for (size_t i = 0; i < additive.size() && i < result.size(); ++i)
-        {
-            Matrix4 baseRef = (i < m_additiveBaseTransforms.size()) ? m_additiveBaseTransforms[i] : Matrix4::Identity();
-
-            // Extract components for proper additive calculation
-            Vector3 baseRefT = baseRef.GetTranslation();
-            Quaternion baseRefR = baseRef.GetRotation();
-            Vector3 baseRefS = baseRef.GetScale();
-
-            Vector3 additiveT = additive[i].GetTranslation();
-            Quaternion additiveR = additive[i].GetRotation();
-            Vector3 additiveS = additive[i].GetScale();
-
-            Vector3 resultT = result[i].GetTranslation();
-            Quaternion resultR = result[i].GetRotation();
-            Vector3 resultS = result[i].GetScale();
-
-            // Compute deltas
-            Vector3 deltaT = additiveT - baseRefT;
-            Quaternion deltaR = additiveR * baseRefR.Inverse();
-            Vector3 deltaS = { additiveS.x / (baseRefS.x != 0.0f ? baseRefS.x : 1.0f), additiveS.y / (baseRefS.y != 0.0f ? baseRefS.y : 1.0f), additiveS.z / (baseRefS.z != 0.0f ? baseRefS.z : 1.0f) };
-
-            // Apply deltas
-            Vector3 finalT = resultT + deltaT;
-            Quaternion finalR = resultR * deltaR;
-            Vector3 finalS = { resultS.x * deltaS.x, resultS.y * deltaS.y, resultS.z * deltaS.z };
-
-            result[i] = Matrix4::Translate(finalT) * Matrix4::FromQuaternion(finalR) * Matrix4::Scale(finalS);
-        }
-    }
-
-    void Animator::SampleAnimationToBuffer(AnimationClip* clip, float time, std::vector<Matrix4>& buffer)
-    {
-        if (!clip || !m_skeleton)
-            return;
-
-        buffer.resize(m_skeleton->bones.size());
-        for (size_t i = 0; i < buffer.size(); ++i)
-            buffer[i] = m_skeleton->bones[i].localTransform;
-
-        struct AnimData
-        {
-            bool hasT = false, hasR = false, hasS = false;
-            Vector3 t;
-            Quaternion r;
-            Vector3 s;
-        };
-
-        std::vector<AnimData> animData(m_skeleton->bones.size());
-
-        for (const AnimationChannel& channel : clip->GetChannels())
-        {
-            int boneIndex = channel.targetBoneIndex;
-            if (boneIndex < 0 || boneIndex >= static_cast<int>(m_skeleton->bones.size()))
-                continue;
-
-            if (!channel.translations.empty())
-            {
-                animData[boneIndex].t = InterpolateTranslation(channel, time);
-                animData[boneIndex].hasT = true;
-            }
-            if (!channel.rotations.empty())
-            {
-                animData[boneIndex].r = InterpolateRotation(channel, time);
-                animData[boneIndex].hasR = true;
-            }
-            if (!channel.scales.empty())
-            {
-                animData[boneIndex].s = InterpolateScale(channel, time);
-                animData[boneIndex].hasS = true;
-            }
-        }
-
-        for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
-        {
-            if (animData[i].hasT || animData[i].hasR || animData[i].hasS)
-            {
-                Vector3 t = animData[i].hasT ? animData[i].t : m_skeleton->bones[i].localTransform.GetTranslation();
-                Quaternion r = animData[i].hasR ? animData[i].r : m_skeleton->bones[i].localTransform.GetRotation();
-                Vector3 s = animData[i].hasS ? animData[i].s : m_skeleton->bones[i].localTransform.GetScale();
-                buffer[i] = Matrix4::Translate(t) * Matrix4::FromQuaternion(r) * Matrix4::Scale(s);
-            }
-        }
+        CalculateBoneTransforms();
     }
 
-    void Animator::EvaluateBlendTree(BlendTreeNode* node, float time, std::vector<Matrix4>& result)
+    bool Animator::EvaluateBlendTree(BlendTreeNode* node, float time, Pose& result)
     {
         if (!node)
-            return;
+            return false;
 
+        // Child results live in pooled scratch poses that are released again before returning
         switch (node->type)
         {
             case BlendTreeNode::Type::Clip:
-                if (node->clip)
-                    SampleAnimationToBuffer(node->clip, time, result);
-                break;
+                return SampleAnimationToPose(node->clip, time, result);
 
             case BlendTreeNode::Type::Blend1D:
             {
                 if (node->children.size() < 2)
-                    return;
+                    return false;
 
                 float param = m_blendParameter;
 
@@ -1550,10 +1954,7 @@ namespace cx
 
                 // Handle edge cases
                 if (idx >= static_cast<int>(node->children.size()) - 1)
-                {
-                    EvaluateBlendTree(node->children.back(), time, result);
-                    return;
-                }
+                    return EvaluateBlendTree(node->children.back(), time, result);
 
                 // Clamp indices to valid thresholds
                 idx = std::min(idx, static_cast<int>(node->thresholds.size()) - 1);
@@ -1564,63 +1965,55 @@ namespace cx
                 float blend = (t1 - t0 > 0.0001f) ? (param - t0) / (t1 - t0) : 0.0f;
                 blend = std::max(0.0f, std::min(1.0f, blend));
 
-                std::vector<Matrix4> temp1, temp2;
-                EvaluateBlendTree(node->children[idx], time, temp1);
-                EvaluateBlendTree(node->children[nextIdx], time, temp2);
+                const size_t poolMark = m_posePoolUsed;
+                Pose& second = AcquirePose();
+                bool hasFirst = EvaluateBlendTree(node->children[idx], time, result);
+                bool hasSecond = EvaluateBlendTree(node->children[nextIdx], time, second);
 
                 // Verify animations have compatible bone counts
-                if (temp1.empty() || temp2.empty())
+                if (!hasFirst || !hasSecond)
                 {
-                    if (!temp1.empty())
-                        result = temp1;
-                    else if (!temp2.empty())
-                        result = temp2;
-                    return;
-                }
-
-                if (temp1.size() != temp2.size())
-                {
-                    std::cerr << "[WARNING] Blend1D: Animations have mismatched bone counts (" << temp1.size() << " vs " << temp2.size() << ")" << std::endl;
-                    result = temp1; // Use first animation as fallback
-                    return;
+                    if (hasSecond)
+                        std::swap(result, second);
                 }
+                else if (result.Size() != second.Size())
+                    std::cerr << "[WARNING] Blend1D: Animations have mismatched bone counts (" << result.Size() << " vs " << second.Size() << ")" << std::endl; // Use first animation as fallback
+                else
+                    BlendPoses(result, second, blend, result);
 
-                BlendBoneTransforms(temp1, temp2, blend, result);
-                break;
+                m_posePoolUsed = poolMark;
+                return hasFirst || hasSecond;
             }
 
             case BlendTreeNode::Type::Blend2D:
             {
                 if (node->children.size() < 3)
                 {
-                    if (node->children.size() == 2)
-                    {
-                        std::vector<Matrix4> temp1, temp2;
-                        EvaluateBlendTree(node->children[0], time, temp1);
-                        EvaluateBlendTree(node->children[1], time, temp2);
+                    if (node->children.size() != 2)
+                        return false;
 
-                        // Verify animations have compatible bone counts
-                        if (temp1.empty() || temp2.empty())
-                        {
-                            if (!temp1.empty())
-                                result = temp1;
-                            else if (!temp2.empty())
-                                result = temp2;
-                            return;
-                        }
-
-                        if (temp1.size() != temp2.size())
-                        {
-                            std::cerr << "[WARNING] Blend2D: Animations have mismatched bone counts" << std::endl;
-                            result = temp1;
-                            return;
-                        }
+                    const size_t poolMark = m_posePoolUsed;
+                    Pose& second = AcquirePose();
+                    bool hasFirst = EvaluateBlendTree(node->children[0], time, result);
+                    bool hasSecond = EvaluateBlendTree(node->children[1], time, second);
 
+                    // Verify animations have compatible bone counts
+                    if (!hasFirst || !hasSecond)
+                    {
+                        if (hasSecond)
+                            std::swap(result, second);
+                    }
+                    else if (result.Size() != second.Size())
+                        std::cerr << "[WARNING] Blend2D: Animations have mismatched bone counts" << std::endl;
+                    else
+                    {
                         float blend = (m_blendParameter + 1.0f) * 0.5f;
                         blend = std::max(0.0f, std::min(1.0f, blend));
-                        BlendBoneTransforms(temp1, temp2, blend, result);
+                        BlendPoses(result, second, blend, result);
                     }
-                    return;
+
+                    m_posePoolUsed = poolMark;
+                    return hasFirst || hasSecond;
                 }
 
                 // This uses inverse distance weighting for blend space sampling. We could use Delaunay triangulation with barycentric interpolation as it would be more mathematically
@@ -1628,30 +2021,40 @@ namespace cx
 
                 Vector2 point(m_blendParameter, m_blendParameterY);
 
-                // Calculate inverse distance weights
-                std::vector<std::pair<float, size_t>> distances;
+                // Find the 3 closest points
+                std::pair<float, size_t> nearest[3];
+                size_t numBlend = 0;
                 for (size_t i = 0; i < node->positions.size() && i < node->children.size(); ++i)
                 {
                     Vector2 pos = node->positions[i];
                     float dist = (pos.x - point.x) * (pos.x - point.x) +
                         (pos.y - point.y) * (pos.y - point.y);
-                    distances.push_back({ dist, i });
-                }
 
-                std::sort(distances.begin(), distances.end());
+                    size_t slot = std::min(numBlend, size_t(2));
+                    if (numBlend == 3 && dist >= nearest[2].first)
+                        continue;
 
-                // Use 3 closest points
-                size_t numBlend = std::min(size_t(3), distances.size());
+                    while (slot > 0 && dist < nearest[slot - 1].first)
+                    {
+                        nearest[slot] = nearest[slot - 1];
+                        --slot;
+                    }
+
+                    nearest[slot] = { dist, i };
+                    numBlend = std::min(numBlend + 1, size_t(3));
+                }
+
+                if (numBlend == 0)
+                    return false;
 
                 // Calculate normalized weights
-                std::vector<float> weights;
+                float weights[3];
                 float totalWeight = 0.0f;
                 for (size_t i = 0; i < numBlend; ++i)
                 {
                     // Inverse distance weighting
-                    float w = 1.0f / (std::sqrt(distances[i].first) + 0.001f);
-                    weights.push_back(w);
-                    totalWeight += w;
+                    weights[i] = 1.0f / (std::sqrt(nearest[i].first) + 0.001f);
+                    totalWeight += weights[i];
                 }
 
                 // Normalize weights
@@ -1659,122 +2062,76 @@ namespace cx
                     weights[i] /= totalWeight;
 
                 // Sample all animations
-                std::vector<std::vector<Matrix4>> sampledAnims(numBlend);
+                const size_t poolMark = m_posePoolUsed;
+                const Pose* sampledPoses[3] = {};
                 for (size_t i = 0; i < numBlend; ++i)
-                    EvaluateBlendTree(node->children[distances[i].second], time, sampledAnims[i]);
+                {
+                    Pose& sampled = AcquirePose();
+                    if (!EvaluateBlendTree(node->children[nearest[i].second], time, sampled))
+                        sampled.Resize(0);
+
+                    sampledPoses[i] = &sampled;
+                }
 
                 // Verify all animations have data and compatible bone counts
-                if (sampledAnims.empty() || sampledAnims[0].empty())
-                    return;
+                if (sampledPoses[0]->Empty())
+                {
+                    m_posePoolUsed = poolMark;
+                    return false;
+                }
 
-                size_t expectedBoneCount = sampledAnims[0].size();
+                size_t expectedBoneCount = sampledPoses[0]->Size();
                 bool allSizesMatch = true;
 
-                for (size_t i = 1; i < sampledAnims.size(); ++i)
+                for (size_t i = 1; i < numBlend; ++i)
                 {
-                    if (sampledAnims[i].empty() || sampledAnims[i].size() != expectedBoneCount)
+                    if (sampledPoses[i]->Size() != expectedBoneCount)
                     {
-                        std::cerr << "[WARNING] Blend2D: Animation " << i << " has mismatched bone count (expected " << expectedBoneCount << ", got " << sampledAnims[i].size() << ")" << std::endl;
+                        std::cerr << "[WARNING] Blend2D: Animation " << i << " has mismatched bone count (expected " << expectedBoneCount << ", got " << sampledPoses[i]->Size() << ")" << std::endl;
                         allSizesMatch = false;
                         break;
                     }
                 }
 
+                // Fallback to first valid animation
                 if (!allSizesMatch)
-                {
-                    // Fallback to first valid animation
-                    result = sampledAnims[0];
-                    return;
-                }
-
-                // Blend all animations with their weights
-                result.resize(expectedBoneCount);
-
-                // Blend each bone across all animations
-                for (size_t boneIdx = 0; boneIdx < expectedBoneCount; ++boneIdx)
-                {
-                    // Decompose all matrices for this bone
-                    std::vector<Vector3> translations;
-                    std::vector<Quaternion> rotations;
-                    std::vector<Vector3> scales;
-
-                    for (size_t i = 0; i < numBlend; ++i)
-                    {
-                        translations.push_back(sampledAnims[i][boneIdx].GetTranslation());
-                        rotations.push_back(sampledAnims[i][boneIdx].GetRotation());
-                        scales.push_back(sampledAnims[i][boneIdx].GetScale());
-                    }
-
-                    // Weighted blend of translation and scale
-                    Vector3 blendedTrans(0.0f, 0.0f, 0.0f);
-                    Vector3 blendedScale(0.0f, 0.0f, 0.0f);
-
-                    for (size_t i = 0; i < numBlend; ++i)
-                    {
-                        blendedTrans = blendedTrans + translations[i] * weights[i];
-                        blendedScale = blendedScale + scales[i] * weights[i];
-                    }
-
-                    // For quaternions, use incremental slerp with weights
-                    Quaternion blendedRot = rotations[0];
-                    float accumulatedWeight = weights[0];
-
-                    for (size_t i = 1; i < numBlend; ++i)
-                    {
-                        // Ensure shortest path
-                        Quaternion rot = rotations[i];
-                        float dot = blendedRot.x * rot.x + blendedRot.y * rot.y + blendedRot.z * rot.z + blendedRot.w * rot.w;
-
-                        if (dot < 0.0f)
-                        {
-                            rot.x = -rot.x;
-                            rot.y = -rot.y;
-                            rot.z = -rot.z;
-                            rot.w = -rot.w;
-                        }
-
-                        // Blend with accumulated rotation
-                        float t = weights[i] / (accumulatedWeight + weights[i]);
-                        blendedRot = Quaternion::Slerp(blendedRot, rot, t);
-                        accumulatedWeight += weights[i];
-                    }
-
-                    blendedRot = blendedRot.Normalize();
+                    result = *sampledPoses[0];
+                else
+                    BlendPosesWeighted(sampledPoses, weights, numBlend, result);
 
-                    // Reconstruct matrix
-                    result[boneIdx] = Matrix4::Translate(blendedTrans) *
-                        Matrix4::FromQuaternion(blendedRot) *
-                        Matrix4::Scale(blendedScale);
-                }
-                break;
+                m_posePoolUsed = poolMark;
+                return true;
             }
 
             case BlendTreeNode::Type::Additive:
-                if (!node->children.empty())
+            {
+                if (node->children.empty() || !EvaluateBlendTree(node->children[0], time, result))
+                    return false;
+
+                if (node->children.size() > 1)
                 {
-                    EvaluateBlendTree(node->children[0], time, result);
+                    const size_t poolMark = m_posePoolUsed;
+                    Pose& additive = AcquirePose();
 
-                    if (node->children.size() > 1)
+                    if (EvaluateBlendTree(node->children[1], time, additive))
                     {
-                        std::vector<Matrix4> additiveTransforms;
-                        EvaluateBlendTree(node->children[1], time, additiveTransforms);
-
                         // Verify compatible bone counts
-                        if (!additiveTransforms.empty() && !result.empty())
+                        if (additive.Size() != result.Size())
                         {
-                            if (additiveTransforms.size() != result.size())
-                            {
-                                std::cerr << "[WARNING] Additive: Animations have mismatched bone counts ("
-                                    << result.size() << " vs " << additiveTransforms.size() << ")" << std::endl;
-                                return; // Skip additive blend
-                            }
-
-                            ApplyAdditiveAnimation(additiveTransforms, result);
+                            std::cerr << "[WARNING] Additive: Animations have mismatched bone counts ("
+                                << result.Size() << " vs " << additive.Size() << ")" << std::endl; // Skip additive blend
                         }
+                        else
+                            ApplyAdditivePose(additive, result);
                     }
+
+                    m_posePoolUsed = poolMark;
                 }
-                break;
+                return true;
+            }
         }
+
+        return false;
     }
 
     Matrix4 Animator::BlendMatrices(const Matrix4& a, const Matrix4& b, float t)
@@ -1913,7 +2270,7 @@ namespace cx
 
                 if (!alreadyFired)
                 {
-                    m_eventCallback(event);
+                    DispatchCallback([this, event]() { if (m_eventCallback) m_eventCallback(event); });
                     m_firedEvents.push_back(firedEvent);
                 }
             }
@@ -1924,6 +2281,20 @@ namespace cx
             m_firedEvents.clear();
     }
 
+    void Animator::FlushDeferredCallbacks()
+    {
+        // Callbacks may queue more work, so run from a swapped out list and hand its capacity back afterwards
+        std::vector<std::function<void()>> callbacks;
+        callbacks.swap(m_deferredCallbacks);
+
+        for (std::function<void()>& callback : callbacks)
+            callback();
+
+        callbacks.clear();
+        if (m_deferredCallbacks.empty())
+            m_deferredCallbacks.swap(callbacks);
+    }
+
     Quaternion Animator::ApplyJointConstraint(const Quaternion& rotation, const JointConstraint& constraint)
     {
         if (constraint.type == JointConstraint::Type::None)
@@ -2180,6 +2551,9 @@ namespace cx
                     SolveCCDIK(chain);
                     break;
             }
+
+            // Later chains may depend on the bones this one moved
+            UpdateGlobalTransforms();
         }
 
         // Recalculate after all IK
@@ -2194,15 +2568,15 @@ namespace cx
         int midIdx = chain.boneIndices[1];
         int tipIdx = chain.boneIndices[2];
 
-        if (rootIdx >= static_cast<int>(m_boneMatrices.size()) ||
-            midIdx >= static_cast<int>(m_boneMatrices.size()) ||
-            tipIdx >= static_cast<int>(m_boneMatrices.size()))
+        if (rootIdx >= static_cast<int>(m_globalTransforms.size()) ||
+            midIdx >= static_cast<int>(m_globalTransforms.size()) ||
+            tipIdx >= static_cast<int>(m_globalTransforms.size()))
             return;
 
         // Get world space positions
-        Vector3 rootPos = m_boneMatrices[rootIdx].GetTranslation();
-        Vector3 midPos = m_boneMatrices[midIdx].GetTranslation();
-        Vector3 tipPos = m_boneMatrices[tipIdx].GetTranslation();
+        Vector3 rootPos = m_globalTransforms[rootIdx].GetTranslation();
+        Vector3 midPos = m_globalTransforms[midIdx].GetTranslation();
+        Vector3 tipPos = m_globalTransforms[tipIdx].GetTranslation();
         Vector3 target = chain.targetPosition;
 
         // Calculate limb segment lengths
@@ -2275,7 +2649,7 @@ namespace cx
 
         Matrix4 parentTransform = Matrix4::Identity();
         if (m_skeleton->bones[rootIdx].parentIndex >= 0)
-            parentTransform = m_boneMatrices[m_skeleton->bones[rootIdx].parentIndex];
+            parentTransform = m_globalTransforms[m_skeleton->bones[rootIdx].parentIndex];
 
         Quaternion parentRot = parentTransform.GetRotation();
         Quaternion currentLocalUpperRot = m_localTransforms[rootIdx].GetRotation();
@@ -2300,7 +2674,7 @@ namespace cx
         Vector3 newLowerDir = (target - newMidPos).Normalize();
         Quaternion lowerDeltaRot = Quaternion::FromToRotation(originalLowerDir, newLowerDir);
 
-        Matrix4 midParentTransform = m_boneMatrices[rootIdx];
+        Matrix4 midParentTransform = m_globalTransforms[rootIdx];
         Quaternion midParentRot = midParentTransform.GetRotation();
         Quaternion currentLocalMidRot = m_localTransforms[midIdx].GetRotation();
 
@@ -2345,10 +2719,10 @@ namespace cx
             return;
 
         int boneIdx = chain.boneIndices[0];
-        if (boneIdx >= static_cast<int>(m_boneMatrices.size()))
+        if (boneIdx >= static_cast<int>(m_globalTransforms.size()))
             return;
 
-        Vector3 bonePos = m_boneMatrices[boneIdx].GetTranslation();
+        Vector3 bonePos = m_globalTransforms[boneIdx].GetTranslation();
         Vector3 toTarget = (chain.targetPosition - bonePos).Normalize();
         Vector3 forward(0.0f, 0.0f, 1.0f);
 
@@ -2375,13 +2749,13 @@ namespace cx
         for (size_t i = 0; i < chain.boneIndices.size(); ++i)
         {
             int boneIdx = chain.boneIndices[i];
-            if (boneIdx < static_cast<int>(m_boneMatrices.size()))
+            if (boneIdx < static_cast<int>(m_globalTransforms.size()))
             {
-                positions.push_back(m_boneMatrices[boneIdx].GetTranslation());
-                rotations.push_back(m_boneMatrices[boneIdx].GetRotation());
+                positions.push_back(m_globalTransforms[boneIdx].GetTranslation());
+                rotations.push_back(m_globalTransforms[boneIdx].GetRotation());
 
                 // Store up vector for twist tracking
-                Vector3 up = m_boneMatrices[boneIdx].GetRotation() * Vector3(0.0f, 1.0f, 0.0f);
+                Vector3 up = m_globalTransforms[boneIdx].GetRotation() * Vector3(0.0f, 1.0f, 0.0f);
                 upVectors.push_back(up);
             }
         }
@@ -2446,7 +2820,7 @@ namespace cx
                 continue;
 
             // Calculate bone direction
-            Vector3 oldDir = (m_boneMatrices[chain.boneIndices[i + 1]].GetTranslation() - m_boneMatrices[boneIdx].GetTranslation()).Normalize();
+            Vector3 oldDir = (m_globalTransforms[chain.boneIndices[i + 1]].GetTranslation() - m_globalTransforms[boneIdx].GetTranslation()).Normalize();
             Vector3 newDir = (positions[i + 1] - positions[i]).Normalize();
 
             // Calculate rotation to align directions
@@ -2477,7 +2851,7 @@ namespace cx
             // Convert to local space
             Matrix4 parentTransform = Matrix4::Identity();
             if (m_skeleton->bones[boneIdx].parentIndex >= 0)
-                parentTransform = m_boneMatrices[m_skeleton->bones[boneIdx].parentIndex];
+                parentTransform = m_globalTransforms[m_skeleton->bones[boneIdx].parentIndex];
 
             Quaternion parentRot = parentTransform.GetRotation();
             Quaternion currentLocalRot = m_localTransforms[boneIdx].GetRotation();
@@ -2511,7 +2885,7 @@ namespace cx
             {
                 Matrix4 parentTransform = Matrix4::Identity();
                 if (m_skeleton->bones[tipIdx].parentIndex >= 0)
-                    parentTransform = m_boneMatrices[m_skeleton->bones[tipIdx].parentIndex];
+                    parentTransform = m_globalTransforms[m_skeleton->bones[tipIdx].parentIndex];
 
                 Quaternion parentRot = parentTransform.GetRotation();
                 Quaternion currentLocalRot = m_localTransforms[tipIdx].GetRotation();
@@ -2545,12 +2919,12 @@ namespace cx
                 int boneIdx = chain.boneIndices[i];
                 int tipIdx = chain.boneIndices.back();
 
-                if (boneIdx >= static_cast<int>(m_boneMatrices.size()) ||
-                    tipIdx >= static_cast<int>(m_boneMatrices.size()))
+                if (boneIdx >= static_cast<int>(m_globalTransforms.size()) ||
+                    tipIdx >= static_cast<int>(m_globalTransforms.size()))
                     continue;
 
-                Vector3 bonePos = m_boneMatrices[boneIdx].GetTranslation();
-                Vector3 tipPos = m_boneMatrices[tipIdx].GetTranslation();
+                Vector3 bonePos = m_globalTransforms[boneIdx].GetTranslation();
+                Vector3 tipPos = m_globalTransforms[tipIdx].GetTranslation();
 
                 Vector3 toTip = (tipPos - bonePos).Normalize();
                 Vector3 toTarget = (target - bonePos).Normalize();
@@ -2563,13 +2937,13 @@ namespace cx
                 Vector3 scale = m_localTransforms[boneIdx].GetScale();
                 m_localTransforms[boneIdx] = Matrix4::Translate(trans) * Matrix4::FromQuaternion(finalRot) * Matrix4::Scale(scale);
 
-                // Recalculate for next iteration
-                CalculateBoneTransforms();
+                // Refresh world positions for the next bone
+                UpdateGlobalTransforms();
             }
 
             // Check if we're close enough
             int tipIdx = chain.boneIndices.back();
-            Vector3 tipPos = m_boneMatrices[tipIdx].GetTranslation();
+            Vector3 tipPos = m_globalTransforms[tipIdx].GetTranslation();
             if ((tipPos - target).Length() < chain.tolerance)
                 break;
         }
@@ -2577,10 +2951,10 @@ namespace cx
 
     Vector3 Animator::GetBoneWorldPosition(int boneIndex) const
     {
-        if (boneIndex < 0 || boneIndex >= static_cast<int>(m_boneMatrices.size()))
+        if (boneIndex < 0 || boneIndex >= static_cast<int>(m_globalTransforms.size()))
             return { 0.0f, 0.0f, 0.0f };
 
-        return m_boneMatrices[boneIndex].GetTranslation();
+        return m_globalTransforms[boneIndex].GetTranslation();
     }
 
     void Animator::SetBoneWorldPosition(int boneIndex, const Vector3& position)
@@ -2598,56 +2972,8 @@ namespace cx
         if (!m_currentClip || !m_skeleton)
             return;
 
-        for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
-            m_localTransforms[i] = m_skeleton->bones[i].localTransform;
-
-        struct AnimData
-        {
-            bool hasT = false, hasR = false, hasS = false;
-            Vector3 t;
-            Quaternion r;
-            Vector3 s;
-        };
-        std::vector<AnimData> animData(m_skeleton->bones.size());
-
-        // Get the animated components
-        for (const AnimationChannel& channel : m_currentClip->GetChannels())
-        {
-            int boneIndex = channel.targetBoneIndex;
-            if (boneIndex < 0 || boneIndex >= static_cast<int>(m_skeleton->bones.size()))
-                continue;
-
-            if (!channel.translations.empty())
-            {
-                animData[boneIndex].t = InterpolateTranslation(channel, time);
-                animData[boneIndex].hasT = true;
-            }
-
-            if (!channel.rotations.empty())
-            {
-                animData[boneIndex].r = InterpolateRotation(channel, time);
-                animData[boneIndex].hasR = true;
-            }
-
-            if (!channel.scales.empty())
-            {
-                animData[boneIndex].s = InterpolateScale(channel, time);
-                animData[boneIndex].hasS = true;
-            }
-        }
-
-        // Reconstruct only bones that have animation
-        for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
-        {
-            if (animData[i].hasT || animData[i].hasR || animData[i].hasS)
-            {
-                Vector3 t = animData[i].hasT ? animData[i].t : m_skeleton->bones[i].localTransform.GetTranslation();
-                Quaternion r = animData[i].hasR ? animData[i].r : m_skeleton->bones[i].localTransform.GetRotation();
-                Vector3 s = animData[i].hasS ? animData[i].s : m_skeleton->bones[i].localTransform.GetScale();
-
-                m_localTransforms[i] = Matrix4::Translate(t) * Matrix4::FromQuaternion(r) * Matrix4::Scale(s);
-            }
-        }
+        SampleAnimationToPose(m_currentClip, time, m_localPose);
+        PoseToLocalTransforms(m_localPose);
     }
 
     void Animator::SampleNodeAnimation(float time)
@@ -2665,14 +2991,21 @@ namespace cx
 
         m_animatedNodeTransforms.clear();
 
-        for (const auto& channel : nodeChannels)
+        // Node channel cursors are stored after the bone channel cursors
+        std::vector<int>& cursors = GetKeyframeCursors(m_currentClip);
+        const size_t cursorOffset = m_currentClip->GetChannels().size();
+
+        for (size_t c = 0; c < nodeChannels.size(); ++c)
         {
+            const NodeAnimationChannel& channel = nodeChannels[c];
             if (channel.targetNodeIndex < 0)
                 continue;
 
-            Vector3 translation = InterpolateNodeTranslation(channel, time);
-            Quaternion rotation = InterpolateNodeRotation(channel, time);
-            Vector3 scale = InterpolateNodeScale(channel, time);
+            // One lookup is shared by the T, R and S tracks
+            int keyIndex = FindKeyframeIndex(channel.times, time, cursors[cursorOffset + c]);
+            Vector3 translation = InterpolateNodeTranslation(channel, time, keyIndex);
+            Quaternion rotation = InterpolateNodeRotation(channel, time, keyIndex);
+            Vector3 scale = InterpolateNodeScale(channel, time, keyIndex);
 
             // Build the transform matrix
             Matrix4 t = Matrix4::Translate(translation);
@@ -2699,12 +3032,17 @@ namespace cx
         if (morphChannels.empty())
             return;
 
-        for (const auto& channel : morphChannels)
+        // Morph channel cursors are stored after the bone and node channel cursors
+        std::vector<int>& cursors = GetKeyframeCursors(m_currentClip);
+        const size_t cursorOffset = m_currentClip->GetChannels().size() + m_currentClip->GetNodeChannels().size();
+
+        for (size_t c = 0; c < morphChannels.size(); ++c)
         {
+            const MorphWeightChannel& channel = morphChannels[c];
             if (channel.weights.empty() || channel.times.empty())
                 continue;
 
-            int index = FindKeyframeIndex(channel.times, time);
+            int index = FindKeyframeIndex(channel.times, time, cursors[cursorOffset + c]);
             int nextIndex = index + 1;
 
             float factor = 0.0f;
@@ -2738,7 +3076,7 @@ namespace cx
                     continue;
                 }
 
-                meshes[channel.targetNodeIndex]->SetMorphWeights(interpolatedWeights);
+                DispatchCallback([mesh = meshes[channel.targetNodeIndex], weights = std::move(interpolatedWeights)]() { mesh->SetMorphWeights(weights); });
             }
         }
     }
@@ -2757,7 +3095,7 @@ namespace cx
         return Matrix4::Identity();
     }
 
-    Vector3 Animator::InterpolateNodeTranslation(const NodeAnimationChannel& channel, float time) const
+    Vector3 Animator::InterpolateNodeTranslation(const NodeAnimationChannel& channel, float time, int index) const
     {
         if (channel.translations.empty())
             return { 0.0f, 0.0f, 0.0f };
@@ -2765,8 +3103,6 @@ namespace cx
         if (channel.translations.size() == 1 || channel.times.empty())
             return channel.translations[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
-
         if (index < 0)
             return channel.translations[0];
 
@@ -2790,7 +3126,7 @@ namespace cx
         };
     }
 
-    Quaternion Animator::InterpolateNodeRotation(const NodeAnimationChannel& channel, float time) const
+    Quaternion Animator::InterpolateNodeRotation(const NodeAnimationChannel& channel, float time, int index) const
     {
         if (channel.rotations.empty())
             return { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -2798,8 +3134,6 @@ namespace cx
         if (channel.rotations.size() == 1 || channel.times.empty())
             return channel.rotations[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
-
         if (index < 0)
             return channel.rotations[0];
 
@@ -2816,7 +3150,7 @@ namespace cx
         return Quaternion::Slerp(channel.rotations[index], channel.rotations[index + 1], factor);
     }
 
-    Vector3 Animator::InterpolateNodeScale(const NodeAnimationChannel& channel, float time) const
+    Vector3 Animator::InterpolateNodeScale(const NodeAnimationChannel& channel, float time, int index) const
     {
         if (channel.scales.empty())
             return { 1.0f, 1.0f, 1.0f };
@@ -2824,8 +3158,6 @@ namespace cx
         if (channel.scales.size() == 1 || channel.times.empty())
             return channel.scales[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
-
         if (index < 0)
             return channel.scales[0];
 
@@ -2854,29 +3186,25 @@ namespace cx
         if (!m_skeleton)
             return;
 
-        m_boneMatrices.resize(m_skeleton->bones.size());
+        if (!m_skeleton->IsFlattened())
+            m_skeleton->Flatten();
 
-        std::function<void(int, const Matrix4&)> compute = [&](int index, const Matrix4& parentGlobal)
-        {
-            const Bone& bone = m_skeleton->bones[index];
-            Matrix4 global = parentGlobal * m_localTransforms[index];
-
-            m_boneMatrices[index] = global * bone.inverseBindMatrix;
+        m_globalTransforms.resize(m_skeleton->bones.size());
+        m_boneMatrices.resize(m_skeleton->bones.size());
+        m_skeleton->ComputeGlobalTransforms(m_localTransforms.data(), m_globalTransforms.data(), m_boneMatrices.data());
 
-            for (int child : bone.children)
-                compute(child, global);
-        };
+        m_skeleton->finalMatrices = m_boneMatrices;
+    }
 
-        for (size_t i = 0; i < m_skeleton->bones.size(); ++i)
-        {
-            if (m_skeleton->bones[i].parentIndex == -1)
-                compute((int)i, Matrix4::Identity());
-        }
+    void Animator::UpdateGlobalTransforms()
+    {
+        if (!m_skeleton || m_globalTransforms.size() != m_skeleton->bones.size())
+            return;
 
-        m_skeleton->finalMatrices = m_boneMatrices;
+        m_skeleton->ComputeGlobalTransforms(m_localTransforms.data(), m_globalTransforms.data());
     }
 
-    Vector3 Animator::InterpolateTranslation(const AnimationChannel& channel, float time) const
+    Vector3 Animator::InterpolateTranslation(const AnimationChannel& channel, float time, int index) const
     {
         if (channel.translations.empty())
             return { 0.0f, 0.0f, 0.0f };
@@ -2884,8 +3212,6 @@ namespace cx
         if (channel.translations.size() == 1 || channel.times.empty())
             return channel.translations[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
-
         if (index < 0)
             return channel.translations[0];
 
@@ -2923,7 +3249,7 @@ namespace cx
             return p0 + (p1 - p0) * s;
     }
 
-    Quaternion Animator::InterpolateRotation(const AnimationChannel& channel, float time) const
+    Quaternion Animator::InterpolateRotation(const AnimationChannel& channel, float time, int index) const
     {
         if (channel.rotations.empty())
             return { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -2931,7 +3257,6 @@ namespace cx
         if (channel.rotations.size() == 1 || channel.times.empty())
             return channel.rotations[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
         if (index < 0)
             return channel.rotations[0];
 
@@ -2971,7 +3296,7 @@ namespace cx
             return Quaternion::Slerp(q0, q1, s);
     }
 
-    Vector3 Animator::InterpolateScale(const AnimationChannel& channel, float time) const
+    Vector3 Animator::InterpolateScale(const AnimationChannel& channel, float time, int index) const
     {
         if (channel.scales.empty())
             return { 1.0f, 1.0f, 1.0f };
@@ -2979,7 +3304,6 @@ namespace cx
         if (channel.scales.size() == 1 || channel.times.empty())
             return channel.scales[0];
 
-        int index = FindKeyframeIndex(channel.times, time);
         if (index < 0)
             return channel.scales[0];
 
@@ -3017,20 +3341,65 @@ namespace cx
             return p0 + (p1 - p0) * s;
     }
 
-    int Animator::FindKeyframeIndex(const std::vector<float>& times, float time) const
+    int Animator::FindKeyframeIndex(const std::vector<float>& times, float time)
+    {
+        if (times.empty())
+            return -1;
+
+        if (time >= times.back())
+            return static_cast<int>(times.size()) - 1;
+
+        // The last key with times[i] <= time, or 0 if the time is before the first key
+        int index = static_cast<int>(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+        return std::max(index, 0);
+    }
+
+    int Animator::FindKeyframeIndex(const std::vector<float>& times, float time, int& cursor)
     {
         if (times.empty())
             return -1;
 
-        for (size_t i = 0; i < times.size() - 1; ++i)
+        const int count = static_cast<int>(times.size());
+        if (time >= times.back())
         {
-            if (time >= times[i] && time < times[i + 1])
-                return static_cast<int>(i);
+            cursor = count - 1;
+            return cursor;
         }
 
-        if (time >= times.back())
-            return static_cast<int>(times.size()) - 1;
+        // Playback moves forward by a few keys at most, so search forward from the cursor in doubling steps. This costs one or two
+        // compares when the time is still in the cursor's segment or the next, and stays cheap when the clip has more keys than frames.
+        int c = std::clamp(cursor, 0, count - 1);
+        if (times[c] <= time)
+        {
+            int low = c;
+            int high = c + 1;
+            int step = 1;
+            while (high < count && times[high] <= time)
+            {
+                low = high;
+                step *= 2;
+                high = c + step;
+            }
+
+            // times.back() is after time, so the first key after time is in (low, high]
+            high = std::min(high, count - 1);
+            cursor = static_cast<int>(std::upper_bound(times.begin() + low, times.begin() + high + 1, time) - times.begin()) - 1;
+            return cursor;
+        }
+
+        // Seek backwards, loop or reverse playback
+        cursor = FindKeyframeIndex(times, time);
+        return cursor;
+    }
+
+    std::vector<int>& Animator::GetKeyframeCursors(const AnimationClip* clip)
+    {
+        std::vector<int>& cursors = m_keyframeCursors[clip];
+
+        size_t count = clip->GetChannels().size() + clip->GetNodeChannels().size() + clip->GetMorphWeightChannels().size();
+        if (cursors.size() != count)
+            cursors.assign(count, 0);
 
-        return 0;
+        return cursors;
     }
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include "Audio.h"
 #include <cstring>
 #include <cmath>
+#include <cfloat>
 #include <algorithm>
+#include <atomic>
 #include <random>
 #include <iostream>
+#include <filesystem>
+#include <thread>
+#include <chrono>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -11,6 +16,161 @@
 
 namespace cx
 {
+    // A file in the sound cache, shared by every Sound loaded from its path
+    struct AudioAsset
+    {
+        std::string path;
+        AudioStorage storage = AUDIO_STORAGE_DECODED; // Resolved, never AUTO
+        ma_resource_manager_data_source source; // Holds the decoded or compressed data, which voices copy. Unused for streams.
+        bool sourceInitialized = false;
+        bool ready = false;
+        bool failed = false;
+        ma_format format = ma_format_unknown;
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+        ma_uint64 frameCount = 0;
+        size_t fileSize = 0;
+        size_t bytes = 0; // Resident once ready, 0 for streams
+        unsigned int refCount = 0; // Sounds loaded from it
+        uint64_t lastUsed = 0;
+    };
+
+    // A pooled ma_sound. Its data source points at the playing Sound's PCM, so reusing it for a sound with the same format only swaps the pointer.
+    // Cached files play through assetSource instead, which shares the cached data and is rebound the same way.
+    struct SoundVoice
+    {
+        ma_sound sound;
+        ma_audio_buffer_ref source;
+        ma_resource_manager_data_source assetSource;
+        AudioAsset* asset = nullptr; // The cached file assetSource reads, null while source is used
+        bool initialized = false;
+        unsigned int index = 0;
+        unsigned int soundId = 0; // 0 while free
+        ma_format format = ma_format_unknown;
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+        int priority = 0;
+        uint64_t startOrder = 0;
+        bool paused = false;
+        int bus = -1;
+        ma_node* output = nullptr; // The node it's attached to, so replays skip relinking
+        std::atomic<bool> ended = false; // Set by the end callback on the audio thread
+    };
+
+    // miniaudio's defaults, which a sound keeps until its 3D setters are called
+    static Audio3DConfig GetDefaultSound3DConfig()
+    {
+        Audio3DConfig config;
+        config.directionZ = -1.0f;
+        config.maxDistance = FLT_MAX;
+        config.positioning = ma_positioning_absolute;
+        return config;
+    }
+
+    // Settings shared by every copy of a Sound, applied to each voice it plays
+    struct SoundState
+    {
+        std::vector<unsigned int> voices;
+        float volume = 1.0f;
+        float pitch = 1.0f;
+        float pan = 0.0f;
+        int priority = 0;
+        int bus = AUDIO_BUS_SFX;
+        bool spatialization = false;
+        Audio3DConfig config3D = GetDefaultSound3DConfig();
+        std::unique_ptr<AudioEffectChain> effects; // Created with the first effect. Every voice of the sound feeds it.
+        AudioAsset* asset = nullptr; // Set for sounds loaded from files
+    };
+
+    // Voices that reached their end, pushed by the audio thread and popped on the main thread
+    struct FinishedVoiceQueue
+    {
+        std::vector<unsigned int> slots;
+        std::atomic<size_t> head = 0;
+        std::atomic<size_t> tail = 0;
+
+        bool Push(unsigned int voice)
+        {
+            size_t tailIndex = tail.load(std::memory_order_relaxed);
+            size_t next = (tailIndex + 1) % slots.size();
+            if (next == head.load(std::memory_order_acquire))
+                return false;
+
+            slots[tailIndex] = voice;
+            tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(unsigned int& voice)
+        {
+            size_t headIndex = head.load(std::memory_order_relaxed);
+            if (headIndex == tail.load(std::memory_order_acquire))
+                return false;
+
+            voice = slots[headIndex];
+            head.store((headIndex + 1) % slots.size(), std::memory_order_release);
+            return true;
+        }
+    };
+
+    // Sits between a bus's group and its effects. Meters the bus for sidechains and applies ducking on the audio thread.
+    struct BusNode
+    {
+        ma_node_base base; // First, so the ma_node* the graph hands back is the BusNode
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+        std::atomic<float> level = 0.0f; // Peak of the last block
+
+        std::atomic<BusNode*> sidechain = nullptr;
+        std::atomic<float> duckedVolume = 1.0f;
+        std::atomic<float> duckThreshold = 0.0f;
+        std::atomic<float> duckAttack = 0.0f;
+        std::atomic<float> duckRelease = 0.0f;
+        float gain = 1.0f; // Audio thread only
+    };
+
+    // A mix bus: sources attach to its group, which feeds the bus node, then its effects, then the parent bus's group
+    struct MixBus
+    {
+        std::string name;
+        int parent = -1;
+        ma_sound_group group;
+        bool groupInitialized = false;
+        BusNode node;
+        bool nodeInitialized = false;
+        std::unique_ptr<AudioEffectChain> effects;
+        float volume = 1.0f;
+        bool muted = false;
+        unsigned int voiceLimit = 0;
+        unsigned int voiceCount = 0; // Voices playing into this bus and the buses under it
+
+        ~MixBus()
+        {
+            // Detach from the sources towards the output, the effects go last as a member
+            if (groupInitialized)
+                ma_sound_group_uninit(&group);
+            if (nodeInitialized)
+                ma_node_uninit(&node.base, nullptr);
+        }
+    };
+
+    // A capture device and the rings its callback copies into. The callback is the only producer of both, so each is single producer single consumer.
+    struct AudioRecorder
+    {
+        ma_device device;
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+        ma_pcm_rb readRing; // Drained by ReadRecordedAudio(), and kept after stopping until the next recording starts
+        ma_pcm_rb fileRing; // Drained by the writer thread when recording to a file
+        bool capturing = false;
+        bool writingFile = false;
+        ma_encoder encoder;
+        std::thread writer;
+        std::atomic<bool> writerRunning = false;
+        std::atomic<uint64_t> droppedFileFrames = 0;
+        std::atomic<uint64_t> unwrittenFileFrames = 0; // The encoder failed to write them
+    };
+
     // Internal audio system state
     struct AudioSystem
     {
@@ -23,17 +183,33 @@ namespace cx
         AudioListener listener;
 
         // Recording
-        ma_device recordingDevice;
-        std::vector<float> recordingBuffer;
-        bool isRecording = false;
-
-        // Active sounds tracking - using unique IDs
-        std::unordered_map<size_t, std::shared_ptr<ma_sound>> activeSounds;
-        size_t nextSoundId = 0;
-
-        // Effect processors
-        std::unordered_map<const Music*, AudioProcessor> musicProcessors;
-        std::unordered_map<const Sound*, AudioProcessor> soundProcessors;
+        std::unique_ptr<AudioRecorder> recorder;
+
+        // Voice pool shared by all sounds
+        std::unique_ptr<SoundVoice[]> voices;
+        unsigned int voiceCount = 0;
+        std::vector<unsigned int> freeVoices;
+        FinishedVoiceQueue finishedVoices;
+        uint64_t nextVoiceOrder = 0;
+
+        std::unordered_map<unsigned int, SoundState> soundStates;
+        unsigned int nextSoundId = 1;
+
+        // Music effect chains
+        std::unordered_map<const Music*, std::unique_ptr<AudioEffectChain>> musicEffects;
+
+        // Mix buses, indexed by id. Parents always come before their children.
+        std::vector<std::unique_ptr<MixBus>> buses;
+
+        // Sound cache, keyed by path
+        std::unordered_map<std::string, std::unique_ptr<AudioAsset>> assets;
+        std::vector<std::unique_ptr<AudioAsset>> failedAssets; // Out of the map so their path can load again, kept until their sounds unload
+        size_t cacheBudget = 0;
+        size_t streamThreshold = 0;
+        uint64_t nextAssetUse = 0;
+        unsigned int cacheHits = 0;
+        unsigned int cacheMisses = 0;
+        unsigned int cacheEvictions = 0;
 
         // Device enumeration
         ma_device_info* playbackDeviceInfos = nullptr;
@@ -78,73 +254,872 @@ namespace cx
         }
     }
 
-    // Recording callback
-    void RecordingDataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+    // Recording
+    // Copies as many frames as fit and returns how many did
+    static ma_uint32 WriteRecordingRing(ma_pcm_rb& ring, const float* frames, ma_uint32 frameCount, ma_uint32 channels)
+    {
+        ma_uint32 written = 0;
+        while (written < frameCount)
+        {
+            // Acquiring stops at the end of the buffer, so a write that wraps takes two
+            ma_uint32 count = frameCount - written;
+            void* buffer = nullptr;
+            if (ma_pcm_rb_acquire_write(&ring, &count, &buffer) != MA_SUCCESS || count == 0)
+                break;
+
+            memcpy(buffer, frames + (size_t)written * channels, (size_t)count * channels * sizeof(float));
+            ma_pcm_rb_commit_write(&ring, count);
+            written += count;
+        }
+
+        return written;
+    }
+
+    // Runs on the device thread, so it only copies into the preallocated rings and drops what doesn't fit
+    static void RecordingDataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+    {
+        AudioRecorder* recorder = (AudioRecorder*)pDevice->pUserData;
+        if (!pInput)
+            return;
+
+        const float* frames = (const float*)pInput;
+        WriteRecordingRing(recorder->readRing, frames, frameCount, recorder->channels);
+
+        if (recorder->writingFile)
+        {
+            ma_uint32 written = WriteRecordingRing(recorder->fileRing, frames, frameCount, recorder->channels);
+            if (written < frameCount)
+                recorder->droppedFileFrames.fetch_add(frameCount - written, std::memory_order_relaxed);
+        }
+    }
+
+    static void DrainRecordingFile(AudioRecorder& recorder)
+    {
+        for (;;)
+        {
+            ma_uint32 count = ma_pcm_rb_available_read(&recorder.fileRing);
+            void* buffer = nullptr;
+            if (count == 0 || ma_pcm_rb_acquire_read(&recorder.fileRing, &count, &buffer) != MA_SUCCESS || count == 0)
+                break;
+
+            // On a failed write the frames are dropped anyway, so the ring can't fill up and stall the capture
+            ma_uint64 written = 0;
+            ma_result result = ma_encoder_write_pcm_frames(&recorder.encoder, buffer, count, &written);
+            if (result != MA_SUCCESS || written < count)
+            {
+                if (recorder.unwrittenFileFrames.fetch_add(count - written, std::memory_order_relaxed) == 0)
+                    std::cout << "Audio Error: Failed to write to the recording file: " << ma_result_description(result) << std::endl;
+            }
+            ma_pcm_rb_commit_read(&recorder.fileRing, count);
+        }
+    }
+
+    // Writes the file as it's captured so long recordings never build up in memory
+    static void RecordingWriterThread(AudioRecorder* recorder)
+    {
+        while (recorder->writerRunning.load(std::memory_order_acquire))
+        {
+            DrainRecordingFile(*recorder);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+
+        // The device is stopped by now, so this catches everything it captured
+        DrainRecordingFile(*recorder);
+    }
+
+    // Frees a stopped recorder along with its unread frames
+    static void ReleaseRecorder()
+    {
+        if (!g_audioSystem.recorder)
+            return;
+
+        StopAudioRecording();
+        ma_pcm_rb_uninit(&g_audioSystem.recorder->readRing);
+        g_audioSystem.recorder.reset();
+    }
+
+    // Mix buses
+    static void ProcessBusNode(ma_node* pNode, const float** ppFramesIn, ma_uint32*, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        BusNode& node = *(BusNode*)pNode;
+        const ma_uint32 frameCount = *pFrameCountOut;
+        const ma_uint32 channels = node.channels;
+        const float* input = ppFramesIn[0];
+        float* output = ppFramesOut[0];
+
+        // The sidechain may not have processed this block yet, so ducking can trail its level by a block
+        float target = 1.0f;
+        BusNode* sidechain = node.sidechain.load(std::memory_order_acquire);
+        if (sidechain && sidechain->level.load(std::memory_order_relaxed) > node.duckThreshold.load(std::memory_order_relaxed))
+            target = node.duckedVolume.load(std::memory_order_relaxed);
+
+        const float start = node.gain;
+        if (target != start)
+        {
+            float seconds = target < start ? node.duckAttack.load(std::memory_order_relaxed) : node.duckRelease.load(std::memory_order_relaxed);
+            float blend = seconds > 0.0f ? 1.0f - expf(-(float)frameCount / (seconds * node.sampleRate)) : 1.0f;
+            node.gain = fabsf(target - start) < 0.001f ? target : start + (target - start) * blend;
+        }
+
+        if (start == 1.0f && node.gain == 1.0f)
+            memcpy(output, input, sizeof(float) * frameCount * channels);
+        else
+        {
+            // Ramp across the block so gain changes don't click
+            const float step = (node.gain - start) / frameCount;
+            for (ma_uint32 frame = 0; frame < frameCount; frame++)
+            {
+                const float gain = start + step * (frame + 1);
+                for (ma_uint32 ch = 0; ch < channels; ch++)
+                    output[frame * channels + ch] = input[frame * channels + ch] * gain;
+            }
+        }
+
+        float peak = 0.0f;
+        for (size_t i = 0; i < (size_t)frameCount * channels; i++)
+            peak = std::max(peak, fabsf(output[i]));
+        node.level.store(peak, std::memory_order_relaxed);
+    }
+
+    // Always processed, so the level drops to 0 and ducking releases once the bus goes quiet
+    static const ma_node_vtable s_busNodeVTable = { ProcessBusNode, nullptr, 1, 1, MA_NODE_FLAG_CONTINUOUS_PROCESSING };
+
+    static MixBus* GetBus(int bus)
+    {
+        if (bus < 0 || bus >= (int)g_audioSystem.buses.size())
+            return nullptr;
+
+        return g_audioSystem.buses[bus].get();
+    }
+
+    // Where sources routed into the bus attach
+    static ma_node* GetBusInput(int bus)
+    {
+        MixBus* mixBus = GetBus(bus);
+        return mixBus ? (ma_node*)&mixBus->group : ma_engine_get_endpoint(&g_audioSystem.engine);
+    }
+
+    static int CreateBus(const std::string& name, int parent)
+    {
+        ma_engine& engine = g_audioSystem.engine;
+        ma_uint32 channels = ma_engine_get_channels(&engine);
+        ma_uint32 sampleRate = ma_engine_get_sample_rate(&engine);
+        MixBus* parentBus = GetBus(parent);
+
+        auto bus = std::make_unique<MixBus>();
+        bus->name = name;
+        bus->parent = parent;
+
+        if (ma_sound_group_init(&engine, MA_SOUND_FLAG_NO_SPATIALIZATION, parentBus ? &parentBus->group : nullptr, &bus->group) != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to create audio bus: " << name << std::endl;
+            return -1;
+        }
+        bus->groupInitialized = true;
+
+        bus->node.channels = channels;
+        bus->node.sampleRate = sampleRate;
+        ma_node_config config = ma_node_config_init();
+        config.vtable = &s_busNodeVTable;
+        config.pInputChannels = &channels;
+        config.pOutputChannels = &channels;
+        if (ma_node_init(ma_engine_get_node_graph(&engine), &config, nullptr, &bus->node.base) != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to create audio bus: " << name << std::endl;
+            return -1;
+        }
+        bus->nodeInitialized = true;
+
+        bus->effects = std::make_unique<AudioEffectChain>(ma_engine_get_node_graph(&engine),
+            parentBus ? (ma_node*)&parentBus->group : ma_engine_get_endpoint(&engine), channels, sampleRate);
+        if (!bus->effects->IsValid())
+            return -1;
+
+        ma_node_attach_output_bus(&bus->node.base, 0, bus->effects->GetInput(), 0);
+        ma_node_attach_output_bus(&bus->group, 0, &bus->node.base, 0);
+
+        g_audioSystem.buses.push_back(std::move(bus));
+        return (int)g_audioSystem.buses.size() - 1;
+    }
+
+    static bool IsInBus(int bus, int ancestor)
+    {
+        for (; bus >= 0; bus = g_audioSystem.buses[bus]->parent)
+        {
+            if (bus == ancestor)
+                return true;
+        }
+
+        return false;
+    }
+
+    // The deepest bus from bus up to Master that is at its voice limit, or -1. Stealing from it frees a voice in every full bus above it too.
+    static int FindFullBus(int bus)
+    {
+        for (; bus >= 0; bus = g_audioSystem.buses[bus]->parent)
+        {
+            const MixBus& mixBus = *g_audioSystem.buses[bus];
+            if (mixBus.voiceLimit > 0 && mixBus.voiceCount >= mixBus.voiceLimit)
+                return bus;
+        }
+
+        return -1;
+    }
+
+    static void AddVoiceToBus(SoundVoice& voice, int bus)
+    {
+        voice.bus = bus;
+        for (; bus >= 0; bus = g_audioSystem.buses[bus]->parent)
+            g_audioSystem.buses[bus]->voiceCount++;
+    }
+
+    static void RemoveVoiceFromBus(SoundVoice& voice)
+    {
+        for (int bus = voice.bus; bus >= 0; bus = g_audioSystem.buses[bus]->parent)
+            g_audioSystem.buses[bus]->voiceCount--;
+        voice.bus = -1;
+    }
+
+    // Voice pool
+    void SoundVoiceEndCallback(void* pUserData, ma_sound*)
+    {
+        SoundVoice* voice = (SoundVoice*)pUserData;
+        voice->ended.store(true, std::memory_order_release);
+        g_audioSystem.finishedVoices.Push(voice->index);
+    }
+
+    static SoundState* FindSoundState(const Sound& sound)
+    {
+        auto it = g_audioSystem.soundStates.find(sound.id);
+        return it != g_audioSystem.soundStates.end() ? &it->second : nullptr;
+    }
+
+    static ma_node* GetSoundOutput(SoundState& state)
+    {
+        return state.effects ? state.effects->GetInput() : GetBusInput(state.bus);
+    }
+
+    static void RouteVoice(SoundVoice& voice, ma_node* output)
+    {
+        if (voice.output == output)
+            return;
+
+        ma_node_attach_output_bus(&voice.sound, 0, output, 0);
+        voice.output = output;
+    }
+
+    static void ReleaseVoice(SoundVoice& voice)
+    {
+        ma_sound_stop(&voice.sound);
+        RemoveVoiceFromBus(voice);
+
+        auto it = g_audioSystem.soundStates.find(voice.soundId);
+        if (it != g_audioSystem.soundStates.end())
+        {
+            std::vector<unsigned int>& voices = it->second.voices;
+            auto voiceIt = std::find(voices.begin(), voices.end(), voice.index);
+            if (voiceIt != voices.end())
+            {
+                *voiceIt = voices.back();
+                voices.pop_back();
+            }
+        }
+
+        voice.soundId = 0;
+        voice.paused = false;
+        g_audioSystem.freeVoices.push_back(voice.index);
+    }
+
+    static void ReclaimFinishedVoices()
+    {
+        unsigned int index;
+        while (g_audioSystem.finishedVoices.Pop(index))
+        {
+            SoundVoice& voice = g_audioSystem.voices[index];
+
+            // A voice that was stolen and restarted before its end was reclaimed has its flag cleared, so the stale entry is skipped
+            if (voice.ended.exchange(false, std::memory_order_acquire) && voice.soundId != 0)
+                ReleaseVoice(voice);
+        }
+    }
+
+    static float GetVoiceListenerDistance(const SoundVoice& voice)
+    {
+        if (!ma_sound_is_spatialization_enabled(&voice.sound))
+            return 0.0f;
+
+        ma_vec3f position = ma_sound_get_position(&voice.sound);
+        if (ma_sound_get_positioning(&voice.sound) == ma_positioning_absolute)
+        {
+            ma_vec3f listener = ma_engine_listener_get_position(&g_audioSystem.engine, 0);
+            position.x -= listener.x;
+            position.y -= listener.y;
+            position.z -= listener.z;
+        }
+
+        return sqrtf(position.x * position.x + position.y * position.y + position.z * position.z);
+    }
+
+    // Picks the voice a play with this priority may take: the lowest priority, then silent voices, then the farthest, then the oldest.
+    // Only voices in bus are considered, unless it's -1.
+    static SoundVoice* FindVoiceToSteal(int priority, int bus = -1)
+    {
+        SoundVoice* best = nullptr;
+        bool bestSilent = false;
+        float bestDistance = 0.0f;
+
+        for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+        {
+            SoundVoice& voice = g_audioSystem.voices[i];
+            if (voice.soundId == 0 || voice.priority > priority || (bus >= 0 && !IsInBus(voice.bus, bus)))
+                continue;
+
+            bool silent = !ma_sound_is_playing(&voice.sound);
+            float distance = silent ? 0.0f : GetVoiceListenerDistance(voice);
+
+            bool better = !best;
+            if (best && voice.priority != best->priority)
+                better = voice.priority < best->priority;
+            else if (best && silent != bestSilent)
+                better = silent;
+            else if (best && distance != bestDistance)
+                better = distance > bestDistance;
+            else if (best)
+                better = voice.startOrder < best->startOrder;
+
+            if (better)
+            {
+                best = &voice;
+                bestSilent = silent;
+                bestDistance = distance;
+            }
+        }
+
+        return best;
+    }
+
+    // What PlaySound() hands a voice: a Sound's own PCM or a cached file
+    struct VoiceData
+    {
+        const ma_audio_buffer_ref* buffer = nullptr;
+        AudioAsset* asset = nullptr;
+        ma_format format = ma_format_unknown;
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+    };
+
+    // Whether the voice's ma_sound can switch to the data without reinitializing
+    static bool CanRebindVoice(const SoundVoice& voice, const VoiceData& data)
+    {
+        return voice.initialized && (voice.asset != nullptr) == (data.asset != nullptr) &&
+            voice.format == data.format && voice.channels == data.channels && voice.sampleRate == data.sampleRate;
+    }
+
+    static ma_result InitAssetSource(AudioAsset& asset, ma_resource_manager_data_source& source)
+    {
+        // Each stream decodes its own pages, while buffers share the cached data
+        if (asset.storage == AUDIO_STORAGE_STREAM)
+            return ma_resource_manager_data_source_init(&g_audioSystem.resourceManager, asset.path.c_str(), MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM, nullptr, &source);
+
+        return ma_resource_manager_data_source_init_copy(&g_audioSystem.resourceManager, &asset.source, &source);
+    }
+
+    // ma_sound_stop() only flags the sound, so the audio thread can still be reading its data source. Detaching the sound waits for any
+    // read in progress to finish, after which its source can be rebound or freed. RouteVoice() attaches it again when it next plays.
+    static void DetachVoice(SoundVoice& voice)
+    {
+        if (!voice.initialized || !voice.output)
+            return;
+
+        ma_node_detach_output_bus(&voice.sound, 0);
+        voice.output = nullptr;
+    }
+
+    static void UninitVoiceSource(SoundVoice& voice)
+    {
+        if (!voice.initialized)
+            return;
+
+        ma_sound_uninit(&voice.sound);
+        if (voice.asset)
+            ma_resource_manager_data_source_uninit(&voice.assetSource);
+        else
+            ma_audio_buffer_ref_uninit(&voice.source);
+
+        voice.asset = nullptr;
+        voice.initialized = false;
+    }
+
+    static SoundVoice* AcquireVoice(const VoiceData& data, int priority, int bus)
+    {
+        std::vector<unsigned int>& freeVoices = g_audioSystem.freeVoices;
+
+        // A bus at its limit has to give up one of its own voices, even with free ones in the pool
+        int fullBus = FindFullBus(bus);
+
+        SoundVoice* voice = nullptr;
+        if (fullBus < 0 && !freeVoices.empty())
+        {
+            // Prefer a voice that last played the same file, then one already set up for this format so it doesn't need reinitializing
+            size_t pick = freeVoices.size() - 1;
+            bool pickMatches = false;
+            for (size_t i = freeVoices.size(); i-- > 0;)
+            {
+                const SoundVoice& candidate = g_audioSystem.voices[freeVoices[i]];
+                if (!CanRebindVoice(candidate, data))
+                    continue;
+
+                if (!pickMatches || (data.asset && candidate.asset == data.asset))
+                {
+                    pick = i;
+                    pickMatches = true;
+                }
+
+                if (!data.asset || candidate.asset == data.asset)
+                    break;
+            }
+
+            voice = &g_audioSystem.voices[freeVoices[pick]];
+            freeVoices[pick] = freeVoices.back();
+            freeVoices.pop_back();
+        }
+        else
+        {
+            voice = FindVoiceToSteal(priority, fullBus);
+            if (!voice)
+                return nullptr;
+
+            ReleaseVoice(*voice);
+            freeVoices.pop_back();
+        }
+
+        if (CanRebindVoice(*voice, data))
+        {
+            // A stolen voice was stopped just above, and a free one may have been stopped just before this
+            DetachVoice(*voice);
+
+            if (data.buffer)
+            {
+                ma_audio_buffer_ref_set_data(&voice->source, data.buffer->pData, data.buffer->sizeInFrames);
+                return voice;
+            }
+
+            if (voice->asset == data.asset)
+            {
+                ma_sound_seek_to_pcm_frame(&voice->sound, 0);
+                return voice;
+            }
+
+            ma_resource_manager_data_source_uninit(&voice->assetSource);
+            if (InitAssetSource(*data.asset, voice->assetSource) == MA_SUCCESS)
+            {
+                voice->asset = data.asset;
+                return voice;
+            }
+
+            // The sound's data source is gone, so the voice starts over
+            ma_sound_uninit(&voice->sound);
+            voice->asset = nullptr;
+            voice->initialized = false;
+            freeVoices.push_back(voice->index);
+            return nullptr;
+        }
+
+        UninitVoiceSource(*voice);
+
+        // The sound's resampler is set up from the data source's format, so a voice only switches formats by reinitializing
+        ma_data_source* source = nullptr;
+        ma_result result;
+        if (data.asset)
+        {
+            result = InitAssetSource(*data.asset, voice->assetSource);
+            source = &voice->assetSource;
+        }
+        else
+        {
+            result = ma_audio_buffer_ref_init(data.format, data.channels, data.buffer->pData, data.buffer->sizeInFrames, &voice->source);
+            voice->source.sampleRate = data.sampleRate;
+            source = &voice->source;
+        }
+
+        if (result == MA_SUCCESS)
+        {
+            result = ma_sound_init_from_data_source(&g_audioSystem.engine, source, MA_SOUND_FLAG_NO_SPATIALIZATION, nullptr, &voice->sound);
+            if (result != MA_SUCCESS)
+            {
+                if (data.asset)
+                    ma_resource_manager_data_source_uninit(&voice->assetSource);
+                else
+                    ma_audio_buffer_ref_uninit(&voice->source);
+            }
+        }
+
+        if (result != MA_SUCCESS)
+        {
+            freeVoices.push_back(voice->index);
+            return nullptr;
+        }
+
+        ma_sound_set_end_callback(&voice->sound, SoundVoiceEndCallback, voice);
+        voice->initialized = true;
+        voice->asset = data.asset;
+        voice->output = ma_engine_get_endpoint(&g_audioSystem.engine);
+        voice->format = data.format;
+        voice->channels = data.channels;
+        voice->sampleRate = data.sampleRate;
+
+        return voice;
+    }
+
+    static void ApplySoundState(SoundVoice& voice, const SoundState& state)
+    {
+        ma_sound* sound = &voice.sound;
+        ma_sound_set_volume(sound, state.volume);
+        ma_sound_set_pitch(sound, state.pitch);
+        ma_sound_set_pan(sound, state.pan);
+        ma_sound_set_spatialization_enabled(sound, state.spatialization ? MA_TRUE : MA_FALSE);
+
+        if (!state.spatialization)
+            return;
+
+        const Audio3DConfig& config = state.config3D;
+        ma_sound_set_position(sound, config.positionX, config.positionY, config.positionZ);
+        ma_sound_set_velocity(sound, config.velocityX, config.velocityY, config.velocityZ);
+        ma_sound_set_direction(sound, config.directionX, config.directionY, config.directionZ);
+        ma_sound_set_cone(sound, config.coneInnerAngle, config.coneOuterAngle, config.coneOuterGain);
+        ma_sound_set_attenuation_model(sound, config.attenuationModel);
+        ma_sound_set_min_distance(sound, config.minDistance);
+        ma_sound_set_max_distance(sound, config.maxDistance);
+        ma_sound_set_rolloff(sound, config.rolloff);
+        ma_sound_set_doppler_factor(sound, config.dopplerFactor);
+        ma_sound_set_positioning(sound, config.positioning);
+    }
+
+    static AudioEffectChain* GetSoundEffects(SoundState& state)
+    {
+        if (!state.effects)
+        {
+            ma_engine& engine = g_audioSystem.engine;
+            state.effects = std::make_unique<AudioEffectChain>(ma_engine_get_node_graph(&engine), GetBusInput(state.bus),
+                ma_engine_get_channels(&engine), ma_engine_get_sample_rate(&engine));
+
+            for (unsigned int index : state.voices)
+                RouteVoice(g_audioSystem.voices[index], state.effects->GetInput());
+        }
+
+        return state.effects.get();
+    }
+
+    static void DestroySoundEffects(SoundState& state)
+    {
+        if (!state.effects)
+            return;
+
+        for (unsigned int index : state.voices)
+            RouteVoice(g_audioSystem.voices[index], GetBusInput(state.bus));
+
+        // Free voices last played by the sound are still attached to the chain, and destroying it detaches them
+        ma_node* input = state.effects->GetInput();
+        for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+        {
+            if (g_audioSystem.voices[i].output == input)
+                g_audioSystem.voices[i].output = nullptr;
+        }
+
+        state.effects.reset();
+    }
+
+    static AudioEffectChain* GetMusicEffects(Music& music)
+    {
+        std::unique_ptr<AudioEffectChain>& effects = g_audioSystem.musicEffects[&music];
+        if (!effects)
+        {
+            ma_engine& engine = g_audioSystem.engine;
+            effects = std::make_unique<AudioEffectChain>(ma_engine_get_node_graph(&engine), GetBusInput(music.bus),
+                ma_engine_get_channels(&engine), ma_engine_get_sample_rate(&engine));
+            ma_node_attach_output_bus(&music.sound, 0, effects->GetInput(), 0);
+        }
+
+        return effects.get();
+    }
+
+    static AudioEffectChain* FindMusicEffects(const Music& music)
+    {
+        auto it = g_audioSystem.musicEffects.find(&music);
+        return it != g_audioSystem.musicEffects.end() ? it->second.get() : nullptr;
+    }
+
+    // Sound cache
+    // Only defined in miniaudio's implementation. Each stream holds two pages.
+    static constexpr ma_uint32 s_streamPageMilliseconds = 1000;
+
+    // Checks on an async load. Returns whether the asset can play.
+    static bool UpdateAsset(AudioAsset& asset)
+    {
+        if (asset.ready || asset.failed)
+            return asset.ready;
+
+        ma_result result = ma_resource_manager_data_source_result(&asset.source);
+        if (result == MA_BUSY)
+            return false;
+
+        if (result == MA_SUCCESS)
+            result = ma_resource_manager_data_source_get_data_format(&asset.source, &asset.format, &asset.channels, &asset.sampleRate, nullptr, 0);
+        if (result == MA_SUCCESS)
+            result = ma_resource_manager_data_source_get_length_in_pcm_frames(&asset.source, &asset.frameCount);
+
+        if (result != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to load sound: " << asset.path << std::endl;
+            asset.failed = true;
+            return false;
+        }
+
+        if (asset.storage == AUDIO_STORAGE_DECODED)
+            asset.bytes = (size_t)asset.frameCount * ma_get_bytes_per_frame(asset.format, asset.channels);
+        else
+            asset.bytes = asset.fileSize;
+
+        asset.ready = true;
+        return true;
+    }
+
+    // Streams only read the file while playing, so loading one just checks the format its voices will decode to
+    static bool ProbeStreamAsset(AudioAsset& asset)
+    {
+        const ma_resource_manager_config& config = g_audioSystem.resourceManager.config;
+        ma_decoder_config decoderConfig = ma_decoder_config_init(config.decodedFormat, config.decodedChannels, config.decodedSampleRate);
+
+        ma_decoder decoder;
+        if (ma_decoder_init_file(asset.path.c_str(), &decoderConfig, &decoder) != MA_SUCCESS)
+            return false;
+
+        asset.format = decoder.outputFormat;
+        asset.channels = decoder.outputChannels;
+        asset.sampleRate = decoder.outputSampleRate;
+        ma_result result = ma_decoder_get_length_in_pcm_frames(&decoder, &asset.frameCount);
+        ma_decoder_uninit(&decoder);
+
+        return result == MA_SUCCESS;
+    }
+
+    // Free voices keep the last file they played open so replays skip rebinding. This lets go of it.
+    static void DetachAssetVoices(const AudioAsset& asset)
+    {
+        for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+        {
+            SoundVoice& voice = g_audioSystem.voices[i];
+            if (voice.asset == &asset && voice.soundId == 0)
+                UninitVoiceSource(voice);
+        }
+    }
+
+    static void DestroyAsset(AudioAsset& asset)
+    {
+        DetachAssetVoices(asset);
+        if (asset.sourceInitialized)
+            ma_resource_manager_data_source_uninit(&asset.source);
+
+        auto it = g_audioSystem.assets.find(asset.path);
+        if (it != g_audioSystem.assets.end() && it->second.get() == &asset)
+        {
+            g_audioSystem.assets.erase(it);
+            return;
+        }
+
+        std::vector<std::unique_ptr<AudioAsset>>& failed = g_audioSystem.failedAssets;
+        failed.erase(std::remove_if(failed.begin(), failed.end(), [&](const std::unique_ptr<AudioAsset>& entry) { return entry.get() == &asset; }), failed.end());
+    }
+
+    // Evicts unused assets, least recently used first, until the cache fits in the budget
+    static void TrimAssets(size_t budget)
+    {
+        size_t total = 0;
+        for (auto& [path, asset] : g_audioSystem.assets)
+            total += asset->bytes;
+
+        while (total > budget)
+        {
+            AudioAsset* oldest = nullptr;
+            for (auto& [path, asset] : g_audioSystem.assets)
+            {
+                if (asset->refCount == 0 && (!oldest || asset->lastUsed < oldest->lastUsed))
+                    oldest = asset.get();
+            }
+
+            if (!oldest)
+                break;
+
+            total -= oldest->bytes;
+            DestroyAsset(*oldest);
+            g_audioSystem.cacheEvictions++;
+        }
+    }
+
+    static AudioAsset* AcquireAsset(const std::string& path, AudioStorage storage, bool async)
+    {
+        auto it = g_audioSystem.assets.find(path);
+        if (it != g_audioSystem.assets.end() && !UpdateAsset(*it->second) && it->second->failed)
+        {
+            // A failed load would never play, so load the path again. Sounds from the failed one keep it until they unload.
+            // Its source goes now, otherwise the resource manager would hand the reload the same failed data.
+            AudioAsset& failed = *it->second;
+            if (failed.sourceInitialized)
+                ma_resource_manager_data_source_uninit(&failed.source);
+            failed.sourceInitialized = false;
+
+            g_audioSystem.failedAssets.push_back(std::move(it->second));
+            g_audioSystem.assets.erase(it);
+            it = g_audioSystem.assets.end();
+        }
+
+        if (it != g_audioSystem.assets.end())
+        {
+            AudioAsset* asset = it->second.get();
+            asset->refCount++;
+            asset->lastUsed = g_audioSystem.nextAssetUse++;
+            g_audioSystem.cacheHits++;
+            return asset;
+        }
+
+        g_audioSystem.cacheMisses++;
+
+        std::error_code error;
+        uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error)
+        {
+            std::cout << "Audio Error: Failed to load sound: " << path << std::endl;
+            return nullptr;
+        }
+
+        auto asset = std::make_unique<AudioAsset>();
+        asset->path = path;
+        asset->fileSize = (size_t)fileSize;
+        asset->storage = storage;
+        if (storage == AUDIO_STORAGE_AUTO)
+            asset->storage = fileSize > g_audioSystem.streamThreshold ? AUDIO_STORAGE_STREAM : AUDIO_STORAGE_DECODED;
+
+        if (asset->storage == AUDIO_STORAGE_STREAM)
+        {
+            if (!ProbeStreamAsset(*asset))
+            {
+                std::cout << "Audio Error: Failed to load sound: " << path << std::endl;
+                return nullptr;
+            }
+
+            asset->ready = true;
+        }
+        else
+        {
+            // Without the decode flag the resource manager keeps the file's bytes and each voice decodes its own copy
+            ma_uint32 flags = asset->storage == AUDIO_STORAGE_DECODED ? MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE : 0;
+            if (async)
+                flags |= MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC;
+
+            if (ma_resource_manager_data_source_init(&g_audioSystem.resourceManager, path.c_str(), flags, nullptr, &asset->source) != MA_SUCCESS)
+            {
+                std::cout << "Audio Error: Failed to load sound: " << path << std::endl;
+                return nullptr;
+            }
+
+            asset->sourceInitialized = true;
+            if (!async && !UpdateAsset(*asset))
+            {
+                ma_resource_manager_data_source_uninit(&asset->source);
+                return nullptr;
+            }
+        }
+
+        asset->refCount = 1;
+        asset->lastUsed = g_audioSystem.nextAssetUse++;
+
+        AudioAsset* result = asset.get();
+        g_audioSystem.assets.emplace(path, std::move(asset));
+        TrimAssets(g_audioSystem.cacheBudget);
+        return result;
+    }
+
+    static void ReleaseAsset(AudioAsset& asset)
     {
-        if (g_audioSystem.isRecording && pInput)
+        if (--asset.refCount > 0)
+            return;
+
+        if (asset.failed)
         {
-            float* samples = (float*)pInput;
-            size_t sampleCount = frameCount * pDevice->capture.channels;
-            g_audioSystem.recordingBuffer.insert(g_audioSystem.recordingBuffer.end(),
-                samples, samples + sampleCount);
+            DestroyAsset(asset);
+            return;
         }
+
+        // Stays cached for the next load of the path until the budget needs the room
+        DetachAssetVoices(asset);
+        asset.lastUsed = g_audioSystem.nextAssetUse++;
+        TrimAssets(g_audioSystem.cacheBudget);
     }
 
-    // Process echo effect
-    void ProcessEcho(EchoEffect& echo, float* buffer, size_t frameCount, unsigned int channels)
+    static Sound LoadCachedSound(const std::string& fileName, AudioStorage storage, bool async)
     {
-        for (size_t i = 0; i < frameCount * channels; i++)
-        {
-            float input = buffer[i];
-            float delayed = echo.delayBuffer[echo.writePos];
+        Sound sound = {};
 
-            buffer[i] = input * (1.0f - echo.wetDry) + delayed * echo.wetDry;
+        if (!g_audioSystem.initialized)
+        {
+            std::cout << "Audio Error: Audio system not initialized" << std::endl;
+            return sound;
+        }
 
-            echo.delayBuffer[echo.writePos] = input + delayed * echo.feedback;
-            echo.writePos = (echo.writePos + 1) % echo.delayBuffer.size();
+        if (fileName.empty())
+        {
+            std::cout << "Audio Error: Empty filename" << std::endl;
+            return sound;
         }
-    }
 
-    // Process reverb effect (Freeverb-style)
-    void ProcessReverb(ReverbEffect& reverb, float* buffer, size_t frameCount, unsigned int channels)
-    {
-        const int combLengths[4] = { 1116, 1188, 1277, 1356 };
-        const int allpassLengths[2] = { 556, 441 };
+        AudioAsset* asset = AcquireAsset(fileName, storage, async);
+        if (!asset)
+            return sound;
 
-        for (size_t frame = 0; frame < frameCount; frame++)
+        if (UpdateAsset(*asset))
         {
-            for (unsigned int ch = 0; ch < channels; ch++)
-            {
-                size_t idx = frame * channels + ch;
-                float input = buffer[idx];
-                float output = 0.0f;
+            sound.frameCount = static_cast<unsigned int>(asset->frameCount);
+            sound.sampleRate = asset->sampleRate;
+            sound.channels = asset->channels;
+        }
 
-                // Parallel comb filters
-                for (int c = 0; c < 4; c++)
-                {
-                    size_t pos = reverb.combWritePos[c] % reverb.combBuffers[c].size();
-                    float delayed = reverb.combBuffers[c][pos];
-                    output += delayed;
-                    reverb.combBuffers[c][pos] = input + delayed * reverb.damping;
-                    reverb.combWritePos[c]++;
-                }
+        sound.valid = true;
+        sound.cached = true;
+        sound.id = g_audioSystem.nextSoundId++;
+        g_audioSystem.soundStates[sound.id].asset = asset;
+        return sound;
+    }
 
-                output *= 0.25f;
+    static void ShutdownVoicePool()
+    {
+        for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+            UninitVoiceSource(g_audioSystem.voices[i]);
 
-                // Serial allpass filters
-                for (int a = 0; a < 2; a++)
-                {
-                    size_t pos = reverb.allpassWritePos[a] % reverb.allpassBuffers[a].size();
-                    float delayed = reverb.allpassBuffers[a][pos];
-                    float temp = output + delayed * 0.5f;
-                    reverb.allpassBuffers[a][pos] = output;
-                    output = delayed - temp * 0.5f;
-                    reverb.allpassWritePos[a]++;
-                }
+        g_audioSystem.voices.reset();
+        g_audioSystem.voiceCount = 0;
+        g_audioSystem.freeVoices.clear();
+        g_audioSystem.finishedVoices.slots.clear();
+        g_audioSystem.finishedVoices.head = 0;
+        g_audioSystem.finishedVoices.tail = 0;
+        g_audioSystem.soundStates.clear();
+    }
 
-                buffer[idx] = input * (1.0f - reverb.wetDry) + output * reverb.wetDry;
-            }
+    static void ShutdownSoundCache()
+    {
+        for (auto& [path, asset] : g_audioSystem.assets)
+        {
+            if (asset->sourceInitialized)
+                ma_resource_manager_data_source_uninit(&asset->source);
+        }
+
+        for (auto& asset : g_audioSystem.failedAssets)
+        {
+            if (asset->sourceInitialized)
+                ma_resource_manager_data_source_uninit(&asset->source);
         }
+
+        g_audioSystem.assets.clear();
+        g_audioSystem.failedAssets.clear();
     }
 
     // Core Audio System Functions
@@ -179,17 +1154,31 @@ namespace cx
         if (result != MA_SUCCESS)
             std::cout << "Audio Warning: Failed to enumerate devices" << std::endl;
 
+        // Sounds and music streams load through our own resource manager so they're decoded to config.decodedFormat
+        ma_resource_manager_config resourceManagerConfig = ma_resource_manager_config_init();
+        resourceManagerConfig.decodedFormat = config.decodedFormat;
+
+        result = ma_resource_manager_init(&resourceManagerConfig, &g_audioSystem.resourceManager);
+        if (result != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to initialize resource manager" << std::endl;
+            ma_context_uninit(&g_audioSystem.context);
+            return false;
+        }
+
         // Initialize engine
         ma_engine_config engineConfig = ma_engine_config_init();
         engineConfig.sampleRate = config.sampleRate;
         engineConfig.channels = config.channels;
         engineConfig.periodSizeInFrames = config.bufferSizeInFrames;
         engineConfig.noAutoStart = MA_FALSE;
+        engineConfig.pResourceManager = &g_audioSystem.resourceManager;
 
         result = ma_engine_init(&engineConfig, &g_audioSystem.engine);
         if (result != MA_SUCCESS)
         {
             std::cout << "Audio Error: Failed to initialize audio engine" << std::endl;
+            ma_resource_manager_uninit(&g_audioSystem.resourceManager);
             ma_context_uninit(&g_audioSystem.context);
             return false;
         }
@@ -199,6 +1188,32 @@ namespace cx
         ma_engine_listener_set_direction(&g_audioSystem.engine, 0, 0.0f, 0.0f, -1.0f);
         ma_engine_listener_set_world_up(&g_audioSystem.engine, 0, 0.0f, 1.0f, 0.0f);
 
+        // Voices are handed out from the back of the free list, so index 0 goes first
+        g_audioSystem.voiceCount = std::max(1u, config.maxVoices);
+        g_audioSystem.voices.reset(new SoundVoice[g_audioSystem.voiceCount]);
+        g_audioSystem.freeVoices.reserve(g_audioSystem.voiceCount);
+        for (unsigned int i = g_audioSystem.voiceCount; i-- > 0;)
+        {
+            g_audioSystem.voices[i].index = i;
+            g_audioSystem.freeVoices.push_back(i);
+        }
+
+        // Room for a stale entry from a stolen voice as well as its real end
+        g_audioSystem.finishedVoices.slots.resize(g_audioSystem.voiceCount * 2 + 1);
+
+        g_audioSystem.cacheBudget = config.soundCacheBudget;
+        g_audioSystem.streamThreshold = config.streamThreshold;
+        g_audioSystem.cacheHits = 0;
+        g_audioSystem.cacheMisses = 0;
+        g_audioSystem.cacheEvictions = 0;
+
+        // Created in AudioBusId order
+        CreateBus("Master", -1);
+        CreateBus("SFX", AUDIO_BUS_MASTER);
+        CreateBus("Music", AUDIO_BUS_MASTER);
+        CreateBus("Voice", AUDIO_BUS_MASTER);
+        CreateBus("UI", AUDIO_BUS_MASTER);
+
         g_audioSystem.initialized = true;
         g_audioSystem.masterVolume = 1.0f;
 
@@ -210,24 +1225,20 @@ namespace cx
         if (!g_audioSystem.initialized)
             return;
 
-        // Stop and clean all active sounds
-        for (auto& pair : g_audioSystem.activeSounds)
-        {
-            if (pair.second)
-                ma_sound_uninit(pair.second.get());
-        }
-        g_audioSystem.activeSounds.clear();
+        ShutdownVoicePool();
+        ShutdownSoundCache();
+        g_audioSystem.musicEffects.clear();
 
-        // Clean processors
-        g_audioSystem.musicProcessors.clear();
-        g_audioSystem.soundProcessors.clear();
+        // Children first, since each bus outputs into its parent's group
+        while (!g_audioSystem.buses.empty())
+            g_audioSystem.buses.pop_back();
 
         // Stop recording
-        if (g_audioSystem.isRecording)
-            StopAudioRecording();
+        ReleaseRecorder();
 
         // Uninitialize engine and context
         ma_engine_uninit(&g_audioSystem.engine);
+        ma_resource_manager_uninit(&g_audioSystem.resourceManager);
         ma_context_uninit(&g_audioSystem.context);
 
         g_audioSystem.initialized = false;
@@ -289,252 +1300,507 @@ namespace cx
     }
 
     // Sound Loading
-    Sound LoadSound(const std::string& fileName)
+    Sound LoadSound(const std::string& fileName, AudioStorage storage)
+    {
+        return LoadCachedSound(fileName, storage, false);
+    }
+
+    Sound LoadSoundAsync(const std::string& fileName, AudioStorage storage)
+    {
+        return LoadCachedSound(fileName, storage, true);
+    }
+
+    Sound LoadSoundFromWave(const void* data, unsigned int frameCount, unsigned int sampleRate,
+        unsigned int channels, ma_format format)
     {
         Sound sound = {};
 
-        if (!g_audioSystem.initialized)
+        if (!g_audioSystem.initialized || !data)
         {
-            std::cout << "Audio Error: Audio system not initialized" << std::endl;
+            std::cout << "Audio Error: Invalid parameters for LoadSoundFromWave" << std::endl;
             return sound;
         }
 
-        if (fileName.empty())
+        ma_audio_buffer_config bufferConfig = ma_audio_buffer_config_init(
+            format,
+            channels,
+            frameCount,
+            data,
+            nullptr
+        );
+
+        ma_result result = ma_audio_buffer_init(&bufferConfig, &sound.audioBuffer);
+        if (result != MA_SUCCESS)
         {
-            std::cout << "Audio Error: Empty filename" << std::endl;
+            std::cout << "Audio Error: Failed to initialize audio buffer from wave data" << std::endl;
             return sound;
         }
 
-        // Load and decode entire file
-        ma_decoder decoder;
-        ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 0, 0);
+        sound.valid = true;
+        sound.id = g_audioSystem.nextSoundId++;
+        sound.frameCount = frameCount;
+        sound.sampleRate = sampleRate;
+        sound.channels = channels;
+        sound.ownsData = false;
 
-        ma_result result = ma_decoder_init_file(fileName.c_str(), &decoderConfig, &decoder);
-        if (result != MA_SUCCESS)
+        return sound;
+    }
+
+    bool IsSoundReady(const Sound& sound)
+    {
+        if (!sound.valid || !sound.cached)
+            return sound.valid;
+
+        SoundState* state = FindSoundState(sound);
+        return state && state->asset && UpdateAsset(*state->asset);
+    }
+
+    void UnloadSound(Sound& sound)
+    {
+        if (!sound.valid)
+            return;
+
+        // Stop its voices before the data they read is freed
+        if (SoundState* state = FindSoundState(sound))
         {
-            std::cout << "Audio Error: Failed to load sound: " << fileName << std::endl;
-            return sound;
+            while (!state->voices.empty())
+                ReleaseVoice(g_audioSystem.voices[state->voices.back()]);
+
+            AudioAsset* asset = state->asset;
+            DestroySoundEffects(*state);
+            g_audioSystem.soundStates.erase(sound.id);
+
+            if (asset)
+                ReleaseAsset(*asset);
         }
 
-        ma_uint64 frameCount;
-        result = ma_decoder_get_length_in_pcm_frames(&decoder, &frameCount);
-        if (result != MA_SUCCESS)
+        if (!sound.cached)
         {
-            std::cout << "Audio Error: Failed to get frame count for: " << fileName << std::endl;
-            ma_decoder_uninit(&decoder);
-            return sound;
+            // Stopped voices can still be read by the audio thread, so every voice pointing at the PCM is detached before it's freed
+            for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+            {
+                SoundVoice& voice = g_audioSystem.voices[i];
+                if (voice.initialized && !voice.asset && voice.source.pData == sound.audioBuffer.ref.pData)
+                    DetachVoice(voice);
+            }
+
+            ma_audio_buffer_uninit(&sound.audioBuffer);
         }
 
-        sound.frameCount = static_cast<unsigned int>(frameCount);
-        sound.channels = decoder.outputChannels;
-        sound.sampleRate = decoder.outputSampleRate;
-        sound.ownsData = true;
+        if (sound.ownsData && sound.pcmData)
+        {
+            delete[] sound.pcmData;
+            sound.pcmData = nullptr;
+        }
 
-        // Allocate and read PCM data
-        sound.pcmData = new float[frameCount * sound.channels];
+        sound.valid = false;
+    }
 
-        ma_uint64 framesRead;
-        result = ma_decoder_read_pcm_frames(&decoder, sound.pcmData, frameCount, &framesRead);
+    // Sound Cache
+    AudioCacheStats GetAudioCacheStats()
+    {
+        AudioCacheStats stats;
+        if (!g_audioSystem.initialized)
+            return stats;
 
-        ma_decoder_uninit(&decoder);
+        stats.hits = g_audioSystem.cacheHits;
+        stats.misses = g_audioSystem.cacheMisses;
+        stats.evictions = g_audioSystem.cacheEvictions;
 
-        if (result != MA_SUCCESS || framesRead != frameCount)
+        for (auto& [path, asset] : g_audioSystem.assets)
         {
-            std::cout << "Audio Error: Failed to read PCM frames from: " << fileName << std::endl;
-            delete[] sound.pcmData;
-            return sound;
+            stats.fileCount++;
+            if (!UpdateAsset(*asset))
+            {
+                if (!asset->failed)
+                    stats.loadingCount++;
+                continue;
+            }
+
+            if (asset->storage == AUDIO_STORAGE_DECODED)
+                stats.decodedBytes += asset->bytes;
+            else
+                stats.compressedBytes += asset->bytes;
+
+            if (asset->refCount == 0)
+                stats.unusedBytes += asset->bytes;
         }
 
-        // Create audio buffer
-        ma_audio_buffer_config bufferConfig = ma_audio_buffer_config_init(
-            ma_format_f32,
-            sound.channels,
-            frameCount,
-            sound.pcmData,
-            nullptr
-        );
+        for (unsigned int i = 0; i < g_audioSystem.voiceCount; i++)
+        {
+            const SoundVoice& voice = g_audioSystem.voices[i];
+            if (voice.asset && voice.asset->storage == AUDIO_STORAGE_STREAM)
+                stats.streamingBytes += (size_t)2 * s_streamPageMilliseconds * (voice.sampleRate / 1000) * ma_get_bytes_per_frame(voice.format, voice.channels);
+        }
 
-        result = ma_audio_buffer_init(&bufferConfig, &sound.audioBuffer);
-        if (result != MA_SUCCESS)
+        return stats;
+    }
+
+    void SetAudioCacheBudget(size_t bytes)
+    {
+        if (!g_audioSystem.initialized)
+            return;
+
+        g_audioSystem.cacheBudget = bytes;
+        TrimAssets(bytes);
+    }
+
+    void TrimAudioCache()
+    {
+        if (!g_audioSystem.initialized)
+            return;
+
+        std::vector<AudioAsset*> unused;
+        for (auto& [path, asset] : g_audioSystem.assets)
         {
-            std::cout << "Audio Error: Failed to initialize audio buffer for: " << fileName << std::endl;
-            delete[] sound.pcmData;
-            return sound;
+            if (asset->refCount == 0)
+                unused.push_back(asset.get());
         }
 
-        sound.valid = true;
-        return sound;
+        for (AudioAsset* asset : unused)
+        {
+            DestroyAsset(*asset);
+            g_audioSystem.cacheEvictions++;
+        }
     }
 
-    Sound LoadSoundFromWave(const void* data, unsigned int frameCount, unsigned int sampleRate,
-        unsigned int channels, ma_format format)
+    // Sound Playback
+    void PlaySound(const Sound& sound)
     {
-        Sound sound = {};
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
 
-        if (!g_audioSystem.initialized || !data)
+        ReclaimFinishedVoices();
+
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+
+        VoiceData data;
+        if (sound.cached)
         {
-            std::cout << "Audio Error: Invalid parameters for LoadSoundFromWave" << std::endl;
-            return sound;
+            if (!state.asset || !UpdateAsset(*state.asset))
+                return; // Still loading, or failed to
+
+            data.asset = state.asset;
+            data.format = state.asset->format;
+            data.channels = state.asset->channels;
+            data.sampleRate = state.asset->sampleRate;
+        }
+        else
+        {
+            data.buffer = &sound.audioBuffer.ref;
+            data.format = sound.audioBuffer.ref.format;
+            data.channels = sound.audioBuffer.ref.channels;
+            data.sampleRate = sound.sampleRate;
         }
 
-        ma_audio_buffer_config bufferConfig = ma_audio_buffer_config_init(
-            format,
-            channels,
-            frameCount,
-            data,
-            nullptr
-        );
+        SoundVoice* voice = AcquireVoice(data, state.priority, state.bus);
+        if (!voice)
+        {
+            if (!g_audioSystem.freeVoices.empty() && FindFullBus(state.bus) < 0)
+                std::cout << "Audio Error: Failed to play sound" << std::endl;
 
-        ma_result result = ma_audio_buffer_init(&bufferConfig, &sound.audioBuffer);
-        if (result != MA_SUCCESS)
+            return; // Otherwise every voice it could take belongs to a higher priority sound
+        }
+
+        voice->soundId = sound.id;
+        voice->priority = state.priority;
+        voice->startOrder = g_audioSystem.nextVoiceOrder++;
+        voice->ended.store(false, std::memory_order_relaxed);
+        state.voices.push_back(voice->index);
+        AddVoiceToBus(*voice, state.bus);
+
+        RouteVoice(*voice, GetSoundOutput(state));
+        ApplySoundState(*voice, state);
+        ma_sound_start(&voice->sound);
+    }
+
+    void PlaySoundMulti(const Sound& sound)
+    {
+        PlaySound(sound);
+    }
+
+    void StopSound(const Sound& sound)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState* state = FindSoundState(sound);
+        if (!state)
+            return;
+
+        while (!state->voices.empty())
+            ReleaseVoice(g_audioSystem.voices[state->voices.back()]);
+    }
+
+    void PauseSound(const Sound& sound)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState* state = FindSoundState(sound);
+        if (!state)
+            return;
+
+        for (unsigned int index : state->voices)
         {
-            std::cout << "Audio Error: Failed to initialize audio buffer from wave data" << std::endl;
-            return sound;
+            SoundVoice& voice = g_audioSystem.voices[index];
+            if (ma_sound_is_playing(&voice.sound))
+            {
+                ma_sound_stop(&voice.sound);
+                voice.paused = true;
+            }
+        }
+    }
+
+    void ResumeSound(const Sound& sound)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState* state = FindSoundState(sound);
+        if (!state)
+            return;
+
+        for (unsigned int index : state->voices)
+        {
+            SoundVoice& voice = g_audioSystem.voices[index];
+            if (voice.paused)
+            {
+                ma_sound_start(&voice.sound);
+                voice.paused = false;
+            }
+        }
+    }
+
+    bool IsSoundPlaying(const Sound& sound)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return false;
+
+        ReclaimFinishedVoices();
+
+        SoundState* state = FindSoundState(sound);
+        if (!state)
+            return false;
+
+        for (unsigned int index : state->voices)
+        {
+            if (ma_sound_is_playing(&g_audioSystem.voices[index].sound))
+                return true;
         }
 
-        sound.valid = true;
-        sound.frameCount = frameCount;
-        sound.sampleRate = sampleRate;
-        sound.channels = channels;
-        sound.ownsData = false;
+        return false;
+    }
+
+    // Sound Properties
+    void SetSoundVolume(const Sound& sound, float volume)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.volume = std::clamp(volume, 0.0f, 1.0f);
+        for (unsigned int index : state.voices)
+            ma_sound_set_volume(&g_audioSystem.voices[index].sound, state.volume);
+    }
+
+    void SetSoundPitch(const Sound& sound, float pitch)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.pitch = std::max(0.1f, pitch);
+        for (unsigned int index : state.voices)
+            ma_sound_set_pitch(&g_audioSystem.voices[index].sound, state.pitch);
+    }
+
+    void SetSoundPan(const Sound& sound, float pan)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
+
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.pan = std::clamp(pan, 0.0f, 1.0f);
+        for (unsigned int index : state.voices)
+            ma_sound_set_pan(&g_audioSystem.voices[index].sound, state.pan);
+    }
+
+    // Sound Voices
+    void SetSoundPriority(const Sound& sound, int priority)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return;
 
-        return sound;
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.priority = priority;
+        for (unsigned int index : state.voices)
+            g_audioSystem.voices[index].priority = priority;
     }
 
-    bool IsSoundReady(const Sound& sound)
+    unsigned int GetActiveVoiceCount()
     {
-        return sound.valid;
+        if (!g_audioSystem.initialized)
+            return 0;
+
+        ReclaimFinishedVoices();
+        return g_audioSystem.voiceCount - (unsigned int)g_audioSystem.freeVoices.size();
     }
 
-    void UnloadSound(Sound& sound)
+    // Mix Buses
+    int CreateAudioBus(const std::string& name, int parent)
     {
-        if (!sound.valid)
-            return;
+        if (!g_audioSystem.initialized || !GetBus(parent) || GetAudioBus(name) >= 0)
+            return -1;
 
-        ma_audio_buffer_uninit(&sound.audioBuffer);
+        return CreateBus(name, parent);
+    }
 
-        if (sound.ownsData && sound.pcmData)
+    int GetAudioBus(const std::string& name)
+    {
+        for (size_t i = 0; i < g_audioSystem.buses.size(); i++)
         {
-            delete[] sound.pcmData;
-            sound.pcmData = nullptr;
+            if (g_audioSystem.buses[i]->name == name)
+                return (int)i;
         }
 
-        // Remove any processors
-        g_audioSystem.soundProcessors.erase(&sound);
-
-        sound.valid = false;
+        return -1;
     }
 
-    // Sound Playback
-    void PlaySound(const Sound& sound)
+    void SetAudioBusVolume(int bus, float volume)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
+        MixBus* mixBus = GetBus(bus);
+        if (!mixBus)
             return;
 
-        auto maSound = std::make_shared<ma_sound>();
-
-        ma_uint32 flags = MA_SOUND_FLAG_NO_PITCH | MA_SOUND_FLAG_NO_SPATIALIZATION;
-
-        ma_audio_buffer* buffer = const_cast<ma_audio_buffer*>(&sound.audioBuffer);
-        ma_result result = ma_sound_init_from_data_source(&g_audioSystem.engine,
-            buffer,
-            flags, nullptr, maSound.get());
-
-        if (result == MA_SUCCESS)
-        {
-            ma_sound_start(maSound.get());
-            size_t id = g_audioSystem.nextSoundId++;
-            g_audioSystem.activeSounds[id] = maSound;
-        }
-        else
-            std::cout << "Audio Error: Failed to play sound" << std::endl;
+        mixBus->volume = std::max(volume, 0.0f);
+        if (!mixBus->muted)
+            ma_sound_group_set_volume(&mixBus->group, mixBus->volume);
     }
 
-    void PlaySoundMulti(const Sound& sound)
+    float GetAudioBusVolume(int bus)
     {
-        PlaySound(sound);
+        MixBus* mixBus = GetBus(bus);
+        return mixBus ? mixBus->volume : 0.0f;
     }
 
-    void StopSound(const Sound& sound)
+    void SetAudioBusMuted(int bus, bool muted)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
+        MixBus* mixBus = GetBus(bus);
+        if (!mixBus)
             return;
 
-        // Stop all instances
-        auto it = g_audioSystem.activeSounds.begin();
-        while (it != g_audioSystem.activeSounds.end())
-        {
-            if (ma_sound_is_playing(it->second.get()))
-                ma_sound_stop(it->second.get());
+        mixBus->muted = muted;
+        ma_sound_group_set_volume(&mixBus->group, muted ? 0.0f : mixBus->volume);
+    }
 
-            ++it;
-        }
+    bool IsAudioBusMuted(int bus)
+    {
+        MixBus* mixBus = GetBus(bus);
+        return mixBus && mixBus->muted;
     }
 
-    void PauseSound(const Sound& sound)
+    float GetAudioBusLevel(int bus)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
-            return;
+        MixBus* mixBus = GetBus(bus);
+        return mixBus ? mixBus->node.level.load(std::memory_order_relaxed) : 0.0f;
+    }
 
-        for (auto& pair : g_audioSystem.activeSounds)
-        {
-            if (ma_sound_is_playing(pair.second.get()))
-                ma_sound_stop(pair.second.get());
-        }
+    void SetAudioBusVoiceLimit(int bus, unsigned int maxVoices)
+    {
+        if (MixBus* mixBus = GetBus(bus))
+            mixBus->voiceLimit = maxVoices;
     }
 
-    void ResumeSound(const Sound& sound)
+    unsigned int GetAudioBusVoiceCount(int bus)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
-            return;
+        MixBus* mixBus = GetBus(bus);
+        if (!mixBus)
+            return 0;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_start(pair.second.get());
+        ReclaimFinishedVoices();
+        return mixBus->voiceCount;
     }
 
-    bool IsSoundPlaying(const Sound& sound)
+    int AddAudioBusEffect(int bus, AudioEffect effect, float param1, float param2)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
-            return false;
+        MixBus* mixBus = GetBus(bus);
+        return mixBus ? mixBus->effects->Add(effect, param1, param2) : -1;
+    }
 
-        for (auto& pair : g_audioSystem.activeSounds)
-        {
-            if (ma_sound_is_playing(pair.second.get()))
-                return true;
-        }
+    void SetAudioBusEffectParameters(int bus, int index, float param1, float param2)
+    {
+        if (MixBus* mixBus = GetBus(bus))
+            mixBus->effects->SetParameters(index, param1, param2);
+    }
 
-        return false;
+    void SetAudioBusEffectEnabled(int bus, int index, bool enabled)
+    {
+        if (MixBus* mixBus = GetBus(bus))
+            mixBus->effects->SetEnabled(index, enabled);
     }
 
-    // Sound Properties
-    void SetSoundVolume(const Sound& sound, float volume)
+    void RemoveAudioBusEffects(int bus)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
+        if (MixBus* mixBus = GetBus(bus))
+            mixBus->effects->Clear();
+    }
+
+    void SetAudioBusDucking(int bus, int sidechainBus, float duckedVolume, float threshold, float attack, float release)
+    {
+        MixBus* mixBus = GetBus(bus);
+        if (!mixBus || sidechainBus == bus)
             return;
 
-        volume = std::clamp(volume, 0.0f, 1.0f);
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_volume(pair.second.get(), volume);
+        MixBus* sidechain = GetBus(sidechainBus);
+        if (!sidechain && sidechainBus != -1)
+            return;
+
+        BusNode& node = mixBus->node;
+        node.duckedVolume.store(std::clamp(duckedVolume, 0.0f, 1.0f), std::memory_order_relaxed);
+        node.duckThreshold.store(std::max(threshold, 0.0f), std::memory_order_relaxed);
+        node.duckAttack.store(std::max(attack, 0.0f), std::memory_order_relaxed);
+        node.duckRelease.store(std::max(release, 0.0f), std::memory_order_relaxed);
+        node.sidechain.store(sidechain ? &sidechain->node : nullptr, std::memory_order_release);
     }
 
-    void SetSoundPitch(const Sound& sound, float pitch)
+    void SetSoundBus(const Sound& sound, int bus)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
+        if (!g_audioSystem.initialized || !sound.valid || !GetBus(bus))
             return;
 
-        pitch = std::max(0.1f, pitch);
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_pitch(pair.second.get(), pitch);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        if (state.bus == bus)
+            return;
+
+        state.bus = bus;
+        for (unsigned int index : state.voices)
+        {
+            // Playing voices move without being stopped, even if that puts the new bus over its limit
+            SoundVoice& voice = g_audioSystem.voices[index];
+            RemoveVoiceFromBus(voice);
+            AddVoiceToBus(voice, bus);
+        }
+
+        if (state.effects)
+            state.effects->SetOutput(GetBusInput(bus));
+        else
+        {
+            for (unsigned int index : state.voices)
+                RouteVoice(g_audioSystem.voices[index], GetBusInput(bus));
+        }
     }
 
-    void SetSoundPan(const Sound& sound, float pan)
+    void SetMusicBus(Music& music, int bus)
     {
-        if (!g_audioSystem.initialized || !sound.valid)
+        if (!g_audioSystem.initialized || !music.valid || !GetBus(bus))
             return;
 
-        pan = std::clamp(pan, 0.0f, 1.0f);
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_pan(pair.second.get(), pan);
+        music.bus = bus;
+        if (AudioEffectChain* effects = FindMusicEffects(music))
+            effects->SetOutput(GetBusInput(bus));
+        else
+            ma_node_attach_output_bus(&music.sound, 0, GetBusInput(bus), 0);
     }
 
     // Music Loading
@@ -556,8 +1822,9 @@ namespace cx
 
         // Initialize streaming sound
         ma_uint32 flags = MA_SOUND_FLAG_STREAM | MA_SOUND_FLAG_NO_SPATIALIZATION;
+        MixBus* bus = GetBus(music.bus);
         ma_result result = ma_sound_init_from_file(&g_audioSystem.engine, fileName.c_str(),
-            flags, nullptr, nullptr, &music.sound);
+            flags, bus ? &bus->group : nullptr, nullptr, &music.sound);
 
         if (result != MA_SUCCESS)
         {
@@ -565,22 +1832,8 @@ namespace cx
             return music;
         }
 
-        // Create separate decoder for length/format queries
-        music.decoder = new ma_decoder();
-        ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 0, 0);
-        result = ma_decoder_init_file(fileName.c_str(), &decoderConfig, music.decoder);
-
-        if (result == MA_SUCCESS)
-        {
-            music.sampleRate = music.decoder->outputSampleRate;
-            music.channels = music.decoder->outputChannels;
-        }
-        else
-        {
-            std::cout << "Audio Warning: Failed to create decoder for queries" << std::endl;
-            delete music.decoder;
-            music.decoder = nullptr;
-        }
+        // The stream already knows its format and length, so there's no need to open the file again for them
+        ma_sound_get_data_format(&music.sound, nullptr, &music.channels, &music.sampleRate, nullptr, 0);
 
         music.valid = true;
         music.volume = 1.0f;
@@ -606,15 +1859,7 @@ namespace cx
             ma_sound_stop(&music.sound);
 
         ma_sound_uninit(&music.sound);
-
-        if (music.decoder)
-        {
-            ma_decoder_uninit(music.decoder);
-            delete music.decoder;
-            music.decoder = nullptr;
-        }
-
-        g_audioSystem.musicProcessors.erase(&music);
+        g_audioSystem.musicEffects.erase(&music);
 
         music.valid = false;
     }
@@ -737,11 +1982,11 @@ namespace cx
 
     float GetMusicTimeLength(const Music& music)
     {
-        if (!g_audioSystem.initialized || !music.valid || !music.decoder)
+        if (!g_audioSystem.initialized || !music.valid || music.sampleRate == 0)
             return 0.0f;
 
         ma_uint64 lengthInFrames;
-        ma_result result = ma_decoder_get_length_in_pcm_frames(music.decoder, &lengthInFrames);
+        ma_result result = ma_sound_get_length_in_pcm_frames(&music.sound, &lengthInFrames);
 
         if (result != MA_SUCCESS)
             return 0.0f;
@@ -1078,8 +2323,12 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_position(pair.second.get(), x, y, z);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.positionX = x;
+        state.config3D.positionY = y;
+        state.config3D.positionZ = z;
+        for (unsigned int index : state.voices)
+            ma_sound_set_position(&g_audioSystem.voices[index].sound, x, y, z);
     }
 
     void SetSoundVelocity(const Sound& sound, float x, float y, float z)
@@ -1087,8 +2336,12 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_velocity(pair.second.get(), x, y, z);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.velocityX = x;
+        state.config3D.velocityY = y;
+        state.config3D.velocityZ = z;
+        for (unsigned int index : state.voices)
+            ma_sound_set_velocity(&g_audioSystem.voices[index].sound, x, y, z);
     }
 
     void SetSoundDirection(const Sound& sound, float x, float y, float z)
@@ -1096,8 +2349,12 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_direction(pair.second.get(), x, y, z);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.directionX = x;
+        state.config3D.directionY = y;
+        state.config3D.directionZ = z;
+        for (unsigned int index : state.voices)
+            ma_sound_set_direction(&g_audioSystem.voices[index].sound, x, y, z);
     }
 
     void SetSoundCone(const Sound& sound, float innerAngle, float outerAngle, float outerGain)
@@ -1105,8 +2362,12 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_cone(pair.second.get(), innerAngle, outerAngle, outerGain);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.coneInnerAngle = innerAngle;
+        state.config3D.coneOuterAngle = outerAngle;
+        state.config3D.coneOuterGain = outerGain;
+        for (unsigned int index : state.voices)
+            ma_sound_set_cone(&g_audioSystem.voices[index].sound, innerAngle, outerAngle, outerGain);
     }
 
     void SetSoundAttenuation(const Sound& sound, ma_attenuation_model model,
@@ -1115,12 +2376,18 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.attenuationModel = model;
+        state.config3D.minDistance = minDistance;
+        state.config3D.maxDistance = maxDistance;
+        state.config3D.rolloff = rolloff;
+        for (unsigned int index : state.voices)
         {
-            ma_sound_set_attenuation_model(pair.second.get(), model);
-            ma_sound_set_min_distance(pair.second.get(), minDistance);
-            ma_sound_set_max_distance(pair.second.get(), maxDistance);
-            ma_sound_set_rolloff(pair.second.get(), rolloff);
+            ma_sound* voice = &g_audioSystem.voices[index].sound;
+            ma_sound_set_attenuation_model(voice, model);
+            ma_sound_set_min_distance(voice, minDistance);
+            ma_sound_set_max_distance(voice, maxDistance);
+            ma_sound_set_rolloff(voice, rolloff);
         }
     }
 
@@ -1141,8 +2408,16 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_spatialization_enabled(pair.second.get(), enable ? MA_TRUE : MA_FALSE);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.spatialization = enable;
+        for (unsigned int index : state.voices)
+        {
+            // Voices only pick up the 3D settings while spatialized, so bring them up to date when it's turned on
+            if (enable)
+                ApplySoundState(g_audioSystem.voices[index], state);
+            else
+                ma_sound_set_spatialization_enabled(&g_audioSystem.voices[index].sound, MA_FALSE);
+        }
     }
 
     void SetSoundDopplerFactor(const Sound& sound, float factor)
@@ -1150,8 +2425,10 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_doppler_factor(pair.second.get(), factor);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.dopplerFactor = factor;
+        for (unsigned int index : state.voices)
+            ma_sound_set_doppler_factor(&g_audioSystem.voices[index].sound, factor);
     }
 
     void SetSoundPositioning(const Sound& sound, ma_positioning mode)
@@ -1159,8 +2436,10 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        for (auto& pair : g_audioSystem.activeSounds)
-            ma_sound_set_positioning(pair.second.get(), mode);
+        SoundState& state = g_audioSystem.soundStates[sound.id];
+        state.config3D.positioning = mode;
+        for (unsigned int index : state.voices)
+            ma_sound_set_positioning(&g_audioSystem.voices[index].sound, mode);
     }
 
     // 3D Audio Music
@@ -1249,101 +2528,31 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return;
 
-        AudioProcessor& processor = g_audioSystem.soundProcessors[&sound];
-        processor.activeEffect = effect;
-        processor.enabled = true;
+        AudioEffectChain* effects = GetSoundEffects(g_audioSystem.soundStates[sound.id]);
+        effects->Clear();
+        effects->Add(effect, param1, param2);
+    }
 
-        ma_format format = ma_format_f32;
-        ma_uint32 sampleRate = sound.sampleRate;
-        ma_uint32 channels = sound.channels;
+    int AddSoundEffect(const Sound& sound, AudioEffect effect, float param1, float param2)
+    {
+        if (!g_audioSystem.initialized || !sound.valid)
+            return -1;
 
-        switch (effect)
-        {
-            case AUDIO_EFFECT_LOWPASS:
-            {
-                ma_lpf_config config = ma_lpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_lpf_init(&config, nullptr, &processor.lpf);
-                break;
-            }
-            case AUDIO_EFFECT_HIGHPASS:
-            {
-                ma_hpf_config config = ma_hpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_hpf_init(&config, nullptr, &processor.hpf);
-                break;
-            }
-            case AUDIO_EFFECT_BANDPASS:
-            {
-                ma_bpf_config config = ma_bpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_bpf_init(&config, nullptr, &processor.bpf);
-                break;
-            }
-            case AUDIO_EFFECT_NOTCH:
-            {
-                ma_notch2_config config = ma_notch2_config_init(format, channels, sampleRate,
-                    param1, param2);
-                ma_notch2_init(&config, nullptr, &processor.notch);
-                break;
-            }
-            case AUDIO_EFFECT_PEAKING:
-            {
-                ma_peak2_config config = ma_peak2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_peak2_init(&config, nullptr, &processor.peak);
-                break;
-            }
-            case AUDIO_EFFECT_LOSHELF:
-            {
-                ma_loshelf2_config config = ma_loshelf2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_loshelf2_init(&config, nullptr, &processor.loshelf);
-                break;
-            }
-            case AUDIO_EFFECT_HISHELF:
-            {
-                ma_hishelf2_config config = ma_hishelf2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_hishelf2_init(&config, nullptr, &processor.hishelf);
-                break;
-            }
-            case AUDIO_EFFECT_ECHO:
-            {
-                // param1 = delay time in seconds, param2 = feedback amount
-                processor.echo.delaySamples = (unsigned int)(param1 * sampleRate * channels);
-                processor.echo.delayBuffer.resize(processor.echo.delaySamples, 0.0f);
-                processor.echo.writePos = 0;
-                processor.echo.feedback = std::clamp(param2, 0.0f, 0.95f);
-                processor.echo.wetDry = 0.5f;
-                break;
-            }
-            case AUDIO_EFFECT_REVERB:
-            {
-                // param1 = room size, param2 = damping
-                processor.reverb.roomSize = std::clamp(param1, 0.0f, 1.0f);
-                processor.reverb.damping = std::clamp(param2, 0.0f, 1.0f);
-                processor.reverb.wetDry = 0.3f;
-
-                // Initialize comb filters
-                const int combLengths[4] = { 1116, 1188, 1277, 1356 };
-                for (int i = 0; i < 4; i++)
-                {
-                    int length = (int)(combLengths[i] * processor.reverb.roomSize);
-                    processor.reverb.combBuffers[i].resize(length * channels, 0.0f);
-                    processor.reverb.combWritePos[i] = 0;
-                }
+        return GetSoundEffects(g_audioSystem.soundStates[sound.id])->Add(effect, param1, param2);
+    }
 
-                // Initialize allpass filters
-                const int allpassLengths[2] = { 556, 441 };
-                for (int i = 0; i < 2; i++)
-                {
-                    processor.reverb.allpassBuffers[i].resize(allpassLengths[i] * channels, 0.0f);
-                    processor.reverb.allpassWritePos[i] = 0;
-                }
-                break;
-            }
-            default:
-                processor.enabled = false;
-                break;
-        }
+    void SetSoundEffectParameters(const Sound& sound, int index, float param1, float param2)
+    {
+        SoundState* state = FindSoundState(sound);
+        if (state && state->effects)
+            state->effects->SetParameters(index, param1, param2);
+    }
+
+    void SetSoundEffectEnabled(const Sound& sound, int index, bool enabled)
+    {
+        SoundState* state = FindSoundState(sound);
+        if (state && state->effects)
+            state->effects->SetEnabled(index, enabled);
     }
 
     void RemoveSoundEffect(const Sound& sound)
@@ -1351,7 +2560,8 @@ namespace cx
         if (!sound.valid)
             return;
 
-        g_audioSystem.soundProcessors.erase(&sound);
+        if (SoundState* state = FindSoundState(sound))
+            DestroySoundEffects(*state);
     }
 
     // Audio Effects Music
@@ -1360,98 +2570,29 @@ namespace cx
         if (!g_audioSystem.initialized || !music.valid)
             return;
 
-        AudioProcessor& processor = g_audioSystem.musicProcessors[&music];
-        processor.activeEffect = effect;
-        processor.enabled = true;
+        AudioEffectChain* effects = GetMusicEffects(music);
+        effects->Clear();
+        effects->Add(effect, param1, param2);
+    }
 
-        ma_format format;
-        ma_uint32 sampleRate;
-        ma_uint32 channels;
-        ma_sound_get_data_format(&music.sound, &format, &channels, &sampleRate, nullptr, 0);
+    int AddMusicEffect(Music& music, AudioEffect effect, float param1, float param2)
+    {
+        if (!g_audioSystem.initialized || !music.valid)
+            return -1;
 
-        switch (effect)
-        {
-            case AUDIO_EFFECT_LOWPASS:
-            {
-                ma_lpf_config config = ma_lpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_lpf_init(&config, nullptr, &processor.lpf);
-                break;
-            }
-            case AUDIO_EFFECT_HIGHPASS:
-            {
-                ma_hpf_config config = ma_hpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_hpf_init(&config, nullptr, &processor.hpf);
-                break;
-            }
-            case AUDIO_EFFECT_BANDPASS:
-            {
-                ma_bpf_config config = ma_bpf_config_init(format, channels, sampleRate, param1, 2);
-                ma_bpf_init(&config, nullptr, &processor.bpf);
-                break;
-            }
-            case AUDIO_EFFECT_NOTCH:
-            {
-                ma_notch2_config config = ma_notch2_config_init(format, channels, sampleRate,
-                    param1, param2);
-                ma_notch2_init(&config, nullptr, &processor.notch);
-                break;
-            }
-            case AUDIO_EFFECT_PEAKING:
-            {
-                ma_peak2_config config = ma_peak2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_peak2_init(&config, nullptr, &processor.peak);
-                break;
-            }
-            case AUDIO_EFFECT_LOSHELF:
-            {
-                ma_loshelf2_config config = ma_loshelf2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_loshelf2_init(&config, nullptr, &processor.loshelf);
-                break;
-            }
-            case AUDIO_EFFECT_HISHELF:
-            {
-                ma_hishelf2_config config = ma_hishelf2_config_init(format, channels, sampleRate,
-                    param1, 0.707, param2);
-                ma_hishelf2_init(&config, nullptr, &processor.hishelf);
-                break;
-            }
-            case AUDIO_EFFECT_ECHO:
-            {
-                processor.echo.delaySamples = (unsigned int)(param1 * sampleRate * channels);
-                processor.echo.delayBuffer.resize(processor.echo.delaySamples, 0.0f);
-                processor.echo.writePos = 0;
-                processor.echo.feedback = std::clamp(param2, 0.0f, 0.95f);
-                processor.echo.wetDry = 0.5f;
-                break;
-            }
-            case AUDIO_EFFECT_REVERB:
-            {
-                processor.reverb.roomSize = std::clamp(param1, 0.0f, 1.0f);
-                processor.reverb.damping = std::clamp(param2, 0.0f, 1.0f);
-                processor.reverb.wetDry = 0.3f;
+        return GetMusicEffects(music)->Add(effect, param1, param2);
+    }
 
-                const int combLengths[4] = { 1116, 1188, 1277, 1356 };
-                for (int i = 0; i < 4; i++)
-                {
-                    int length = (int)(combLengths[i] * processor.reverb.roomSize);
-                    processor.reverb.combBuffers[i].resize(length * channels, 0.0f);
-                    processor.reverb.combWritePos[i] = 0;
-                }
+    void SetMusicEffectParameters(Music& music, int index, float param1, float param2)
+    {
+        if (AudioEffectChain* effects = FindMusicEffects(music))
+            effects->SetParameters(index, param1, param2);
+    }
 
-                const int allpassLengths[2] = { 556, 441 };
-                for (int i = 0; i < 2; i++)
-                {
-                    processor.reverb.allpassBuffers[i].resize(allpassLengths[i] * channels, 0.0f);
-                    processor.reverb.allpassWritePos[i] = 0;
-                }
-                break;
-            }
-            default:
-                processor.enabled = false;
-                break;
-        }
+    void SetMusicEffectEnabled(Music& music, int index, bool enabled)
+    {
+        if (AudioEffectChain* effects = FindMusicEffects(music))
+            effects->SetEnabled(index, enabled);
     }
 
     void RemoveMusicEffect(Music& music)
@@ -1459,103 +2600,182 @@ namespace cx
         if (!music.valid)
             return;
 
-        g_audioSystem.musicProcessors.erase(&music);
+        auto it = g_audioSystem.musicEffects.find(&music);
+        if (it == g_audioSystem.musicEffects.end())
+            return;
+
+        ma_node_attach_output_bus(&music.sound, 0, GetBusInput(music.bus), 0);
+        g_audioSystem.musicEffects.erase(it);
     }
 
     // Audio Recording
-    bool StartAudioRecording(unsigned int sampleRate, unsigned int channels)
+    // Big enough for the writer thread to fall well behind before frames are dropped
+    static constexpr unsigned int s_recordingBufferSeconds = 2;
+
+    static bool StartRecording(const std::string& fileName, unsigned int sampleRate, unsigned int channels)
     {
-        if (!g_audioSystem.initialized || g_audioSystem.isRecording)
+        if (!g_audioSystem.initialized || IsRecordingAudio() || channels == 0 || sampleRate == 0)
         {
             std::cout << "Audio Error: Cannot start recording" << std::endl;
             return false;
         }
 
+        // Anything the last recording left unread is discarded now
+        ReleaseRecorder();
+
+        auto recorder = std::make_unique<AudioRecorder>();
+        recorder->channels = channels;
+        recorder->sampleRate = sampleRate;
+
+        ma_uint32 bufferFrames = sampleRate * s_recordingBufferSeconds;
+        if (ma_pcm_rb_init(ma_format_f32, channels, bufferFrames, nullptr, nullptr, &recorder->readRing) != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to initialize recording buffer" << std::endl;
+            return false;
+        }
+
+        if (!fileName.empty())
+        {
+            if (ma_pcm_rb_init(ma_format_f32, channels, bufferFrames, nullptr, nullptr, &recorder->fileRing) != MA_SUCCESS)
+            {
+                std::cout << "Audio Error: Failed to initialize recording buffer" << std::endl;
+                ma_pcm_rb_uninit(&recorder->readRing);
+                return false;
+            }
+
+            ma_encoder_config encoderConfig = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, channels, sampleRate);
+            if (ma_encoder_init_file(fileName.c_str(), &encoderConfig, &recorder->encoder) != MA_SUCCESS)
+            {
+                std::cout << "Audio Error: Failed to open recording file: " << fileName << std::endl;
+                ma_pcm_rb_uninit(&recorder->fileRing);
+                ma_pcm_rb_uninit(&recorder->readRing);
+                return false;
+            }
+
+            recorder->writingFile = true;
+        }
+
         ma_device_config deviceConfig = ma_device_config_init(ma_device_type_capture);
         deviceConfig.capture.format = ma_format_f32;
         deviceConfig.capture.channels = channels;
         deviceConfig.sampleRate = sampleRate;
         deviceConfig.dataCallback = RecordingDataCallback;
-        deviceConfig.pUserData = nullptr;
+        deviceConfig.pUserData = recorder.get();
 
-        ma_result result = ma_device_init(&g_audioSystem.context, &deviceConfig, &g_audioSystem.recordingDevice);
-        if (result != MA_SUCCESS)
+        ma_result result = ma_device_init(&g_audioSystem.context, &deviceConfig, &recorder->device);
+        if (result == MA_SUCCESS)
         {
-            std::cout << "Audio Error: Failed to initialize recording device" << std::endl;
-            return false;
+            result = ma_device_start(&recorder->device);
+            if (result != MA_SUCCESS)
+            {
+                std::cout << "Audio Error: Failed to start recording device" << std::endl;
+                ma_device_uninit(&recorder->device);
+            }
         }
+        else
+            std::cout << "Audio Error: Failed to initialize recording device" << std::endl;
 
-        result = ma_device_start(&g_audioSystem.recordingDevice);
         if (result != MA_SUCCESS)
         {
-            std::cout << "Audio Error: Failed to start recording device" << std::endl;
-            ma_device_uninit(&g_audioSystem.recordingDevice);
+            if (recorder->writingFile)
+            {
+                ma_encoder_uninit(&recorder->encoder);
+                ma_pcm_rb_uninit(&recorder->fileRing);
+            }
+            ma_pcm_rb_uninit(&recorder->readRing);
             return false;
         }
 
-        g_audioSystem.isRecording = true;
-        g_audioSystem.recordingBuffer.clear();
+        if (recorder->writingFile)
+        {
+            recorder->writerRunning = true;
+            recorder->writer = std::thread(RecordingWriterThread, recorder.get());
+        }
 
+        recorder->capturing = true;
+        g_audioSystem.recorder = std::move(recorder);
         return true;
     }
 
+    bool StartAudioRecording(unsigned int sampleRate, unsigned int channels)
+    {
+        return StartRecording("", sampleRate, channels);
+    }
+
+    bool StartAudioRecordingToFile(const std::string& fileName, unsigned int sampleRate, unsigned int channels)
+    {
+        if (fileName.empty())
+        {
+            std::cout << "Audio Error: Empty filename" << std::endl;
+            return false;
+        }
+
+        return StartRecording(fileName, sampleRate, channels);
+    }
+
     void StopAudioRecording()
     {
-        if (!g_audioSystem.isRecording)
+        if (!IsRecordingAudio())
             return;
 
-        ma_device_stop(&g_audioSystem.recordingDevice);
-        ma_device_uninit(&g_audioSystem.recordingDevice);
-        g_audioSystem.isRecording = false;
+        AudioRecorder& recorder = *g_audioSystem.recorder;
+        ma_device_uninit(&recorder.device);
+        recorder.capturing = false;
+
+        if (recorder.writingFile)
+        {
+            recorder.writerRunning = false;
+            recorder.writer.join();
+            ma_encoder_uninit(&recorder.encoder);
+            ma_pcm_rb_uninit(&recorder.fileRing);
+
+            uint64_t dropped = recorder.droppedFileFrames.load(std::memory_order_relaxed);
+            if (dropped > 0)
+                std::cout << "Audio Warning: Recording file is missing " << dropped << " frames the writer couldn't keep up with" << std::endl;
+
+            uint64_t unwritten = recorder.unwrittenFileFrames.load(std::memory_order_relaxed);
+            if (unwritten > 0)
+                std::cout << "Audio Error: Recording file is missing " << unwritten << " frames that failed to write" << std::endl;
+        }
+
+        // readRing stays readable, so frames captured before the stop can still be read
     }
 
     bool IsRecordingAudio()
     {
-        return g_audioSystem.isRecording;
+        return g_audioSystem.recorder && g_audioSystem.recorder->capturing;
     }
 
-    std::vector<float> GetRecordedAudio()
+    unsigned int GetRecordedAudioAvailable()
     {
-        return g_audioSystem.recordingBuffer;
+        return g_audioSystem.recorder ? ma_pcm_rb_available_read(&g_audioSystem.recorder->readRing) : 0;
     }
 
-    void SaveRecordedAudio(const std::string& fileName)
+    unsigned int ReadRecordedAudio(float* frames, unsigned int maxFrames)
     {
-        if (g_audioSystem.recordingBuffer.empty() || fileName.empty())
-        {
-            std::cout << "Audio Error: No recorded audio or invalid filename" << std::endl;
-            return;
-        }
-
-        ma_encoder_config config = ma_encoder_config_init(
-            ma_encoding_format_wav,
-            ma_format_f32,
-            g_audioSystem.recordingDevice.capture.channels,
-            g_audioSystem.recordingDevice.sampleRate
-        );
+        if (!g_audioSystem.recorder || !frames)
+            return 0;
 
-        ma_encoder encoder;
-        ma_result result = ma_encoder_init_file(fileName.c_str(), &config, &encoder);
-        if (result != MA_SUCCESS)
+        AudioRecorder& recorder = *g_audioSystem.recorder;
+        unsigned int read = 0;
+        while (read < maxFrames)
         {
-            std::cout << "Audio Error: Failed to initialize encoder" << std::endl;
-            return;
-        }
-
-        ma_uint64 framesToWrite = g_audioSystem.recordingBuffer.size() / g_audioSystem.recordingDevice.capture.channels;
-        ma_uint64 framesWritten = 0;
+            ma_uint32 count = maxFrames - read;
+            void* buffer = nullptr;
+            if (ma_pcm_rb_acquire_read(&recorder.readRing, &count, &buffer) != MA_SUCCESS || count == 0)
+                break;
 
-        result = ma_encoder_write_pcm_frames(&encoder,
-            g_audioSystem.recordingBuffer.data(),
-            framesToWrite,
-            &framesWritten);
+            memcpy(frames + (size_t)read * recorder.channels, buffer, (size_t)count * recorder.channels * sizeof(float));
+            ma_pcm_rb_commit_read(&recorder.readRing, count);
+            read += count;
+        }
 
-        if (result != MA_SUCCESS)
-            std::cout << "Audio Error: Failed to write recorded audio" << std::endl;
-        else
-            std::cout << "Audio System: Saved recording to " << fileName << std::endl;
+        return read;
+    }
 
-        ma_encoder_uninit(&encoder);
+    unsigned int GetRecordingChannels()
+    {
+        return g_audioSystem.recorder ? g_audioSystem.recorder->channels : 0;
     }
 
     // Waveform Generation
@@ -1681,11 +2901,8 @@ namespace cx
         if (!g_audioSystem.initialized || !sound.valid)
             return 0.0f;
 
-        // Return volume from first active instance
-        for (auto& pair : g_audioSystem.activeSounds)
-            return ma_sound_get_volume(pair.second.get());
-
-        return 0.0f;
+        SoundState* state = FindSoundState(sound);
+        return state ? state->volume : 1.0f;
     }
 
     float GetMusicVolume(const Music& music)
@@ -0,0 +1,583 @@
+#include "AudioEffects.h"
+#include <bx/simd_t.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace cx
+{
+    // Nodes process in blocks of at most this many frames so their scratch memory is allocated up front
+    static constexpr ma_uint32 s_maxBlockFrames = 256;
+
+    // Freeverb's tuning, with lengths in samples at 44.1 kHz
+    static constexpr int s_reverbCombLengths[ReverbEffect::CombCount] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+    static constexpr int s_reverbAllpassLengths[ReverbEffect::AllpassCount] = { 556, 441, 341, 225 };
+    static constexpr int s_reverbStereoSpread = 23;
+    static constexpr float s_reverbInputGain = 0.015f;
+    static constexpr float s_reverbWetScale = 3.0f;
+    static constexpr float s_reverbAllpassFeedback = 0.5f;
+
+    // Echo delay lines hold at least this much, so the delay can be raised later without allocating
+    static constexpr float s_minEchoCapacitySeconds = 1.0f;
+
+    // Tails are treated as finished once they've decayed by this much (-80 dB)
+    static constexpr float s_tailThreshold = 0.0001f;
+
+    struct AudioEffectChain::EffectNode
+    {
+        ma_node_base base; // First, so the ma_node* the graph hands back is the EffectNode
+        bool nodeInitialized = false;
+        AudioEffect type = AUDIO_EFFECT_NONE;
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+
+        // Written by the main thread and picked up by the audio thread at the start of its next block
+        std::atomic<float> param1 = 0.0f;
+        std::atomic<float> param2 = 0.0f;
+        std::atomic<uint32_t> version = 0;
+        std::atomic<bool> enabled = true;
+        uint32_t appliedVersion = 0;
+
+        union
+        {
+            ma_lpf lpf;
+            ma_hpf hpf;
+            ma_bpf bpf;
+            ma_notch2 notch;
+            ma_peak2 peak;
+            ma_loshelf2 loshelf;
+            ma_hishelf2 hishelf;
+        } filter;
+        bool filterInitialized = false;
+
+        EchoEffect echo;
+        ReverbEffect reverb;
+        std::vector<float> scratch;
+
+        // Echo and reverb keep ringing after their input stops. Once the tail has decayed they skip processing until input returns.
+        uint64_t tailLength = 0;
+        uint64_t tailRemaining = 0;
+
+        ~EffectNode();
+    };
+
+    static bool IsFilter(AudioEffect effect)
+    {
+        return effect >= AUDIO_EFFECT_LOWPASS && effect <= AUDIO_EFFECT_HISHELF;
+    }
+
+    static ma_result InitFilter(AudioEffectChain::EffectNode& node, float param1, float param2)
+    {
+        const ma_format format = ma_format_f32;
+        const ma_uint32 channels = node.channels;
+        const ma_uint32 sampleRate = node.sampleRate;
+        const double frequency = std::clamp((double)param1, 10.0, sampleRate * 0.45);
+        const bool reinit = node.filterInitialized;
+
+        // Reinitializing keeps the filter's history and doesn't allocate, so it's safe on the audio thread
+        switch (node.type)
+        {
+            case AUDIO_EFFECT_LOWPASS:
+            {
+                ma_lpf_config config = ma_lpf_config_init(format, channels, sampleRate, frequency, 2);
+                return reinit ? ma_lpf_reinit(&config, &node.filter.lpf) : ma_lpf_init(&config, nullptr, &node.filter.lpf);
+            }
+            case AUDIO_EFFECT_HIGHPASS:
+            {
+                ma_hpf_config config = ma_hpf_config_init(format, channels, sampleRate, frequency, 2);
+                return reinit ? ma_hpf_reinit(&config, &node.filter.hpf) : ma_hpf_init(&config, nullptr, &node.filter.hpf);
+            }
+            case AUDIO_EFFECT_BANDPASS:
+            {
+                ma_bpf_config config = ma_bpf_config_init(format, channels, sampleRate, frequency, 2);
+                return reinit ? ma_bpf_reinit(&config, &node.filter.bpf) : ma_bpf_init(&config, nullptr, &node.filter.bpf);
+            }
+            case AUDIO_EFFECT_NOTCH:
+            {
+                ma_notch2_config config = ma_notch2_config_init(format, channels, sampleRate, std::max(0.01f, param2), frequency);
+                return reinit ? ma_notch2_reinit(&config, &node.filter.notch) : ma_notch2_init(&config, nullptr, &node.filter.notch);
+            }
+            case AUDIO_EFFECT_PEAKING:
+            {
+                ma_peak2_config config = ma_peak2_config_init(format, channels, sampleRate, param2, 0.707, frequency);
+                return reinit ? ma_peak2_reinit(&config, &node.filter.peak) : ma_peak2_init(&config, nullptr, &node.filter.peak);
+            }
+            case AUDIO_EFFECT_LOSHELF:
+            {
+                ma_loshelf2_config config = ma_loshelf2_config_init(format, channels, sampleRate, param2, 0.707, frequency);
+                return reinit ? ma_loshelf2_reinit(&config, &node.filter.loshelf) : ma_loshelf2_init(&config, nullptr, &node.filter.loshelf);
+            }
+            case AUDIO_EFFECT_HISHELF:
+            {
+                ma_hishelf2_config config = ma_hishelf2_config_init(format, channels, sampleRate, param2, 0.707, frequency);
+                return reinit ? ma_hishelf2_reinit(&config, &node.filter.hishelf) : ma_hishelf2_init(&config, nullptr, &node.filter.hishelf);
+            }
+            default:
+                return MA_INVALID_ARGS;
+        }
+    }
+
+    static void UninitFilter(AudioEffectChain::EffectNode& node)
+    {
+        switch (node.type)
+        {
+            case AUDIO_EFFECT_LOWPASS: ma_lpf_uninit(&node.filter.lpf, nullptr); break;
+            case AUDIO_EFFECT_HIGHPASS: ma_hpf_uninit(&node.filter.hpf, nullptr); break;
+            case AUDIO_EFFECT_BANDPASS: ma_bpf_uninit(&node.filter.bpf, nullptr); break;
+            case AUDIO_EFFECT_NOTCH: ma_notch2_uninit(&node.filter.notch, nullptr); break;
+            case AUDIO_EFFECT_PEAKING: ma_peak2_uninit(&node.filter.peak, nullptr); break;
+            case AUDIO_EFFECT_LOSHELF: ma_loshelf2_uninit(&node.filter.loshelf, nullptr); break;
+            case AUDIO_EFFECT_HISHELF: ma_hishelf2_uninit(&node.filter.hishelf, nullptr); break;
+            default: break;
+        }
+    }
+
+    static void ProcessFilter(AudioEffectChain::EffectNode& node, float* output, const float* input, ma_uint32 frameCount)
+    {
+        switch (node.type)
+        {
+            case AUDIO_EFFECT_LOWPASS: ma_lpf_process_pcm_frames(&node.filter.lpf, output, input, frameCount); break;
+            case AUDIO_EFFECT_HIGHPASS: ma_hpf_process_pcm_frames(&node.filter.hpf, output, input, frameCount); break;
+            case AUDIO_EFFECT_BANDPASS: ma_bpf_process_pcm_frames(&node.filter.bpf, output, input, frameCount); break;
+            case AUDIO_EFFECT_NOTCH: ma_notch2_process_pcm_frames(&node.filter.notch, output, input, frameCount); break;
+            case AUDIO_EFFECT_PEAKING: ma_peak2_process_pcm_frames(&node.filter.peak, output, input, frameCount); break;
+            case AUDIO_EFFECT_LOSHELF: ma_loshelf2_process_pcm_frames(&node.filter.loshelf, output, input, frameCount); break;
+            case AUDIO_EFFECT_HISHELF: ma_hishelf2_process_pcm_frames(&node.filter.hishelf, output, input, frameCount); break;
+            default: std::memcpy(output, input, sizeof(float) * frameCount * node.channels); break;
+        }
+    }
+
+    AudioEffectChain::EffectNode::~EffectNode()
+    {
+        // Uninitializing the node waits for the audio thread to finish with it
+        if (nodeInitialized)
+            ma_node_uninit(&base, nullptr);
+
+        if (filterInitialized)
+            UninitFilter(*this);
+    }
+
+    static float GetReverbFeedback(float roomSize)
+    {
+        return roomSize * 0.28f + 0.7f;
+    }
+
+    static uint64_t GetDecayFrames(uint64_t loopFrames, float feedback)
+    {
+        if (feedback <= s_tailThreshold)
+            return loopFrames;
+
+        return loopFrames * (uint64_t)(std::ceil(std::log(s_tailThreshold) / std::log(feedback)) + 1.0f);
+    }
+
+    // Runs on the audio thread for parameter changes, so it must not allocate
+    static void ApplyParameters(AudioEffectChain::EffectNode& node, float param1, float param2)
+    {
+        if (IsFilter(node.type))
+        {
+            if (InitFilter(node, param1, param2) == MA_SUCCESS)
+                node.filterInitialized = true;
+
+            return;
+        }
+
+        if (node.type == AUDIO_EFFECT_ECHO)
+        {
+            EchoEffect& echo = node.echo;
+            const size_t capacity = echo.delayBuffer.size() / node.channels;
+            echo.delayFrames = (unsigned int)std::clamp<size_t>((size_t)(std::max(param1, 0.0f) * node.sampleRate), 1, capacity);
+            echo.feedback = std::clamp(param2, 0.0f, 0.95f);
+            node.tailLength = GetDecayFrames(echo.delayFrames, echo.feedback);
+        }
+        else if (node.type == AUDIO_EFFECT_REVERB)
+        {
+            ReverbEffect& reverb = node.reverb;
+            reverb.roomSize = std::clamp(param1, 0.0f, 1.0f);
+            reverb.damping = std::clamp(param2, 0.0f, 1.0f);
+
+            uint64_t longestComb = 0;
+            uint64_t allpassFrames = 0;
+            for (const std::vector<float>& comb : reverb.channels[0].combBuffers)
+                longestComb = std::max<uint64_t>(longestComb, comb.size());
+            for (const std::vector<float>& allpass : reverb.channels[0].allpassBuffers)
+                allpassFrames += allpass.size();
+
+            node.tailLength = GetDecayFrames(longestComb, GetReverbFeedback(reverb.roomSize)) + allpassFrames;
+        }
+    }
+
+    static void ClearDelayLines(AudioEffectChain::EffectNode& node)
+    {
+        std::fill(node.echo.delayBuffer.begin(), node.echo.delayBuffer.end(), 0.0f);
+
+        for (ReverbEffect::Channel& channel : node.reverb.channels)
+        {
+            for (int c = 0; c < ReverbEffect::CombCount; c++)
+            {
+                std::fill(channel.combBuffers[c].begin(), channel.combBuffers[c].end(), 0.0f);
+                channel.combFilterStore[c] = 0.0f;
+            }
+
+            for (std::vector<float>& allpass : channel.allpassBuffers)
+                std::fill(allpass.begin(), allpass.end(), 0.0f);
+        }
+    }
+
+    static void ProcessEcho(EchoEffect& echo, float* output, const float* input, ma_uint32 frameCount, ma_uint32 channels)
+    {
+        const size_t capacity = echo.delayBuffer.size() / channels;
+        size_t readPos = (echo.writePos + capacity - echo.delayFrames) % capacity;
+        float* delay = echo.delayBuffer.data();
+
+        for (ma_uint32 frame = 0; frame < frameCount; frame++)
+        {
+            for (ma_uint32 ch = 0; ch < channels; ch++)
+            {
+                const float in = input[frame * channels + ch];
+                const float delayed = delay[readPos * channels + ch];
+
+                output[frame * channels + ch] = in * (1.0f - echo.wetDry) + delayed * echo.wetDry;
+                delay[echo.writePos * channels + ch] = in + delayed * echo.feedback;
+            }
+
+            if (++readPos == capacity)
+                readPos = 0;
+            if (++echo.writePos == capacity)
+                echo.writePos = 0;
+        }
+    }
+
+    // The 8 combs run side by side in two SIMD registers. Each comb's damping filter depends on its previous sample, so it can't be
+    // vectorized over time, but the combs are independent of each other.
+    static void ProcessCombBank(ReverbEffect::Channel& channel, const float* input, float* output, ma_uint32 frameCount, float feedback, float damping)
+    {
+        static_assert(ReverbEffect::CombCount == 8, "The comb kernel works on two registers of four combs");
+        using bx::simd128_t;
+
+        const simd128_t damp = bx::simd_splat<simd128_t>(damping);
+        const simd128_t undamp = bx::simd_splat<simd128_t>(1.0f - damping);
+        const simd128_t gain = bx::simd_splat<simd128_t>(feedback);
+
+        alignas(16) float values[ReverbEffect::CombCount];
+        alignas(16) float delayed[ReverbEffect::CombCount];
+        std::memcpy(values, channel.combFilterStore, sizeof(values));
+        simd128_t storeLow = bx::simd_ld<simd128_t>(values);
+        simd128_t storeHigh = bx::simd_ld<simd128_t>(values + 4);
+
+        float* lines[ReverbEffect::CombCount];
+        size_t sizes[ReverbEffect::CombCount];
+        size_t positions[ReverbEffect::CombCount];
+        for (int c = 0; c < ReverbEffect::CombCount; c++)
+        {
+            lines[c] = channel.combBuffers[c].data();
+            sizes[c] = channel.combBuffers[c].size();
+            positions[c] = channel.combPos[c];
+        }
+
+        for (ma_uint32 i = 0; i < frameCount; i++)
+        {
+            for (int c = 0; c < ReverbEffect::CombCount; c++)
+                delayed[c] = lines[c][positions[c]];
+
+            const simd128_t delayedLow = bx::simd_ld<simd128_t>(delayed);
+            const simd128_t delayedHigh = bx::simd_ld<simd128_t>(delayed + 4);
+            storeLow = bx::simd_madd(delayedLow, undamp, bx::simd_mul(storeLow, damp));
+            storeHigh = bx::simd_madd(delayedHigh, undamp, bx::simd_mul(storeHigh, damp));
+
+            const simd128_t in = bx::simd_splat<simd128_t>(input[i]);
+            bx::simd_st(values, bx::simd_madd(storeLow, gain, in));
+            bx::simd_st(values + 4, bx::simd_madd(storeHigh, gain, in));
+
+            float sum = 0.0f;
+            for (int c = 0; c < ReverbEffect::CombCount; c++)
+            {
+                sum += delayed[c];
+                lines[c][positions[c]] = values[c];
+                if (++positions[c] == sizes[c])
+                    positions[c] = 0;
+            }
+            output[i] = sum;
+        }
+
+        bx::simd_st(values, storeLow);
+        bx::simd_st(values + 4, storeHigh);
+        for (int c = 0; c < ReverbEffect::CombCount; c++)
+        {
+            // Flush denormals left by a decaying tail, they're very slow on x86
+            channel.combFilterStore[c] = std::fabs(values[c]) < 1e-15f ? 0.0f : values[c];
+            channel.combPos[c] = positions[c];
+        }
+    }
+
+    // An allpass reads what it wrote one delay length ago, so within a run that doesn't wrap no sample depends on another and the loop vectorizes
+    static void ProcessAllpass(std::vector<float>& line, size_t& position, float* samples, ma_uint32 frameCount)
+    {
+        ma_uint32 done = 0;
+        while (done < frameCount)
+        {
+            const size_t run = std::min<size_t>(frameCount - done, line.size() - position);
+            float* delay = line.data() + position;
+            float* io = samples + done;
+
+            for (size_t i = 0; i < run; i++)
+            {
+                const float delayed = delay[i];
+                const float in = io[i];
+                io[i] = delayed - in;
+                delay[i] = in + delayed * s_reverbAllpassFeedback;
+            }
+
+            position += run;
+            if (position == line.size())
+                position = 0;
+            done += (ma_uint32)run;
+        }
+    }
+
+    // Every channel's reverb is fed the same mono mix, the way Freeverb does. Their delay lines differ, which decorrelates the outputs.
+    static void ProcessReverb(ReverbEffect& reverb, float* output, const float* input, ma_uint32 frameCount, ma_uint32 channels, float* scratch)
+    {
+        float* mono = scratch;
+        float* wet = scratch + s_maxBlockFrames;
+
+        for (ma_uint32 i = 0; i < frameCount; i++)
+        {
+            float sum = 0.0f;
+            for (ma_uint32 ch = 0; ch < channels; ch++)
+                sum += input[i * channels + ch];
+            mono[i] = sum * s_reverbInputGain;
+        }
+
+        const float feedback = GetReverbFeedback(reverb.roomSize);
+        const float damping = reverb.damping * 0.4f;
+        const float dryGain = 1.0f - reverb.wetDry;
+        const float wetGain = reverb.wetDry * s_reverbWetScale;
+
+        for (ma_uint32 ch = 0; ch < channels; ch++)
+        {
+            ReverbEffect::Channel& channel = reverb.channels[ch];
+            ProcessCombBank(channel, mono, wet, frameCount, feedback, damping);
+            for (int a = 0; a < ReverbEffect::AllpassCount; a++)
+                ProcessAllpass(channel.allpassBuffers[a], channel.allpassPos[a], wet, frameCount);
+
+            for (ma_uint32 i = 0; i < frameCount; i++)
+                output[i * channels + ch] = input[i * channels + ch] * dryGain + wet[i] * wetGain;
+        }
+    }
+
+    static void ProcessEffectNode(ma_node* pNode, const float** ppFramesIn, ma_uint32*, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        AudioEffectChain::EffectNode& node = *(AudioEffectChain::EffectNode*)pNode;
+        const ma_uint32 frameCount = *pFrameCountOut;
+        const ma_uint32 channels = node.channels;
+        const float* input = ppFramesIn[0];
+        float* output = ppFramesOut[0];
+
+        const uint32_t version = node.version.load(std::memory_order_acquire);
+        if (version != node.appliedVersion)
+        {
+            node.appliedVersion = version;
+            ApplyParameters(node, node.param1.load(std::memory_order_relaxed), node.param2.load(std::memory_order_relaxed));
+        }
+
+        if (!node.enabled.load(std::memory_order_relaxed))
+        {
+            std::memcpy(output, input, sizeof(float) * frameCount * channels);
+            return;
+        }
+
+        if (IsFilter(node.type))
+        {
+            ProcessFilter(node, output, input, frameCount);
+            return;
+        }
+
+        const float* end = input + (size_t)frameCount * channels;
+        const bool silent = std::all_of(input, end, [](float sample) { return sample == 0.0f; });
+        if (!silent)
+            node.tailRemaining = node.tailLength;
+        else if (node.tailRemaining == 0)
+        {
+            std::memset(output, 0, sizeof(float) * frameCount * channels);
+            return;
+        }
+        else
+            node.tailRemaining -= std::min<uint64_t>(node.tailRemaining, frameCount);
+
+        for (ma_uint32 done = 0; done < frameCount; done += s_maxBlockFrames)
+        {
+            const ma_uint32 block = std::min(s_maxBlockFrames, frameCount - done);
+            const size_t offset = (size_t)done * channels;
+
+            if (node.type == AUDIO_EFFECT_ECHO)
+                ProcessEcho(node.echo, output + offset, input + offset, block, channels);
+            else
+                ProcessReverb(node.reverb, output + offset, input + offset, block, channels, node.scratch.data());
+        }
+
+        // Start the next sound from silence rather than the residue of the last one
+        if (silent && node.tailRemaining == 0)
+            ClearDelayLines(node);
+    }
+
+    static void ProcessChainInput(ma_node* pNode, const float** ppFramesIn, ma_uint32*, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        // Only called if miniaudio stops honoring the passthrough flag
+        ma_uint32 channels = ma_node_get_output_channels(pNode, 0);
+        std::memcpy(ppFramesOut[0], ppFramesIn[0], sizeof(float) * *pFrameCountOut * channels);
+    }
+
+    static const ma_node_vtable s_chainInputVTable = { ProcessChainInput, nullptr, 1, 1, MA_NODE_FLAG_PASSTHROUGH };
+    static const ma_node_vtable s_filterNodeVTable = { ProcessEffectNode, nullptr, 1, 1, 0 };
+    // Echo and reverb keep processing without input so their tails ring out after the last sound stops
+    static const ma_node_vtable s_tailNodeVTable = { ProcessEffectNode, nullptr, 1, 1, MA_NODE_FLAG_CONTINUOUS_PROCESSING };
+
+    AudioEffectChain::AudioEffectChain(ma_node_graph* graph, ma_node* output, ma_uint32 channels, ma_uint32 sampleRate)
+        : m_graph(graph), m_output(output), m_channels(channels), m_sampleRate(sampleRate)
+    {
+        ma_node_config config = ma_node_config_init();
+        config.vtable = &s_chainInputVTable;
+        config.pInputChannels = &channels;
+        config.pOutputChannels = &channels;
+
+        if (ma_node_init(graph, &config, nullptr, &m_input) != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to create effect chain" << std::endl;
+            return;
+        }
+
+        ma_node_attach_output_bus(&m_input, 0, m_output, 0);
+        m_valid = true;
+    }
+
+    AudioEffectChain::~AudioEffectChain()
+    {
+        // Detach from the sources towards the output, so each detach waits on as little processing as possible
+        if (m_valid)
+            ma_node_uninit(&m_input, nullptr);
+
+        for (std::unique_ptr<EffectNode>& effect : m_effects)
+            effect.reset();
+    }
+
+    void AudioEffectChain::SetOutput(ma_node* output)
+    {
+        m_output = output;
+        if (m_valid)
+            ma_node_attach_output_bus(GetNode(GetCount() - 1), 0, m_output, 0);
+    }
+
+    int AudioEffectChain::Add(AudioEffect effect, float param1, float param2)
+    {
+        if (!m_valid || effect == AUDIO_EFFECT_NONE)
+            return -1;
+
+        auto node = std::make_unique<EffectNode>();
+        node->type = effect;
+        node->channels = m_channels;
+        node->sampleRate = m_sampleRate;
+        node->param1 = param1;
+        node->param2 = param2;
+
+        // Everything the audio thread touches is allocated here, so processing and parameter changes never allocate
+        if (effect == AUDIO_EFFECT_ECHO)
+        {
+            const size_t capacity = (size_t)(std::max(param1, s_minEchoCapacitySeconds) * m_sampleRate) + 1;
+            node->echo.delayBuffer.assign(capacity * m_channels, 0.0f);
+        }
+        else if (effect == AUDIO_EFFECT_REVERB)
+        {
+            const float scale = m_sampleRate / 44100.0f;
+            node->reverb.channels.resize(m_channels);
+            for (ma_uint32 ch = 0; ch < m_channels; ch++)
+            {
+                const int spread = (ch % 2) ? s_reverbStereoSpread : 0;
+                ReverbEffect::Channel& channel = node->reverb.channels[ch];
+                for (int c = 0; c < ReverbEffect::CombCount; c++)
+                    channel.combBuffers[c].assign(std::max(1, (int)((s_reverbCombLengths[c] + spread) * scale)), 0.0f);
+                for (int a = 0; a < ReverbEffect::AllpassCount; a++)
+                    channel.allpassBuffers[a].assign(std::max(1, (int)((s_reverbAllpassLengths[a] + spread) * scale)), 0.0f);
+            }
+            node->scratch.resize(s_maxBlockFrames * 2);
+        }
+
+        ApplyParameters(*node, param1, param2);
+        if (IsFilter(effect) && !node->filterInitialized)
+        {
+            std::cout << "Audio Error: Failed to create audio effect filter" << std::endl;
+            return -1;
+        }
+
+        ma_uint32 channels = m_channels;
+        ma_node_config config = ma_node_config_init();
+        config.vtable = IsFilter(effect) ? &s_filterNodeVTable : &s_tailNodeVTable;
+        config.pInputChannels = &channels;
+        config.pOutputChannels = &channels;
+
+        if (ma_node_init(m_graph, &config, nullptr, &node->base) != MA_SUCCESS)
+        {
+            std::cout << "Audio Error: Failed to create audio effect node" << std::endl;
+            return -1;
+        }
+        node->nodeInitialized = true;
+
+        // Connect the new node's output before routing into it, so audio never reaches a dead end
+        ma_node_attach_output_bus(&node->base, 0, m_output, 0);
+        ma_node_attach_output_bus(GetNode(GetCount() - 1), 0, &node->base, 0);
+        m_effects.push_back(std::move(node));
+
+        return GetCount() - 1;
+    }
+
+    void AudioEffectChain::Remove(int index)
+    {
+        if (index < 0 || index >= GetCount())
+            return;
+
+        // Route around the node before destroying it
+        ma_node_attach_output_bus(GetNode(index - 1), 0, index + 1 < GetCount() ? GetNode(index + 1) : m_output, 0);
+        m_effects.erase(m_effects.begin() + index);
+    }
+
+    void AudioEffectChain::Clear()
+    {
+        if (m_effects.empty())
+            return;
+
+        ma_node_attach_output_bus(&m_input, 0, m_output, 0);
+        m_effects.clear();
+    }
+
+    AudioEffect AudioEffectChain::GetType(int index) const
+    {
+        if (index < 0 || index >= GetCount())
+            return AUDIO_EFFECT_NONE;
+
+        return m_effects[index]->type;
+    }
+
+    void AudioEffectChain::SetParameters(int index, float param1, float param2)
+    {
+        if (index < 0 || index >= GetCount())
+            return;
+
+        EffectNode& node = *m_effects[index];
+        node.param1.store(param1, std::memory_order_relaxed);
+        node.param2.store(param2, std::memory_order_relaxed);
+        node.version.fetch_add(1, std::memory_order_release);
+    }
+
+    void AudioEffectChain::SetEnabled(int index, bool enabled)
+    {
+        if (index < 0 || index >= GetCount())
+            return;
+
+        m_effects[index]->enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    ma_node* AudioEffectChain::GetNode(int index)
+    {
+        return index < 0 ? (ma_node*)&m_input : (ma_node*)&m_effects[index]->base;
+    }
+}
@@ -62,7 +62,7 @@ namespace cx
         s_cryonix->initialized = false;
 
         // Create platform window
-        s_cryonix->window = Window::Create();
+        s_cryonix->window = Window::Create(config);
         if (!s_cryonix->window)
         {
             delete s_cryonix;
@@ -125,9 +125,10 @@ namespace cx
         static auto lastTime = std::chrono::steady_clock::now();
         auto now = std::chrono::steady_clock::now();
         float delta = std::chrono::duration<float>(now - lastTime).count();
+        bool fixedStep = s_cryonix->config.fixedTimeStep > 0.0f;
 
-        // Frame rate limiting
-        if (s_cryonix->targetFPS > 0)
+        // Frame rate limiting. A fixed time step runs as fast as possible since time no longer comes from the wall clock.
+        if (s_cryonix->targetFPS > 0 && !fixedStep)
         {
             float targetFrameTime = 1.0f / s_cryonix->targetFPS;
             float sleepThreshold = 0.002f;
@@ -157,9 +158,14 @@ namespace cx
             }
         }
 
-        // Clamp delta to prevent spikes
-        constexpr float MAX_DELTA = 0.1f;
-        s_cryonix->deltaTime = std::min(delta, MAX_DELTA);
+        if (fixedStep)
+            s_cryonix->deltaTime = s_cryonix->config.fixedTimeStep;
+        else
+        {
+            // Clamp delta to prevent spikes
+            constexpr float MAX_DELTA = 0.1f;
+            s_cryonix->deltaTime = std::min(delta, MAX_DELTA);
+        }
 
         // Update timing
         s_cryonix->lastFrameTime = lastTime;
@@ -234,6 +240,7 @@ namespace cx
         //    UnloadAudioStream(*s_audioStreams[i]);
         //s_audioStreams.clear();
 
+        ShutdownJobSystem();
         ShutdownRenderer();
         Input::Shutdown();
 
@@ -426,6 +433,10 @@ namespace cx
         if (!s_cryonix)
             return 0.0;
 
+        // Simulated time keeps fixed time step runs deterministic
+        if (s_cryonix->config.fixedTimeStep > 0.0f)
+            return static_cast<double>(s_cryonix->config.fixedTimeStep) * s_cryonix->frameCount;
+
         auto now = std::chrono::steady_clock::now();
         std::chrono::duration<double> elapsed = now - s_cryonix->startTime;
         return elapsed.count();
@@ -480,6 +491,15 @@ namespace cx
         return s_cryonix ? s_cryonix->window : nullptr;
     }
 
+    HeadlessWindow* GetHeadlessWindow()
+    {
+        // Window::Create() makes a HeadlessWindow for exactly this backend
+        if (!s_cryonix || s_cryonix->config.windowBackend != WindowBackend::Headless)
+            return nullptr;
+
+        return static_cast<HeadlessWindow*>(s_cryonix->window);
+    }
+
     const Config& GetConfig()
     {
         static Config emptyConfig;
@@ -0,0 +1,762 @@
+#include "Image.h"
+#include "JobSystem.h"
+#include <bx/simd_t.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace cx
+{
+    // Passes with fewer output texels than this run on the calling thread, they're not worth the dispatch
+    static constexpr size_t s_parallelTexelThreshold = 128 * 128;
+
+    // Flips and rotations copy texels in square tiles of this size
+    static constexpr int s_remapTileSize = 32;
+
+    // How sharply the Kaiser window falls off
+    static constexpr float s_kaiserAlpha = 4.0f;
+
+    enum class FilterKernel
+    {
+        Point,
+        Box,
+        Triangle,
+        CatmullRom,
+        Lanczos3,
+        Kaiser
+    };
+
+    // The weights for one dimension of a resample. Every output texel reads the same number of source texels,
+    // with the indices already clamped to the edge.
+    struct FilterTaps
+    {
+        int count = 0;
+        std::vector<int> indices; // count per output texel
+        std::vector<float> weights; // count per output texel
+    };
+
+    // An image being filtered, one float per channel. Rows are padded to a multiple of four floats so the SIMD loops never need a scalar tail.
+    struct FloatImage
+    {
+        int width = 0;
+        int height = 0;
+        size_t stride = 0; // Floats per row
+        std::vector<float> data;
+
+        void Allocate(int w, int h, int channels)
+        {
+            width = w;
+            height = h;
+            stride = (size_t(w) * channels + 3) & ~size_t(3);
+            data.assign(stride * h, 0.0f);
+        }
+
+        float* Row(int y) { return data.data() + stride * y; }
+        const float* Row(int y) const { return data.data() + stride * y; }
+    };
+
+    static bool IsSimdAligned(const void* data)
+    {
+        return (reinterpret_cast<uintptr_t>(data) & 15) == 0;
+    }
+
+    static const float* GetSrgbToLinearTable()
+    {
+        static const std::vector<float> table = []()
+        {
+            std::vector<float> values(256);
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = i / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+    // Indexed by linear value * 4095. Fine enough that every 8 bit sRGB value is reachable.
+    static const uint8_t* GetLinearToSrgbTable()
+    {
+        static const std::vector<uint8_t> table = []()
+        {
+            std::vector<uint8_t> values(4096);
+            for (int i = 0; i < 4096; ++i)
+            {
+                const float c = i / 4095.0f;
+                const float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                values[i] = uint8_t(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+            return values;
+        }();
+        return table.data();
+    }
+
+    // Alpha is coverage, not color, so only the color channels of color images are converted to linear
+    static int GetSrgbChannels(int channels, bool isColorTexture)
+    {
+        if (!isColorTexture)
+            return 0;
+
+        return (channels == 2 || channels == 4) ? channels - 1 : channels;
+    }
+
+    static float BesselI0(float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        const float halfX = x * 0.5f;
+        for (int k = 1; k < 32 && term > sum * 1e-7f; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    static float Sinc(float x)
+    {
+        return x == 0.0f ? 1.0f : std::sin(PI * x) / (PI * x);
+    }
+
+    // How far the kernel reaches from the output texel's center, in output texels when downsampling and source texels when upsampling
+    static float GetKernelRadius(FilterKernel kernel)
+    {
+        switch (kernel)
+        {
+        case FilterKernel::Point: return 0.5f;
+        case FilterKernel::Box: return 0.5f;
+        case FilterKernel::Triangle: return 1.0f;
+        case FilterKernel::CatmullRom: return 2.0f;
+        case FilterKernel::Lanczos3: return 3.0f;
+        case FilterKernel::Kaiser: return 2.0f;
+        }
+        return 1.0f;
+    }
+
+    static float EvaluateKernel(FilterKernel kernel, float t)
+    {
+        t = std::fabs(t);
+        switch (kernel)
+        {
+        case FilterKernel::Triangle:
+            return std::max(0.0f, 1.0f - t);
+        case FilterKernel::CatmullRom:
+            if (t < 1.0f)
+                return 1.5f * t * t * t - 2.5f * t * t + 1.0f;
+            if (t < 2.0f)
+                return -0.5f * t * t * t + 2.5f * t * t - 4.0f * t + 2.0f;
+            return 0.0f;
+        case FilterKernel::Lanczos3:
+            return t < 3.0f ? Sinc(t) * Sinc(t / 3.0f) : 0.0f;
+        case FilterKernel::Kaiser:
+        {
+            const float radius = GetKernelRadius(FilterKernel::Kaiser);
+            if (t >= radius)
+                return 0.0f;
+
+            const float ratio = t / radius;
+            return Sinc(t) * BesselI0(s_kaiserAlpha * std::sqrt(1.0f - ratio * ratio)) / BesselI0(s_kaiserAlpha);
+        }
+        default:
+            return t <= 0.5f ? 1.0f : 0.0f;
+        }
+    }
+
+    static FilterTaps BuildFilterTaps(int srcSize, int dstSize, FilterKernel kernel)
+    {
+        const float scale = float(srcSize) / float(dstSize);
+        const float filterScale = std::max(1.0f, scale); // Downsampling widens the kernel so every source texel contributes
+        const float support = GetKernelRadius(kernel) * filterScale; // In source texels
+
+        FilterTaps taps;
+        taps.count = kernel == FilterKernel::Point ? 1 : int(std::ceil(support * 2.0f)) + 1;
+        taps.indices.resize(size_t(dstSize) * taps.count);
+        taps.weights.resize(size_t(dstSize) * taps.count);
+
+        for (int i = 0; i < dstSize; ++i)
+        {
+            const float center = (i + 0.5f) * scale;
+            int* indices = &taps.indices[size_t(i) * taps.count];
+            float* weights = &taps.weights[size_t(i) * taps.count];
+
+            if (kernel == FilterKernel::Point)
+            {
+                indices[0] = std::clamp(int(center), 0, srcSize - 1);
+                weights[0] = 1.0f;
+                continue;
+            }
+
+            const int first = int(std::floor(center - support));
+            float total = 0.0f;
+            for (int k = 0; k < taps.count; ++k)
+            {
+                const int texel = first + k;
+                float weight = 0.0f;
+                if (kernel == FilterKernel::Box)
+                    weight = std::max(0.0f, std::min(texel + 1.0f, center + support) - std::max(float(texel), center - support));
+                else
+                    weight = EvaluateKernel(kernel, (texel + 0.5f - center) / filterScale);
+
+                indices[k] = std::clamp(texel, 0, srcSize - 1);
+                weights[k] = weight;
+                total += weight;
+            }
+
+            for (int k = 0; k < taps.count; ++k)
+                weights[k] = total != 0.0f ? weights[k] / total : 1.0f / taps.count;
+        }
+
+        return taps;
+    }
+
+    static void RunRows(int rows, size_t texels, bool useJobPool, const std::function<void(size_t begin, size_t end)>& func)
+    {
+        if (useJobPool && texels >= s_parallelTexelThreshold)
+            ParallelFor(size_t(rows), 0, func);
+        else
+            func(0, size_t(rows));
+    }
+
+    static size_t GetPaddedRowSize(int width, int channels)
+    {
+        return (size_t(width) * channels + 3) & ~size_t(3);
+    }
+
+    // Filters the rows then the columns. Source rows are fetched as floats through loadRow and output rows handed to storeRow, so 8 bit
+    // images convert a row at a time instead of keeping a float copy. The horizontal pass is SIMD for four channel images, where a texel
+    // is exactly one register, and the vertical pass works on whole rows so it's SIMD for any channel count.
+    static void Resample(int srcWidth, int srcHeight, int dstWidth, int dstHeight, int channels, FilterKernel kernel, bool useJobPool,
+        const std::function<void(int y, float* row)>& loadRow, const std::function<void(int y, const float* row)>& storeRow)
+    {
+        const FilterTaps horizontal = BuildFilterTaps(srcWidth, dstWidth, kernel);
+        const FilterTaps vertical = BuildFilterTaps(srcHeight, dstHeight, kernel);
+
+        FloatImage rows;
+        rows.Allocate(dstWidth, srcHeight, channels);
+
+        RunRows(srcHeight, size_t(dstWidth) * srcHeight, useJobPool, [&](size_t begin, size_t end)
+        {
+            std::vector<float> source(GetPaddedRowSize(srcWidth, channels));
+            const bool simd = channels == 4 && IsSimdAligned(source.data()) && IsSimdAligned(rows.data.data());
+
+            for (size_t y = begin; y < end; ++y)
+            {
+                loadRow(int(y), source.data());
+                const float* in = source.data();
+                float* out = rows.Row(int(y));
+
+                for (int x = 0; x < dstWidth; ++x)
+                {
+                    const int* indices = &horizontal.indices[size_t(x) * horizontal.count];
+                    const float* weights = &horizontal.weights[size_t(x) * horizontal.count];
+
+                    if (simd)
+                    {
+                        using bx::simd128_t;
+                        simd128_t sum = bx::simd_zero<simd128_t>();
+                        for (int k = 0; k < horizontal.count; ++k)
+                            sum = bx::simd_madd(bx::simd_ld<simd128_t>(in + indices[k] * 4), bx::simd_splat<simd128_t>(weights[k]), sum);
+                        bx::simd_st(out + x * 4, sum);
+                        continue;
+                    }
+
+                    for (int c = 0; c < channels; ++c)
+                    {
+                        float sum = 0.0f;
+                        for (int k = 0; k < horizontal.count; ++k)
+                            sum += in[indices[k] * channels + c] * weights[k];
+                        out[x * channels + c] = sum;
+                    }
+                }
+            }
+        });
+
+        RunRows(dstHeight, size_t(dstWidth) * dstHeight, useJobPool, [&](size_t begin, size_t end)
+        {
+            std::vector<float> result(rows.stride);
+            const bool simd = IsSimdAligned(result.data()) && IsSimdAligned(rows.data.data());
+
+            for (size_t y = begin; y < end; ++y)
+            {
+                const int* indices = &vertical.indices[y * vertical.count];
+                const float* weights = &vertical.weights[y * vertical.count];
+                float* out = result.data();
+
+                if (simd)
+                {
+                    using bx::simd128_t;
+                    for (size_t i = 0; i < rows.stride; i += 4)
+                    {
+                        simd128_t sum = bx::simd_zero<simd128_t>();
+                        for (int k = 0; k < vertical.count; ++k)
+                            sum = bx::simd_madd(bx::simd_ld<simd128_t>(rows.Row(indices[k]) + i), bx::simd_splat<simd128_t>(weights[k]), sum);
+                        bx::simd_st(out + i, sum);
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < rows.stride; ++i)
+                    {
+                        float sum = 0.0f;
+                        for (int k = 0; k < vertical.count; ++k)
+                            sum += rows.Row(indices[k])[i] * weights[k];
+                        out[i] = sum;
+                    }
+                }
+
+                storeRow(int(y), out);
+            }
+        });
+    }
+
+    // Filtering shortens normals, and the Kaiser filter's negative lobes can push them past unit length. Works on the 0 to 1 encoding.
+    static void RenormalizeRow(float* row, int width, int channels)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            float* texel = row + x * channels;
+            const float nx = texel[0] * 2.0f - 1.0f;
+            const float ny = texel[1] * 2.0f - 1.0f;
+            const float nz = texel[2] * 2.0f - 1.0f;
+            const float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+            if (length < 1e-6f)
+            {
+                texel[0] = 0.5f;
+                texel[1] = 0.5f;
+                texel[2] = 1.0f;
+                continue;
+            }
+
+            const float scale = 0.5f / length;
+            texel[0] = nx * scale + 0.5f;
+            texel[1] = ny * scale + 0.5f;
+            texel[2] = nz * scale + 0.5f;
+        }
+    }
+
+    static const float* GetUnormToFloatTable()
+    {
+        static const std::vector<float> table = []()
+        {
+            std::vector<float> values(256);
+            for (int i = 0; i < 256; ++i)
+                values[i] = i / 255.0f;
+            return values;
+        }();
+        return table.data();
+    }
+
+    // Converts between 8 bit rows and float rows. One table per channel keeps the color space branch out of the loops.
+    struct RowConverter
+    {
+        int channels = 4;
+        const float* toFloat[4] = {};
+        bool toSrgb[4] = {};
+
+        RowConverter(int channels, int srgbChannels)
+            : channels(channels)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                toFloat[c] = c < srgbChannels ? GetSrgbToLinearTable() : GetUnormToFloatTable();
+                toSrgb[c] = c < srgbChannels;
+            }
+        }
+
+        void Load(const uint8_t* in, int width, float* out) const
+        {
+            for (int i = 0; i < width * channels; i += channels)
+            {
+                for (int c = 0; c < channels; ++c)
+                    out[i + c] = toFloat[c][in[i + c]];
+            }
+        }
+
+        void Store(const float* in, int width, uint8_t* out) const
+        {
+            const uint8_t* linearToSrgb = GetLinearToSrgbTable();
+            for (int i = 0; i < width * channels; i += channels)
+            {
+                for (int c = 0; c < channels; ++c)
+                {
+                    const float value = std::clamp(in[i + c], 0.0f, 1.0f);
+                    out[i + c] = toSrgb[c] ? linearToSrgb[int(value * 4095.0f + 0.5f)] : uint8_t(value * 255.0f + 0.5f);
+                }
+            }
+        }
+    };
+
+    int GetMipCount(int width, int height)
+    {
+        int count = 1;
+        while (width > 1 || height > 1)
+        {
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+            ++count;
+        }
+        return count;
+    }
+
+    std::vector<uint8_t> GenerateMipChain(const uint8_t* pixels, int width, int height, int channels, bool isColorTexture, const MipGenerationOptions& options)
+    {
+        if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+            return {};
+
+        // Normal maps are data even when flagged as color
+        const int srgbChannels = GetSrgbChannels(channels, isColorTexture && !options.isNormalMap);
+        const bool renormalize = options.isNormalMap && channels >= 3;
+        const FilterKernel kernel = options.filter == MipFilter::Kaiser ? FilterKernel::Kaiser : FilterKernel::Box;
+
+        size_t totalSize = 0;
+        for (int level = 0, w = width, h = height; level < GetMipCount(width, height); ++level, w = std::max(1, w / 2), h = std::max(1, h / 2))
+            totalSize += size_t(w) * h * channels;
+
+        std::vector<uint8_t> chain(totalSize);
+        const size_t baseSize = size_t(width) * height * channels;
+        std::copy(pixels, pixels + baseSize, chain.begin());
+
+        const RowConverter converter(channels, srgbChannels);
+
+        // Each level is filtered from the previous one, kept in float so rounding doesn't build up down the chain. Level 0 is converted as it's read.
+        size_t offset = baseSize;
+        FloatImage current;
+        FloatImage next;
+        int levelWidth = width;
+        int levelHeight = height;
+        while (levelWidth > 1 || levelHeight > 1)
+        {
+            const int nextWidth = std::max(1, levelWidth / 2);
+            const int nextHeight = std::max(1, levelHeight / 2);
+            next.Allocate(nextWidth, nextHeight, channels);
+            uint8_t* level = chain.data() + offset;
+
+            const bool fromBase = current.data.empty();
+            Resample(levelWidth, levelHeight, nextWidth, nextHeight, channels, kernel, options.useJobPool,
+                [&](int y, float* row)
+                {
+                    if (fromBase)
+                        converter.Load(pixels + size_t(y) * width * channels, width, row);
+                    else
+                        std::copy_n(current.Row(y), size_t(levelWidth) * channels, row);
+                },
+                [&](int y, const float* row)
+                {
+                    float* out = next.Row(y);
+                    std::copy_n(row, size_t(nextWidth) * channels, out);
+                    if (renormalize)
+                        RenormalizeRow(out, nextWidth, channels);
+                    converter.Store(out, nextWidth, level + size_t(y) * nextWidth * channels);
+                });
+
+            offset += size_t(nextWidth) * nextHeight * channels;
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+            std::swap(current, next);
+        }
+
+        return chain;
+    }
+
+    std::vector<uint8_t> ResizeImage(const uint8_t* pixels, int width, int height, int channels, int newWidth, int newHeight, ResizeFilter filter, bool isColorTexture)
+    {
+        if (!pixels || width <= 0 || height <= 0 || newWidth <= 0 || newHeight <= 0 || channels < 1 || channels > 4)
+            return {};
+
+        std::vector<uint8_t> resized(size_t(newWidth) * newHeight * channels);
+
+        // Point sampling copies texels, so it skips the float conversion
+        if (filter == ResizeFilter::Nearest)
+        {
+            const FilterTaps columns = BuildFilterTaps(width, newWidth, FilterKernel::Point);
+            const FilterTaps rows = BuildFilterTaps(height, newHeight, FilterKernel::Point);
+
+            RunRows(newHeight, size_t(newWidth) * newHeight, true, [&](size_t begin, size_t end)
+            {
+                for (size_t y = begin; y < end; ++y)
+                {
+                    const uint8_t* in = pixels + size_t(rows.indices[y]) * width * channels;
+                    uint8_t* out = resized.data() + y * newWidth * channels;
+                    for (int x = 0; x < newWidth; ++x)
+                        std::copy_n(in + columns.indices[x] * channels, channels, out + x * channels);
+                }
+            });
+            return resized;
+        }
+
+        FilterKernel kernel = FilterKernel::Triangle;
+        if (filter == ResizeFilter::Bicubic)
+            kernel = FilterKernel::CatmullRom;
+        else if (filter == ResizeFilter::Lanczos)
+            kernel = FilterKernel::Lanczos3;
+
+        const RowConverter converter(channels, GetSrgbChannels(channels, isColorTexture));
+        Resample(width, height, newWidth, newHeight, channels, kernel, true,
+            [&](int y, float* row) { converter.Load(pixels + size_t(y) * width * channels, width, row); },
+            [&](int y, const float* row) { converter.Store(row, newWidth, resized.data() + size_t(y) * newWidth * channels); });
+        return resized;
+    }
+
+    ImageOperations& ImageOperations::Resize(int width, int height, ResizeFilter filter)
+    {
+        // Later flips and rotations are applied after the resample, so the size is kept in the source's orientation
+        m_resize = true;
+        m_resizeWidth = SwapsAxes() ? height : width;
+        m_resizeHeight = SwapsAxes() ? width : height;
+        m_resizeFilter = filter;
+        return *this;
+    }
+
+    void ImageOperations::Orient(int xx, int xy, int yx, int yy)
+    {
+        const int* m = m_orientation;
+        const int result[4] = { m[0] * xx + m[1] * yx, m[0] * xy + m[1] * yy, m[2] * xx + m[3] * yx, m[2] * xy + m[3] * yy };
+        std::copy_n(result, 4, m_orientation);
+    }
+
+    ImageOperations& ImageOperations::FlipVertical()
+    {
+        Orient(1, 0, 0, -1);
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::FlipHorizontal()
+    {
+        Orient(-1, 0, 0, 1);
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::Rotate90(bool clockwise)
+    {
+        if (clockwise)
+            Orient(0, 1, -1, 0);
+        else
+            Orient(0, -1, 1, 0);
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::Grayscale()
+    {
+        m_colorOps.emplace_back(ColorOp::Grayscale, Color());
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::Invert()
+    {
+        m_colorOps.emplace_back(ColorOp::Invert, Color());
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::Tint(const Color& color)
+    {
+        m_colorOps.emplace_back(ColorOp::Tint, color);
+        return *this;
+    }
+
+    ImageOperations& ImageOperations::Then(const ImageOperations& next)
+    {
+        // next's resize size is in its source's orientation, which is this chain's output
+        if (next.m_resize)
+            Resize(next.m_resizeWidth, next.m_resizeHeight, next.m_resizeFilter);
+
+        Orient(next.m_orientation[0], next.m_orientation[1], next.m_orientation[2], next.m_orientation[3]);
+        m_colorOps.insert(m_colorOps.end(), next.m_colorOps.begin(), next.m_colorOps.end());
+        return *this;
+    }
+
+    // The color edits folded into one affine transform of the color channels, in 0 to 255 units
+    struct ColorTransform
+    {
+        alignas(16) float columns[3][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 } }; // columns[input][output]
+        alignas(16) float offset[4] = {};
+        int colorChannels = 0;
+        bool isIdentity = true;
+        bool isDiagonal = true; // No channel reads another, so a lookup table per channel covers it
+        uint8_t lookup[3][256] = {};
+
+        void Multiply(const float matrix[3][3], const float add[3])
+        {
+            float newColumns[3][4] = {};
+            float newOffset[4] = {};
+            for (int out = 0; out < 3; ++out)
+            {
+                for (int in = 0; in < 3; ++in)
+                {
+                    for (int k = 0; k < 3; ++k)
+                        newColumns[in][out] += matrix[out][k] * columns[in][k];
+                    newOffset[out] += matrix[out][in] * offset[in];
+                }
+                newOffset[out] += add[out];
+            }
+
+            std::copy_n(&newColumns[0][0], 12, &columns[0][0]);
+            std::copy_n(newOffset, 4, offset);
+            isIdentity = false;
+        }
+
+        void Finish()
+        {
+            for (int in = 0; in < 3; ++in)
+            {
+                for (int out = 0; out < 3; ++out)
+                {
+                    if (in != out && columns[in][out] != 0.0f)
+                        isDiagonal = false;
+                }
+            }
+
+            if (!isDiagonal)
+                return;
+
+            for (int c = 0; c < colorChannels; ++c)
+            {
+                for (int value = 0; value < 256; ++value)
+                    lookup[c][value] = uint8_t(std::clamp(columns[c][c] * value + offset[c] + 0.5f, 0.0f, 255.0f));
+            }
+        }
+
+        void Apply(uint8_t* texel) const
+        {
+            if (isDiagonal)
+            {
+                for (int c = 0; c < colorChannels; ++c)
+                    texel[c] = lookup[c][texel[c]];
+                return;
+            }
+
+            // Only reached with three or more channels, grayscale and tint skip smaller images
+            using bx::simd128_t;
+            simd128_t result = bx::simd_ld<simd128_t>(offset);
+            result = bx::simd_madd(bx::simd_splat<simd128_t>(float(texel[0])), bx::simd_ld<simd128_t>(columns[0]), result);
+            result = bx::simd_madd(bx::simd_splat<simd128_t>(float(texel[1])), bx::simd_ld<simd128_t>(columns[1]), result);
+            result = bx::simd_madd(bx::simd_splat<simd128_t>(float(texel[2])), bx::simd_ld<simd128_t>(columns[2]), result);
+            result = bx::simd_min(bx::simd_max(bx::simd_add(result, bx::simd_splat<simd128_t>(0.5f)), bx::simd_zero<simd128_t>()), bx::simd_splat<simd128_t>(255.0f));
+
+            alignas(16) float values[4];
+            bx::simd_st(values, result);
+            texel[0] = uint8_t(values[0]);
+            texel[1] = uint8_t(values[1]);
+            texel[2] = uint8_t(values[2]);
+        }
+    };
+
+    bool ImageOperations::Apply(std::vector<uint8_t>& pixels, int& width, int& height, int channels, bool isColorTexture) const
+    {
+        if (width <= 0 || height <= 0 || channels < 1 || channels > 4 || pixels.size() < size_t(width) * height * channels)
+            return false;
+
+        std::vector<uint8_t> working;
+        int sourceWidth = width;
+        int sourceHeight = height;
+        if (m_resize && (m_resizeWidth != width || m_resizeHeight != height))
+        {
+            working = ResizeImage(pixels.data(), width, height, channels, m_resizeWidth, m_resizeHeight, m_resizeFilter, isColorTexture);
+            if (working.empty())
+                return false;
+
+            sourceWidth = m_resizeWidth;
+            sourceHeight = m_resizeHeight;
+        }
+        else
+            working.swap(pixels);
+
+        ColorTransform color;
+        color.colorChannels = (channels == 2 || channels == 4) ? channels - 1 : channels; // Alpha is left alone
+        for (const auto& [op, tint] : m_colorOps)
+        {
+            if (op == ColorOp::Invert)
+            {
+                const float matrix[3][3] = { { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, -1 } };
+                const float add[3] = { 255, 255, 255 };
+                color.Multiply(matrix, add);
+            }
+            else if (channels >= 3 && op == ColorOp::Grayscale)
+            {
+                const float matrix[3][3] = { { 0.299f, 0.587f, 0.114f }, { 0.299f, 0.587f, 0.114f }, { 0.299f, 0.587f, 0.114f } };
+                const float add[3] = {};
+                color.Multiply(matrix, add);
+            }
+            else if (channels >= 3 && op == ColorOp::Tint)
+            {
+                const float matrix[3][3] = { { tint.r / 255.0f, 0, 0 }, { 0, tint.g / 255.0f, 0 }, { 0, 0, tint.b / 255.0f } };
+                const float add[3] = {};
+                color.Multiply(matrix, add);
+            }
+        }
+        color.Finish();
+
+        const size_t texels = size_t(sourceWidth) * sourceHeight;
+        if (IsIdentityOrientation())
+        {
+            // Texels stay where they are, so the color pass runs in place
+            if (!color.isIdentity)
+            {
+                RunRows(sourceHeight, texels, true, [&](size_t begin, size_t end)
+                {
+                    uint8_t* texel = working.data() + begin * sourceWidth * channels;
+                    for (size_t i = begin * sourceWidth; i < end * sourceWidth; ++i, texel += channels)
+                        color.Apply(texel);
+                });
+            }
+
+            pixels.swap(working);
+            width = sourceWidth;
+            height = sourceHeight;
+            return true;
+        }
+
+        // One remap pass. Stepping one texel right in the output steps (m[0], m[2]) in the source, one row down steps (m[1], m[3]).
+        const int* m = m_orientation;
+        const int outWidth = SwapsAxes() ? sourceHeight : sourceWidth;
+        const int outHeight = SwapsAxes() ? sourceWidth : sourceHeight;
+        const int originX = (m[0] < 0 || m[1] < 0) ? sourceWidth - 1 : 0;
+        const int originY = (m[2] < 0 || m[3] < 0) ? sourceHeight - 1 : 0;
+
+        // Rotations read the source down its columns, so the output is walked in tiles that keep the reads within a few cache lines
+        const int bands = (outHeight + s_remapTileSize - 1) / s_remapTileSize;
+        std::vector<uint8_t> oriented(texels * channels);
+        RunRows(bands, texels, true, [&](size_t begin, size_t end)
+        {
+            const int firstRow = int(begin) * s_remapTileSize;
+            const int lastRow = std::min(outHeight, int(end) * s_remapTileSize);
+
+            for (int tileX = 0; tileX < outWidth; tileX += s_remapTileSize)
+            {
+                const int tileEnd = std::min(outWidth, tileX + s_remapTileSize);
+                for (int y = firstRow; y < lastRow; ++y)
+                {
+                    const uint8_t* in = working.data() + (size_t(originY + m[3] * y + m[2] * tileX) * sourceWidth + originX + m[1] * y + m[0] * tileX) * channels;
+                    const ptrdiff_t step = (ptrdiff_t(m[2]) * sourceWidth + m[0]) * channels;
+                    uint8_t* out = oriented.data() + (size_t(y) * outWidth + tileX) * channels;
+
+                    if (channels == 4)
+                    {
+                        for (int x = tileX; x < tileEnd; ++x, in += step, out += 4)
+                            std::memcpy(out, in, 4);
+                    }
+                    else
+                    {
+                        for (int x = tileX; x < tileEnd; ++x, in += step, out += channels)
+                            std::copy_n(in, channels, out);
+                    }
+                }
+            }
+
+            if (color.isIdentity)
+                return;
+
+            uint8_t* texel = oriented.data() + size_t(firstRow) * outWidth * channels;
+            for (size_t i = size_t(firstRow) * outWidth; i < size_t(lastRow) * outWidth; ++i, texel += channels)
+                color.Apply(texel);
+        });
+
+        pixels.swap(oriented);
+        width = outWidth;
+        height = outHeight;
+        return true;
+    }
+}
@@ -0,0 +1,233 @@
+#include "JobSystem.h"
+#include "Cryonix.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cx
+{
+    struct Job
+    {
+        const std::function<void(size_t, size_t)>* func = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        std::atomic<size_t>* remaining = nullptr;
+    };
+
+    // The owning thread takes jobs from the back of its queue, other threads steal from the front
+    struct JobQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    struct JobSystemState
+    {
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<JobQueue>> queues; // One per worker, plus a last one shared by all other threads
+        std::atomic<size_t> queuedJobs{ 0 };
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        bool running = false; // Guarded by wakeMutex
+        std::deque<std::function<void()>> asyncJobs; // Guarded by wakeMutex. Only workers run these.
+    };
+
+    static JobSystemState s_jobSystem;
+    static std::mutex s_jobSystemStartMutex;
+    static std::atomic<bool> s_jobSystemStarted{ false };
+    static thread_local int t_jobQueueIndex = -1;
+
+    static bool PopJob(size_t queueIndex, Job& job)
+    {
+        JobQueue& queue = *s_jobSystem.queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        s_jobSystem.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    static bool StealJob(size_t thiefIndex, Job& job)
+    {
+        const size_t queueCount = s_jobSystem.queues.size();
+        for (size_t offset = 1; offset < queueCount; ++offset)
+        {
+            JobQueue& queue = *s_jobSystem.queues[(thiefIndex + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty())
+                continue;
+
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            s_jobSystem.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    static void RunJob(const Job& job)
+    {
+        (*job.func)(job.begin, job.end);
+        job.remaining->fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    static void WorkerMain(size_t queueIndex)
+    {
+        t_jobQueueIndex = static_cast<int>(queueIndex);
+
+        while (true)
+        {
+            Job job;
+            if (PopJob(queueIndex, job) || StealJob(queueIndex, job))
+            {
+                RunJob(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(s_jobSystem.wakeMutex);
+            s_jobSystem.wakeCondition.wait(lock, [] { return !s_jobSystem.running || s_jobSystem.queuedJobs.load(std::memory_order_relaxed) > 0 || !s_jobSystem.asyncJobs.empty(); });
+
+            if (!s_jobSystem.running)
+                return;
+
+            // Parallel ranges come first since a thread is waiting on them
+            if (s_jobSystem.queuedJobs.load(std::memory_order_relaxed) == 0 && !s_jobSystem.asyncJobs.empty())
+            {
+                std::function<void()> asyncJob = std::move(s_jobSystem.asyncJobs.front());
+                s_jobSystem.asyncJobs.pop_front();
+                lock.unlock();
+                asyncJob();
+            }
+        }
+    }
+
+    static void StartJobSystem()
+    {
+        if (s_jobSystemStarted.load(std::memory_order_acquire))
+            return;
+
+        std::lock_guard<std::mutex> lock(s_jobSystemStartMutex);
+        if (s_jobSystemStarted.load(std::memory_order_relaxed))
+            return;
+
+        int coreCount = GetCPUCoreCount();
+        size_t workerCount = coreCount > 1 ? static_cast<size_t>(coreCount - 1) : 0;
+
+        s_jobSystem.queues.clear();
+        for (size_t i = 0; i <= workerCount; ++i)
+            s_jobSystem.queues.push_back(std::make_unique<JobQueue>());
+
+        {
+            std::lock_guard<std::mutex> wakeLock(s_jobSystem.wakeMutex);
+            s_jobSystem.running = true;
+        }
+
+        for (size_t i = 0; i < workerCount; ++i)
+            s_jobSystem.workers.emplace_back(WorkerMain, i);
+
+        s_jobSystemStarted.store(true, std::memory_order_release);
+    }
+
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& func)
+    {
+        if (count == 0)
+            return;
+
+        StartJobSystem();
+
+        const size_t workerCount = s_jobSystem.workers.size();
+        if (grainSize == 0)
+            grainSize = std::max<size_t>(1, count / ((workerCount + 1) * 4));
+
+        if (workerCount == 0 || count <= grainSize)
+        {
+            func(0, count);
+            return;
+        }
+
+        const size_t jobCount = (count + grainSize - 1) / grainSize;
+        std::atomic<size_t> remaining(jobCount);
+
+        const size_t queueIndex = t_jobQueueIndex >= 0 ? static_cast<size_t>(t_jobQueueIndex) : workerCount;
+        {
+            JobQueue& queue = *s_jobSystem.queues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (size_t begin = 0; begin < count; begin += grainSize)
+                queue.jobs.push_back({ &func, begin, std::min(begin + grainSize, count), &remaining });
+        }
+
+        s_jobSystem.queuedJobs.fetch_add(jobCount, std::memory_order_relaxed);
+        {
+            // Taking the lock orders the push against a worker that is about to wait
+            std::lock_guard<std::mutex> wakeLock(s_jobSystem.wakeMutex);
+        }
+        s_jobSystem.wakeCondition.notify_all();
+
+        // Help out until every range of this call is done. This may run jobs from other calls, which never block on this one.
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            Job job;
+            if (PopJob(queueIndex, job) || StealJob(queueIndex, job))
+                RunJob(job);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void RunJobAsync(std::function<void()> func)
+    {
+        if (!func)
+            return;
+
+        StartJobSystem();
+
+        if (s_jobSystem.workers.empty())
+        {
+            func();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> wakeLock(s_jobSystem.wakeMutex);
+            s_jobSystem.asyncJobs.push_back(std::move(func));
+        }
+        s_jobSystem.wakeCondition.notify_one();
+    }
+
+    int GetJobWorkerCount()
+    {
+        StartJobSystem();
+        return static_cast<int>(s_jobSystem.workers.size());
+    }
+
+    void ShutdownJobSystem()
+    {
+        std::lock_guard<std::mutex> lock(s_jobSystemStartMutex);
+        if (!s_jobSystemStarted.load(std::memory_order_relaxed))
+            return;
+
+        {
+            std::lock_guard<std::mutex> wakeLock(s_jobSystem.wakeMutex);
+            s_jobSystem.running = false;
+            s_jobSystem.asyncJobs.clear();
+        }
+        s_jobSystem.wakeCondition.notify_all();
+
+        for (std::thread& worker : s_jobSystem.workers)
+            worker.join();
+
+        s_jobSystem.workers.clear();
+        s_jobSystem.queues.clear();
+        s_jobSystem.queuedJobs.store(0, std::memory_order_relaxed);
+        s_jobSystemStarted.store(false, std::memory_order_release);
+    }
+}
@@ -9,7 +9,15 @@ namespace cx
 {
     void Material::SetShader(Shader* shader)
     {
+        // Uniform handles belong to the shader
+        if (m_shader != shader)
+        {
+            m_uniformHandlesCached = false;
+            m_ShaderParams.ResetHandles();
+        }
+
         m_shader = shader;
+        MarkChanged();
     }
 
     Shader* Material::GetShader() const
@@ -21,6 +29,7 @@ namespace cx
     void Material::SetMaterialMap(MaterialMapType type, Texture* texture)
     {
         m_materialMaps[static_cast<size_t>(type)] = texture;
+        MarkChanged();
     }
 
     Texture* Material::GetMaterialMap(MaterialMapType type) const
@@ -36,37 +45,44 @@ namespace cx
     void Material::RemoveMaterialMap(MaterialMapType type)
     {
         m_materialMaps[static_cast<size_t>(type)] = nullptr;
+        MarkChanged();
     }
 
     void Material::ClearMaterialMaps()
     {
         m_materialMaps.fill(nullptr);
+        MarkChanged();
     }
 
     // PBR Properties
     void Material::SetAlbedo(const Color& color)
     {
         m_albedo = color;
+        MarkChanged();
     }
 
     void Material::SetMetallic(float value)
     {
         m_metallic = std::clamp(value, 0.0f, 1.0f);
+        MarkChanged();
     }
 
     void Material::SetRoughness(float value)
     {
         m_roughness = std::clamp(value, 0.0f, 1.0f);
+        MarkChanged();
     }
 
     void Material::SetEmissive(const Color& color)
     {
         m_emissive = color;
+        MarkChanged();
     }
 
     void Material::SetAO(float value)
     {
         m_ao = std::clamp(value, 0.0f, 1.0f);
+        MarkChanged();
     }
 
     // User parameters
@@ -99,207 +115,190 @@ namespace cx
     }
 
     // Shader parameters
-    void Material::SetShaderParam(std::string_view name, const float v)
+    void Material::SetShaderParam(UniformId id, const float v)
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Vec4, v });
+        if (m_ShaderParams.Set(id, UniformType::Vec4, v))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, const int v)
+    void Material::SetShaderParam(UniformId id, const int v)
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Vec4, v });
+        if (m_ShaderParams.Set(id, UniformType::Vec4, v))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, const float(&v2)[2])
+    void Material::SetShaderParam(UniformId id, const float(&v2)[2])
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Vec4, std::array<float, 2>{ v2[0], v2[1] } });
+        if (m_ShaderParams.Set(id, UniformType::Vec4, std::array<float, 2>{ v2[0], v2[1] }))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, const float(&v3)[3])
+    void Material::SetShaderParam(UniformId id, const float(&v3)[3])
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Vec4, std::array<float, 3>{ v3[0], v3[1], v3[2] } });
+        if (m_ShaderParams.Set(id, UniformType::Vec4, std::array<float, 3>{ v3[0], v3[1], v3[2] }))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, const float(&v4)[4])
+    void Material::SetShaderParam(UniformId id, const float(&v4)[4])
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Vec4, std::array<float, 4>{ v4[0], v4[1], v4[2], v4[3] } });
+        if (m_ShaderParams.Set(id, UniformType::Vec4, std::array<float, 4>{ v4[0], v4[1], v4[2], v4[3] }))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, const float(&m4)[16])
+    void Material::SetShaderParam(UniformId id, const float(&m4)[16])
     {
         std::array<float, 16> arr;
         std::copy(std::begin(m4), std::end(m4), arr.begin());
-        m_ShaderParams.push_back({ name.data(), UniformType::Mat4, arr });
+
+        if (m_ShaderParams.Set(id, UniformType::Mat4, arr))
+            MarkChanged();
+    }
+
+    void Material::SetShaderParam(UniformId id, Texture* texture)
+    {
+        if (m_ShaderParams.Set(id, UniformType::Sampler, texture))
+            MarkChanged();
     }
 
-    void Material::SetShaderParam(std::string_view name, Texture* texture)
+    void Material::RemoveShaderParam(UniformId id)
     {
-        m_ShaderParams.push_back({ name.data(), UniformType::Sampler, texture });
+        if (m_ShaderParams.Remove(id))
+            MarkChanged();
     }
 
     void Material::ApplyShaderUniforms()
     {
-        for (ShaderUniform& param : m_ShaderParams)
+        if (m_shader)
+            m_shader->ApplyUniformTable(m_ShaderParams);
+    }
+
+    static constexpr UniformId s_materialBlockId("u_MaterialBlock");
+
+    static constexpr UniformId s_blockUniformIds[Material::MaterialBlockSize] = {
+        UniformId("u_MaterialFlags0"), UniformId("u_MaterialFlags1"), UniformId("u_Albedo"), UniformId("u_EmissiveParams"), UniformId("u_MaterialProps")
+    };
+
+    // Indexed by MaterialMapType
+    static constexpr UniformId s_samplerIds[static_cast<size_t>(MaterialMapType::Count)] = {
+        UniformId("u_AlbedoMap"), UniformId("u_NormalMap"), UniformId("u_MetallicMap"), UniformId("u_RoughnessMap"), UniformId("u_AOMap"),
+        UniformId("u_EmissiveMap"), UniformId("u_HeightMap"), UniformId("u_MetallicRoughnessMap"), UniformId("u_OpacityMap")
+    };
+
+    void Material::CacheUniformHandles()
+    {
+        m_hMaterialBlock = BGFX_INVALID_HANDLE;
+        m_hBlockUniforms.fill(BGFX_INVALID_HANDLE);
+
+        if (m_shader->UsesPackedMaterialBlock())
+            m_hMaterialBlock = m_shader->GetOrCreateUniform(s_materialBlockId, UniformType::Vec4, MaterialBlockSize);
+        else
         {
-            std::visit([this, &param](auto&& arg)
-            {
-                using T = std::decay_t<decltype(arg)>;
-
-                if (!bgfx::isValid(param.cachedUniform))
-                {
-                    if constexpr (std::is_same_v<T, Texture*>)
-                    {
-                        param.cachedUniform = m_shader->GetOrCreateSamplerUniform(param.name);
-                        param.cachedStage = m_shader->GetSamplerStage(param.name);
-                    }
-                    else
-                    {
-                        UniformType utype;
-
-                        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int> || std::is_same_v<T, std::array<float, 2>> || std::is_same_v<T, std::array<float, 3>> || std::is_same_v<T, std::array<float, 4>>)
-                            utype = UniformType::Vec4;
-                        else if constexpr (std::is_same_v<T, std::array<float, 16>>)
-                            utype = UniformType::Mat4;
-
-                        param.cachedUniform = m_shader->GetOrCreateUniform(param.name, utype, 1);
-                    }
-                }
-
-                if constexpr (std::is_same_v<T, Texture*>)
-                {
-                    if (arg && bgfx::isValid(param.cachedUniform) && param.cachedStage != 255)
-                    {
-                        bgfx::TextureHandle handle = arg->GetHandle();
-                        if (bgfx::isValid(handle))
-                            bgfx::setTexture(param.cachedStage, param.cachedUniform, handle);
-                    }
-                }
-                else if (bgfx::isValid(param.cachedUniform))
-                {
-                    if constexpr (std::is_same_v<T, float>)
-                    {
-                        float tmp[4] = { arg, 0.0f, 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, int>)
-                    {
-                        float tmp[4] = { static_cast<float>(arg), 0.0f, 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 2>>)
-                    {
-                        float tmp[4] = { arg[0], arg[1], 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 3>>)
-                    {
-                        float tmp[4] = { arg[0], arg[1], arg[2], 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 4>> || std::is_same_v<T, std::array<float, 16>>)
-                        bgfx::setUniform(param.cachedUniform, arg.data());
-                }
-            }, param.value);
+            for (size_t i = 0; i < MaterialBlockSize; ++i)
+                m_hBlockUniforms[i] = m_shader->GetOrCreateUniform(s_blockUniformIds[i], UniformType::Vec4, 1);
         }
+
+        // Samplers are created when the material first has that map
+        m_hSamplers.fill(BGFX_INVALID_HANDLE);
+        m_samplerStages.fill(255);
+        m_uniformHandlesCached = true;
     }
 
-    void Material::ApplyPBRUniforms()
+    void Material::BakeUniforms()
     {
-        if (!m_shader)
-            return;
+        if (!m_uniformHandlesCached)
+            CacheUniformHandles();
+
+        auto hasMap = [this](MaterialMapType type) { return HasMaterialMap(type) ? 1.0f : 0.0f; };
+
+        float (&block)[MaterialBlockSize][4] = m_uniformBlock;
+        block[MaterialFlags0][0] = hasMap(MaterialMapType::Albedo);
+        block[MaterialFlags0][1] = hasMap(MaterialMapType::Normal);
+        block[MaterialFlags0][2] = hasMap(MaterialMapType::Metallic);
+        block[MaterialFlags0][3] = hasMap(MaterialMapType::Roughness);
+
+        block[MaterialFlags1][0] = hasMap(MaterialMapType::MetallicRoughness);
+        block[MaterialFlags1][1] = hasMap(MaterialMapType::AO);
+        block[MaterialFlags1][2] = hasMap(MaterialMapType::Emissive);
+        block[MaterialFlags1][3] = hasMap(MaterialMapType::Opacity);
+
+        block[AlbedoColor][0] = m_albedo.r / 255.0f;
+        block[AlbedoColor][1] = m_albedo.g / 255.0f;
+        block[AlbedoColor][2] = m_albedo.b / 255.0f;
+        block[AlbedoColor][3] = m_albedo.a / 255.0f;
+
+        block[EmissiveParams][0] = m_emissive.r / 255.0f;
+        block[EmissiveParams][1] = m_emissive.g / 255.0f;
+        block[EmissiveParams][2] = m_emissive.b / 255.0f;
+        block[EmissiveParams][3] = 0.0f;
+
+        block[MaterialProps][0] = m_metallic;
+        block[MaterialProps][1] = m_roughness;
+        block[MaterialProps][2] = m_ao;
+        block[MaterialProps][3] = 0.0f;
+
+        // Only the maps the material has are bound
+        m_bakedMapCount = 0;
+        for (size_t i = 0; i < m_materialMaps.size(); ++i)
+        {
+            Texture* texture = m_materialMaps[i];
+            if (!texture)
+                continue;
 
-        // We're not using SetUniformInternal() here because unordered_map lookups can get expensive when doing it tens of thousands of times each frame.
-        // Todo: "u_MaterialFlags2" is set currently being set as a SetShaderParam() which should be changed.
+            if (!bgfx::isValid(m_hSamplers[i]))
+            {
+                m_hSamplers[i] = m_shader->GetOrCreateSamplerUniform(s_samplerIds[i]);
+                m_samplerStages[i] = m_shader->GetSamplerStage(s_samplerIds[i]);
+            }
 
-        // Todo: This map code needs to be optimized
+            if (bgfx::isValid(m_hSamplers[i]) && m_samplerStages[i] != 255)
+                m_bakedMaps[m_bakedMapCount++] = { m_samplerStages[i], m_hSamplers[i], texture, texture->GetHandle() };
+        }
 
-        // Build material flags as vec4 uniforms to match shader expectations
-        float flags0[4] = {
-            HasMaterialMap(MaterialMapType::Albedo) ? 1.0f : 0.0f,     // x = hasAlbedo
-            HasMaterialMap(MaterialMapType::Normal) ? 1.0f : 0.0f,     // y = hasNormal
-            HasMaterialMap(MaterialMapType::Metallic) ? 1.0f : 0.0f,   // z = hasMetallic
-            HasMaterialMap(MaterialMapType::Roughness) ? 1.0f : 0.0f   // w = hasRoughness
-        };
+        m_bakedVersion = m_version;
+    }
 
-        if (!bgfx::isValid(m_hMaterialFlags0))
-            m_hMaterialFlags0 = m_shader->GetOrCreateUniform("u_MaterialFlags0", UniformType::Vec4, 1);
+    uint32_t Material::GetVersion()
+    {
+        // Textures can be reloaded under the same Texture object, both material maps and textures set with SetShaderParam()
+        for (size_t i = 0; i < m_bakedMapCount; ++i)
+        {
+            if (m_bakedMaps[i].texture->GetHandle().idx != m_bakedMaps[i].handle.idx)
+            {
+                MarkChanged();
+                return m_version;
+            }
+        }
 
-        if (bgfx::isValid(m_hMaterialFlags0))
-            bgfx::setUniform(m_hMaterialFlags0, flags0);
+        if (m_ShaderParams.HasChangedTextures())
+            MarkChanged();
 
-        float flags1[4] = {
-            HasMaterialMap(MaterialMapType::MetallicRoughness) ? 1.0f : 0.0f, // x = hasMetallicRoughness
-            HasMaterialMap(MaterialMapType::AO) ? 1.0f : 0.0f,                // y = hasAO
-            HasMaterialMap(MaterialMapType::Emissive) ? 1.0f : 0.0f,          // z = hasEmissive
-            HasMaterialMap(MaterialMapType::Opacity) ? 1.0f : 0.0f            // w = hasOpacity
-        };
+        return m_version;
+    }
 
-        if (!bgfx::isValid(m_hMaterialFlags1))
-            m_hMaterialFlags1 = m_shader->GetOrCreateUniform("u_MaterialFlags1", UniformType::Vec4, 1);
+    void Material::ApplyPBRUniforms()
+    {
+        if (!m_shader)
+            return;
 
-        if (bgfx::isValid(m_hMaterialFlags1))
-            bgfx::setUniform(m_hMaterialFlags1, flags1);
+        if (m_bakedVersion != m_version)
+            BakeUniforms();
 
-        // Texture samplers
-        auto bindTexture = [&](MaterialMapType type, const char* uniformName, bgfx::UniformHandle& hSampler, uint8_t& stage)
+        if (bgfx::isValid(m_hMaterialBlock))
+            bgfx::setUniform(m_hMaterialBlock, m_uniformBlock, MaterialBlockSize);
+        else
+        {
+            for (size_t i = 0; i < MaterialBlockSize; ++i)
             {
-                if (HasMaterialMap(type))
-                {
-                    if (!bgfx::isValid(hSampler))
-                    {
-                        hSampler = m_shader->GetOrCreateSamplerUniform(uniformName);
-                        stage = m_shader->GetSamplerStage(uniformName);
-                    }
-
-                    if (bgfx::isValid(hSampler) && stage != 255)
-                        bgfx::setTexture(stage, hSampler, GetMaterialMap(type)->GetHandle());
-                }
-            };
-
-        bindTexture(MaterialMapType::Albedo, "u_AlbedoMap", m_hSamplerAlbedo, m_stageAlbedo);
-        bindTexture(MaterialMapType::Normal, "u_NormalMap", m_hSamplerNormal, m_stageNormal);
-        bindTexture(MaterialMapType::Metallic, "u_MetallicMap", m_hSamplerMetallic, m_stageMetallic);
-        bindTexture(MaterialMapType::Roughness, "u_RoughnessMap", m_hSamplerRoughness, m_stageRoughness);
-        bindTexture(MaterialMapType::MetallicRoughness, "u_MetallicRoughnessMap", m_hSamplerMetallicRoughness, m_stageMetallicRoughness);
-        bindTexture(MaterialMapType::AO, "u_AOMap", m_hSamplerAO, m_stageAO);
-        bindTexture(MaterialMapType::Emissive, "u_EmissiveMap", m_hSamplerEmissive, m_stageEmissive);
-        bindTexture(MaterialMapType::Height, "u_HeightMap", m_hSamplerHeight, m_stageHeight);
-        bindTexture(MaterialMapType::Opacity, "u_OpacityMap", m_hSamplerOpacity, m_stageOpacity);
-
-        // Set material properties
-        float albedo[4] = {
-            m_albedo.r / 255.0f,
-            m_albedo.g / 255.0f,
-            m_albedo.b / 255.0f,
-            m_albedo.a / 255.0f
-        };
-
-        if (!bgfx::isValid(m_hAlbedo))
-            m_hAlbedo = m_shader->GetOrCreateUniform("u_Albedo", UniformType::Vec4, 1);
-
-        if (bgfx::isValid(m_hAlbedo))
-            bgfx::setUniform(m_hAlbedo, albedo);
-
-        float emissiveParams[4] = {
-            m_emissive.r / 255.0f,
-            m_emissive.g / 255.0f,
-            m_emissive.b / 255.0f,
-            0.0f
-        };
-
-        if (!bgfx::isValid(m_hEmissiveParams))
-            m_hEmissiveParams = m_shader->GetOrCreateUniform("u_EmissiveParams", UniformType::Vec4, 1);
-
-        if (bgfx::isValid(m_hEmissiveParams))
-            bgfx::setUniform(m_hEmissiveParams, emissiveParams);
-
-        // u_MaterialProps expects vec4 (x=metallic, y=roughness, z=ao, w=unused)
-        float materialProps[4] = { m_metallic, m_roughness, m_ao, 0.0f };
-
-        if (!bgfx::isValid(m_hMaterialProps))
-            m_hMaterialProps = m_shader->GetOrCreateUniform("u_MaterialProps", UniformType::Vec4, 1);
-
-        if (bgfx::isValid(m_hMaterialProps))
-            bgfx::setUniform(m_hMaterialProps, materialProps);
+                if (bgfx::isValid(m_hBlockUniforms[i]))
+                    bgfx::setUniform(m_hBlockUniforms[i], m_uniformBlock[i]);
+            }
+        }
+
+        for (size_t i = 0; i < m_bakedMapCount; ++i)
+        {
+            const BakedMap& map = m_bakedMaps[i];
+            bgfx::setTexture(map.stage, map.sampler, map.texture->GetHandle());
+        }
     }
 
     void Material::Clear()
@@ -307,12 +306,15 @@ namespace cx
         m_shader = nullptr;
         m_materialMaps.fill(nullptr);
         m_UserParams.clear();
-        m_ShaderParams.clear();
+        m_ShaderParams.Clear();
 
         m_albedo = Color::White();
         m_metallic = 0.0f;
         m_roughness = 0.5f;
         m_emissive = Color::Black();
         m_ao = 1.0f;
+
+        m_uniformHandlesCached = false;
+        MarkChanged();
     }
 }
\ No newline at end of file
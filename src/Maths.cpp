@@ -1,5 +1,6 @@
 #include "Maths.h"
 #include <random>
+#include <algorithm>
 #include <chrono>
 
 namespace cx
@@ -619,6 +620,117 @@ namespace cx
         return result;
     }
 
+    // Bounds
+
+    void BoundingBox::Expand(const Vector3& point)
+    {
+        min = Vector3(std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z));
+        max = Vector3(std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z));
+    }
+
+    void BoundingBox::Expand(const BoundingBox& box)
+    {
+        if (!box.IsValid())
+            return;
+
+        Expand(box.min);
+        Expand(box.max);
+    }
+
+    BoundingBox BoundingBox::Transform(const Matrix4& transform) const
+    {
+        if (!IsValid())
+            return *this;
+
+        // The new extents are the absolute transform applied to the old extents
+        const Vector3 center = transform.TransformPoint(GetCenter());
+        const Vector3 extents = GetExtents();
+        const float* m = transform.m;
+        const Vector3 newExtents(
+            std::fabs(m[0]) * extents.x + std::fabs(m[4]) * extents.y + std::fabs(m[8]) * extents.z,
+            std::fabs(m[1]) * extents.x + std::fabs(m[5]) * extents.y + std::fabs(m[9]) * extents.z,
+            std::fabs(m[2]) * extents.x + std::fabs(m[6]) * extents.y + std::fabs(m[10]) * extents.z);
+
+        return BoundingBox(center - newExtents, center + newExtents);
+    }
+
+    BoundingSphere BoundingSphere::Transform(const Matrix4& transform) const
+    {
+        if (!IsValid())
+            return *this;
+
+        const float* m = transform.m;
+        const float scaleX = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+        const float scaleY = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+        const float scaleZ = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+        const float maxScale = std::sqrt(std::max({ scaleX, scaleY, scaleZ }));
+
+        return BoundingSphere(transform.TransformPoint(center), radius * maxScale);
+    }
+
+    Frustum Frustum::FromMatrix(const Matrix4& viewProjection, bool homogeneousDepth)
+    {
+        // Rows of the column-major matrix
+        const float* m = viewProjection.m;
+        const Vector4 row0(m[0], m[4], m[8], m[12]);
+        const Vector4 row1(m[1], m[5], m[9], m[13]);
+        const Vector4 row2(m[2], m[6], m[10], m[14]);
+        const Vector4 row3(m[3], m[7], m[11], m[15]);
+
+        auto add = [](const Vector4& a, const Vector4& b) { return Vector4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); };
+        auto sub = [](const Vector4& a, const Vector4& b) { return Vector4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); };
+
+        Frustum frustum;
+        frustum.planes[0] = add(row3, row0);
+        frustum.planes[1] = sub(row3, row0);
+        frustum.planes[2] = add(row3, row1);
+        frustum.planes[3] = sub(row3, row1);
+        frustum.planes[4] = homogeneousDepth ? add(row3, row2) : row2;
+        frustum.planes[5] = sub(row3, row2);
+
+        for (Vector4& plane : frustum.planes)
+        {
+            float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f)
+                plane = Vector4(plane.x / length, plane.y / length, plane.z / length, plane.w / length);
+        }
+
+        return frustum;
+    }
+
+    bool Frustum::Intersects(const BoundingBox& box) const
+    {
+        if (!box.IsValid())
+            return true;
+
+        const Vector3 center = box.GetCenter();
+        const Vector3 extents = box.GetExtents();
+        for (const Vector4& plane : planes)
+        {
+            // The box is outside if even its corner furthest along the plane normal is behind the plane
+            float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float radius = std::fabs(plane.x) * extents.x + std::fabs(plane.y) * extents.y + std::fabs(plane.z) * extents.z;
+            if (distance + radius < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool Frustum::Intersects(const BoundingSphere& sphere) const
+    {
+        if (!sphere.IsValid())
+            return true;
+
+        for (const Vector4& plane : planes)
+        {
+            if (plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w < -sphere.radius)
+                return false;
+        }
+
+        return true;
+    }
+
     // Random numbers
 
     void SetRandomSeed(unsigned int seed)
@@ -1,8 +1,14 @@
 #include "Mesh.h"
+#include "Renderer.h"
+#include <bx/uint32_t.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 
 namespace cx
 {
     std::vector<Mesh*> Mesh::s_meshes;
+    VertexFormat Mesh::s_defaultVertexFormat;
 
     Mesh::Mesh()
         : m_vbh(BGFX_INVALID_HANDLE)
@@ -10,6 +16,7 @@ namespace cx
         , m_uploaded(false)
         , m_skinned(false)
         , m_material(nullptr)
+        , m_vertexFormat(s_defaultVertexFormat)
     {
         s_meshes.push_back(this);
     }
@@ -24,10 +31,15 @@ namespace cx
         , m_indices(other.m_indices)
         , m_vbh(BGFX_INVALID_HANDLE)
         , m_ibh(BGFX_INVALID_HANDLE)
+        , m_morphTargets(other.m_morphTargets)
+        , m_morphWeights(other.m_morphWeights)
+        , m_dynamic(other.m_dynamic)
         , m_uploaded(false)
         , m_skinned(other.m_skinned)
         , m_material(other.m_material)
+        , m_vertexFormat(other.m_vertexFormat)
     {
+        ComputeBounds();
         Upload();
         s_meshes.push_back(this);
     }
@@ -36,6 +48,9 @@ namespace cx
     {
         m_vertices = vertices;
         m_uploaded = false;
+        m_morphTextureDirty = true;
+        m_morphWeightsDirty = true;
+        ComputeBounds();
     }
 
     void Mesh::SetIndices(const std::vector<uint32_t>& indices)
@@ -62,36 +77,366 @@ namespace cx
             return m_vertices.size() / 3;
     }
 
+    static int16_t ToSnorm16(float v)
+    {
+        v = std::clamp(v, -1.0f, 1.0f);
+        return static_cast<int16_t>(std::lround(v * 32767.0f));
+    }
+
+    static uint32_t ToUnorm(float v, uint32_t maxValue)
+    {
+        v = std::clamp(v, 0.0f, 1.0f);
+        return static_cast<uint32_t>(std::lround(v * static_cast<float>(maxValue)));
+    }
+
+    static uint32_t PackUnorm1010102(const Vector3& v, bool positiveW)
+    {
+        uint32_t x = ToUnorm(v.x * 0.5f + 0.5f, 1023);
+        uint32_t y = ToUnorm(v.y * 0.5f + 0.5f, 1023);
+        uint32_t z = ToUnorm(v.z * 0.5f + 0.5f, 1023);
+        uint32_t w = positiveW ? 3u : 0u;
+        return x | (y << 10) | (z << 20) | (w << 30);
+    }
+
+    // Maps a unit vector onto the octahedron, then unfolds the lower hemisphere into the square's corners
+    static Vector2 OctahedralEncode(const Vector3& n)
+    {
+        float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+        if (l1 <= 0.0f)
+            return Vector2(0.0f, 0.0f);
+
+        float x = n.x / l1;
+        float y = n.y / l1;
+        if (n.z < 0.0f)
+        {
+            float ox = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float oy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = ox;
+            y = oy;
+        }
+
+        return Vector2(x, y);
+    }
+
+    // Quantizes skin weights so they still sum to exactly maxValue
+    static void QuantizeWeights(const float weights[4], uint32_t maxValue, uint32_t out[4])
+    {
+        float sum = weights[0] + weights[1] + weights[2] + weights[3];
+        float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+
+        int total = 0;
+        int largest = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = ToUnorm(weights[i] * scale, maxValue);
+            total += static_cast<int>(out[i]);
+            if (weights[i] > weights[largest])
+                largest = i;
+        }
+
+        if (sum > 0.0f)
+            out[largest] = static_cast<uint32_t>(std::max(0, static_cast<int>(out[largest]) + static_cast<int>(maxValue) - total));
+    }
+
+    std::vector<uint8_t> Mesh::PackVertices(const std::vector<Vertex>& vertices, const VertexFormat& format, bool hasSkin, bool hasTexCoord1)
+    {
+        const uint64_t caps = bgfx::getCaps() ? bgfx::getCaps()->supported : 0;
+        const bool halfSupported = (caps & BGFX_CAPS_VERTEX_ATTRIB_HALF) != 0;
+        const bool uint10Supported = (caps & BGFX_CAPS_VERTEX_ATTRIB_UINT10) != 0;
+
+        NormalEncoding normalEncoding = format.normal;
+        if (normalEncoding == NormalEncoding::Packed1010102 && !uint10Supported)
+            normalEncoding = NormalEncoding::Snorm16;
+
+        const bool halfTexCoords = format.texCoord == TexCoordEncoding::Half && halfSupported;
+
+        // Positions are dequantized through the model transform, which happens after skinning, so skinned meshes keep full precision.
+        // Morphed positions can leave the quantization bounds, so morphed meshes do too.
+        const bool quantizePositions = format.position == PositionEncoding::Quantized16 && !hasSkin && m_morphTargets.empty();
+
+        float maxBoneIndex = 0.0f;
+        if (hasSkin)
+        {
+            for (const Vertex& v : vertices)
+                maxBoneIndex = std::max({ maxBoneIndex, v.boneIndices[0], v.boneIndices[1], v.boneIndices[2], v.boneIndices[3] });
+        }
+        const bool uint8BoneIndices = format.compactBoneIndices && maxBoneIndex < 256.0f;
+
+        // Build the layout
+        m_layout.begin();
+
+        if (quantizePositions)
+            m_layout.add(bgfx::Attrib::Position, 4, bgfx::AttribType::Int16, true);
+        else
+            m_layout.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+
+        switch (normalEncoding)
+        {
+        case NormalEncoding::Float:
+            m_layout.add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float);
+            m_layout.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Float);
+            break;
+        case NormalEncoding::Snorm16:
+            m_layout.add(bgfx::Attrib::Normal, 4, bgfx::AttribType::Int16, true);
+            m_layout.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Int16, true);
+            break;
+        case NormalEncoding::Octahedral16:
+            m_layout.add(bgfx::Attrib::Normal, 2, bgfx::AttribType::Int16, true);
+            m_layout.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Int16, true);
+            break;
+        case NormalEncoding::Packed1010102:
+            m_layout.add(bgfx::Attrib::Normal, 4, bgfx::AttribType::Uint10, true);
+            m_layout.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Uint10, true);
+            break;
+        }
+
+        const bgfx::AttribType::Enum texCoordType = halfTexCoords ? bgfx::AttribType::Half : bgfx::AttribType::Float;
+        m_layout.add(bgfx::Attrib::TexCoord0, 2, texCoordType);
+        if (hasTexCoord1)
+            m_layout.add(bgfx::Attrib::TexCoord1, 2, texCoordType);
+
+        if (hasSkin)
+        {
+            // Integer bone indices match the layout bgfx's geometryc produces
+            if (format.compactBoneIndices)
+                m_layout.add(bgfx::Attrib::Indices, 4, uint8BoneIndices ? bgfx::AttribType::Uint8 : bgfx::AttribType::Int16, false, true);
+            else
+                m_layout.add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Float);
+
+            if (format.boneWeights == BoneWeightEncoding::Unorm8)
+                m_layout.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Uint8, true);
+            else if (format.boneWeights == BoneWeightEncoding::Unorm16)
+                m_layout.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Int16, true);
+            else
+                m_layout.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Float);
+        }
+        else
+        {
+            // Shaders with skinning still declare a_indices and a_weight, so static meshes keep them at their smallest, left zero
+            m_layout.add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Uint8, false, true);
+            m_layout.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Uint8, true);
+        }
+
+        m_layout.end();
+
+        // Dequantization uses a uniform scale so normals stay correct under the combined transform
+        Vector3 center;
+        float extent = 1.0f;
+        if (quantizePositions)
+        {
+            Vector3 minPos = vertices[0].position;
+            Vector3 maxPos = vertices[0].position;
+            for (const Vertex& v : vertices)
+            {
+                minPos = Vector3(std::min(minPos.x, v.position.x), std::min(minPos.y, v.position.y), std::min(minPos.z, v.position.z));
+                maxPos = Vector3(std::max(maxPos.x, v.position.x), std::max(maxPos.y, v.position.y), std::max(maxPos.z, v.position.z));
+            }
+
+            center = (minPos + maxPos) * 0.5f;
+            Vector3 halfSize = (maxPos - minPos) * 0.5f;
+            extent = std::max({ halfSize.x, halfSize.y, halfSize.z });
+            if (extent <= 0.0f)
+                extent = 1.0f;
+        }
+
+        m_quantizedPositions = quantizePositions;
+        m_dequantization = quantizePositions ? Matrix4::Translate(center) * Matrix4::Scale(Vector3(extent, extent, extent)) : Matrix4::Identity();
+        m_uploadedNormalEncoding = normalEncoding;
+
+        // Pack the vertices
+        const uint32_t stride = m_layout.getStride();
+        const uint16_t offPosition = m_layout.getOffset(bgfx::Attrib::Position);
+        const uint16_t offNormal = m_layout.getOffset(bgfx::Attrib::Normal);
+        const uint16_t offTangent = m_layout.getOffset(bgfx::Attrib::Tangent);
+        const uint16_t offTexCoord0 = m_layout.getOffset(bgfx::Attrib::TexCoord0);
+        const uint16_t offTexCoord1 = m_layout.getOffset(bgfx::Attrib::TexCoord1);
+        const uint16_t offIndices = m_layout.getOffset(bgfx::Attrib::Indices);
+        const uint16_t offWeight = m_layout.getOffset(bgfx::Attrib::Weight);
+        const float invExtent = 1.0f / extent;
+
+        std::vector<uint8_t> data(static_cast<size_t>(stride) * vertices.size(), 0);
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const Vertex& v = vertices[i];
+            uint8_t* dst = data.data() + i * stride;
+
+            if (quantizePositions)
+            {
+                Vector3 p = (v.position - center) * invExtent;
+                int16_t q[4] = { ToSnorm16(p.x), ToSnorm16(p.y), ToSnorm16(p.z), 0 };
+                std::memcpy(dst + offPosition, q, sizeof(q));
+            }
+            else
+                std::memcpy(dst + offPosition, &v.position, sizeof(Vector3));
+
+            const Vector3 tangent(v.tangent.x, v.tangent.y, v.tangent.z);
+            switch (normalEncoding)
+            {
+            case NormalEncoding::Float:
+                std::memcpy(dst + offNormal, &v.normal, sizeof(Vector3));
+                std::memcpy(dst + offTangent, &v.tangent, sizeof(Vector4));
+                break;
+            case NormalEncoding::Snorm16:
+            {
+                int16_t n[4] = { ToSnorm16(v.normal.x), ToSnorm16(v.normal.y), ToSnorm16(v.normal.z), 0 };
+                int16_t t[4] = { ToSnorm16(v.tangent.x), ToSnorm16(v.tangent.y), ToSnorm16(v.tangent.z), ToSnorm16(v.tangent.w >= 0.0f ? 1.0f : -1.0f) };
+                std::memcpy(dst + offNormal, n, sizeof(n));
+                std::memcpy(dst + offTangent, t, sizeof(t));
+                break;
+            }
+            case NormalEncoding::Octahedral16:
+            {
+                Vector2 on = OctahedralEncode(v.normal);
+                Vector2 ot = OctahedralEncode(tangent);
+                int16_t n[2] = { ToSnorm16(on.x), ToSnorm16(on.y) };
+                int16_t t[4] = { ToSnorm16(ot.x), ToSnorm16(ot.y), ToSnorm16(v.tangent.w >= 0.0f ? 1.0f : -1.0f), 0 };
+                std::memcpy(dst + offNormal, n, sizeof(n));
+                std::memcpy(dst + offTangent, t, sizeof(t));
+                break;
+            }
+            case NormalEncoding::Packed1010102:
+            {
+                uint32_t n = PackUnorm1010102(v.normal, true);
+                uint32_t t = PackUnorm1010102(tangent, v.tangent.w >= 0.0f);
+                std::memcpy(dst + offNormal, &n, sizeof(n));
+                std::memcpy(dst + offTangent, &t, sizeof(t));
+                break;
+            }
+            }
+
+            if (halfTexCoords)
+            {
+                uint16_t uv0[2] = { bx::halfFromFloat(v.texCoord.x), bx::halfFromFloat(v.texCoord.y) };
+                std::memcpy(dst + offTexCoord0, uv0, sizeof(uv0));
+                if (hasTexCoord1)
+                {
+                    uint16_t uv1[2] = { bx::halfFromFloat(v.texCoord1.x), bx::halfFromFloat(v.texCoord1.y) };
+                    std::memcpy(dst + offTexCoord1, uv1, sizeof(uv1));
+                }
+            }
+            else
+            {
+                std::memcpy(dst + offTexCoord0, &v.texCoord, sizeof(Vector2));
+                if (hasTexCoord1)
+                    std::memcpy(dst + offTexCoord1, &v.texCoord1, sizeof(Vector2));
+            }
+
+            if (hasSkin)
+            {
+                if (!format.compactBoneIndices)
+                    std::memcpy(dst + offIndices, v.boneIndices, sizeof(v.boneIndices));
+                else if (uint8BoneIndices)
+                {
+                    uint8_t idx[4];
+                    for (int j = 0; j < 4; ++j)
+                        idx[j] = static_cast<uint8_t>(std::max(0.0f, v.boneIndices[j]));
+                    std::memcpy(dst + offIndices, idx, sizeof(idx));
+                }
+                else
+                {
+                    int16_t idx[4];
+                    for (int j = 0; j < 4; ++j)
+                        idx[j] = static_cast<int16_t>(std::clamp(v.boneIndices[j], 0.0f, 32767.0f));
+                    std::memcpy(dst + offIndices, idx, sizeof(idx));
+                }
+
+                if (format.boneWeights == BoneWeightEncoding::Unorm8)
+                {
+                    uint32_t q[4];
+                    QuantizeWeights(v.boneWeights, 255, q);
+                    uint8_t w[4] = { uint8_t(q[0]), uint8_t(q[1]), uint8_t(q[2]), uint8_t(q[3]) };
+                    std::memcpy(dst + offWeight, w, sizeof(w));
+                }
+                else if (format.boneWeights == BoneWeightEncoding::Unorm16)
+                {
+                    uint32_t q[4];
+                    QuantizeWeights(v.boneWeights, 32767, q);
+                    int16_t w[4] = { int16_t(q[0]), int16_t(q[1]), int16_t(q[2]), int16_t(q[3]) };
+                    std::memcpy(dst + offWeight, w, sizeof(w));
+                }
+                else
+                    std::memcpy(dst + offWeight, v.boneWeights, sizeof(v.boneWeights));
+            }
+        }
+
+        return data;
+    }
+
+    const bgfx::Memory* Mesh::BuildVertexMemory(const std::vector<Vertex>& vertices)
+    {
+        const VertexFormat& format = m_vertexFormat;
+        const bool fullLayout = m_skinned && m_hasTexCoord1
+            && format.position == PositionEncoding::Float
+            && format.normal == NormalEncoding::Float
+            && format.texCoord == TexCoordEncoding::Float
+            && format.boneWeights == BoneWeightEncoding::Float
+            && !format.compactBoneIndices;
+
+        if (fullLayout)
+        {
+            // The Vertex struct already matches this layout
+            m_layout.begin()
+                .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::TexCoord1, 2, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Float)
+                .end();
+
+            m_quantizedPositions = false;
+            m_dequantization = Matrix4::Identity();
+            m_uploadedNormalEncoding = NormalEncoding::Float;
+            return bgfx::copy(vertices.data(), static_cast<uint32_t>(vertices.size() * sizeof(Vertex)));
+        }
+
+        std::vector<uint8_t> packed = PackVertices(vertices, format, m_skinned, m_hasTexCoord1);
+        return bgfx::copy(packed.data(), static_cast<uint32_t>(packed.size()));
+    }
+
     void Mesh::Upload()
     {
         if (m_uploaded || m_vertices.empty() || m_indices.empty())
             return;
 
-        bgfx::VertexLayout layout;
-        layout.begin()
-            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::TexCoord1, 2, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Float)
-            .end();
-
-        const bgfx::Memory* vbMem = bgfx::copy(m_vertices.data(), static_cast<uint32_t>(m_vertices.size() * sizeof(Vertex)));
-        //if (m_dynamic)
-        //{
-        //    m_vbh = bgfx::createDynamicVertexBuffer(static_cast<uint32_t>(m_vertices.size()), layout, 0);
-        //    bgfx::update(m_vbh, 0, vbMem);
-        //}
-        //else
-            m_vbh = bgfx::createVertexBuffer(vbMem, layout);
+        // Re-uploading after SetVertices() or SetVertexFormat() replaces the old buffers
+        if (bgfx::isValid(m_vbh))
+            bgfx::destroy(m_vbh);
+        if (bgfx::isValid(m_ibh))
+            bgfx::destroy(m_ibh);
+
+        // The layout may change, so the CPU morph buffers are recreated on the next ApplyMorphTargets()
+        DestroyMorphBuffers();
+
+        ComputeBounds();
+
+        // Drop streams the mesh doesn't use
+        m_hasTexCoord1 = std::any_of(m_vertices.begin(), m_vertices.end(), [](const Vertex& v) { return v.texCoord1.x != 0.0f || v.texCoord1.y != 0.0f; });
+
+        m_vbh = bgfx::createVertexBuffer(BuildVertexMemory(m_vertices), m_layout);
         const bgfx::Memory* ibMem = bgfx::copy(m_indices.data(), static_cast<uint32_t>(m_indices.size() * sizeof(uint32_t)));
         m_ibh = bgfx::createIndexBuffer(ibMem, BGFX_BUFFER_INDEX32);
 
         m_uploaded = true;
     }
 
+    void Mesh::DestroyMorphBuffers()
+    {
+        for (bgfx::DynamicVertexBufferHandle& buffer : m_morphVertexBuffers)
+        {
+            if (bgfx::isValid(buffer))
+            {
+                bgfx::destroy(buffer);
+                buffer = BGFX_INVALID_HANDLE;
+            }
+        }
+
+        m_morphVertexBuffer = -1;
+        m_morphWriteBuffer = -1;
+        m_morphWeightsDirty = true;
+    }
+
     void Mesh::Destroy()
     {
         if (bgfx::isValid(m_vbh))
@@ -106,6 +451,15 @@ namespace cx
             m_ibh = BGFX_INVALID_HANDLE;
         }
 
+        if (bgfx::isValid(m_morphTexture))
+        {
+            bgfx::destroy(m_morphTexture);
+            m_morphTexture = BGFX_INVALID_HANDLE;
+        }
+        m_morphTextureDirty = true;
+
+        DestroyMorphBuffers();
+
         m_uploaded = false;
 
         for (size_t i = 0; i < s_meshes.size(); ++i)
@@ -126,30 +480,202 @@ namespace cx
         if (!m_dynamic || !bgfx::isValid(m_vbh) || m_vertices.empty())
             return;
 
-        //const bgfx::Memory* mem = bgfx::copy(m_vertices.data(), static_cast<uint32_t>(m_vertices.size() * sizeof(Vertex)));
-        //bgfx::update(m_vbh, 0, mem);
+        // Re-morph from the current vertices, so edits made through GetVertices() reach the dynamic buffer
+        m_morphWeightsDirty = true;
+        ApplyMorphTargets();
+    }
+
+    void Mesh::BindVertexBuffer(bool useMorphedVertices) const
+    {
+        if (useMorphedVertices && m_morphVertexBuffer >= 0 && bgfx::isValid(m_morphVertexBuffers[m_morphVertexBuffer]))
+            bgfx::setVertexBuffer(0, m_morphVertexBuffers[m_morphVertexBuffer]);
+        else
+            bgfx::setVertexBuffer(0, m_vbh);
+    }
+
+    void Mesh::SetMorphTargets(const std::vector<MorphTarget>& targets)
+    {
+        m_dynamic = true;
+        m_morphTargets = targets;
+        m_morphTextureDirty = true;
+        m_morphWeightsDirty = true;
+
+        ComputeBounds();
+
+        // Quantized positions can't hold morphed positions, so re-upload without them now. Nothing on the draw path uploads again.
+        if (m_quantizedPositions && m_uploaded)
+        {
+            m_uploaded = false;
+            Upload();
+        }
+    }
+
+    void Mesh::SetMorphWeights(const std::vector<float>& weights)
+    {
+        // Animations set the weights every frame, so only flag a change when they actually differ
+        if (weights == m_morphWeights)
+            return;
+
+        m_morphWeights = weights;
+        m_morphWeightsDirty = true;
+    }
+
+    uint32_t Mesh::GetActiveMorphTargets(float* weights, float* indices, uint32_t maxCount) const
+    {
+        const size_t count = std::min(m_morphTargets.size(), m_morphWeights.size());
+
+        uint32_t active = 0;
+        for (size_t t = 0; t < count; ++t)
+        {
+            if (m_morphWeights[t] == 0.0f)
+                continue;
+
+            if (active < maxCount)
+            {
+                weights[active] = m_morphWeights[t];
+                indices[active] = static_cast<float>(t);
+            }
+            ++active;
+        }
+
+        return active;
+    }
+
+    bool Mesh::UploadMorphTargets()
+    {
+        if (m_morphTargets.empty() || m_vertices.empty())
+            return false;
+
+        if (!m_morphTextureDirty)
+            return bgfx::isValid(m_morphTexture);
+
+        m_morphTextureDirty = false;
+
+        if (bgfx::isValid(m_morphTexture))
+        {
+            bgfx::destroy(m_morphTexture);
+            m_morphTexture = BGFX_INVALID_HANDLE;
+        }
+
+        const bgfx::Caps* caps = bgfx::getCaps();
+        const uint32_t maxSize = caps ? caps->limits.maxTextureSize : 4096;
+
+        // 3 texels per vertex per target: position, normal and tangent deltas
+        const size_t vertexCount = m_vertices.size();
+        const size_t texelCount = m_morphTargets.size() * vertexCount * 3;
+        const uint32_t width = static_cast<uint32_t>(std::min<size_t>(maxSize, texelCount));
+        const size_t height = (texelCount + width - 1) / width;
+        if (height > maxSize)
+        {
+            std::cerr << "[ERROR] Mesh - morph targets need " << texelCount << " texels, which is more than fits in a texture. Falling back to CPU morphing." << std::endl;
+            return false;
+        }
+
+        const bgfx::Memory* mem = bgfx::alloc(static_cast<uint32_t>(width * height * 4 * sizeof(float)));
+        std::memset(mem->data, 0, mem->size);
+        float* texels = reinterpret_cast<float*>(mem->data);
+
+        for (size_t t = 0; t < m_morphTargets.size(); ++t)
+        {
+            const MorphTarget& target = m_morphTargets[t];
+            const std::vector<Vector3>* deltas[3] = { &target.positionDeltas, &target.normalDeltas, &target.tangentDeltas };
+
+            for (int attribute = 0; attribute < 3; ++attribute)
+            {
+                const size_t count = std::min(deltas[attribute]->size(), vertexCount);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    float* texel = texels + ((t * vertexCount + i) * 3 + attribute) * 4;
+                    const Vector3& delta = (*deltas[attribute])[i];
+                    texel[0] = delta.x;
+                    texel[1] = delta.y;
+                    texel[2] = delta.z;
+                }
+            }
+        }
+
+        m_morphTexture = bgfx::createTexture2D(static_cast<uint16_t>(width), static_cast<uint16_t>(height), false, 1, bgfx::TextureFormat::RGBA32F,
+            BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP, mem);
+        m_morphTextureWidth = static_cast<uint16_t>(width);
+
+        return bgfx::isValid(m_morphTexture);
     }
 
     void Mesh::ApplyMorphTargets()
     {
-        if (m_morphTargets.empty())
+        if (m_morphTargets.empty() || !m_morphWeightsDirty || !m_uploaded)
             return;
 
-        for (size_t i = 0; i < m_vertices.size(); ++i)
+        m_morphWeightsDirty = false;
+
+        // Always morph from the original vertices so the results don't accumulate
+        m_morphedVertices = m_vertices;
+
+        const size_t vertexCount = m_vertices.size();
+        const size_t targetCount = std::min(m_morphTargets.size(), m_morphWeights.size());
+        bool morphed = false;
+        for (size_t t = 0; t < targetCount; ++t)
         {
-            Vector3 morphedPos = m_vertices[i].position;
-            Vector3 morphedNormal = m_vertices[i].normal;
+            const float weight = m_morphWeights[t];
+            if (weight == 0.0f)
+                continue;
 
-            for (size_t t = 0; t < m_morphTargets.size(); ++t)
+            const MorphTarget& target = m_morphTargets[t];
+            const size_t positionCount = std::min(target.positionDeltas.size(), vertexCount);
+            for (size_t i = 0; i < positionCount; ++i)
+                m_morphedVertices[i].position += target.positionDeltas[i] * weight;
+
+            const size_t normalCount = std::min(target.normalDeltas.size(), vertexCount);
+            for (size_t i = 0; i < normalCount; ++i)
+                m_morphedVertices[i].normal += target.normalDeltas[i] * weight;
+
+            const size_t tangentCount = std::min(target.tangentDeltas.size(), vertexCount);
+            for (size_t i = 0; i < tangentCount; ++i)
             {
-                float weight = m_morphWeights[t];
-                morphedPos += m_morphTargets[t].positionDeltas[i] * weight;
-                morphedNormal += m_morphTargets[t].normalDeltas[i] * weight;
+                m_morphedVertices[i].tangent.x += target.tangentDeltas[i].x * weight;
+                m_morphedVertices[i].tangent.y += target.tangentDeltas[i].y * weight;
+                m_morphedVertices[i].tangent.z += target.tangentDeltas[i].z * weight;
             }
 
-            m_vertices[i].position = morphedPos;
-            m_vertices[i].normal = morphedNormal.Normalize();
+            morphed = true;
         }
+
+        // With every weight at zero the static buffer already holds the right vertices
+        if (!morphed)
+        {
+            m_morphVertexBuffer = -1;
+            return;
+        }
+
+        for (Vertex& v : m_morphedVertices)
+        {
+            v.normal = v.normal.Normalize();
+            Vector3 tangent = Vector3(v.tangent.x, v.tangent.y, v.tangent.z).Normalize();
+            v.tangent = Vector4(tangent.x, tangent.y, tangent.z, v.tangent.w);
+        }
+
+        // Switch to the other buffer on the first write of a frame. Every update in a frame lands before its draws, so later
+        // writes in the same frame can reuse the buffer.
+        const uint32_t frame = s_renderer ? s_renderer->currentFrame : 0;
+        if (m_morphWriteBuffer < 0 || frame != m_morphWriteFrame)
+        {
+            m_morphWriteBuffer = m_morphWriteBuffer == 0 ? 1 : 0;
+            m_morphWriteFrame = frame;
+        }
+        const int next = m_morphWriteBuffer;
+        const bgfx::Memory* mem = BuildVertexMemory(m_morphedVertices);
+        if (!bgfx::isValid(m_morphVertexBuffers[next]))
+            m_morphVertexBuffers[next] = bgfx::createDynamicVertexBuffer(static_cast<uint32_t>(m_morphedVertices.size()), m_layout);
+
+        if (!bgfx::isValid(m_morphVertexBuffers[next]))
+        {
+            std::cerr << "[ERROR] Mesh - failed to create the morph target vertex buffer." << std::endl;
+            m_morphVertexBuffer = -1;
+            return;
+        }
+
+        bgfx::update(m_morphVertexBuffers[next], 0, mem);
+        m_morphVertexBuffer = next;
     }
 
     void Mesh::SetMaterial(Material* material)
@@ -161,10 +687,109 @@ namespace cx
         m_material = material;
     }
 
+    void Mesh::ComputeBounds()
+    {
+        m_bounds = BoundingBox();
+        m_boundingSphere = BoundingSphere();
+        m_boneBounds.clear();
+
+        if (m_vertices.empty())
+            return;
+
+        // Each vertex's reach is its position plus the sum of its negative and positive morph deltas
+        std::vector<Vector3> morphMin;
+        std::vector<Vector3> morphMax;
+        if (!m_morphTargets.empty())
+        {
+            morphMin.assign(m_vertices.size(), Vector3());
+            morphMax.assign(m_vertices.size(), Vector3());
+            for (const MorphTarget& target : m_morphTargets)
+            {
+                const size_t count = std::min(target.positionDeltas.size(), m_vertices.size());
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const Vector3& d = target.positionDeltas[i];
+                    morphMin[i] += Vector3(std::min(d.x, 0.0f), std::min(d.y, 0.0f), std::min(d.z, 0.0f));
+                    morphMax[i] += Vector3(std::max(d.x, 0.0f), std::max(d.y, 0.0f), std::max(d.z, 0.0f));
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_vertices.size(); ++i)
+        {
+            const Vertex& v = m_vertices[i];
+            BoundingBox reach(v.position, v.position);
+            if (!morphMin.empty())
+                reach = BoundingBox(v.position + morphMin[i], v.position + morphMax[i]);
+
+            m_bounds.Expand(reach);
+
+            if (!m_skinned)
+                continue;
+
+            for (int j = 0; j < 4; ++j)
+            {
+                if (v.boneWeights[j] <= 0.0f || v.boneIndices[j] < 0.0f)
+                    continue;
+
+                size_t bone = static_cast<size_t>(v.boneIndices[j]);
+                if (bone >= m_boneBounds.size())
+                    m_boneBounds.resize(bone + 1);
+                m_boneBounds[bone].Expand(reach);
+            }
+        }
+
+        // The sphere is centered on the box, with the radius reaching the furthest vertex
+        const Vector3 center = m_bounds.GetCenter();
+        float radiusSquared = 0.0f;
+        for (size_t i = 0; i < m_vertices.size(); ++i)
+        {
+            Vector3 lo = m_vertices[i].position - center;
+            Vector3 hi = lo;
+            if (!morphMin.empty())
+            {
+                lo += morphMin[i];
+                hi += morphMax[i];
+            }
+
+            Vector3 furthest(std::max(std::fabs(lo.x), std::fabs(hi.x)), std::max(std::fabs(lo.y), std::fabs(hi.y)), std::max(std::fabs(lo.z), std::fabs(hi.z)));
+            radiusSquared = std::max(radiusSquared, Vector3::Dot(furthest, furthest));
+        }
+
+        m_boundingSphere = BoundingSphere(center, std::sqrt(radiusSquared));
+    }
+
+    BoundingBox Mesh::GetSkinnedBounds(const std::vector<Matrix4>& boneMatrices) const
+    {
+        // Vertices referencing bones without a matrix aren't posed predictably, so fall back to the bind pose bounds
+        if (m_boneBounds.empty() || m_boneBounds.size() > boneMatrices.size())
+            return m_bounds;
+
+        BoundingBox bounds;
+        for (size_t bone = 0; bone < m_boneBounds.size(); ++bone)
+        {
+            if (m_boneBounds[bone].IsValid())
+                bounds.Expand(m_boneBounds[bone].Transform(boneMatrices[bone]));
+        }
+
+        return bounds.IsValid() ? bounds : m_bounds;
+    }
+
     void Mesh::SetSkinned(bool skinned)
     {
+        bool changed = m_skinned != skinned;
         m_skinned = skinned;
 
+        if (changed)
+            ComputeBounds();
+
+        // Static meshes get zeroed compact skinning streams, so the vertex buffer needs rebuilding
+        if (changed && m_uploaded)
+        {
+            m_uploaded = false;
+            Upload();
+        }
+
         if (m_material)
             m_material->SetShaderParam("u_IsSkinned", skinned);
     }
@@ -1,5 +1,6 @@
 #include "Model.h"
 #include "Material.h"
+#include "JobSystem.h"
 #include <algorithm>
 #include <iostream>
 #include <unordered_map>
@@ -473,6 +474,58 @@ namespace cx
         m_animator.Update(deltaTime, m_meshes);
     }
 
+    void UpdateAnimations(Model* const* models, size_t count, float deltaTime)
+    {
+        // With callbacks deferred an animator only writes to itself and its skeleton. Models sharing a skeleton are grouped so they
+        // update one after another on the same worker, in model order, and every group can run on any worker.
+        std::vector<std::vector<size_t>> groups;
+        std::unordered_map<const Skeleton*, size_t> skeletonGroups;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!models[i])
+                continue;
+
+            const Skeleton* skeleton = models[i]->GetAnimator()->GetSkeleton();
+            if (!skeleton)
+            {
+                groups.push_back({ i });
+                continue;
+            }
+
+            auto [it, inserted] = skeletonGroups.try_emplace(skeleton, groups.size());
+            if (inserted)
+                groups.emplace_back();
+            groups[it->second].push_back(i);
+        }
+
+        ParallelFor(groups.size(), 0, [models, deltaTime, &groups](size_t begin, size_t end)
+        {
+            for (size_t g = begin; g < end; ++g)
+            {
+                for (size_t i : groups[g])
+                {
+                    Animator* animator = models[i]->GetAnimator();
+                    bool wasDeferring = animator->IsDeferringCallbacks();
+
+                    animator->SetDeferCallbacks(true);
+                    models[i]->UpdateAnimation(deltaTime);
+                    animator->SetDeferCallbacks(wasDeferring);
+                }
+            }
+        });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (models[i])
+                models[i]->GetAnimator()->FlushDeferredCallbacks();
+        }
+    }
+
+    void UpdateAnimations(const std::vector<Model*>& models, float deltaTime)
+    {
+        UpdateAnimations(models.data(), models.size(), deltaTime);
+    }
+
     void Model::SetRootMotionEnabled(bool enabled)
     {
         m_animator.SetRootMotionEnabled(enabled);
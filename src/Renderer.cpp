@@ -2,6 +2,8 @@
 #include <bgfx.h>
 #include <platform.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #ifdef PLATFORM_WINDOWS
 #define NOMINMAX
@@ -13,7 +15,67 @@ namespace cx
 {
     static bgfx::UniformHandle u_BoneMatrices = BGFX_INVALID_HANDLE;
     static bgfx::UniformHandle u_IsSkinned = BGFX_INVALID_HANDLE;
+    static bgfx::UniformHandle u_VertexDecode = BGFX_INVALID_HANDLE; // x = NormalEncoding of the mesh's vertex buffer
+
+    // GPU morph targets. The layout is described above MorphTarget in Mesh.h.
+    static bgfx::UniformHandle u_MorphParams = BGFX_INVALID_HANDLE; // x = active target count, y = vertex count, z = delta texture width, w = texels per vertex
+    static bgfx::UniformHandle u_MorphWeights = BGFX_INVALID_HANDLE;
+    static bgfx::UniformHandle u_MorphIndices = BGFX_INVALID_HANDLE;
+    static bgfx::UniformHandle u_MorphDeltas = BGFX_INVALID_HANDLE;
+    static constexpr uint8_t s_morphDeltasStage = 9; // The first stage after the material maps
+    static constexpr uint16_t s_morphUniformVec4s = Mesh::MaxGPUMorphTargets / 4;
+    static bool s_gpuMorphTargetsSupported = false;
     static std::unordered_map<InstanceBatchKey, InstanceBatch, InstanceBatchKeyHasher> s_instanceBatches;
+    static constexpr uint32_t s_instanceBatchEvictFrames = 300; // Batches that haven't been drawn for this many frames release their GPU buffer
+
+    // Instance data is a mat4 split into 4 vec4s, following bgfx's i_data0-3 convention
+    static bgfx::VertexLayout s_instanceLayout;
+
+    // Single-mesh draws share one persistent instance buffer which is uploaded once at the end of the frame
+    static bgfx::DynamicVertexBufferHandle s_frameInstanceBuffer = BGFX_INVALID_HANDLE;
+    static uint32_t s_frameInstanceCapacity = 0;
+    static std::vector<Matrix4> s_frameInstances;
+
+    // Deferred draw queue, sorted and submitted in EndFrame()
+    struct DrawCommand
+    {
+        Mesh* mesh = nullptr;
+        Material* material = nullptr;
+        Shader* shader = nullptr;
+        uint32_t boneOffset = 0; // Into s_drawQueueBones
+        uint32_t boneCount = 0;
+        Matrix4 transform;
+        uint64_t state = 0;
+        uint16_t viewId = 0;
+    };
+
+    struct DrawSortKey
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static std::vector<DrawCommand> s_drawQueue;
+    static std::vector<DrawSortKey> s_drawQueueKeys;
+    static std::vector<DrawSortKey> s_drawQueueScratch;
+    static std::vector<Matrix4> s_drawQueueBones; // Copies of the queued draws' bone palettes, since the caller's may change before EndFrame()
+    static std::unordered_map<const void*, uint32_t> s_drawQueueShaderIds; // Dense per-frame ids for the sort keys
+    static std::unordered_map<const void*, uint32_t> s_drawQueueMaterialIds;
+    static std::unordered_map<const void*, uint32_t> s_drawQueueMeshIds;
+    static void FlushDrawQueue();
+
+    // The shader and material whose uniforms and textures the last queued draw applied. A queued draw keeps its texture bindings when the next
+    // one has the same material, so that draw doesn't need to apply anything if it's in the same sequential view and nothing changed versions.
+    // Only set while flushing the draw queue, since bgfx re-sorts other draws and their uniforms could end up applied to the wrong draw.
+    static Shader* s_boundShader = nullptr;
+    static Material* s_boundMaterial = nullptr;
+    static uint32_t s_boundShaderVersion = 0;
+    static uint32_t s_boundMaterialVersion = 0;
+    static uint16_t s_boundViewId = UINT16_MAX;
+    // The bone palette the last queued draw uploaded. Only draws that upload one set it, since unskinned meshes leave u_BoneMatrices alone.
+    static const void* s_boundBones = nullptr;
+    // Keeps the texture bindings for the next queued draw. Only used when it has the same material, since a different one could leave stages unset.
+    static constexpr uint8_t s_keepBindingsDiscardFlags = BGFX_DISCARD_ALL & ~BGFX_DISCARD_BINDINGS;
 
     RendererState* s_renderer = nullptr;
 
@@ -65,6 +127,9 @@ namespace cx
         else if (config.renderingAPI == Vulkan)
             init.type = bgfx::RendererType::Vulkan;
 
+        if (config.windowBackend == WindowBackend::Headless && init.type != bgfx::RendererType::Noop)
+            std::cout << "[WARNING] A headless window has no native handle. Use RenderingAPI::Null unless the chosen API supports rendering without a window." << std::endl;
+
         if (!bgfx::init(init))
         {
             delete s_renderer;
@@ -78,6 +143,25 @@ namespace cx
 
         u_BoneMatrices = bgfx::createUniform("u_BoneMatrices", bgfx::UniformType::Mat4, 128); // This is enough for most models, but to configure it, it would also need to be set in the shader.
         u_IsSkinned = bgfx::createUniform("u_IsSkinned", bgfx::UniformType::Vec4);
+        u_VertexDecode = bgfx::createUniform("u_VertexDecode", bgfx::UniformType::Vec4);
+
+        u_MorphParams = bgfx::createUniform("u_MorphParams", bgfx::UniformType::Vec4);
+        u_MorphWeights = bgfx::createUniform("u_MorphWeights", bgfx::UniformType::Vec4, s_morphUniformVec4s);
+        u_MorphIndices = bgfx::createUniform("u_MorphIndices", bgfx::UniformType::Vec4, s_morphUniformVec4s);
+        u_MorphDeltas = bgfx::createUniform("u_MorphDeltas", bgfx::UniformType::Sampler);
+
+        // GPU morphing reads the deltas by vertex index from a float texture in the vertex shader
+        const bgfx::Caps* caps = bgfx::getCaps();
+        s_gpuMorphTargetsSupported = (caps->supported & BGFX_CAPS_VERTEX_ID) != 0
+            && (caps->formats[bgfx::TextureFormat::RGBA32F] & BGFX_CAPS_FORMAT_TEXTURE_VERTEX) != 0;
+
+        s_instanceLayout
+            .begin()
+            .add(bgfx::Attrib::TexCoord7, 4, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord6, 4, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord5, 4, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord4, 4, bgfx::AttribType::Float)
+            .end();
 
         return true;
     }
@@ -96,6 +180,34 @@ namespace cx
             if (bgfx::isValid(u_IsSkinned))
                 bgfx::destroy(u_IsSkinned);
 
+            if (bgfx::isValid(u_VertexDecode))
+                bgfx::destroy(u_VertexDecode);
+
+            for (bgfx::UniformHandle* uniform : { &u_MorphParams, &u_MorphWeights, &u_MorphIndices, &u_MorphDeltas })
+            {
+                if (bgfx::isValid(*uniform))
+                    bgfx::destroy(*uniform);
+                *uniform = BGFX_INVALID_HANDLE;
+            }
+
+            for (auto& pair : s_instanceBatches)
+            {
+                if (bgfx::isValid(pair.second.instanceBuffer))
+                    bgfx::destroy(pair.second.instanceBuffer);
+            }
+            s_instanceBatches.clear();
+
+            s_drawQueue.clear();
+            s_drawQueueKeys.clear();
+            s_drawQueueBones.clear();
+            InvalidateBoundMaterial();
+
+            if (bgfx::isValid(s_frameInstanceBuffer))
+                bgfx::destroy(s_frameInstanceBuffer);
+            s_frameInstanceBuffer = BGFX_INVALID_HANDLE;
+            s_frameInstanceCapacity = 0;
+            s_frameInstances.clear();
+
             bgfx::shutdown();
             delete s_renderer;
             s_renderer = nullptr;
@@ -108,6 +220,8 @@ namespace cx
             return;
 
         Texture::ProcessPendingReadbacks(s_renderer->currentFrame);
+        Texture::UpdateStreaming(s_renderer->currentFrame);
+        Texture::ProcessAsyncUploads();
 
         s_renderer->frameStartTime = std::chrono::steady_clock::now();
         s_renderer->drawStats = DrawStats();
@@ -115,17 +229,73 @@ namespace cx
         if (s_renderer->profilerEnabled)
             s_renderer->profileMarkers.clear();
 
+        // bgfx keeps view modes between frames
+        for (uint16_t viewId : s_renderer->sequentialViews)
+            bgfx::setViewMode(viewId, bgfx::ViewMode::Default);
+        s_renderer->sequentialViews.clear();
+
         s_renderer->currentViewId = 0;
+        s_renderer->hasViewFrustum = false;
+        s_renderer->lastShader = nullptr;
+        InvalidateBoundMaterial();
         s_renderer->window->GetWindowSize(s_renderer->width, s_renderer->height);
     }
 
+    static void FlushFrameInstances()
+    {
+        uint32_t count = static_cast<uint32_t>(s_frameInstances.size());
+
+        // Updates are executed before this frame's draws, so DrawMesh() can reference slots before they are uploaded
+        uint32_t uploadCount = std::min(count, s_frameInstanceCapacity);
+        if (uploadCount > 0)
+            bgfx::update(s_frameInstanceBuffer, 0, bgfx::copy(s_frameInstances.data(), uploadCount * sizeof(Matrix4)));
+
+        // Draws past the capacity fell back to transient buffers, so grow for the next frame
+        if (count > s_frameInstanceCapacity)
+        {
+            if (bgfx::isValid(s_frameInstanceBuffer))
+                bgfx::destroy(s_frameInstanceBuffer);
+
+            s_frameInstanceCapacity = std::max(count + count / 2, 64u);
+            s_frameInstanceBuffer = bgfx::createDynamicVertexBuffer(s_frameInstanceCapacity, s_instanceLayout);
+            if (!bgfx::isValid(s_frameInstanceBuffer))
+                s_frameInstanceCapacity = 0;
+        }
+
+        s_frameInstances.clear();
+    }
+
+    static void EvictUnusedInstanceBatches()
+    {
+        uint32_t currentFrame = s_renderer->currentFrame;
+        for (auto it = s_instanceBatches.begin(); it != s_instanceBatches.end();)
+        {
+            InstanceBatch& batch = it->second;
+            bool neverSubmitted = batch.lastSubmitFrame == UINT32_MAX;
+            if (batch.transforms.empty() && (neverSubmitted || currentFrame - batch.lastSubmitFrame > s_instanceBatchEvictFrames))
+            {
+                if (bgfx::isValid(batch.instanceBuffer))
+                    bgfx::destroy(batch.instanceBuffer);
+                it = s_instanceBatches.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
     void EndFrame()
     {
         if (!s_renderer)
             return;
 
+        // Queued draws push their transforms into the frame instance buffer, so they go first
+        FlushDrawQueue();
+        FlushFrameInstances();
+
         s_renderer->currentFrame = bgfx::frame();
 
+        EvictUnusedInstanceBatches();
+
         // CPU time
         s_renderer->frameEndTime = std::chrono::steady_clock::now();
         std::chrono::duration<float, std::milli> cpuTime = s_renderer->frameEndTime - s_renderer->frameStartTime;
@@ -145,10 +315,6 @@ namespace cx
         // Draw call counts
         s_renderer->drawStats.drawCalls = stats->numDraw;
 
-        // Texture and shader counts
-        s_renderer->drawStats.textureBinds = stats->numTextures;
-        s_renderer->drawStats.shaderSwitches = stats->numShaders;
-
         // Memory usage
         s_renderer->drawStats.textureMemoryUsed = stats->textureMemoryUsed;
         s_renderer->drawStats.gpuMemoryUsed = stats->gpuMemoryUsed;
@@ -187,6 +353,63 @@ namespace cx
             return;
 
         bgfx::setViewTransform(s_renderer->currentViewId, view.m, projection.m);
+
+        const bgfx::Caps* caps = bgfx::getCaps();
+        s_renderer->viewFrustum = Frustum::FromMatrix(projection * view, caps && caps->homogeneousDepth);
+        s_renderer->hasViewFrustum = true;
+
+        // Orthographic projections keep w at 1
+        s_renderer->perspectiveView = projection.m[15] == 0.0f;
+        s_renderer->viewPixelScale = std::fabs(projection.m[5]) * 0.5f * static_cast<float>(s_renderer->height);
+    }
+
+    // How many pixels tall the sphere appears in the current view, measured at its nearest point
+    static float GetScreenPixels(const BoundingSphere& worldSphere)
+    {
+        if (!s_renderer->hasViewFrustum || !worldSphere.IsValid())
+            return 0.0f;
+
+        float pixels = worldSphere.radius * 2.0f * s_renderer->viewPixelScale;
+        if (s_renderer->perspectiveView)
+        {
+            const Vector4& nearPlane = s_renderer->viewFrustum.planes[4];
+            const Vector3& center = worldSphere.center;
+            const float depth = nearPlane.x * center.x + nearPlane.y * center.y + nearPlane.z * center.z + nearPlane.w - worldSphere.radius;
+            pixels /= std::max(depth, 0.01f);
+        }
+
+        return pixels;
+    }
+
+    // Streamed textures load the mips their largest draw needs
+    static void NoteTextureUsage(Material* material, float screenPixels)
+    {
+        if (screenPixels <= 0.0f)
+            return;
+
+        for (size_t i = 0; i < static_cast<size_t>(MaterialMapType::Count); ++i)
+        {
+            Texture* texture = material->GetMaterialMap(static_cast<MaterialMapType>(i));
+            if (texture && texture->IsStreamed())
+                texture->NoteStreamingUsage(screenPixels);
+        }
+    }
+
+    static bool IsInViewFrustum(const BoundingBox& worldBounds)
+    {
+        if (!s_renderer->frustumCullingEnabled || !s_renderer->hasViewFrustum)
+            return true;
+
+        return s_renderer->viewFrustum.Intersects(worldBounds);
+    }
+
+    // The mesh's bounds in world space. Skinned meshes use their posed bounds.
+    static BoundingBox GetMeshWorldBounds(const Mesh* mesh, const Matrix4& transform, const std::vector<Matrix4>* bones)
+    {
+        if (bones && mesh->IsSkinned())
+            return mesh->GetSkinnedBounds(*bones).Transform(transform);
+
+        return mesh->GetBounds().Transform(transform);
     }
 
     uint64_t GetBlendState(BlendMode mode)
@@ -231,32 +454,55 @@ namespace cx
         }
     }
 
-    void DrawMesh(Mesh* mesh, const Matrix4& transform, const std::vector<Matrix4>* bones)
+    // Blends morph targets in the vertex shader when the shader and renderer support it, otherwise updates the CPU morphed
+    // vertex buffer, which only does work when the weights changed. Then binds the mesh's vertex buffer.
+    static void BindMeshVertexBuffer(Mesh* mesh, Shader* shader)
     {
-        if (s_renderer->currentViewId == 0 || !mesh || !mesh->IsValid() || !mesh->GetMaterial() || !mesh->GetMaterial()->GetShader())
-            return;
+        float params[4] = { 0.0f, 0.0f, 0.0f, 3.0f };
+        bool cpuMorph = false;
 
-        // Allocate instance data buffer for single instance
-        bgfx::InstanceDataBuffer idb;
-        bgfx::allocInstanceDataBuffer(&idb, 1, sizeof(Matrix4));
-
-        if (!bgfx::isValid(idb.handle))
+        if (mesh->HasMorphTargets())
         {
-            std::cerr << "[ERROR] Failed to allocate instance data buffer for single mesh draw." << std::endl;
-            return;
+            if (s_gpuMorphTargetsSupported && shader->SupportsGPUMorphTargets() && mesh->UploadMorphTargets())
+            {
+                float weights[Mesh::MaxGPUMorphTargets] = {};
+                float indices[Mesh::MaxGPUMorphTargets] = {};
+                uint32_t active = mesh->GetActiveMorphTargets(weights, indices, Mesh::MaxGPUMorphTargets);
+
+                if (active <= Mesh::MaxGPUMorphTargets)
+                {
+                    if (active > 0)
+                    {
+                        uint16_t vec4s = static_cast<uint16_t>((active + 3) / 4);
+                        bgfx::setUniform(u_MorphWeights, weights, vec4s);
+                        bgfx::setUniform(u_MorphIndices, indices, vec4s);
+                        bgfx::setTexture(s_morphDeltasStage, u_MorphDeltas, mesh->GetMorphTexture());
+                    }
+
+                    params[0] = static_cast<float>(active);
+                    params[1] = static_cast<float>(mesh->GetVertices().size());
+                    params[2] = static_cast<float>(mesh->GetMorphTextureWidth());
+                }
+                else
+                    cpuMorph = true;
+            }
+            else
+                cpuMorph = true;
         }
 
-        // Copy transform data
-        std::memcpy(idb.data, &transform, sizeof(Matrix4));
+        if (cpuMorph)
+            mesh->ApplyMorphTargets();
 
-        mesh->ApplyMorphTargets(); // Todo: It would be best to blend weights in the shader
-        mesh->UpdateBuffer();
+        // Always set so a previous draw's targets aren't applied to this mesh
+        if (shader->SupportsGPUMorphTargets())
+            bgfx::setUniform(u_MorphParams, params);
 
-        bgfx::setVertexBuffer(0, mesh->GetVertexBuffer());
-        bgfx::setIndexBuffer(mesh->GetIndexBuffer());
-        bgfx::setInstanceDataBuffer(&idb);
+        mesh->BindVertexBuffer(cpuMorph);
+    }
 
-        uint64_t state = 0
+    static uint64_t GetMeshState()
+    {
+        return 0
             | BGFX_STATE_WRITE_RGB
             | BGFX_STATE_WRITE_A
             | BGFX_STATE_WRITE_Z
@@ -264,9 +510,26 @@ namespace cx
             | BGFX_STATE_CULL_CW
             | BGFX_STATE_MSAA
             | GetBlendState(s_renderer->currentBlendMode);
+    }
+
+    static void CountMaterialBind(const Material* material)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(MaterialMapType::Count); ++i)
+        {
+            if (material->HasMaterialMap(static_cast<MaterialMapType>(i)))
+                s_renderer->drawStats.textureBinds++;
+        }
+    }
 
-        Material* material = mesh->GetMaterial();
-        Shader* shader = material->GetShader();
+    // Applies the shader's global uniforms and the material's uniforms and textures. sequential is set for queued draws, which bgfx submits
+    // in order, so they skip applying what the previous queued draw in the same view already bound at the same versions.
+    static void ApplyMaterial(Material* material, Shader* shader, uint16_t viewId, bool sequential)
+    {
+        const uint32_t shaderVersion = shader->GetVersion();
+        const uint32_t materialVersion = material->GetVersion();
+        if (sequential && viewId == s_boundViewId && shader == s_boundShader && material == s_boundMaterial &&
+            shaderVersion == s_boundShaderVersion && materialVersion == s_boundMaterialVersion)
+            return;
 
         // Apply global uniforms
         shader->ApplyUniforms();
@@ -277,29 +540,298 @@ namespace cx
         // Apply PBR material map uniforms
         material->ApplyPBRUniforms();
 
+        CountMaterialBind(material);
+
+        if (!sequential)
+        {
+            InvalidateBoundMaterial();
+            return;
+        }
+
+        s_boundShader = shader;
+        s_boundMaterial = material;
+        s_boundShaderVersion = shaderVersion;
+        s_boundMaterialVersion = materialVersion;
+        s_boundViewId = viewId;
+    }
+
+    // Submits a single mesh draw. Queued draws skip the bone upload when the last palette uploaded in the same view is the same one,
+    // since bgfx keeps uniform values between draws. keepBindings leaves the textures bound for the next draw, which must use the same material.
+    static void SubmitDraw(const DrawCommand& command, const Matrix4* bones, bool sequential, bool keepBindings)
+    {
+        Mesh* mesh = command.mesh;
+        Material* material = command.material;
+        Shader* shader = command.shader;
+
+        // Quantized positions are dequantized as part of the model transform
+        const Matrix4 instanceTransform = mesh->HasQuantizedPositions() ? command.transform * mesh->GetDequantizationTransform() : command.transform;
+
+        // The transform goes into the shared frame instance buffer, which is uploaded once in EndFrame()
+        uint32_t instanceIndex = static_cast<uint32_t>(s_frameInstances.size());
+        if (instanceIndex < s_frameInstanceCapacity)
+        {
+            s_frameInstances.push_back(instanceTransform);
+            bgfx::setInstanceDataBuffer(s_frameInstanceBuffer, instanceIndex, 1);
+        }
+        else
+        {
+            // The shared buffer is full this frame, so use a transient buffer. The slot is still counted so the buffer grows for next frame.
+            bgfx::InstanceDataBuffer idb;
+            bgfx::allocInstanceDataBuffer(&idb, 1, sizeof(Matrix4));
+
+            if (!bgfx::isValid(idb.handle))
+            {
+                std::cerr << "[ERROR] Failed to allocate instance data buffer for single mesh draw." << std::endl;
+                return;
+            }
+
+            std::memcpy(idb.data, &instanceTransform, sizeof(Matrix4));
+            s_frameInstances.push_back(instanceTransform);
+            bgfx::setInstanceDataBuffer(&idb);
+        }
+
+        BindMeshVertexBuffer(mesh, shader);
+        bgfx::setIndexBuffer(mesh->GetIndexBuffer());
+
+        ApplyMaterial(material, shader, command.viewId, sequential);
+
         // Apply skinned and bone uniforms
         float skinned[4] = { mesh->IsSkinned() ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f };
         bgfx::setUniform(u_IsSkinned, skinned);
 
-        if (bones && mesh->IsSkinned())
+        float vertexDecode[4] = { static_cast<float>(mesh->GetUploadedNormalEncoding()), 0.0f, 0.0f, 0.0f };
+        bgfx::setUniform(u_VertexDecode, vertexDecode);
+
+        if (bones && command.boneCount > 0 && mesh->IsSkinned() && !(sequential && bones == s_boundBones))
         {
-            size_t numBones = bones->size();
             //std::vector<Matrix4> transposedBones(numBones);
             //for (size_t i = 0; i < numBones; ++i)
             //    transposedBones[i] = (*bones)[i].Transpose();
-            bgfx::setUniform(u_BoneMatrices, bones->data(), static_cast<uint16_t>(numBones)); // Todo: There may be issues if the bones > max bones set when creating the u_boneMatrices
+            bgfx::setUniform(u_BoneMatrices, bones, static_cast<uint16_t>(command.boneCount)); // Todo: There may be issues if the bones > max bones set when creating the u_boneMatrices
+            s_boundBones = sequential ? bones : nullptr;
         }
 
-        bgfx::setState(state);
-        bgfx::submit(s_renderer->currentViewId, shader->GetHandle());
+        bgfx::setState(command.state);
+        bgfx::submit(command.viewId, shader->GetHandle(), 0, keepBindings ? s_keepBindingsDiscardFlags : BGFX_DISCARD_ALL);
+
+        // The textures were discarded, so the next draw has to bind them again. Uniforms, including the bone palette, are kept.
+        if (!keepBindings)
+            s_boundMaterial = nullptr;
 
         // Update stats
+        if (shader != s_renderer->lastShader)
+        {
+            s_renderer->drawStats.shaderSwitches++;
+            s_renderer->lastShader = shader;
+        }
+
         s_renderer->drawStats.drawCalls++;
         s_renderer->drawStats.triangles += mesh->GetTriangleCount();
         s_renderer->drawStats.vertices += mesh->GetVertices().size();
         s_renderer->drawStats.indicies += mesh->GetIndices().size();
     }
 
+    // Float bits of a non-negative value sort in the same order as the value, so the top bits make a coarse depth key
+    static uint64_t QuantizeDepth(float depth, int bits)
+    {
+        depth = std::max(depth, 0.0f);
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &depth, sizeof(depthBits));
+        return depthBits >> (32 - bits);
+    }
+
+    static uint32_t GetSortId(std::unordered_map<const void*, uint32_t>& ids, const void* object)
+    {
+        return ids.emplace(object, static_cast<uint32_t>(ids.size())).first->second;
+    }
+
+    // Sort key layout, from the most significant bit:
+    //   view (16) | blended (1) | blend mode (4) | opaque: shader (10), material (12), depth (13), mesh (8)
+    //                                            | back-to-front: inverted depth (24), shader (8), material (11)
+    // Opaque draws are grouped by state and go front-to-back within a material. Order dependent blending is sorted back-to-front.
+    static uint64_t MakeSortKey(const DrawCommand& command, float depth)
+    {
+        const BlendMode blendMode = s_renderer->currentBlendMode;
+        const uint64_t shaderId = GetSortId(s_drawQueueShaderIds, command.shader);
+        const uint64_t materialId = GetSortId(s_drawQueueMaterialIds, command.material);
+
+        uint64_t key = static_cast<uint64_t>(command.viewId) << 48;
+        key |= static_cast<uint64_t>(blendMode != BlendMode::None) << 47;
+        key |= (static_cast<uint64_t>(blendMode) & 0xF) << 43;
+
+        if (blendMode == BlendMode::Alpha || blendMode == BlendMode::PremultipliedAlpha)
+        {
+            key |= (~QuantizeDepth(depth, 24) & 0xFFFFFF) << 19;
+            key |= (shaderId & 0xFF) << 11;
+            key |= materialId & 0x7FF;
+        }
+        else
+        {
+            const uint64_t meshId = GetSortId(s_drawQueueMeshIds, command.mesh);
+            key |= (shaderId & 0x3FF) << 33;
+            key |= (materialId & 0xFFF) << 21;
+            key |= QuantizeDepth(depth, 13) << 8;
+            key |= meshId & 0xFF;
+        }
+
+        return key;
+    }
+
+    // Submits the mesh without culling it. The caller has checked that it can be drawn. queuedBones is the offset of the bones' copy in
+    // s_drawQueueBones, or UINT32_MAX if they haven't been copied yet, so the meshes of one model share a single copy.
+    static void SubmitMesh(Mesh* mesh, const Matrix4& transform, const std::vector<Matrix4>* bones, uint32_t& queuedBones)
+    {
+        DrawCommand command;
+        command.mesh = mesh;
+        command.material = mesh->GetMaterial();
+        command.shader = command.material->GetShader();
+        command.boneCount = bones && mesh->IsSkinned() ? static_cast<uint32_t>(bones->size()) : 0;
+        command.transform = transform;
+        command.state = GetMeshState();
+        command.viewId = s_renderer->currentViewId;
+
+        if (Texture::HasStreamedTextures())
+            NoteTextureUsage(command.material, GetScreenPixels(mesh->GetBoundingSphere().Transform(transform)));
+
+        if (!s_renderer->drawQueueEnabled)
+        {
+            SubmitDraw(command, command.boneCount > 0 ? bones->data() : nullptr, false, false);
+            return;
+        }
+
+        if (command.boneCount > 0)
+        {
+            if (queuedBones == UINT32_MAX)
+            {
+                queuedBones = static_cast<uint32_t>(s_drawQueueBones.size());
+                s_drawQueueBones.insert(s_drawQueueBones.end(), bones->begin(), bones->end());
+            }
+            command.boneOffset = queuedBones;
+        }
+
+        // Depth is the distance of the mesh's center in front of the camera
+        float depth = 0.0f;
+        if (s_renderer->hasViewFrustum)
+        {
+            const Vector4& nearPlane = s_renderer->viewFrustum.planes[4];
+            const Vector3 center = transform.TransformPoint(mesh->GetBounds().IsValid() ? mesh->GetBounds().GetCenter() : Vector3());
+            depth = nearPlane.x * center.x + nearPlane.y * center.y + nearPlane.z * center.z + nearPlane.w;
+        }
+
+        s_drawQueueKeys.push_back({ MakeSortKey(command, depth), static_cast<uint32_t>(s_drawQueue.size()) });
+        s_drawQueue.push_back(command);
+    }
+
+    // LSD radix sort by key, 8 bits per pass. Passes where every key has the same byte are skipped.
+    static void RadixSortDrawQueue(std::vector<DrawSortKey>& keys, std::vector<DrawSortKey>& scratch)
+    {
+        scratch.resize(keys.size());
+
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            uint32_t counts[256] = {};
+            for (const DrawSortKey& key : keys)
+                counts[(key.key >> shift) & 0xFF]++;
+
+            if (counts[(keys[0].key >> shift) & 0xFF] == keys.size())
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t& count : counts)
+            {
+                uint32_t c = count;
+                count = offset;
+                offset += c;
+            }
+
+            for (const DrawSortKey& key : keys)
+                scratch[counts[(key.key >> shift) & 0xFF]++] = key;
+
+            keys.swap(scratch);
+        }
+    }
+
+    static void FlushDrawQueue()
+    {
+        if (s_drawQueue.empty())
+            return;
+
+        RadixSortDrawQueue(s_drawQueueKeys, s_drawQueueScratch);
+
+        // bgfx would otherwise re-sort the draws within each view by its own key
+        uint16_t lastViewId = UINT16_MAX;
+        for (const DrawSortKey& key : s_drawQueueKeys)
+        {
+            uint16_t viewId = s_drawQueue[key.index].viewId;
+            if (viewId != lastViewId)
+            {
+                SetViewSequentialForFrame(viewId);
+                lastViewId = viewId;
+            }
+        }
+
+        // Sorting puts draws sharing a material next to each other, so ApplyMaterial() skips most of them.
+        // Anything submitted since the last flush may have changed the uniforms, so the first draw applies everything.
+        InvalidateBoundMaterial();
+        uint16_t boundViewId = UINT16_MAX;
+        for (size_t i = 0; i < s_drawQueueKeys.size(); ++i)
+        {
+            const DrawCommand& command = s_drawQueue[s_drawQueueKeys[i].index];
+
+            // Nothing bound in one view carries over to the next
+            if (command.viewId != boundViewId)
+            {
+                InvalidateBoundMaterial();
+                boundViewId = command.viewId;
+            }
+
+            // Texture bindings are only kept for a following draw of the same material, which skips binding them
+            const DrawCommand* next = i + 1 < s_drawQueueKeys.size() ? &s_drawQueue[s_drawQueueKeys[i + 1].index] : nullptr;
+            const bool keepBindings = next && next->viewId == command.viewId && next->material == command.material && next->shader == command.shader;
+
+            SubmitDraw(command, command.boneCount > 0 ? &s_drawQueueBones[command.boneOffset] : nullptr, true, keepBindings);
+        }
+        InvalidateBoundMaterial();
+
+        s_drawQueue.clear();
+        s_drawQueueKeys.clear();
+        s_drawQueueBones.clear();
+        s_drawQueueShaderIds.clear();
+        s_drawQueueMaterialIds.clear();
+        s_drawQueueMeshIds.clear();
+    }
+
+    static bool CanDrawMesh(Mesh* mesh)
+    {
+        return mesh && mesh->IsValid() && mesh->GetMaterial() && mesh->GetMaterial()->GetShader();
+    }
+
+    void DrawMesh(Mesh* mesh, const Matrix4& transform, const std::vector<Matrix4>* bones)
+    {
+        if (s_renderer->currentViewId == 0 || !CanDrawMesh(mesh))
+            return;
+
+        // Rigid meshes try the cheaper sphere test first
+        bool visible = true;
+        if (s_renderer->frustumCullingEnabled && s_renderer->hasViewFrustum)
+        {
+            if (!(bones && mesh->IsSkinned()) && !s_renderer->viewFrustum.Intersects(mesh->GetBoundingSphere().Transform(transform)))
+                visible = false;
+            else
+                visible = IsInViewFrustum(GetMeshWorldBounds(mesh, transform, bones));
+        }
+
+        if (!visible)
+        {
+            s_renderer->drawStats.culledObjects++;
+            return;
+        }
+
+        s_renderer->drawStats.visibleObjects++;
+        uint32_t queuedBones = UINT32_MAX;
+        SubmitMesh(mesh, transform, bones, queuedBones);
+    }
+
     void DrawMesh(Mesh* mesh, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
     {
         if (!mesh)
@@ -343,31 +875,51 @@ namespace cx
         else if (animator && model->HasSkeleton())
             bones = &animator->GetFinalBoneMatrices();
 
-        // Draw each mesh
-        if (useNodeAnimation)
-        {
-            const auto& nodeTransforms = animator->GetNodeTransforms();
-            for (size_t i = 0; i < model->GetMeshes().size(); ++i)
-            {
-                const auto& mesh = model->GetMeshes()[i];
-                Matrix4 meshTransform = transform;
+        if (s_renderer->currentViewId == 0)
+            return;
 
-                if (i < nodeTransforms.size() && nodeTransforms[i] != Matrix4::Identity())
-                    meshTransform = transform * nodeTransforms[i];
+        // Gather each mesh's transform and world bounds so the whole model can be rejected before any mesh is looked at further
+        static std::vector<Matrix4> meshTransforms;
+        static std::vector<BoundingBox> meshBounds;
+        const auto& meshes = model->GetMeshes();
+        meshTransforms.resize(meshes.size());
+        meshBounds.resize(meshes.size());
+
+        const std::vector<Matrix4>* nodeTransforms = useNodeAnimation ? &animator->GetNodeTransforms() : nullptr;
+        const bool culling = s_renderer->frustumCullingEnabled && s_renderer->hasViewFrustum;
+        BoundingBox modelBounds;
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            meshTransforms[i] = transform;
+            if (nodeTransforms && i < nodeTransforms->size() && (*nodeTransforms)[i] != Matrix4::Identity())
+                meshTransforms[i] = transform * (*nodeTransforms)[i];
 
-                //for (size_t i = 0; i < numBones; ++i)
-                //{
-                //    const Matrix4& mat = (*bones)[i];
-                //    memcpy(&boneData[i * 16], mat.m, 16 * sizeof(float));
-                //}
+            meshBounds[i] = culling && meshes[i] ? GetMeshWorldBounds(meshes[i].get(), meshTransforms[i], bones) : BoundingBox();
+            modelBounds.Expand(meshBounds[i]);
+        }
 
-                DrawMesh(mesh.get(), meshTransform, bones);
-            }
+        if (!IsInViewFrustum(modelBounds))
+        {
+            s_renderer->drawStats.culledObjects += static_cast<int>(meshes.size());
+            return;
         }
-        else
+
+        // Draw each mesh
+        uint32_t queuedBones = UINT32_MAX;
+        for (size_t i = 0; i < meshes.size(); ++i)
         {
-            for (const auto& mesh : model->GetMeshes())
-                DrawMesh(mesh.get(), transform, bones);
+            Mesh* mesh = meshes[i].get();
+            if (!CanDrawMesh(mesh))
+                continue;
+
+            if (!IsInViewFrustum(meshBounds[i]))
+            {
+                s_renderer->drawStats.culledObjects++;
+                continue;
+            }
+
+            s_renderer->drawStats.visibleObjects++;
+            SubmitMesh(mesh, meshTransforms[i], bones, queuedBones);
         }
     }
 
@@ -399,17 +951,115 @@ namespace cx
             DrawModel(model, model->GetPosition(), model->GetRotationQuat(), model->GetScale());
     }
 
-    void DrawMeshInstanced(Mesh* mesh, const std::vector<Matrix4>& transforms, const std::vector<Matrix4>* boneMatrices)
+    // Writes instance transforms, folding in the mesh's position dequantization if it has one
+    static void WriteInstanceTransforms(const Mesh* mesh, const Matrix4* transforms, uint32_t count, void* dst)
     {
-        // Todo: This isnt instanced
-        if (!mesh || !mesh->IsValid() || !mesh->GetMaterial() || !mesh->GetMaterial()->GetShader() || transforms.empty())
+        if (!mesh->HasQuantizedPositions())
+        {
+            std::memcpy(dst, transforms, count * sizeof(Matrix4));
             return;
+        }
+
+        const Matrix4& dequantization = mesh->GetDequantizationTransform();
+        Matrix4* out = static_cast<Matrix4*>(dst);
+        for (uint32_t i = 0; i < count; ++i)
+            out[i] = transforms[i] * dequantization;
+    }
 
-        mesh->ApplyMorphTargets(); // Todo: It would be best to blend weights in the shader
-        mesh->UpdateBuffer();
+    static const bgfx::Memory* CopyInstanceTransforms(const Mesh* mesh, const Matrix4* transforms, uint32_t count)
+    {
+        const bgfx::Memory* mem = bgfx::alloc(count * sizeof(Matrix4));
+        WriteInstanceTransforms(mesh, transforms, count, mem->data);
+        return mem;
+    }
 
-        Material* material = mesh->GetMaterial();
-        Shader* shader = material->GetShader();
+    // Uploads the changed part of the batch's persistent instance buffer and binds it. Returns false if nothing could be bound.
+    static bool BindBatchInstanceData(InstanceBatch& batch, const Matrix4* transforms, uint32_t count)
+    {
+        // A dynamic buffer holds one set of contents per frame, so a second draw of the same batch this frame gets transient data
+        if (batch.lastSubmitFrame == s_renderer->currentFrame)
+        {
+            if (bgfx::getAvailInstanceDataBuffer(count, sizeof(Matrix4)) < count)
+            {
+                std::cerr << "[ERROR] Failed to allocate instance data buffer for batch of " << count << " instances." << std::endl;
+                return false;
+            }
+
+            bgfx::InstanceDataBuffer idb;
+            bgfx::allocInstanceDataBuffer(&idb, count, sizeof(Matrix4));
+            WriteInstanceTransforms(batch.mesh, transforms, count, idb.data);
+            bgfx::setInstanceDataBuffer(&idb);
+            return true;
+        }
+
+        // A re-uploaded mesh may have new dequantization, which invalidates everything resident
+        if (batch.mesh->GetDequantizationTransform() != batch.uploadedDequantization)
+        {
+            batch.uploadedDequantization = batch.mesh->GetDequantizationTransform();
+            batch.uploadedTransforms.clear();
+        }
+
+        if (count > batch.instanceCapacity || !bgfx::isValid(batch.instanceBuffer))
+        {
+            // Grow and upload everything in one go
+            if (bgfx::isValid(batch.instanceBuffer))
+                bgfx::destroy(batch.instanceBuffer);
+
+            batch.instanceCapacity = std::max(count + count / 2, 16u);
+            batch.instanceBuffer = bgfx::createDynamicVertexBuffer(batch.instanceCapacity, s_instanceLayout);
+            if (!bgfx::isValid(batch.instanceBuffer))
+            {
+                std::cerr << "[ERROR] Failed to create instance buffer for batch of " << count << " instances." << std::endl;
+                batch.instanceCapacity = 0;
+                batch.uploadedTransforms.clear();
+                return false;
+            }
+
+            bgfx::update(batch.instanceBuffer, 0, CopyInstanceTransforms(batch.mesh, transforms, count));
+            batch.uploadedTransforms.assign(transforms, transforms + count);
+        }
+        else
+        {
+            // Find the range of transforms that differ from what is already on the GPU
+            uint32_t resident = static_cast<uint32_t>(batch.uploadedTransforms.size());
+            uint32_t dirtyBegin = count;
+            uint32_t dirtyEnd = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (i < resident && std::memcmp(&batch.uploadedTransforms[i], &transforms[i], sizeof(Matrix4)) == 0)
+                    continue;
+
+                if (dirtyBegin == count)
+                    dirtyBegin = i;
+                dirtyEnd = i + 1;
+            }
+
+            if (dirtyBegin < dirtyEnd)
+            {
+                bgfx::update(batch.instanceBuffer, dirtyBegin, CopyInstanceTransforms(batch.mesh, &transforms[dirtyBegin], dirtyEnd - dirtyBegin));
+
+                if (resident < count)
+                    batch.uploadedTransforms.resize(count);
+                std::memcpy(&batch.uploadedTransforms[dirtyBegin], &transforms[dirtyBegin], (dirtyEnd - dirtyBegin) * sizeof(Matrix4));
+            }
+        }
+
+        batch.lastSubmitFrame = s_renderer->currentFrame;
+        bgfx::setInstanceDataBuffer(batch.instanceBuffer, 0, count);
+        return true;
+    }
+
+    static void SubmitInstanceBatch(InstanceBatch& batch, const Matrix4* transforms, uint32_t count)
+    {
+        Mesh* mesh = batch.mesh;
+        Material* material = batch.material;
+        Shader* shader = batch.shader;
+
+        if (!BindBatchInstanceData(batch, transforms, count))
+            return;
+
+        BindMeshVertexBuffer(mesh, shader);
+        bgfx::setIndexBuffer(mesh->GetIndexBuffer());
 
         uint64_t state = BGFX_STATE_WRITE_RGB
             | BGFX_STATE_WRITE_A
@@ -419,68 +1069,87 @@ namespace cx
             | BGFX_STATE_MSAA
             | GetBlendState(s_renderer->currentBlendMode);
 
-        constexpr uint32_t maxInstancesPerBatch = 512; // Todo: Should this be higher?
-        uint32_t numInstances = static_cast<uint32_t>(transforms.size());
-        uint32_t instanceOffset = 0;
-        while (instanceOffset < numInstances)
+        if (Texture::HasStreamedTextures())
         {
-            uint32_t batchSize = std::min(maxInstancesPerBatch, numInstances - instanceOffset);
-            bgfx::InstanceDataBuffer idb;
-            bgfx::allocInstanceDataBuffer(&idb, batchSize, sizeof(Matrix4));
+            float screenPixels = 0.0f;
+            for (uint32_t i = 0; i < count; ++i)
+                screenPixels = std::max(screenPixels, GetScreenPixels(mesh->GetBoundingSphere().Transform(transforms[i])));
+            NoteTextureUsage(material, screenPixels);
+        }
 
-            // Check validity
-            if (!bgfx::isValid(idb.handle))
-            {
-                std::cerr << "[ERROR] Failed to allocate instance data buffer for batch of " << batchSize << " instances." << std::endl;
-                instanceOffset += batchSize;
-                continue;
-            }
+        // Uniforms are applied once for the whole batch
+        ApplyMaterial(material, shader, s_renderer->currentViewId, false);
 
-            // Copy transform data
-            std::memcpy(idb.data, &transforms[instanceOffset], batchSize * sizeof(Matrix4));
+        // Bone matrices
+        float skinned[4] = { mesh->IsSkinned() ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f };
+        bgfx::setUniform(u_IsSkinned, skinned);
 
-            // Bind buffers
-            bgfx::setVertexBuffer(0, mesh->GetVertexBuffer());
-            bgfx::setIndexBuffer(mesh->GetIndexBuffer());
-            bgfx::setInstanceDataBuffer(&idb);
+        float vertexDecode[4] = { static_cast<float>(mesh->GetUploadedNormalEncoding()), 0.0f, 0.0f, 0.0f };
+        bgfx::setUniform(u_VertexDecode, vertexDecode);
 
-            // Uniforms must be set each frame
+        if (mesh->IsSkinned() && batch.boneMatrices)
+        {
+            size_t numBones = batch.boneMatrices->size();
+            bgfx::setUniform(u_BoneMatrices, batch.boneMatrices->data(), static_cast<uint16_t>(numBones)); // Todo: There may be issues if the bones > max bones set when creating the u_boneMatrices
+        }
 
-            // Apply global uniforms
-            shader->ApplyUniforms();
+        bgfx::setState(state);
+        bgfx::submit(s_renderer->currentViewId, shader->GetHandle(), 0, BGFX_DISCARD_ALL);
 
-            // Apply material specific uniforms
-            material->ApplyShaderUniforms();
+        // Update stats
+        if (shader != s_renderer->lastShader)
+        {
+            s_renderer->drawStats.shaderSwitches++;
+            s_renderer->lastShader = shader;
+        }
 
-            // Apply PBR material map uniforms
-            material->ApplyPBRUniforms();
+        s_renderer->drawStats.drawCalls++;
+        s_renderer->drawStats.triangles += mesh->GetTriangleCount() * count;
+        s_renderer->drawStats.vertices += static_cast<uint32_t>(mesh->GetVertices().size()) * count;
+        s_renderer->drawStats.indicies += static_cast<uint32_t>(mesh->GetIndices().size()) * count;
+    }
 
-            // Bone matrices
-            float skinned[4] = { mesh->IsSkinned() ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f };
-            bgfx::setUniform(u_IsSkinned, skinned);
+    void DrawMeshInstanced(Mesh* mesh, const std::vector<Matrix4>& transforms, const std::vector<Matrix4>* boneMatrices)
+    {
+        if (!s_renderer || !mesh || !mesh->IsValid() || !mesh->GetMaterial() || !mesh->GetMaterial()->GetShader() || transforms.empty())
+            return;
 
-            if (mesh->IsSkinned() && boneMatrices)
+        // The whole batch is submitted if any instance is visible, so the persistent instance buffer stays unchanged
+        if (s_renderer->frustumCullingEnabled && s_renderer->hasViewFrustum)
+        {
+            const BoundingBox localBounds = boneMatrices && mesh->IsSkinned() ? mesh->GetSkinnedBounds(*boneMatrices) : mesh->GetBounds();
+            bool anyVisible = false;
+            for (const Matrix4& instanceTransform : transforms)
             {
-                if (boneMatrices && mesh->IsSkinned())
+                if (s_renderer->viewFrustum.Intersects(localBounds.Transform(instanceTransform)))
                 {
-                    size_t numBones = boneMatrices->size();
-                    //std::vector<Matrix4> transposedBones(numBones);
-                    //for (size_t i = 0; i < numBones; ++i)
-                    //    transposedBones[i] = (*boneMatrices)[i].Transpose();
-                    bgfx::setUniform(u_BoneMatrices, boneMatrices->data(), static_cast<uint16_t>(numBones)); // Todo: There may be issues if the bones > max bones set when creating the u_boneMatrices
+                    anyVisible = true;
+                    break;
                 }
             }
 
-            bgfx::setState(state);
-            bgfx::submit(s_renderer->currentViewId, shader->GetHandle());
+            if (!anyVisible)
+            {
+                s_renderer->drawStats.culledObjects += static_cast<int>(transforms.size());
+                return;
+            }
+        }
+        s_renderer->drawStats.visibleObjects += static_cast<int>(transforms.size());
 
-            // Update stats
-            s_renderer->drawStats.drawCalls++;
-            s_renderer->drawStats.triangles += mesh->GetTriangleCount() * batchSize;
-            s_renderer->drawStats.vertices += static_cast<uint32_t>(mesh->GetVertices().size()) * batchSize;
-            s_renderer->drawStats.indicies += static_cast<uint32_t>(mesh->GetIndices().size()) * batchSize;
-            instanceOffset += batchSize;
+        InstanceBatchKey key{ mesh, mesh->GetMaterial(), mesh->GetMaterial()->GetShader(), boneMatrices };
+        auto it = s_instanceBatches.find(key);
+        if (it == s_instanceBatches.end())
+        {
+            InstanceBatch batch;
+            batch.mesh = mesh;
+            batch.material = key.material;
+            batch.shader = key.shader;
+            batch.boneMatrices = boneMatrices;
+            batch.isSkinned = mesh->IsSkinned();
+            it = s_instanceBatches.emplace(key, std::move(batch)).first;
         }
+
+        SubmitInstanceBatch(it->second, transforms.data(), static_cast<uint32_t>(transforms.size()));
     }
 
     void DrawModelInstanced(Model* model, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
@@ -515,6 +1184,24 @@ namespace cx
             return;
         }
 
+        // Culled instances are never added to the batches
+        if (s_renderer->frustumCullingEnabled && s_renderer->hasViewFrustum)
+        {
+            BoundingBox modelBounds;
+            for (const auto& mesh : model->GetMeshes())
+            {
+                if (mesh)
+                    modelBounds.Expand(GetMeshWorldBounds(mesh.get(), baseTransform, bones));
+            }
+
+            if (!s_renderer->viewFrustum.Intersects(modelBounds))
+            {
+                s_renderer->drawStats.culledObjects += static_cast<int>(model->GetMeshes().size());
+                return;
+            }
+        }
+        s_renderer->drawStats.visibleObjects += static_cast<int>(model->GetMeshes().size());
+
         for (const auto& mesh : model->GetMeshes())
         {
             if (!mesh || !mesh->IsValid() || !mesh->GetMaterial() || !mesh->GetMaterial()->GetShader())
@@ -563,8 +1250,8 @@ namespace cx
             if (batch.transforms.empty())
                 continue;
 
-            DrawMeshInstanced(batch.mesh, batch.transforms, batch.boneMatrices);
-            pair.second.Clear();
+            SubmitInstanceBatch(batch, batch.transforms.data(), static_cast<uint32_t>(batch.transforms.size()));
+            batch.Clear();
         }
     }
 
@@ -578,6 +1265,34 @@ namespace cx
         // Todo: Depth test state is set per-draw call in bgfx
     }
 
+    void SetDrawQueueEnabled(bool enabled)
+    {
+        if (!s_renderer || s_renderer->drawQueueEnabled == enabled)
+            return;
+
+        // Draws recorded so far still go out this frame
+        if (!enabled)
+            FlushDrawQueue();
+
+        s_renderer->drawQueueEnabled = enabled;
+    }
+
+    bool IsDrawQueueEnabled()
+    {
+        return s_renderer && s_renderer->drawQueueEnabled;
+    }
+
+    void SetFrustumCulling(bool enabled)
+    {
+        if (s_renderer)
+            s_renderer->frustumCullingEnabled = enabled;
+    }
+
+    bool IsFrustumCullingEnabled()
+    {
+        return s_renderer && s_renderer->frustumCullingEnabled;
+    }
+
     void SetWireframe(bool enabled)
     {
         if (enabled)
@@ -601,6 +1316,27 @@ namespace cx
         return BGFX_INVALID_HANDLE;
     }
 
+    void SetViewSequentialForFrame(uint16_t viewId)
+    {
+        if (!s_renderer)
+            return;
+
+        std::vector<uint16_t>& views = s_renderer->sequentialViews;
+        if (std::find(views.begin(), views.end(), viewId) != views.end())
+            return;
+
+        bgfx::setViewMode(viewId, bgfx::ViewMode::Sequential);
+        views.push_back(viewId);
+    }
+
+    void InvalidateBoundMaterial()
+    {
+        s_boundShader = nullptr;
+        s_boundMaterial = nullptr;
+        s_boundViewId = UINT16_MAX;
+        s_boundBones = nullptr;
+    }
+
     // Blend Mode
 
     void SetBlendMode(BlendMode mode)
@@ -652,6 +1388,16 @@ namespace cx
         return s_renderer ? s_renderer->drawStats.shaderSwitches : 0;
     }
 
+    int GetCulledObjectCount()
+    {
+        return s_renderer ? s_renderer->drawStats.culledObjects : 0;
+    }
+
+    int GetVisibleObjectCount()
+    {
+        return s_renderer ? s_renderer->drawStats.visibleObjects : 0;
+    }
+
     float GetCPUFrameTime()
     {
         return s_renderer ? s_renderer->drawStats.cpuTime : 0.0f;
@@ -3,6 +3,10 @@
 #include <fstream>
 #include <vector>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
 #include <bgfx.h>
 
 namespace cx
@@ -10,15 +14,102 @@ namespace cx
     std::vector<Shader*> Shader::s_shaders;
     Shader* s_defaultShader = nullptr;
 
+    // Flat open addressing table of the bgfx uniforms a shader created, keyed by UniformId hash with linear probing.
+    // Entries are only ever added or cleared all at once, so there are no tombstones.
+    class UniformHandleTable
+    {
+    public:
+        struct Entry
+        {
+            UniformId id; // Interned
+            bgfx::UniformHandle handle = BGFX_INVALID_HANDLE;
+            uint8_t stage = 255; // Samplers only
+            bool used = false;
+        };
+
+        Entry* Find(UniformId id)
+        {
+            if (m_entries.empty())
+                return nullptr;
+
+            const size_t mask = m_entries.size() - 1;
+            for (size_t i = id.GetHash() & mask;; i = (i + 1) & mask)
+            {
+                Entry& entry = m_entries[i];
+                if (!entry.used)
+                    return nullptr;
+                if (entry.id == id)
+                    return &entry;
+            }
+        }
+
+        Entry& FindOrInsert(UniformId id)
+        {
+            if (Entry* entry = Find(id))
+                return *entry;
+
+            // Keep the load factor under 3/4
+            if ((m_count + 1) * 4 > m_entries.size() * 3)
+                Rehash(m_entries.empty() ? 16 : m_entries.size() * 2);
+
+            Entry& entry = Slot(id.GetHash());
+            entry.id = UniformId::Intern(id.GetName());
+            entry.used = true;
+            ++m_count;
+            return entry;
+        }
+
+        template<typename Func>
+        void ForEach(Func&& func)
+        {
+            for (Entry& entry : m_entries)
+            {
+                if (entry.used)
+                    func(entry);
+            }
+        }
+
+        void Clear()
+        {
+            m_entries.clear();
+            m_count = 0;
+        }
+
+    private:
+        std::vector<Entry> m_entries; // Size is zero or a power of two
+        size_t m_count = 0;
+
+        // Returns the first free slot for the hash
+        Entry& Slot(uint32_t hash)
+        {
+            const size_t mask = m_entries.size() - 1;
+            size_t i = hash & mask;
+            while (m_entries[i].used)
+                i = (i + 1) & mask;
+            return m_entries[i];
+        }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<Entry> old = std::move(m_entries);
+            m_entries.assign(capacity, Entry());
+            for (Entry& entry : old)
+            {
+                if (entry.used)
+                    Slot(entry.id.GetHash()) = entry;
+            }
+        }
+    };
+
     struct ShaderImpl
     {
         bgfx::ShaderHandle vertex = BGFX_INVALID_HANDLE;
         bgfx::ShaderHandle fragment = BGFX_INVALID_HANDLE;
         bgfx::ProgramHandle program = BGFX_INVALID_HANDLE;
-        mutable std::unordered_map<std::string, bgfx::UniformHandle> uniforms;
-        mutable std::unordered_map<std::string, bgfx::UniformHandle> samplerUniforms;
-        mutable std::unordered_map<std::string, uint8_t> samplerStages;
-        mutable uint8_t nextSamplerStage = 0;
+        mutable UniformHandleTable uniforms;
+        mutable UniformHandleTable samplerUniforms;
+        bool gpuMorphTargets = false;
+        bool packedMaterialBlock = false;
     };
 
     Shader* LoadDefaultShader(std::string_view vertexPath, std::string_view fragmentPath)
@@ -174,10 +265,28 @@ namespace cx
         }
 
         // Reset caches
-        m_impl->uniforms.clear();
-        m_impl->samplerUniforms.clear();
-        m_impl->samplerStages.clear();
-        m_impl->nextSamplerStage = 0;
+        m_impl->uniforms.Clear();
+        m_impl->samplerUniforms.Clear();
+
+        // Optional features are detected from the uniforms the shaders declare
+        m_impl->gpuMorphTargets = false;
+        m_impl->packedMaterialBlock = false;
+        for (bgfx::ShaderHandle stage : { m_impl->vertex, m_impl->fragment })
+        {
+            bgfx::UniformHandle declared[64];
+            const uint16_t declaredCount = std::min<uint16_t>(bgfx::getShaderUniforms(stage, declared, 64), 64);
+            for (uint16_t i = 0; i < declaredCount; ++i)
+            {
+                bgfx::UniformInfo info;
+                bgfx::getUniformInfo(declared[i], info);
+                if (stage.idx == m_impl->vertex.idx && std::strcmp(info.name, "u_MorphWeights") == 0)
+                    m_impl->gpuMorphTargets = true;
+                else if (std::strcmp(info.name, "u_MaterialBlock") == 0)
+                    m_impl->packedMaterialBlock = true;
+            }
+        }
+
+        ++m_version;
         return true;
     }
 
@@ -205,22 +314,16 @@ namespace cx
         }
 
         // Destroy uniforms and samplers
-        for (auto& p : m_impl->uniforms)
-        {
-            if (bgfx::isValid(p.second))
-                bgfx::destroy(p.second);
-        }
-        m_impl->uniforms.clear();
-
-        for (auto& p : m_impl->samplerUniforms)
+        auto destroyUniform = [](UniformHandleTable::Entry& entry)
         {
-            if (bgfx::isValid(p.second))
-                bgfx::destroy(p.second);
-        }
-        m_impl->samplerUniforms.clear();
+            if (bgfx::isValid(entry.handle))
+                bgfx::destroy(entry.handle);
+        };
+        m_impl->uniforms.ForEach(destroyUniform);
+        m_impl->uniforms.Clear();
 
-        m_impl->samplerStages.clear();
-        m_impl->nextSamplerStage = 0;
+        m_impl->samplerUniforms.ForEach(destroyUniform);
+        m_impl->samplerUniforms.Clear();
     }
 
     bool Shader::IsValid() const
@@ -228,6 +331,16 @@ namespace cx
         return m_impl && bgfx::isValid(m_impl->program);
     }
 
+    bool Shader::SupportsGPUMorphTargets() const
+    {
+        return m_impl && m_impl->gpuMorphTargets;
+    }
+
+    bool Shader::UsesPackedMaterialBlock() const
+    {
+        return m_impl && m_impl->packedMaterialBlock;
+    }
+
     // Uniform functions
 
     //bool Shader::HasUniform(std::string_view name) const
@@ -238,176 +351,195 @@ namespace cx
     //    return m_impl->uniforms.find(name.data()) != m_impl->uniforms.end() || m_impl->samplerUniforms.find(name.data()) != m_impl->samplerUniforms.end();
     //}
 
-    void Shader::SetUniform(std::string_view name, float v)
+    void Shader::SetUniform(UniformId id, float v)
     {
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
-        {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = v;
-            uniform.type = UniformType::Vec4;
-        }
-        else
-        {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Vec4, v });
-        }
+        if (m_Uniforms.Set(id, UniformType::Vec4, v))
+            ++m_version;
     }
 
-    void Shader::SetUniform(std::string_view name, int v)
+    void Shader::SetUniform(UniformId id, int v)
     {
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
-        {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = v;
-            uniform.type = UniformType::Vec4;
-        }
-        else
-        {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Vec4, v });
-        }
+        if (m_Uniforms.Set(id, UniformType::Vec4, v))
+            ++m_version;
     }
 
-    void Shader::SetUniform(std::string_view name, const float(&v2)[2])
+    void Shader::SetUniform(UniformId id, const float(&v2)[2])
     {
-        std::array<float, 2> arr{ v2[0], v2[1] };
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
-        {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = arr;
-            uniform.type = UniformType::Vec4;
-        }
-        else
-        {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Vec4, arr });
-        }
+        if (m_Uniforms.Set(id, UniformType::Vec4, std::array<float, 2>{ v2[0], v2[1] }))
+            ++m_version;
     }
 
-    void Shader::SetUniform(std::string_view name, const float(&v3)[3])
+    void Shader::SetUniform(UniformId id, const float(&v3)[3])
     {
-        std::array<float, 3> arr{ v3[0], v3[1], v3[2] };
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
-        {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = arr;
-            uniform.type = UniformType::Vec4;
-        }
-        else
-        {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Vec4, arr });
-        }
+        if (m_Uniforms.Set(id, UniformType::Vec4, std::array<float, 3>{ v3[0], v3[1], v3[2] }))
+            ++m_version;
     }
 
-    void Shader::SetUniform(std::string_view name, const float(&v4)[4])
+    void Shader::SetUniform(UniformId id, const float(&v4)[4])
     {
-        std::array<float, 4> arr{ v4[0], v4[1], v4[2], v4[3] };
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
-        {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = arr;
-            uniform.type = UniformType::Vec4;
-        }
-        else
-        {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Vec4, arr });
-        }
+        if (m_Uniforms.Set(id, UniformType::Vec4, std::array<float, 4>{ v4[0], v4[1], v4[2], v4[3] }))
+            ++m_version;
     }
 
-    void Shader::SetUniform(std::string_view name, const float(&m4)[16])
+    void Shader::SetUniform(UniformId id, const float(&m4)[16])
     {
         std::array<float, 16> arr;
         std::copy(std::begin(m4), std::end(m4), arr.begin());
 
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
+        if (m_Uniforms.Set(id, UniformType::Mat4, arr))
+            ++m_version;
+    }
+
+    void Shader::SetUniform(UniformId id, Texture* texture)
+    {
+        if (m_Uniforms.Set(id, UniformType::Sampler, texture))
+            ++m_version;
+    }
+
+    // Uniform table
+
+    UniformId UniformId::Intern(std::string_view name)
+    {
+        // Nodes of an unordered_set never move, so the stored names stay valid
+        static std::unordered_set<std::string> s_names;
+        static std::mutex s_mutex;
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto it = s_names.find(std::string(name));
+        if (it == s_names.end())
+            it = s_names.emplace(name).first;
+
+        return UniformId(std::string_view(*it));
+    }
+
+    bool ShaderUniformTable::Set(UniformId id, UniformType type, const ShaderUniformValue& value)
+    {
+        ShaderUniform* uniform = Find(id);
+        if (!uniform)
         {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = arr;
-            uniform.type = UniformType::Mat4;
+            m_uniforms.push_back({ UniformId::Intern(id.GetName()), type, value });
+            return true;
         }
-        else
+
+        if (uniform->type == type && uniform->value == value)
+            return false;
+
+        // A different uniform type needs a different handle
+        if (uniform->type != type)
         {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Mat4, arr });
+            uniform->cachedUniform = BGFX_INVALID_HANDLE;
+            uniform->cachedStage = 255;
         }
+
+        uniform->type = type;
+        uniform->value = value;
+        return true;
+    }
+
+    bool ShaderUniformTable::Remove(UniformId id)
+    {
+        ShaderUniform* uniform = Find(id);
+        if (!uniform)
+            return false;
+
+        // Order doesn't matter, so swap with the last entry instead of shifting
+        *uniform = std::move(m_uniforms.back());
+        m_uniforms.pop_back();
+        return true;
     }
 
-    void Shader::SetUniform(std::string_view name, Texture* texture)
+    ShaderUniform* ShaderUniformTable::Find(UniformId id)
     {
-        auto it = m_UniformIndices.find(name.data());
-        if (it != m_UniformIndices.end())
+        for (ShaderUniform& uniform : m_uniforms)
         {
-            auto& uniform = m_Uniforms[it->second];
-            uniform.value = texture;
-            uniform.type = UniformType::Sampler;
+            if (uniform.id == id)
+                return &uniform;
         }
-        else
+        return nullptr;
+    }
+
+    void ShaderUniformTable::ResetHandles()
+    {
+        for (ShaderUniform& uniform : m_uniforms)
         {
-            m_UniformIndices[name.data()] = m_Uniforms.size();
-            m_Uniforms.push_back({ name.data(), UniformType::Sampler, texture });
+            uniform.cachedUniform = BGFX_INVALID_HANDLE;
+            uniform.cachedStage = 255;
         }
     }
 
+    bool ShaderUniformTable::HasChangedTextures() const
+    {
+        for (const ShaderUniform& uniform : m_uniforms)
+        {
+            if (uniform.value.index() != 6 || uniform.cachedStage == 255)
+                continue;
+
+            const Texture* texture = std::get<Texture*>(uniform.value);
+            if (texture && texture->GetHandle().idx != uniform.appliedTexture)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t Shader::GetVersion()
+    {
+        if (m_Uniforms.HasChangedTextures())
+            ++m_version;
+
+        return m_version;
+    }
+
     // Internal uniform functions
 
-    bgfx::UniformHandle Shader::GetOrCreateUniform(std::string_view name, UniformType type, uint16_t num) const
+    bgfx::UniformHandle Shader::GetOrCreateUniform(UniformId id, UniformType type, uint16_t num) const
     {
         if (!m_impl)
             return BGFX_INVALID_HANDLE;
 
-        auto it = m_impl->uniforms.find(name.data());
-        if (it != m_impl->uniforms.end())
-            return it->second;
+        if (UniformHandleTable::Entry* entry = m_impl->uniforms.Find(id))
+            return entry->handle;
 
-        bgfx::UniformHandle h = bgfx::createUniform(name.data(), ToBgfxUniformType(type), num);
+        bgfx::UniformHandle h = bgfx::createUniform(std::string(id.GetName()).c_str(), ToBgfxUniformType(type), num);
         if (!bgfx::isValid(h))
         {
-            std::cerr << "Shader::getOrCreateUniform: failed to create uniform " << name << std::endl;
+            std::cerr << "Shader::getOrCreateUniform: failed to create uniform " << id.GetName() << std::endl;
             return BGFX_INVALID_HANDLE;
         }
 
-        m_impl->uniforms[name.data()] = h;
+        m_impl->uniforms.FindOrInsert(id).handle = h;
         return h;
     }
 
 
-    bgfx::UniformHandle Shader::GetOrCreateSamplerUniform(std::string_view name) const
+    bgfx::UniformHandle Shader::GetOrCreateSamplerUniform(UniformId id) const
     {
         if (!m_impl)
             return BGFX_INVALID_HANDLE;
 
-        auto it = m_impl->samplerUniforms.find(name.data());
-        if (it != m_impl->samplerUniforms.end())
-            return it->second;
+        UniformHandleTable::Entry* entry = m_impl->samplerUniforms.Find(id);
+        if (entry && bgfx::isValid(entry->handle))
+            return entry->handle;
 
-        bgfx::UniformHandle h = bgfx::createUniform(name.data(), bgfx::UniformType::Sampler);
+        bgfx::UniformHandle h = bgfx::createUniform(std::string(id.GetName()).c_str(), bgfx::UniformType::Sampler);
         if (!bgfx::isValid(h))
         {
-            std::cerr << "Shader::SetUniform: failed to create sampler uniform " << name << std::endl;
+            std::cerr << "Shader::SetUniform: failed to create sampler uniform " << id.GetName() << std::endl;
             return BGFX_INVALID_HANDLE;
         }
 
-        m_impl->samplerUniforms[name.data()] = h;
+        m_impl->samplerUniforms.FindOrInsert(id).handle = h;
         return h;
     }
 
 
-    uint8_t Shader::GetSamplerStage(std::string_view name) const
+    uint8_t Shader::GetSamplerStage(UniformId id) const
     {
         if (!m_impl)
             return 255;
 
-        auto it = m_impl->samplerStages.find(name.data());
-        if (it != m_impl->samplerStages.end())
-            return it->second;
+        UniformHandleTable::Entry* entry = m_impl->samplerUniforms.Find(id);
+        if (entry && entry->stage != 255)
+            return entry->stage;
 
         static const std::unordered_map<std::string_view, uint8_t> g_samplerStages = {
             {"u_AlbedoMap", 0},
@@ -421,94 +553,94 @@ namespace cx
             {"u_OpacityMap", 8}
         };
 
-        auto globalIt = g_samplerStages.find(name);
+        auto globalIt = g_samplerStages.find(id.GetName());
         if (globalIt == g_samplerStages.end())
         {
-            std::cerr << "[Error] Shader::SetUniform - Unknown sampler name " << name << std::endl;
+            std::cerr << "[Error] Shader::SetUniform - Unknown sampler name " << id.GetName() << std::endl;
             return 255;
         }
 
         uint8_t stage = globalIt->second;
-        m_impl->samplerStages[name.data()] = stage;
+        m_impl->samplerUniforms.FindOrInsert(id).stage = stage;
         return stage;
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, float v) const
+    void Shader::SetUniformInternal(UniformId id, float v) const
     {
         if (!m_impl)
             return;
 
         thread_local float tmp[4] = { v, 0.0f, 0.0f, 0.0f };
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Vec4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Vec4, 1);
 
         if (bgfx::isValid(h))
             bgfx::setUniform(h, tmp);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, int v) const
+    void Shader::SetUniformInternal(UniformId id, int v) const
     {
         if (!m_impl)
             return;
 
         thread_local float tmp[4] = { static_cast<float>(v), 0.0f, 0.0f, 0.0f };
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Vec4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Vec4, 1);
 
         if (bgfx::isValid(h))
             bgfx::setUniform(h, tmp);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, const float(&v2)[2]) const
+    void Shader::SetUniformInternal(UniformId id, const float(&v2)[2]) const
     {
         if (!m_impl)
             return;
 
         thread_local float tmp[4] = { v2[0], v2[1], 0.0f, 0.0f };
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Vec4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Vec4, 1);
 
         if (bgfx::isValid(h))
             bgfx::setUniform(h, tmp);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, const float(&v3)[3]) const
+    void Shader::SetUniformInternal(UniformId id, const float(&v3)[3]) const
     {
         if (!m_impl)
             return;
 
         thread_local float tmp[4] = { v3[0], v3[1], v3[2], 0.0f };
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Vec4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Vec4, 1);
 
         if (bgfx::isValid(h))
             bgfx::setUniform(h, tmp);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, const float(&v4)[4]) const
+    void Shader::SetUniformInternal(UniformId id, const float(&v4)[4]) const
     {
         if (!m_impl)
             return;
 
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Vec4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Vec4, 1);
         if (bgfx::isValid(h))
             bgfx::setUniform(h, v4);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, const float(&m4)[16]) const
+    void Shader::SetUniformInternal(UniformId id, const float(&m4)[16]) const
     {
         if (!m_impl)
             return;
 
-        bgfx::UniformHandle h = GetOrCreateUniform(name, UniformType::Mat4, 1);
+        bgfx::UniformHandle h = GetOrCreateUniform(id, UniformType::Mat4, 1);
         if (bgfx::isValid(h))
             bgfx::setUniform(h, m4);
     }
 
 
-    void Shader::SetUniformInternal(std::string_view name, const Texture* texture) const
+    void Shader::SetUniformInternal(UniformId id, const Texture* texture) const
     {
         if (!m_impl || !texture)
             return;
@@ -517,11 +649,11 @@ namespace cx
         if (!bgfx::isValid(handle))
             return;
 
-        bgfx::UniformHandle sampler = GetOrCreateSamplerUniform(name);
+        bgfx::UniformHandle sampler = GetOrCreateSamplerUniform(id);
         if (!bgfx::isValid(sampler))
             return;
 
-        uint8_t stage = GetSamplerStage(name);
+        uint8_t stage = GetSamplerStage(id);
         if (stage == 255)
             return;
 
@@ -539,67 +671,75 @@ namespace cx
 
     void Shader::ApplyUniforms()
     {
-        for (ShaderUniform& param : m_Uniforms)
+        ApplyUniformTable(m_Uniforms);
+    }
+
+    void Shader::ApplyUniformTable(ShaderUniformTable& uniforms) const
+    {
+        for (ShaderUniform& param : uniforms)
         {
-            std::visit([this, &param](auto&& arg)
+            // Resolve the handle once, it stays cached in the table entry
+            if (!bgfx::isValid(param.cachedUniform))
             {
-                using T = std::decay_t<decltype(arg)>;
-
-                if (!bgfx::isValid(param.cachedUniform))
+                if (param.type == UniformType::Sampler)
                 {
-                    if constexpr (std::is_same_v<T, Texture*>)
-                    {
-                        param.cachedUniform = GetOrCreateSamplerUniform(param.name);
-                        param.cachedStage = GetSamplerStage(param.name);
-                    }
-                    else
-                    {
-                        UniformType utype;
-
-                        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int> || std::is_same_v<T, std::array<float, 2>> || std::is_same_v<T, std::array<float, 3>> || std::is_same_v<T, std::array<float, 4>>)
-                            utype = UniformType::Vec4;
-                        else if constexpr (std::is_same_v<T, std::array<float, 16>>)
-                            utype = UniformType::Mat4;
-
-                        param.cachedUniform = GetOrCreateUniform(param.name, utype, 1);
-                    }
+                    param.cachedUniform = GetOrCreateSamplerUniform(param.id);
+                    param.cachedStage = GetSamplerStage(param.id);
                 }
+                else
+                    param.cachedUniform = GetOrCreateUniform(param.id, param.type, 1);
 
-                if constexpr (std::is_same_v<T, Texture*>)
-                {
-                    if (arg && bgfx::isValid(param.cachedUniform) && param.cachedStage != 255)
-                    {
-                        bgfx::TextureHandle handle = arg->GetHandle();
-                        if (bgfx::isValid(handle))
-                            bgfx::setTexture(param.cachedStage, param.cachedUniform, handle);
-                    }
-                }
-                else if (bgfx::isValid(param.cachedUniform))
+                if (!bgfx::isValid(param.cachedUniform))
+                    continue;
+            }
+
+            switch (param.value.index())
+            {
+            case 0: // float
+            {
+                float tmp[4] = { std::get<float>(param.value), 0.0f, 0.0f, 0.0f };
+                bgfx::setUniform(param.cachedUniform, tmp);
+                break;
+            }
+            case 1: // int
+            {
+                float tmp[4] = { static_cast<float>(std::get<int>(param.value)), 0.0f, 0.0f, 0.0f };
+                bgfx::setUniform(param.cachedUniform, tmp);
+                break;
+            }
+            case 2: // vec2
+            {
+                const auto& v = std::get<std::array<float, 2>>(param.value);
+                float tmp[4] = { v[0], v[1], 0.0f, 0.0f };
+                bgfx::setUniform(param.cachedUniform, tmp);
+                break;
+            }
+            case 3: // vec3
+            {
+                const auto& v = std::get<std::array<float, 3>>(param.value);
+                float tmp[4] = { v[0], v[1], v[2], 0.0f };
+                bgfx::setUniform(param.cachedUniform, tmp);
+                break;
+            }
+            case 4: // vec4
+                bgfx::setUniform(param.cachedUniform, std::get<std::array<float, 4>>(param.value).data());
+                break;
+            case 5: // mat4
+                bgfx::setUniform(param.cachedUniform, std::get<std::array<float, 16>>(param.value).data());
+                break;
+            case 6: // texture
+            {
+                Texture* texture = std::get<Texture*>(param.value);
+                if (texture && param.cachedStage != 255)
                 {
-                    if constexpr (std::is_same_v<T, float>)
-                    {
-                        float tmp[4] = { arg, 0.0f, 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, int>)
-                    {
-                        float tmp[4] = { static_cast<float>(arg), 0.0f, 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 2>>)
-                    {
-                        float tmp[4] = { arg[0], arg[1], 0.0f, 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 3>>)
-                    {
-                        float tmp[4] = { arg[0], arg[1], arg[2], 0.0f };
-                        bgfx::setUniform(param.cachedUniform, tmp);
-                    }
-                    else if constexpr (std::is_same_v<T, std::array<float, 4>> || std::is_same_v<T, std::array<float, 16>>)
-                        bgfx::setUniform(param.cachedUniform, arg.data());
+                    bgfx::TextureHandle handle = texture->GetHandle();
+                    param.appliedTexture = handle.idx;
+                    if (bgfx::isValid(handle))
+                        bgfx::setTexture(param.cachedStage, param.cachedUniform, handle);
                 }
-            }, param.value);
+                break;
+            }
+            }
         }
     }
-}
\ No newline at end of file
+}
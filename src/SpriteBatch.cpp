@@ -0,0 +1,335 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace cx
+{
+    // Transient indices are 16 bit, so each transient buffer holds at most this many vertices
+    static constexpr uint32_t s_maxChunkVertices = UINT16_MAX;
+    static constexpr int s_maxCircleSegments = 1024;
+
+    static uint32_t PackColor(const Color& color)
+    {
+        return uint32_t(color.r) | (uint32_t(color.g) << 8) | (uint32_t(color.b) << 16) | (uint32_t(color.a) << 24);
+    }
+
+    SpriteBatch::SpriteBatch()
+    {
+        m_layout
+            .begin()
+            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+            .end();
+    }
+
+    SpriteBatch::~SpriteBatch()
+    {
+        // The renderer is gone after cx::Shutdown(), and bgfx with it
+        if (s_renderer && bgfx::isValid(m_textureSampler))
+            bgfx::destroy(m_textureSampler);
+    }
+
+    void SpriteBatch::Begin(SpriteSortMode sortMode)
+    {
+        m_sortMode = sortMode;
+        m_viewId = s_renderer ? s_renderer->currentViewId : 0;
+    }
+
+    void SpriteBatch::End()
+    {
+        Flush();
+    }
+
+    void SpriteBatch::DrawTexture(Texture* texture, const Vector2& position, const Color& tint)
+    {
+        if (!texture || !texture->IsValid())
+            return;
+
+        AddQuad(texture->GetHandle(), Rect(position.x, position.y, float(texture->GetWidth()), float(texture->GetHeight())), Vector2(), 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, tint);
+    }
+
+    void SpriteBatch::DrawTexture(Texture* texture, const Vector2& position, float rotation, float scale, const Color& tint)
+    {
+        if (!texture || !texture->IsValid())
+            return;
+
+        AddQuad(texture->GetHandle(), Rect(position.x, position.y, texture->GetWidth() * scale, texture->GetHeight() * scale), Vector2(), rotation, 0.0f, 0.0f, 1.0f, 1.0f, tint);
+    }
+
+    void SpriteBatch::DrawTextureRec(Texture* texture, const Rect& source, const Vector2& position, const Color& tint)
+    {
+        if (!texture)
+            return;
+
+        DrawTexturePro(texture, source, Rect(position.x, position.y, std::fabs(source.width), std::fabs(source.height)), Vector2(), 0.0f, tint);
+    }
+
+    void SpriteBatch::DrawTexturePro(Texture* texture, const Rect& source, const Rect& dest, const Vector2& origin, float rotation, const Color& tint)
+    {
+        if (!texture || !texture->IsValid() || texture->GetWidth() <= 0 || texture->GetHeight() <= 0)
+            return;
+
+        const float invWidth = 1.0f / texture->GetWidth();
+        const float invHeight = 1.0f / texture->GetHeight();
+        AddQuad(texture->GetHandle(), dest, origin, rotation,
+            source.x * invWidth, source.y * invHeight, (source.x + source.width) * invWidth, (source.y + source.height) * invHeight, tint);
+    }
+
+    void SpriteBatch::DrawRegion(const TextureAtlas& atlas, const AtlasRegion& region, const Vector2& position, const Color& tint)
+    {
+        DrawRegion(atlas, region, Rect(position.x, position.y, float(region.width), float(region.height)), Vector2(), 0.0f, tint);
+    }
+
+    void SpriteBatch::DrawRegion(const TextureAtlas& atlas, const AtlasRegion& region, const Rect& dest, const Vector2& origin, float rotation, const Color& tint)
+    {
+        Texture* page = atlas.GetPageTexture(region.page);
+        if (!page || !page->IsValid())
+            return;
+
+        AddQuad(page->GetHandle(), dest, origin, rotation, region.uvMin.x, region.uvMin.y, region.uvMax.x, region.uvMax.y, tint);
+    }
+
+    void SpriteBatch::DrawRectangle(const Rect& rect, const Color& color)
+    {
+        DrawRectangle(rect, Vector2(), 0.0f, color);
+    }
+
+    void SpriteBatch::DrawRectangle(const Rect& rect, const Vector2& origin, float rotation, const Color& color)
+    {
+        // Shapes sample the white placeholder, so they batch with each other like any other texture
+        AddQuad(Texture::GetPlaceholderTexture(TexturePlaceholder::White)->GetHandle(), rect, origin, rotation, 0.0f, 0.0f, 1.0f, 1.0f, color);
+    }
+
+    void SpriteBatch::DrawLine(const Vector2& start, const Vector2& end, float thickness, const Color& color)
+    {
+        const Vector2 direction = end - start;
+        const float length = direction.Length();
+        if (length <= 0.0f)
+            return;
+
+        const Vector2 side = Vector2(-direction.y, direction.x) * (thickness * 0.5f / length);
+        const Vector2 corners[4] = { start - side, end - side, start + side, end + side };
+        AddQuad(Texture::GetPlaceholderTexture(TexturePlaceholder::White)->GetHandle(), corners, 0.0f, 0.0f, 1.0f, 1.0f, color);
+    }
+
+    void SpriteBatch::DrawCircle(const Vector2& center, float radius, const Color& color, int segments)
+    {
+        if (radius <= 0.0f)
+            return;
+
+        // About one segment every 6 units of circumference
+        if (segments <= 0)
+            segments = static_cast<int>(std::ceil(2.0f * PI * radius / 6.0f));
+        segments = std::clamp(segments, 8, s_maxCircleSegments);
+
+        uint16_t* indices = nullptr;
+        SpriteVertex* vertices = AddItem(Texture::GetPlaceholderTexture(TexturePlaceholder::White)->GetHandle(), uint16_t(segments + 1), uint16_t(segments * 3), indices);
+        const uint32_t packed = PackColor(color);
+
+        vertices[0] = { center.x, center.y, 0.0f, 0.5f, 0.5f, packed };
+        const float step = 2.0f * PI / segments;
+        for (int i = 0; i < segments; ++i)
+        {
+            const float angle = step * i;
+            vertices[i + 1] = { center.x + std::cos(angle) * radius, center.y + std::sin(angle) * radius, 0.0f, 0.5f, 0.5f, packed };
+
+            indices[i * 3 + 0] = 0;
+            indices[i * 3 + 1] = uint16_t(i + 1);
+            indices[i * 3 + 2] = uint16_t(i + 1 < segments ? i + 2 : 1);
+        }
+    }
+
+    SpriteBatch::SpriteVertex* SpriteBatch::AddItem(bgfx::TextureHandle texture, uint16_t vertexCount, uint16_t indexCount, uint16_t*& outIndices)
+    {
+        const uint64_t sequence = m_items.size();
+        const uint64_t layer = uint64_t(std::clamp(m_layer, INT16_MIN, INT16_MAX) - INT16_MIN);
+
+        // Layer (16) | blend mode (4) | texture (16) | sequence (28) when sorting by texture, otherwise layer (16) | sequence (48)
+        SpriteItem item;
+        if (m_sortMode == SpriteSortMode::Texture)
+            item.key = (layer << 48) | ((uint64_t(m_blendMode) & 0xF) << 44) | (uint64_t(texture.idx) << 28) | (sequence & 0xFFFFFFF);
+        else
+            item.key = (layer << 48) | (sequence & 0xFFFFFFFFFFFF);
+
+        item.firstVertex = static_cast<uint32_t>(m_vertices.size());
+        item.firstIndex = static_cast<uint32_t>(m_indices.size());
+        item.vertexCount = vertexCount;
+        item.indexCount = indexCount;
+        item.texture = texture;
+        item.blendMode = m_blendMode;
+        m_items.push_back(item);
+
+        m_vertices.resize(m_vertices.size() + vertexCount);
+        m_indices.resize(m_indices.size() + indexCount);
+        outIndices = m_indices.data() + item.firstIndex;
+        return m_vertices.data() + item.firstVertex;
+    }
+
+    void SpriteBatch::AddQuad(bgfx::TextureHandle texture, const Vector2 (&corners)[4], float u0, float v0, float u1, float v1, const Color& color)
+    {
+        uint16_t* indices = nullptr;
+        SpriteVertex* vertices = AddItem(texture, 4, 6, indices);
+        const uint32_t packed = PackColor(color);
+
+        // Bottom left, bottom right, top left, top right. The top edge shows the source's first row.
+        vertices[0] = { corners[0].x, corners[0].y, 0.0f, u0, v1, packed };
+        vertices[1] = { corners[1].x, corners[1].y, 0.0f, u1, v1, packed };
+        vertices[2] = { corners[2].x, corners[2].y, 0.0f, u0, v0, packed };
+        vertices[3] = { corners[3].x, corners[3].y, 0.0f, u1, v0, packed };
+
+        static const uint16_t quadIndices[6] = { 0, 1, 2, 1, 3, 2 };
+        std::memcpy(indices, quadIndices, sizeof(quadIndices));
+    }
+
+    void SpriteBatch::AddQuad(bgfx::TextureHandle texture, const Rect& dest, const Vector2& origin, float rotation, float u0, float v0, float u1, float v1, const Color& color)
+    {
+        const float left = -origin.x;
+        const float bottom = -origin.y;
+        const float right = left + dest.width;
+        const float top = bottom + dest.height;
+
+        Vector2 corners[4];
+        if (rotation == 0.0f)
+        {
+            corners[0] = Vector2(dest.x + left, dest.y + bottom);
+            corners[1] = Vector2(dest.x + right, dest.y + bottom);
+            corners[2] = Vector2(dest.x + left, dest.y + top);
+            corners[3] = Vector2(dest.x + right, dest.y + top);
+        }
+        else
+        {
+            const float radians = rotation * PI / 180.0f;
+            const float c = std::cos(radians);
+            const float s = std::sin(radians);
+            auto rotate = [&](float x, float y) { return Vector2(dest.x + x * c - y * s, dest.y + x * s + y * c); };
+            corners[0] = rotate(left, bottom);
+            corners[1] = rotate(right, bottom);
+            corners[2] = rotate(left, top);
+            corners[3] = rotate(right, top);
+        }
+
+        AddQuad(texture, corners, u0, v0, u1, v1, color);
+    }
+
+    void SpriteBatch::Flush()
+    {
+        if (m_items.empty())
+            return;
+
+        if (!s_renderer || !m_shader || !m_shader->IsValid())
+        {
+            if (s_renderer)
+                std::cerr << "[ERROR] SpriteBatch: No valid shader set, dropping " << m_items.size() << " sprites. See SpriteBatch::SetShader()." << std::endl;
+
+            m_items.clear();
+            m_vertices.clear();
+            m_indices.clear();
+            return;
+        }
+
+        if (!bgfx::isValid(m_textureSampler))
+            m_textureSampler = bgfx::createUniform("u_SpriteTexture", bgfx::UniformType::Sampler);
+
+        m_order.resize(m_items.size());
+        for (uint32_t i = 0; i < m_order.size(); ++i)
+            m_order[i] = i;
+
+        std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) { return m_items[a].key < m_items[b].key; });
+
+        // bgfx would otherwise reorder the submits by state and undo the layering
+        SetViewSequentialForFrame(m_viewId);
+
+        bgfx::TextureHandle lastTexture = BGFX_INVALID_HANDLE;
+        size_t next = 0;
+        while (next < m_order.size())
+        {
+            // As many sprites as 16 bit indices can address
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+            size_t end = next;
+            while (end < m_order.size() && vertexCount + m_items[m_order[end]].vertexCount <= s_maxChunkVertices)
+            {
+                vertexCount += m_items[m_order[end]].vertexCount;
+                indexCount += m_items[m_order[end]].indexCount;
+                ++end;
+            }
+
+            bgfx::TransientVertexBuffer tvb;
+            bgfx::TransientIndexBuffer tib;
+            if (!bgfx::allocTransientBuffers(&tvb, m_layout, vertexCount, &tib, indexCount))
+            {
+                std::cerr << "[WARNING] SpriteBatch: Out of transient buffer space, dropping " << m_order.size() - next << " sprites this frame." << std::endl;
+                break;
+            }
+
+            SpriteVertex* dstVertices = reinterpret_cast<SpriteVertex*>(tvb.data);
+            uint16_t* dstIndices = reinterpret_cast<uint16_t*>(tib.data);
+            uint32_t chunkVertex = 0;
+            uint32_t chunkIndex = 0;
+            for (size_t i = next; i < end; ++i)
+            {
+                const SpriteItem& item = m_items[m_order[i]];
+                std::memcpy(dstVertices + chunkVertex, m_vertices.data() + item.firstVertex, item.vertexCount * sizeof(SpriteVertex));
+                for (uint16_t j = 0; j < item.indexCount; ++j)
+                    dstIndices[chunkIndex + j] = uint16_t(m_indices[item.firstIndex + j] + chunkVertex);
+
+                chunkVertex += item.vertexCount;
+                chunkIndex += item.indexCount;
+            }
+
+            // One submit per run of sprites sharing a texture and blend mode
+            uint32_t runFirstIndex = 0;
+            uint32_t runIndexCount = 0;
+            uint32_t runVertexCount = 0;
+            for (size_t i = next; i < end; ++i)
+            {
+                const SpriteItem& item = m_items[m_order[i]];
+                runIndexCount += item.indexCount;
+                runVertexCount += item.vertexCount;
+
+                const bool lastInRun = i + 1 == end
+                    || m_items[m_order[i + 1]].texture.idx != item.texture.idx
+                    || m_items[m_order[i + 1]].blendMode != item.blendMode;
+                if (!lastInRun)
+                    continue;
+
+                m_shader->ApplyUniforms();
+                bgfx::setVertexBuffer(0, &tvb);
+                bgfx::setIndexBuffer(&tib, runFirstIndex, runIndexCount);
+                bgfx::setTexture(0, m_textureSampler, item.texture);
+                bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_MSAA | GetBlendState(item.blendMode));
+                bgfx::submit(m_viewId, m_shader->GetHandle());
+
+                DrawStats& stats = s_renderer->drawStats;
+                stats.drawCalls++;
+                stats.triangles += runIndexCount / 3;
+                stats.vertices += runVertexCount;
+                stats.indicies += runIndexCount;
+                if (item.texture.idx != lastTexture.idx)
+                    stats.textureBinds++;
+                if (s_renderer->lastShader != m_shader)
+                {
+                    stats.shaderSwitches++;
+                    s_renderer->lastShader = m_shader;
+                }
+
+                lastTexture = item.texture;
+                runFirstIndex += runIndexCount;
+                runIndexCount = 0;
+                runVertexCount = 0;
+            }
+
+            next = end;
+        }
+
+        // These submits dropped the bindings the mesh draws rely on keeping
+        InvalidateBoundMaterial();
+
+        m_items.clear();
+        m_vertices.clear();
+        m_indices.clear();
+    }
+}
@@ -28,6 +28,9 @@ namespace cx
         , m_hasMipmaps(false)
         , m_cachePixelData(false)
         , m_readbackPending(false)
+        , m_streaming(nullptr)
+        , m_asyncLoadId(0)
+        , m_showsPlaceholder(false)
     {
         s_textures.push_back(this);
     }
@@ -113,7 +116,7 @@ namespace cx
         return bgfx::isValid(m_handle);
     }
 
-    bool Texture::LoadFromMemory(const void* data, int width, int height, int channels, bool isColorTexture)
+    bool Texture::LoadFromMemory(const void* data, int width, int height, int channels, bool isColorTexture, const MipGenerationOptions* mipOptions)
     {
         if (!data || width <= 0 || height <= 0)
         {
@@ -126,15 +129,22 @@ namespace cx
         if (isColorTexture)
             flags |= BGFX_TEXTURE_SRGB;
 
-        const bgfx::Memory* mem = bgfx::copy(data, static_cast<uint32_t>(width * height * channels));
-        m_handle = bgfx::createTexture2D(static_cast<uint16_t>(width), static_cast<uint16_t>(height), false, 1, format, flags, mem); // Todo: Mipmaps are default to false here
+        std::vector<uint8_t> mipChain;
+        if (mipOptions)
+            mipChain = GenerateMipChain(static_cast<const uint8_t*>(data), width, height, channels, isColorTexture, *mipOptions);
+
+        const bool hasMips = !mipChain.empty();
+        const bgfx::Memory* mem = hasMips ? bgfx::copy(mipChain.data(), static_cast<uint32_t>(mipChain.size())) : bgfx::copy(data, static_cast<uint32_t>(width * height * channels));
+        m_handle = bgfx::createTexture2D(static_cast<uint16_t>(width), static_cast<uint16_t>(height), hasMips, 1, format, flags, mem);
 
         m_width = width;
         m_height = height;
         m_channels = channels;
         m_format = format;
         m_isColorTexture = isColorTexture;
-        m_hasMipmaps = false;
+        m_hasMipmaps = hasMips;
+        if (hasMips)
+            m_mipOptions = *mipOptions;
 
         bool valid = bgfx::isValid(m_handle);
         if (!valid)
@@ -192,6 +202,38 @@ namespace cx
         return LoadFromMemory(data.data(), width, height, 4, true);
     }
 
+    bool Texture::CreateDynamic(int width, int height, int channels, bool isColorTexture)
+    {
+        if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
+        {
+            std::cerr << "[ERROR] Failed to create dynamic texture." << std::endl;
+            return false;
+        }
+
+        bgfx::TextureFormat::Enum format = ChannelsToFormat(channels);
+        uint64_t flags = BGFX_TEXTURE_NONE;
+        if (isColorTexture)
+            flags |= BGFX_TEXTURE_SRGB;
+
+        m_handle = bgfx::createTexture2D(static_cast<uint16_t>(width), static_cast<uint16_t>(height), false, 1, format, flags);
+
+        m_width = width;
+        m_height = height;
+        m_channels = channels;
+        m_format = format;
+        m_isColorTexture = isColorTexture;
+        m_hasMipmaps = false;
+
+        bool valid = bgfx::isValid(m_handle);
+        if (!valid)
+            std::cerr << "[ERROR] Failed to create dynamic texture." << std::endl;
+
+        if (valid && m_cachePixelData)
+            m_cachedPixelData.assign(size_t(width) * height * channels, 0);
+
+        return valid;
+    }
+
     bool Texture::SaveToFile(std::string_view path)
     {
         std::string pathStr(path);
@@ -274,6 +316,23 @@ namespace cx
         const bgfx::Memory* mem = bgfx::copy(data, m_width * m_height * channels);
         bgfx::updateTexture2D(m_handle, 0, 0, 0, 0, m_width, m_height, mem);
 
+        // The smaller mips would still show the old pixels
+        if (m_hasMipmaps && channels == m_channels)
+        {
+            std::vector<uint8_t> mipChain = GenerateMipChain(static_cast<const uint8_t*>(data), m_width, m_height, channels, m_isColorTexture, m_mipOptions);
+            size_t offset = size_t(m_width) * m_height * channels;
+            int width = m_width;
+            int height = m_height;
+            for (int mip = 1; mip < GetMipCount(m_width, m_height) && !mipChain.empty(); ++mip)
+            {
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+                const uint32_t size = uint32_t(width * height * channels);
+                bgfx::updateTexture2D(m_handle, 0, uint8_t(mip), 0, 0, uint16_t(width), uint16_t(height), bgfx::copy(mipChain.data() + offset, size));
+                offset += size;
+            }
+        }
+
         if (m_cachePixelData)
         {
             m_cachedPixelData.resize(m_width * m_height * channels);
@@ -283,6 +342,24 @@ namespace cx
         return true;
     }
 
+    bool Texture::UpdateRegion(int x, int y, int width, int height, const void* data)
+    {
+        if (!IsValid() || !data || width <= 0 || height <= 0 || x < 0 || y < 0 || x + width > m_width || y + height > m_height)
+            return false;
+
+        const uint32_t rowSize = uint32_t(width * m_channels);
+        bgfx::updateTexture2D(m_handle, 0, 0, uint16_t(x), uint16_t(y), uint16_t(width), uint16_t(height), bgfx::copy(data, rowSize * height));
+
+        if (m_cachePixelData && !m_cachedPixelData.empty())
+        {
+            const uint8_t* src = static_cast<const uint8_t*>(data);
+            for (int row = 0; row < height; ++row)
+                std::memcpy(m_cachedPixelData.data() + (size_t(y + row) * m_width + x) * m_channels, src + size_t(row) * rowSize, rowSize);
+        }
+
+        return true;
+    }
+
     Color Texture::GetPixel(int x, int y)
     {
         if (x < 0 || x >= m_width || y < 0 || y >= m_height)
@@ -312,60 +389,23 @@ namespace cx
 
         if (!EnsureCacheLoaded())
         {
-            QueueOperation(PendingOpType::SetPixel, x, y, color);
+            QueueSetPixel(x, y, color);
             return;
         }
 
-        int channels = m_channels > 0 ? m_channels : 4;
-        int idx = (y * m_width + x) * channels;
-
-        if (channels > 0)
-            m_cachedPixelData[idx + 0] = color.r;
-
-        if (channels > 1)
-            m_cachedPixelData[idx + 1] = color.g;
-
-        if (channels > 2)
-            m_cachedPixelData[idx + 2] = color.b;
-
-        if (channels > 3)
-            m_cachedPixelData[idx + 3] = color.a;
-
+        WritePixel(x, y, color);
         UpdateTextureFromCache();
     }
 
-    bool Texture::Resize(int newWidth, int newHeight)
+    bool Texture::Resize(int newWidth, int newHeight, ResizeFilter filter)
     {
-        if (!IsValid())
+        if (newWidth <= 0 || newHeight <= 0)
             return false;
 
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(PendingOpType::Resize, newWidth, newHeight);
-            return true;
-        }
-
-        std::vector<uint8_t> newData(newWidth * newHeight * m_channels);
-
-        for (int y = 0; y < newHeight; ++y)
-        {
-            for (int x = 0; x < newWidth; ++x)
-            {
-                int srcX = x * m_width / newWidth;
-                int srcY = y * m_height / newHeight;
-                int srcIdx = (srcY * m_width + srcX) * m_channels;
-                int dstIdx = (y * newWidth + x) * m_channels;
-
-                for (int c = 0; c < m_channels; ++c)
-                    newData[dstIdx + c] = m_cachedPixelData[srcIdx + c];
-            }
-        }
-
-        Destroy();
-        return LoadFromMemory(newData.data(), newWidth, newHeight, m_channels, m_isColorTexture);
+        return ApplyOperations(ImageOperations().Resize(newWidth, newHeight, filter));
     }
 
-    bool Texture::GenerateMipmaps()
+    bool Texture::GenerateMipmaps(const MipGenerationOptions& options)
     {
         if (!IsValid())
             return false;
@@ -376,184 +416,84 @@ namespace cx
             return false;
         }
 
-        Destroy();
-
-        uint64_t flags = BGFX_TEXTURE_NONE;
-        if (m_isColorTexture)
-            flags |= BGFX_TEXTURE_SRGB;
+        // Destroy() clears the cache and size, so keep what the new texture is built from
+        std::vector<uint8_t> pixels = m_cachedPixelData;
+        const int width = m_width;
+        const int height = m_height;
+        const int channels = m_channels;
+        const bool isColorTexture = m_isColorTexture;
+        const std::string filePath = m_filePath;
 
-        const bgfx::Memory* mem = bgfx::copy(m_cachedPixelData.data(), m_width * m_height * m_channels);
-        m_handle = bgfx::createTexture2D(m_width, m_height, true, 1, m_format, flags, mem);
-        m_hasMipmaps = true;
+        Destroy();
 
-        return bgfx::isValid(m_handle);
+        const bool success = LoadFromMemory(pixels.data(), width, height, channels, isColorTexture, &options);
+        m_filePath = filePath;
+        return success;
     }
 
     bool Texture::FlipVertical()
     {
-        if (!IsValid())
-            return false;
-
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(PendingOpType::FlipVertical);
-            return true;
-        }
-
-        int rowSize = m_width * m_channels;
-        std::vector<uint8_t> tempRow(rowSize);
-
-        for (int y = 0; y < m_height / 2; ++y)
-        {
-            int topIdx = y * rowSize;
-            int botIdx = (m_height - 1 - y) * rowSize;
-
-            std::memcpy(tempRow.data(), &m_cachedPixelData[topIdx], rowSize);
-            std::memcpy(&m_cachedPixelData[topIdx], &m_cachedPixelData[botIdx], rowSize);
-            std::memcpy(&m_cachedPixelData[botIdx], tempRow.data(), rowSize);
-        }
-
-        return UpdateTextureFromCache();
+        return ApplyOperations(ImageOperations().FlipVertical());
     }
 
     bool Texture::FlipHorizontal()
     {
-        if (!IsValid())
-            return false;
-
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(PendingOpType::FlipHorizontal);
-            return true;
-        }
-
-        for (int y = 0; y < m_height; ++y)
-        {
-            for (int x = 0; x < m_width / 2; ++x)
-            {
-                int leftIdx = (y * m_width + x) * m_channels;
-                int rightIdx = (y * m_width + (m_width - 1 - x)) * m_channels;
-
-                for (int c = 0; c < m_channels; ++c)
-                    std::swap(m_cachedPixelData[leftIdx + c], m_cachedPixelData[rightIdx + c]);
-            }
-        }
-
-        return UpdateTextureFromCache();
+        return ApplyOperations(ImageOperations().FlipHorizontal());
     }
 
     bool Texture::Rotate90(bool clockwise)
     {
-        if (!IsValid())
-            return false;
-
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(clockwise ? PendingOpType::Rotate90CW : PendingOpType::Rotate90CCW);
-            return true;
-        }
-
-        std::vector<uint8_t> rotated(m_width * m_height * m_channels);
-
-        for (int y = 0; y < m_height; ++y)
-        {
-            for (int x = 0; x < m_width; ++x)
-            {
-                int srcIdx = (y * m_width + x) * m_channels;
-                int dstIdx;
-
-                if (clockwise)
-                    dstIdx = (x * m_height + (m_height - 1 - y)) * m_channels;
-                else
-                    dstIdx = ((m_width - 1 - x) * m_height + y) * m_channels;
-
-                for (int c = 0; c < m_channels; ++c)
-                    rotated[dstIdx + c] = m_cachedPixelData[srcIdx + c];
-            }
-        }
-
-        Destroy();
-        return LoadFromMemory(rotated.data(), m_height, m_width, m_channels, m_isColorTexture);
+        return ApplyOperations(ImageOperations().Rotate90(clockwise));
     }
 
     bool Texture::Grayscale()
     {
-        if (!IsValid() || m_channels < 3)
+        if (m_channels < 3)
             return false;
 
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(PendingOpType::Grayscale);
-            return true;
-        }
-
-        for (int i = 0; i < m_width * m_height; ++i)
-        {
-            int idx = i * m_channels;
-            uint8_t r = m_cachedPixelData[idx + 0];
-            uint8_t g = m_cachedPixelData[idx + 1];
-            uint8_t b = m_cachedPixelData[idx + 2];
-            uint8_t gray = static_cast<uint8_t>(0.299f * r + 0.587f * g + 0.114f * b);
-
-            m_cachedPixelData[idx + 0] = gray;
-            m_cachedPixelData[idx + 1] = gray;
-            m_cachedPixelData[idx + 2] = gray;
-        }
-
-        return UpdateTextureFromCache();
+        return ApplyOperations(ImageOperations().Grayscale());
     }
 
     bool Texture::Invert()
     {
-        if (!IsValid())
-            return false;
-
-        if (!EnsureCacheLoaded())
-        {
-            QueueOperation(PendingOpType::Invert);
-            return true;
-        }
+        return ApplyOperations(ImageOperations().Invert());
+    }
 
-        for (int i = 0; i < m_width * m_height; ++i)
-        {
-            for (int c = 0; c < m_channels; ++c)
-            {
-                if (c < 3)
-                    m_cachedPixelData[i * m_channels + c] = 255 - m_cachedPixelData[i * m_channels + c];
-            }
-        }
+    bool Texture::ApplyTint(const Color& color)
+    {
+        if (m_channels < 3)
+            return false;
 
-        return UpdateTextureFromCache();
+        return ApplyOperations(ImageOperations().Tint(color));
     }
 
-    bool Texture::ApplyTint(const Color& color)
+    bool Texture::ApplyOperations(const ImageOperations& operations)
     {
-        if (!IsValid() || m_channels < 3)
+        if (!IsValid())
             return false;
 
+        if (operations.IsEmpty())
+            return true;
+
         if (!EnsureCacheLoaded())
         {
-            QueueOperation(PendingOpType::ApplyTint, 0, 0, color);
+            QueueOperations(operations);
             return true;
         }
 
-        float tintR = color.r / 255.0f;
-        float tintG = color.g / 255.0f;
-        float tintB = color.b / 255.0f;
-
-        for (int i = 0; i < m_width * m_height; ++i)
-        {
-            int idx = i * m_channels;
-            m_cachedPixelData[idx + 0] = static_cast<uint8_t>(m_cachedPixelData[idx + 0] * tintR);
-            m_cachedPixelData[idx + 1] = static_cast<uint8_t>(m_cachedPixelData[idx + 1] * tintG);
-            m_cachedPixelData[idx + 2] = static_cast<uint8_t>(m_cachedPixelData[idx + 2] * tintB);
-        }
+        const int oldWidth = m_width;
+        const int oldHeight = m_height;
+        if (!operations.Apply(m_cachedPixelData, m_width, m_height, m_channels, m_isColorTexture))
+            return false;
 
-        return UpdateTextureFromCache();
+        return CommitCache(m_width != oldWidth || m_height != oldHeight);
     }
 
     void Texture::Destroy()
     {
+        ReleaseStreaming();
+        CancelAsyncLoad();
+
         if (bgfx::isValid(m_handle))
         {
             bgfx::destroy(m_handle);
@@ -706,16 +646,36 @@ namespace cx
         return false;
     }
 
-    void Texture::QueueOperation(PendingOpType type, int param1, int param2, const Color& color)
+    void Texture::QueueOperations(const ImageOperations& operations)
+    {
+        for (auto& request : s_pendingReadbacks)
+        {
+            if (request.texture != this)
+                continue;
+
+            // Joins the previous operations so they run as one pass
+            if (!request.pendingOps.empty() && !request.pendingOps.back().isSetPixel)
+                request.pendingOps.back().operations.Then(operations);
+            else
+            {
+                PendingOperation op;
+                op.operations = operations;
+                request.pendingOps.push_back(op);
+            }
+            return;
+        }
+    }
+
+    void Texture::QueueSetPixel(int x, int y, const Color& color)
     {
         for (auto& request : s_pendingReadbacks)
         {
             if (request.texture == this)
             {
                 PendingOperation op;
-                op.type = type;
-                op.param1 = param1;
-                op.param2 = param2;
+                op.isSetPixel = true;
+                op.x = x;
+                op.y = y;
                 op.color = color;
 
                 request.pendingOps.push_back(op);
@@ -724,31 +684,47 @@ namespace cx
         }
     }
 
-    bool Texture::ExecuteOperation(const PendingOperation& op)
+    void Texture::WritePixel(int x, int y, const Color& color)
     {
-        switch (op.type)
-        {
-        case PendingOpType::Resize:
-            return Resize(op.param1, op.param2);
-        case PendingOpType::FlipVertical:
-            return FlipVertical();
-        case PendingOpType::FlipHorizontal:
-            return FlipHorizontal();
-        case PendingOpType::Rotate90CW:
-            return Rotate90(true);
-        case PendingOpType::Rotate90CCW:
-            return Rotate90(false);
-        case PendingOpType::Grayscale:
-            return Grayscale();
-        case PendingOpType::Invert:
-            return Invert();
-        case PendingOpType::ApplyTint:
-            return ApplyTint(op.color);
-        case PendingOpType::SetPixel:
-            SetPixel(op.param1, op.param2, op.color);
-            return true;
-        }
-        return false;
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+            return;
+
+        int channels = m_channels > 0 ? m_channels : 4;
+        int idx = (y * m_width + x) * channels;
+
+        if (channels > 0)
+            m_cachedPixelData[idx + 0] = color.r;
+
+        if (channels > 1)
+            m_cachedPixelData[idx + 1] = color.g;
+
+        if (channels > 2)
+            m_cachedPixelData[idx + 2] = color.b;
+
+        if (channels > 3)
+            m_cachedPixelData[idx + 3] = color.a;
+    }
+
+    bool Texture::CommitCache(bool sizeChanged)
+    {
+        if (!sizeChanged)
+            return UpdateTextureFromCache();
+
+        // The GPU texture has the old size, so it's recreated from the cache. Destroy() clears the cache and size, so keep them.
+        std::vector<uint8_t> pixels = std::move(m_cachedPixelData);
+        const int width = m_width;
+        const int height = m_height;
+        const int channels = m_channels;
+        const bool isColorTexture = m_isColorTexture;
+        const bool hadMipmaps = m_hasMipmaps;
+        const MipGenerationOptions mipOptions = m_mipOptions;
+        const std::string filePath = m_filePath;
+
+        Destroy();
+
+        const bool success = LoadFromMemory(pixels.data(), width, height, channels, isColorTexture, hadMipmaps ? &mipOptions : nullptr);
+        m_filePath = filePath;
+        return success;
     }
 
     bgfx::TextureHandle Texture::CreateStagingTexture()
@@ -795,9 +771,20 @@ namespace cx
                 if (bgfx::isValid(it->stagingTexture))
                     bgfx::destroy(it->stagingTexture);
 
-                // Execute all pending operations
-                for (const auto& op : it->pendingOps)
-                    tex->ExecuteOperation(op);
+                // Run the edits made while waiting against the cache, then upload once
+                if (!it->pendingOps.empty() && !tex->m_cachedPixelData.empty())
+                {
+                    const int oldWidth = tex->m_width;
+                    const int oldHeight = tex->m_height;
+                    for (const PendingOperation& op : it->pendingOps)
+                    {
+                        if (op.isSetPixel)
+                            tex->WritePixel(op.x, op.y, op.color);
+                        else
+                            op.operations.Apply(tex->m_cachedPixelData, tex->m_width, tex->m_height, tex->m_channels, tex->m_isColorTexture);
+                    }
+                    tex->CommitCache(tex->m_width != oldWidth || tex->m_height != oldHeight);
+                }
 
                 it = s_pendingReadbacks.erase(it);
             }
@@ -0,0 +1,515 @@
+#include "Texture.h"
+#include "JobSystem.h"
+#include <bimg.h>
+#include <decode.h>
+#include <bx/allocator.h>
+#include <bx/file.h>
+#include <stb_image.h>
+#include "basis universal/basisu_transcoder.h"
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace cx
+{
+    // Stop uploading for the frame once this much has been uploaded, so a level load doesn't stall a single frame
+    static constexpr size_t s_maxUploadBytesPerFrame = 64 * 1024 * 1024;
+
+    static bx::DefaultAllocator s_decodeAllocator;
+
+    // A decoded image, either a bimg container for files and KTX2 or RGBA8 pixels for images decoded with stb
+    struct DecodedImage
+    {
+        bimg::ImageContainer* container = nullptr;
+        std::vector<uint8_t> pixels;
+        int width = 0;
+        int height = 0;
+
+        DecodedImage() = default;
+        DecodedImage(const DecodedImage&) = delete;
+        DecodedImage& operator=(const DecodedImage&) = delete;
+        ~DecodedImage()
+        {
+            if (container)
+                bimg::imageFree(container);
+        }
+
+        size_t GetSize() const { return container ? container->m_size : pixels.size(); }
+    };
+
+    struct AsyncTextureLoad
+    {
+        enum class State
+        {
+            Decoding,
+            Decoded,
+            Uploaded,
+            Failed
+        };
+
+        std::atomic<State> state{ State::Decoding };
+        uint64_t id = 0;
+        std::string path; // Empty when decoding from memory
+        std::vector<uint8_t> encoded;
+        bool isColorTexture = true;
+        TexturePlaceholder placeholder = TexturePlaceholder::White;
+        bool generateMips = false;
+        MipGenerationOptions mipOptions;
+        DecodedImage image;
+    };
+
+    static std::mutex s_asyncMutex;
+    static uint64_t s_nextAsyncLoadId = 1; // Guarded by s_asyncMutex
+    static std::unordered_map<uint64_t, Texture*> s_asyncTextures; // Guarded by s_asyncMutex
+    static std::vector<std::shared_ptr<AsyncTextureLoad>> s_decodedLoads; // Guarded by s_asyncMutex
+    static Texture* s_placeholders[size_t(TexturePlaceholder::Count)] = {}; // Guarded by s_asyncMutex
+
+    static bool IsKTX2(const uint8_t* data, size_t size)
+    {
+        static const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        return size >= sizeof(identifier) && std::memcmp(data, identifier, sizeof(identifier)) == 0;
+    }
+
+    struct BasisTarget
+    {
+        basist::transcoder_texture_format basisFormat;
+        bimg::TextureFormat::Enum format;
+    };
+
+    // Picks the GPU format to transcode to, preferring formats closest to the source's quality. Falls back to RGBA8 when nothing compressed is supported.
+    static BasisTarget SelectBasisTarget(const basist::ktx2_transcoder& transcoder, bool isColorTexture)
+    {
+        using TF = basist::transcoder_texture_format;
+
+        const bool hasAlpha = transcoder.get_has_alpha() != 0;
+        std::vector<BasisTarget> candidates;
+
+        // ETC1S is already lower quality than BC1 and ETC1, so opaque ETC1S textures lose nothing by using the smaller formats first
+        if (transcoder.is_etc1s() && !hasAlpha)
+        {
+            candidates.push_back({ TF::cTFBC1_RGB, bimg::TextureFormat::BC1 });
+            candidates.push_back({ TF::cTFETC1_RGB, bimg::TextureFormat::ETC2 });
+        }
+        candidates.push_back({ TF::cTFBC7_RGBA, bimg::TextureFormat::BC7 });
+        candidates.push_back({ TF::cTFASTC_4x4_RGBA, bimg::TextureFormat::ASTC4x4 });
+        if (hasAlpha)
+        {
+            candidates.push_back({ TF::cTFBC3_RGBA, bimg::TextureFormat::BC3 });
+            candidates.push_back({ TF::cTFETC2_RGBA, bimg::TextureFormat::ETC2A });
+        }
+        else
+        {
+            candidates.push_back({ TF::cTFBC1_RGB, bimg::TextureFormat::BC1 });
+            candidates.push_back({ TF::cTFETC1_RGB, bimg::TextureFormat::ETC2 });
+        }
+
+        const bgfx::Caps* caps = bgfx::getCaps();
+        const uint16_t requiredCaps = isColorTexture ? BGFX_CAPS_FORMAT_TEXTURE_2D_SRGB : BGFX_CAPS_FORMAT_TEXTURE_2D;
+        for (const BasisTarget& candidate : candidates)
+        {
+            if (caps && (caps->formats[candidate.format] & requiredCaps) != 0 && basist::basis_is_format_supported(candidate.basisFormat, transcoder.get_basis_tex_format()))
+                return candidate;
+        }
+
+        return { TF::cTFRGBA32, bimg::TextureFormat::RGBA8 };
+    }
+
+    // Transcodes every level into a bimg container so it uploads like any other file
+    static bimg::ImageContainer* TranscodeKTX2(basist::ktx2_transcoder& transcoder, const BasisTarget& target, bool hasMips)
+    {
+        const uint32_t width = transcoder.get_width();
+        const uint32_t height = transcoder.get_height();
+
+        bimg::ImageContainer* container = bimg::imageAlloc(&s_decodeAllocator, target.format, uint16_t(width), uint16_t(height), 0, 1, false, hasMips);
+        if (!container)
+            return nullptr;
+
+        const bool uncompressed = target.basisFormat == basist::transcoder_texture_format::cTFRGBA32;
+        for (uint8_t level = 0; level < container->m_numMips; ++level)
+        {
+            bimg::ImageMip mip;
+            if (!bimg::imageGetRawData(*container, 0, level, container->m_data, container->m_size, mip))
+            {
+                bimg::imageFree(container);
+                return nullptr;
+            }
+
+            // The output size is in pixels for uncompressed formats and in blocks for block formats
+            const uint32_t outputSize = uncompressed ? mip.m_width * mip.m_height : ((mip.m_width + 3) / 4) * ((mip.m_height + 3) / 4);
+            if (!transcoder.transcode_image_level(level, 0, 0, const_cast<uint8_t*>(mip.m_data), outputSize, target.basisFormat))
+            {
+                bimg::imageFree(container);
+                return nullptr;
+            }
+        }
+
+        return container;
+    }
+
+    static bool DecodeKTX2(const uint8_t* data, size_t size, bool isColorTexture, DecodedImage& out)
+    {
+        basist::ktx2_transcoder transcoder;
+        if (!transcoder.init(data, static_cast<uint32_t>(size)) || !transcoder.start_transcoding())
+        {
+            std::cerr << "[ERROR] BasisU failed to start transcoding." << std::endl;
+            return false;
+        }
+
+        const uint32_t width = transcoder.get_width();
+        const uint32_t height = transcoder.get_height();
+        if (width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX)
+        {
+            std::cerr << "[ERROR] Invalid dimensions from BasisU: " << width << "x" << height << std::endl;
+            return false;
+        }
+
+        // bgfx needs a full chain, so files with only some of their mips just use the top level
+        const uint32_t fullChain = bimg::imageGetNumMips(bimg::TextureFormat::RGBA8, uint16_t(width), uint16_t(height));
+        const bool hasMips = transcoder.get_levels() >= fullChain;
+
+        const BasisTarget target = SelectBasisTarget(transcoder, isColorTexture);
+        out.container = TranscodeKTX2(transcoder, target, hasMips);
+
+        // A compressed format can still fail for some source formats, RGBA8 always works
+        if (!out.container && target.format != bimg::TextureFormat::RGBA8)
+            out.container = TranscodeKTX2(transcoder, { basist::transcoder_texture_format::cTFRGBA32, bimg::TextureFormat::RGBA8 }, hasMips);
+
+        if (!out.container)
+        {
+            std::cerr << "[ERROR] BasisU transcode_image_level failed." << std::endl;
+            return false;
+        }
+
+        out.width = int(width);
+        out.height = int(height);
+        return true;
+    }
+
+    // 8 bit images stored without mips get a generated chain. Compressed and float formats and images that already have mips are left as they are.
+    static void AddMipChain(DecodedImage& image, bool isColorTexture, const MipGenerationOptions& options)
+    {
+        bimg::TextureFormat::Enum format = bimg::TextureFormat::RGBA8;
+        const uint8_t* pixels = image.pixels.data();
+        int channels = 4;
+
+        if (image.container)
+        {
+            const bimg::ImageContainer& container = *image.container;
+            if (container.m_numMips > 1 || container.m_numLayers > 1 || container.m_cubeMap || container.m_depth > 1)
+                return;
+
+            switch (container.m_format)
+            {
+            case bimg::TextureFormat::R8: channels = 1; break;
+            case bimg::TextureFormat::RG8: channels = 2; break;
+            case bimg::TextureFormat::RGB8: channels = 3; break;
+            case bimg::TextureFormat::RGBA8: channels = 4; break;
+            default: return;
+            }
+
+            bimg::ImageMip mip;
+            if (!bimg::imageGetRawData(container, 0, 0, container.m_data, container.m_size, mip))
+                return;
+
+            format = container.m_format;
+            pixels = mip.m_data;
+        }
+
+        std::vector<uint8_t> mipChain = GenerateMipChain(pixels, image.width, image.height, channels, isColorTexture, options);
+        if (mipChain.empty())
+            return;
+
+        bimg::ImageContainer* withMips = bimg::imageAlloc(&s_decodeAllocator, format, uint16_t(image.width), uint16_t(image.height), 0, 1, false, true, mipChain.data());
+        if (!withMips)
+            return;
+
+        if (image.container)
+            bimg::imageFree(image.container);
+        image.container = withMips;
+        image.pixels = std::vector<uint8_t>();
+    }
+
+    // PNG, JPG and anything else stb_image reads decode to RGBA8. DDS, KTX and the other container formats go through bimg.
+    static bool DecodeImageData(const uint8_t* data, size_t size, bool isColorTexture, DecodedImage& out)
+    {
+        if (!data || size == 0)
+            return false;
+
+        if (IsKTX2(data, size))
+            return DecodeKTX2(data, size, isColorTexture, out);
+
+        int width = 0, height = 0, channels = 0;
+        if (unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4))
+        {
+            out.pixels.assign(pixels, pixels + size_t(width) * height * 4);
+            out.width = width;
+            out.height = height;
+            stbi_image_free(pixels);
+            return true;
+        }
+
+        out.container = bimg::imageParse(&s_decodeAllocator, data, static_cast<uint32_t>(size));
+        if (!out.container)
+        {
+            std::cerr << "[ERROR] Failed to decode texture: " << stbi_failure_reason() << std::endl;
+            return false;
+        }
+
+        out.width = int(out.container->m_width);
+        out.height = int(out.container->m_height);
+        return true;
+    }
+
+    static bool DecodeEncodedImage(const uint8_t* data, size_t size, bool isColorTexture, const MipGenerationOptions* mipOptions, DecodedImage& out)
+    {
+        if (!DecodeImageData(data, size, isColorTexture, out))
+            return false;
+
+        if (mipOptions)
+            AddMipChain(out, isColorTexture, *mipOptions);
+        return true;
+    }
+
+    static bool DecodeTextureFile(const std::string& path, bool isColorTexture, const MipGenerationOptions* mipOptions, DecodedImage& out)
+    {
+        bx::FileReader reader;
+        if (!bx::open(&reader, path.c_str()))
+        {
+            std::cerr << "[ERROR] Failed to open texture \"" << path << "\"." << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> data(size_t(bx::getSize(&reader)));
+        bx::read(&reader, data.data(), int32_t(data.size()), bx::ErrorAssert{});
+        bx::close(&reader);
+
+        if (IsKTX2(data.data(), data.size()))
+            return DecodeKTX2(data.data(), data.size(), isColorTexture, out);
+
+        // Files are parsed like LoadFromFile() does, keeping their stored format and mips
+        out.container = bimg::imageParse(&s_decodeAllocator, data.data(), static_cast<uint32_t>(data.size()));
+        if (!out.container)
+        {
+            std::cerr << "[ERROR] Failed to decode texture \"" << path << "\"." << std::endl;
+            return false;
+        }
+
+        out.width = int(out.container->m_width);
+        out.height = int(out.container->m_height);
+        if (mipOptions)
+            AddMipChain(out, isColorTexture, *mipOptions);
+        return true;
+    }
+
+    bool Texture::UploadDecodedImage(DecodedImage& image, bool isColorTexture)
+    {
+        if (!image.container)
+            return LoadFromMemory(image.pixels.data(), image.width, image.height, 4, isColorTexture);
+
+        bimg::ImageContainer* container = image.container;
+        image.container = nullptr;
+
+        uint64_t flags = BGFX_TEXTURE_NONE;
+        if (isColorTexture)
+            flags |= BGFX_TEXTURE_SRGB;
+
+        // bgfx reads the memory later, so the container is freed once it's done with it
+        const bgfx::Memory* mem = bgfx::makeRef(container->m_data, container->m_size,
+            [](void*, void* userData) { bimg::imageFree(static_cast<bimg::ImageContainer*>(userData)); }, container);
+
+        m_handle = bgfx::createTexture2D(uint16_t(container->m_width), uint16_t(container->m_height), container->m_numMips > 1,
+            container->m_numLayers, bgfx::TextureFormat::Enum(container->m_format), flags, mem);
+
+        m_width = int(container->m_width);
+        m_height = int(container->m_height);
+        m_format = bgfx::TextureFormat::Enum(container->m_format);
+        m_channels = GetFormatChannels(m_format);
+        m_isColorTexture = isColorTexture;
+        m_hasMipmaps = container->m_numMips > 1;
+
+        return bgfx::isValid(m_handle);
+    }
+
+    bool Texture::LoadFromEncodedMemory(const void* data, size_t size, bool isColorTexture, const MipGenerationOptions* mipOptions)
+    {
+        Destroy();
+
+        DecodedImage image;
+        if (!DecodeEncodedImage(static_cast<const uint8_t*>(data), size, isColorTexture, mipOptions, image))
+            return false;
+
+        return UploadDecodedImage(image, isColorTexture);
+    }
+
+    Texture* Texture::GetPlaceholderTexture(TexturePlaceholder placeholder)
+    {
+        std::lock_guard<std::mutex> lock(s_asyncMutex);
+
+        Texture*& texture = s_placeholders[size_t(placeholder)];
+        if (!texture)
+            texture = new Texture();
+
+        // Recreated if cx::Shutdown() destroyed it
+        if (!texture->IsValid())
+        {
+            static const uint8_t pixels[size_t(TexturePlaceholder::Count)][4] =
+            {
+                { 255, 255, 255, 255 }, // White
+                { 0, 0, 0, 255 }, // Black
+                { 128, 128, 255, 255 } // FlatNormal
+            };
+            texture->LoadFromMemory(pixels[size_t(placeholder)], 1, 1, 4, placeholder != TexturePlaceholder::FlatNormal);
+        }
+
+        return texture;
+    }
+
+    TextureHandleFuture Texture::StartAsyncLoad(std::shared_ptr<AsyncTextureLoad> load)
+    {
+        Destroy();
+
+        Texture* placeholder = GetPlaceholderTexture(load->placeholder);
+        m_handle = placeholder->GetHandle();
+        m_width = placeholder->GetWidth();
+        m_height = placeholder->GetHeight();
+        m_channels = placeholder->GetChannels();
+        m_format = placeholder->GetFormat();
+        m_isColorTexture = load->isColorTexture;
+        m_showsPlaceholder = true;
+        m_filePath = load->path;
+
+        {
+            std::lock_guard<std::mutex> lock(s_asyncMutex);
+            load->id = s_nextAsyncLoadId++;
+            s_asyncTextures[load->id] = this;
+        }
+        m_asyncLoadId = load->id;
+
+        RunJobAsync([load]()
+        {
+            const MipGenerationOptions* mipOptions = load->generateMips ? &load->mipOptions : nullptr;
+            bool decoded = load->path.empty() ? DecodeEncodedImage(load->encoded.data(), load->encoded.size(), load->isColorTexture, mipOptions, load->image)
+                : DecodeTextureFile(load->path, load->isColorTexture, mipOptions, load->image);
+            load->encoded.clear();
+            load->encoded.shrink_to_fit();
+
+            std::lock_guard<std::mutex> lock(s_asyncMutex);
+            load->state = decoded ? AsyncTextureLoad::State::Decoded : AsyncTextureLoad::State::Failed;
+            s_decodedLoads.push_back(load);
+        });
+
+        return TextureHandleFuture(this, std::move(load));
+    }
+
+    TextureHandleFuture Texture::LoadAsync(std::string_view path, bool isColorTexture, const MipGenerationOptions* mipOptions, TexturePlaceholder placeholder)
+    {
+        std::shared_ptr<AsyncTextureLoad> load = std::make_shared<AsyncTextureLoad>();
+        load->path = std::string(path);
+        load->isColorTexture = isColorTexture;
+        load->placeholder = placeholder;
+        load->generateMips = mipOptions != nullptr;
+        if (mipOptions)
+            load->mipOptions = *mipOptions;
+        return StartAsyncLoad(std::move(load));
+    }
+
+    TextureHandleFuture Texture::LoadFromEncodedMemoryAsync(std::vector<uint8_t> data, bool isColorTexture, const MipGenerationOptions* mipOptions, TexturePlaceholder placeholder)
+    {
+        std::shared_ptr<AsyncTextureLoad> load = std::make_shared<AsyncTextureLoad>();
+        load->encoded = std::move(data);
+        load->isColorTexture = isColorTexture;
+        load->placeholder = placeholder;
+        load->generateMips = mipOptions != nullptr;
+        if (mipOptions)
+            load->mipOptions = *mipOptions;
+        return StartAsyncLoad(std::move(load));
+    }
+
+    void Texture::CancelAsyncLoad()
+    {
+        if (m_asyncLoadId != 0)
+        {
+            std::lock_guard<std::mutex> lock(s_asyncMutex);
+            s_asyncTextures.erase(m_asyncLoadId);
+            m_asyncLoadId = 0;
+        }
+
+        // The placeholder's handle isn't ours to destroy
+        if (m_showsPlaceholder)
+        {
+            m_handle = BGFX_INVALID_HANDLE;
+            m_showsPlaceholder = false;
+        }
+    }
+
+    void Texture::ProcessAsyncUploads()
+    {
+        std::vector<std::shared_ptr<AsyncTextureLoad>> loads;
+        {
+            std::lock_guard<std::mutex> lock(s_asyncMutex);
+            loads.swap(s_decodedLoads);
+        }
+
+        size_t uploadedBytes = 0;
+        size_t i = 0;
+        for (; i < loads.size() && uploadedBytes < s_maxUploadBytesPerFrame; ++i)
+        {
+            AsyncTextureLoad& load = *loads[i];
+
+            Texture* texture = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(s_asyncMutex);
+                auto it = s_asyncTextures.find(load.id);
+                if (it == s_asyncTextures.end())
+                    continue; // The texture was destroyed or started another load
+
+                texture = it->second;
+                s_asyncTextures.erase(it);
+            }
+            texture->m_asyncLoadId = 0;
+
+            if (load.state == AsyncTextureLoad::State::Failed)
+                continue; // Keeps showing the placeholder
+
+            uploadedBytes += load.image.GetSize();
+
+            texture->m_handle = BGFX_INVALID_HANDLE;
+            texture->m_showsPlaceholder = false;
+            if (texture->UploadDecodedImage(load.image, load.isColorTexture))
+                load.state = AsyncTextureLoad::State::Uploaded;
+            else
+            {
+                load.state = AsyncTextureLoad::State::Failed;
+                texture->m_handle = GetPlaceholderTexture(load.placeholder)->GetHandle();
+                texture->m_showsPlaceholder = true;
+            }
+            load.image.pixels = std::vector<uint8_t>();
+        }
+
+        // Whatever didn't fit waits for the next frame
+        if (i < loads.size())
+        {
+            std::lock_guard<std::mutex> lock(s_asyncMutex);
+            s_decodedLoads.insert(s_decodedLoads.begin(), loads.begin() + i, loads.end());
+        }
+    }
+
+    TextureHandleFuture::TextureHandleFuture(Texture* texture, std::shared_ptr<AsyncTextureLoad> load)
+        : m_texture(texture)
+        , m_load(std::move(load))
+    {
+    }
+
+    bool TextureHandleFuture::IsReady() const
+    {
+        return m_load && m_load->state == AsyncTextureLoad::State::Uploaded;
+    }
+
+    bool TextureHandleFuture::HasFailed() const
+    {
+        return m_load && m_load->state == AsyncTextureLoad::State::Failed;
+    }
+}
@@ -0,0 +1,743 @@
+#include "TextureAtlas.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include <stb_image.h>
+#include <stb_image_write.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace cx
+{
+    static const uint32_t s_atlasFileMagic = 0x54415843; // "CXAT"
+    static const uint32_t s_atlasFileVersion = 1;
+
+    static int NextPowerOfTwo(int value)
+    {
+        int result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    // Expands the image to RGBA and surrounds it with padding texels copied from its nearest edge
+    static std::vector<uint8_t> BuildPaddedImage(const uint8_t* pixels, int width, int height, int channels, int padding)
+    {
+        const int paddedWidth = width + padding * 2;
+        const int paddedHeight = height + padding * 2;
+        std::vector<uint8_t> result(size_t(paddedWidth) * paddedHeight * 4);
+
+        for (int y = 0; y < paddedHeight; ++y)
+        {
+            const int srcY = std::clamp(y - padding, 0, height - 1);
+            uint8_t* dst = result.data() + size_t(y) * paddedWidth * 4;
+            for (int x = 0; x < paddedWidth; ++x, dst += 4)
+            {
+                const int srcX = std::clamp(x - padding, 0, width - 1);
+                const uint8_t* src = pixels + (size_t(srcY) * width + srcX) * channels;
+                switch (channels)
+                {
+                case 1:
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = 255;
+                    break;
+                case 2:
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = src[1];
+                    break;
+                case 3:
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = 255;
+                    break;
+                default:
+                    std::memcpy(dst, src, 4);
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    TextureAtlas::TextureAtlas(const TextureAtlasOptions& options)
+        : m_options(options)
+    {
+        m_options.padding = std::max(0, m_options.padding);
+        m_options.initialPageSize = std::max(1, m_options.initialPageSize);
+        m_options.maxPageSize = std::max(m_options.initialPageSize, m_options.maxPageSize);
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+        Clear();
+    }
+
+    const AtlasRegion* TextureAtlas::Add(std::string_view name, const void* pixels, int width, int height, int channels)
+    {
+        auto existing = m_regions.find(std::string(name));
+        if (existing != m_regions.end())
+            return &existing->second;
+
+        if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+        {
+            std::cerr << "[ERROR] TextureAtlas: Invalid image for " << name << std::endl;
+            return nullptr;
+        }
+
+        const int paddedWidth = width + m_options.padding * 2;
+        const int paddedHeight = height + m_options.padding * 2;
+        const int maxPageSize = GetMaxPageSize();
+        if (paddedWidth > maxPageSize || paddedHeight > maxPageSize)
+        {
+            std::cerr << "[ERROR] TextureAtlas: " << name << " (" << width << "x" << height << ") is larger than the max page size of " << maxPageSize << std::endl;
+            return nullptr;
+        }
+
+        // Fill the existing pages before growing them, and grow them before starting a new one
+        PackRect rect = {};
+        int pageIndex = -1;
+        for (size_t i = 0; i < m_pages.size() && pageIndex < 0; ++i)
+        {
+            if (Insert(*m_pages[i], paddedWidth, paddedHeight, rect))
+                pageIndex = static_cast<int>(i);
+        }
+
+        for (size_t i = 0; i < m_pages.size() && pageIndex < 0; ++i)
+        {
+            while (Grow(static_cast<int>(i)))
+            {
+                if (Insert(*m_pages[i], paddedWidth, paddedHeight, rect))
+                {
+                    pageIndex = static_cast<int>(i);
+                    break;
+                }
+            }
+        }
+
+        if (pageIndex < 0)
+        {
+            const int pageSize = std::min(maxPageSize, std::max(m_options.initialPageSize, NextPowerOfTwo(std::max(paddedWidth, paddedHeight))));
+            Page* page = CreatePage(pageSize, pageSize);
+            if (!page || !Insert(*page, paddedWidth, paddedHeight, rect))
+                return nullptr;
+
+            pageIndex = static_cast<int>(m_pages.size()) - 1;
+        }
+
+        Page& page = *m_pages[pageIndex];
+        std::vector<uint8_t> padded = BuildPaddedImage(static_cast<const uint8_t*>(pixels), width, height, channels, m_options.padding);
+        for (int row = 0; row < paddedHeight; ++row)
+            std::memcpy(page.pixels.data() + (size_t(rect.y + row) * page.width + rect.x) * 4, padded.data() + size_t(row) * paddedWidth * 4, size_t(paddedWidth) * 4);
+
+        page.texture->UpdateRegion(rect.x, rect.y, paddedWidth, paddedHeight, padded.data());
+
+        AtlasRegion region;
+        region.page = pageIndex;
+        region.x = rect.x + m_options.padding;
+        region.y = rect.y + m_options.padding;
+        region.width = width;
+        region.height = height;
+        region.uvMin = Vector2(float(region.x) / page.width, float(region.y) / page.height);
+        region.uvMax = Vector2(float(region.x + width) / page.width, float(region.y + height) / page.height);
+
+        return &m_regions.emplace(std::string(name), region).first->second;
+    }
+
+    const AtlasRegion* TextureAtlas::Add(std::string_view name, Texture& texture)
+    {
+        if (const AtlasRegion* region = GetRegion(name))
+            return region;
+
+        switch (texture.GetFormat())
+        {
+        case bgfx::TextureFormat::R8:
+        case bgfx::TextureFormat::RG8:
+        case bgfx::TextureFormat::RGB8:
+        case bgfx::TextureFormat::RGBA8:
+            break;
+        default:
+            std::cerr << "[ERROR] TextureAtlas: Only 8 bit textures can be packed, " << name << " has a different format" << std::endl;
+            return nullptr;
+        }
+
+        std::vector<uint8_t> pixels;
+        if (!texture.GetPixelData(pixels))
+            return nullptr;
+
+        return Add(name, pixels.data(), texture.GetWidth(), texture.GetHeight(), texture.GetChannels());
+    }
+
+    const AtlasRegion* TextureAtlas::AddFromFile(std::string_view name, std::string_view path)
+    {
+        if (const AtlasRegion* region = GetRegion(name))
+            return region;
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        unsigned char* pixels = stbi_load(std::string(path).c_str(), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cerr << "[ERROR] TextureAtlas: Failed to load image: " << path << std::endl;
+            return nullptr;
+        }
+
+        const AtlasRegion* region = Add(name, pixels, width, height, 4);
+        stbi_image_free(pixels);
+        return region;
+    }
+
+    const AtlasRegion* TextureAtlas::GetRegion(std::string_view name) const
+    {
+        auto it = m_regions.find(std::string(name));
+        return it != m_regions.end() ? &it->second : nullptr;
+    }
+
+    Texture* TextureAtlas::GetPageTexture(int page) const
+    {
+        return page >= 0 && page < GetPageCount() ? m_pages[page]->texture.get() : nullptr;
+    }
+
+    Material* TextureAtlas::GetPageMaterial(int page) const
+    {
+        return page >= 0 && page < GetPageCount() ? m_pages[page]->material.get() : nullptr;
+    }
+
+    float TextureAtlas::GetPageOccupancy(int page) const
+    {
+        if (page < 0 || page >= GetPageCount())
+            return 0.0f;
+
+        const Page& p = *m_pages[page];
+        return float(double(p.usedArea) / (double(p.width) * p.height));
+    }
+
+    Mesh TextureAtlas::GenSpriteMesh(std::string_view name, float width, float height, bool centered) const
+    {
+        Mesh mesh;
+        const AtlasRegion* region = GetRegion(name);
+        if (!region)
+        {
+            std::cerr << "[ERROR] TextureAtlas: No region named " << name << std::endl;
+            return mesh;
+        }
+
+        const float left = centered ? -width * 0.5f : 0.0f;
+        const float bottom = centered ? -height * 0.5f : 0.0f;
+
+        // Bottom left, bottom right, top left, top right. Y points up, so the top edge shows the image's first row.
+        std::vector<Vertex> vertices(4);
+        const Vector2 positions[4] = { { left, bottom }, { left + width, bottom }, { left, bottom + height }, { left + width, bottom + height } };
+        const Vector2 uvs[4] = { { region->uvMin.x, region->uvMax.y }, { region->uvMax.x, region->uvMax.y }, { region->uvMin.x, region->uvMin.y }, { region->uvMax.x, region->uvMin.y } };
+        for (int i = 0; i < 4; ++i)
+        {
+            vertices[i].position = Vector3(positions[i].x, positions[i].y, 0.0f);
+            vertices[i].normal = Vector3(0.0f, 0.0f, -1.0f);
+            vertices[i].tangent = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+            vertices[i].texCoord = uvs[i];
+        }
+
+        mesh.SetVertices(vertices);
+        mesh.SetIndices({ 0, 2, 1, 1, 2, 3 });
+        mesh.SetMaterial(GetPageMaterial(region->page));
+        mesh.Upload();
+        return mesh;
+    }
+
+    template<typename T>
+    static void WriteValue(std::ofstream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void WritePNGBytes(void* context, void* data, int size)
+    {
+        auto* bytes = static_cast<std::vector<uint8_t>*>(context);
+        bytes->insert(bytes->end(), static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
+    }
+
+    bool TextureAtlas::Save(std::string_view path) const
+    {
+        std::ofstream out(std::string(path), std::ios::binary);
+        if (!out)
+        {
+            std::cerr << "[ERROR] TextureAtlas: Failed to open " << path << " for writing" << std::endl;
+            return false;
+        }
+
+        WriteValue(out, s_atlasFileMagic);
+        WriteValue(out, s_atlasFileVersion);
+        WriteValue(out, static_cast<uint32_t>(m_options.packing));
+        WriteValue(out, static_cast<int32_t>(m_options.initialPageSize));
+        WriteValue(out, static_cast<int32_t>(m_options.maxPageSize));
+        WriteValue(out, static_cast<int32_t>(m_options.padding));
+        WriteValue(out, static_cast<uint8_t>(m_options.isColorTexture));
+
+        WriteValue(out, static_cast<uint32_t>(m_pages.size()));
+        for (const auto& page : m_pages)
+        {
+            WriteValue(out, static_cast<int32_t>(page->width));
+            WriteValue(out, static_cast<int32_t>(page->height));
+            WriteValue(out, page->usedArea);
+
+            WriteValue(out, static_cast<uint32_t>(page->freeRects.size()));
+            for (const PackRect& rect : page->freeRects)
+                out.write(reinterpret_cast<const char*>(&rect), sizeof(PackRect));
+
+            WriteValue(out, static_cast<uint32_t>(page->skyline.size()));
+            for (const SkylineNode& node : page->skyline)
+                out.write(reinterpret_cast<const char*>(&node), sizeof(SkylineNode));
+
+            std::vector<uint8_t> png;
+            if (!stbi_write_png_to_func(WritePNGBytes, &png, page->width, page->height, 4, page->pixels.data(), page->width * 4))
+            {
+                std::cerr << "[ERROR] TextureAtlas: Failed to encode a page of " << path << std::endl;
+                return false;
+            }
+
+            WriteValue(out, static_cast<uint32_t>(png.size()));
+            out.write(reinterpret_cast<const char*>(png.data()), png.size());
+        }
+
+        WriteValue(out, static_cast<uint32_t>(m_regions.size()));
+        for (const auto& [name, region] : m_regions)
+        {
+            WriteValue(out, static_cast<uint32_t>(name.size()));
+            out.write(name.data(), name.size());
+            WriteValue(out, static_cast<int32_t>(region.page));
+            WriteValue(out, static_cast<int32_t>(region.x));
+            WriteValue(out, static_cast<int32_t>(region.y));
+            WriteValue(out, static_cast<int32_t>(region.width));
+            WriteValue(out, static_cast<int32_t>(region.height));
+        }
+
+        return out.good();
+    }
+
+    // Reads the atlas file, failing instead of reading past its end
+    struct AtlasFileReader
+    {
+        const uint8_t* data;
+        size_t size;
+        size_t offset = 0;
+
+        bool Read(void* dst, size_t bytes)
+        {
+            if (bytes > size - offset)
+                return false;
+
+            std::memcpy(dst, data + offset, bytes);
+            offset += bytes;
+            return true;
+        }
+
+        template<typename T>
+        bool Read(T& value) { return Read(&value, sizeof(T)); }
+    };
+
+    bool TextureAtlas::Load(std::string_view path)
+    {
+        std::ifstream in(std::string(path), std::ios::binary | std::ios::ate);
+        if (!in)
+        {
+            std::cerr << "[ERROR] TextureAtlas: Failed to open " << path << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(in.tellg()));
+        in.seekg(0, std::ios::beg);
+        if (!in.read(reinterpret_cast<char*>(bytes.data()), bytes.size()))
+            return false;
+
+        AtlasFileReader reader{ bytes.data(), bytes.size() };
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (!reader.Read(magic) || !reader.Read(version) || magic != s_atlasFileMagic || version != s_atlasFileVersion)
+        {
+            std::cerr << "[ERROR] TextureAtlas: " << path << " is not a texture atlas or was written by a different version" << std::endl;
+            return false;
+        }
+
+        Clear();
+
+        uint32_t packing = 0;
+        int32_t initialPageSize = 0;
+        int32_t maxPageSize = 0;
+        int32_t padding = 0;
+        uint8_t isColorTexture = 0;
+        uint32_t pageCount = 0;
+        bool valid = reader.Read(packing) && reader.Read(initialPageSize) && reader.Read(maxPageSize) && reader.Read(padding) && reader.Read(isColorTexture) && reader.Read(pageCount);
+
+        m_options.packing = packing == static_cast<uint32_t>(AtlasPacking::Skyline) ? AtlasPacking::Skyline : AtlasPacking::MaxRects;
+        m_options.initialPageSize = std::max(1, initialPageSize);
+        m_options.maxPageSize = std::max(m_options.initialPageSize, maxPageSize);
+        m_options.padding = std::max(0, padding);
+        m_options.isColorTexture = isColorTexture != 0;
+
+        for (uint32_t i = 0; valid && i < pageCount; ++i)
+        {
+            int32_t width = 0;
+            int32_t height = 0;
+            int64_t usedArea = 0;
+            uint32_t freeRectCount = 0;
+            uint32_t skylineCount = 0;
+            uint32_t pngSize = 0;
+            valid = reader.Read(width) && reader.Read(height) && reader.Read(usedArea) && reader.Read(freeRectCount) && freeRectCount <= (reader.size - reader.offset) / sizeof(PackRect);
+            if (!valid)
+                break;
+
+            std::vector<PackRect> freeRects(freeRectCount);
+            valid = reader.Read(freeRects.data(), freeRects.size() * sizeof(PackRect)) && reader.Read(skylineCount) && skylineCount <= (reader.size - reader.offset) / sizeof(SkylineNode);
+            if (!valid)
+                break;
+
+            std::vector<SkylineNode> skyline(skylineCount);
+            valid = reader.Read(skyline.data(), skyline.size() * sizeof(SkylineNode)) && reader.Read(pngSize) && pngSize <= reader.size - reader.offset;
+            if (!valid)
+                break;
+
+            int pngWidth = 0;
+            int pngHeight = 0;
+            int pngChannels = 0;
+            unsigned char* pixels = stbi_load_from_memory(reader.data + reader.offset, static_cast<int>(pngSize), &pngWidth, &pngHeight, &pngChannels, 4);
+            reader.offset += pngSize;
+            valid = pixels && pngWidth == width && pngHeight == height;
+            if (!valid)
+            {
+                stbi_image_free(pixels);
+                break;
+            }
+
+            auto page = std::make_unique<Page>();
+            page->width = width;
+            page->height = height;
+            page->pixels.assign(pixels, pixels + size_t(width) * height * 4);
+            page->freeRects = std::move(freeRects);
+            page->skyline = std::move(skyline);
+            page->usedArea = usedArea;
+            stbi_image_free(pixels);
+
+            page->texture = std::make_unique<Texture>();
+            page->material = std::make_unique<Material>();
+            page->material->SetShader(s_defaultShader);
+            page->material->SetMaterialMap(MaterialMapType::Albedo, page->texture.get());
+            valid = UploadPage(*page);
+            m_pages.push_back(std::move(page));
+        }
+
+        uint32_t regionCount = 0;
+        valid = valid && reader.Read(regionCount);
+        for (uint32_t i = 0; valid && i < regionCount; ++i)
+        {
+            uint32_t nameLength = 0;
+            valid = reader.Read(nameLength) && nameLength <= reader.size - reader.offset;
+            if (!valid)
+                break;
+
+            std::string name(reinterpret_cast<const char*>(reader.data + reader.offset), nameLength);
+            reader.offset += nameLength;
+
+            int32_t values[5] = {};
+            valid = reader.Read(values, sizeof(values)) && values[0] >= 0 && values[0] < GetPageCount();
+            if (!valid)
+                break;
+
+            AtlasRegion region;
+            region.page = values[0];
+            region.x = values[1];
+            region.y = values[2];
+            region.width = values[3];
+            region.height = values[4];
+            m_regions[name] = region;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "[ERROR] TextureAtlas: " << path << " is corrupt" << std::endl;
+            Clear();
+            return false;
+        }
+
+        for (int i = 0; i < GetPageCount(); ++i)
+            UpdateRegionUVs(i);
+
+        ++m_version;
+        return true;
+    }
+
+    void TextureAtlas::Clear()
+    {
+        m_regions.clear();
+        m_pages.clear();
+        ++m_version;
+    }
+
+    int TextureAtlas::GetMaxPageSize() const
+    {
+        const int gpuMax = GetMaxTextureSize();
+        return gpuMax > 0 ? std::min(m_options.maxPageSize, gpuMax) : m_options.maxPageSize;
+    }
+
+    TextureAtlas::Page* TextureAtlas::CreatePage(int width, int height)
+    {
+        auto page = std::make_unique<Page>();
+        page->width = width;
+        page->height = height;
+        page->pixels.assign(size_t(width) * height * 4, 0);
+        if (m_options.packing == AtlasPacking::MaxRects)
+            page->freeRects.push_back({ 0, 0, width, height });
+        else
+            page->skyline.push_back({ 0, 0, width });
+
+        page->texture = std::make_unique<Texture>();
+        page->material = std::make_unique<Material>();
+        page->material->SetShader(s_defaultShader);
+        page->material->SetMaterialMap(MaterialMapType::Albedo, page->texture.get());
+
+        if (!UploadPage(*page))
+            return nullptr;
+
+        m_pages.push_back(std::move(page));
+        return m_pages.back().get();
+    }
+
+    bool TextureAtlas::UploadPage(Page& page)
+    {
+        page.texture->Destroy();
+        if (!page.texture->CreateDynamic(page.width, page.height, 4, m_options.isColorTexture))
+            return false;
+
+        return page.texture->UpdateRegion(0, 0, page.width, page.height, page.pixels.data());
+    }
+
+    bool TextureAtlas::Grow(int pageIndex)
+    {
+        Page& page = *m_pages[pageIndex];
+        const int maxPageSize = GetMaxPageSize();
+        if (page.width >= maxPageSize && page.height >= maxPageSize)
+            return false;
+
+        // Doubles the shorter side so pages stay close to square
+        const bool growWidth = page.height >= maxPageSize || (page.width <= page.height && page.width < maxPageSize);
+        const int newWidth = growWidth ? std::min(page.width * 2, maxPageSize) : page.width;
+        const int newHeight = growWidth ? page.height : std::min(page.height * 2, maxPageSize);
+
+        std::vector<uint8_t> pixels(size_t(newWidth) * newHeight * 4, 0);
+        for (int y = 0; y < page.height; ++y)
+            std::memcpy(pixels.data() + size_t(y) * newWidth * 4, page.pixels.data() + size_t(y) * page.width * 4, size_t(page.width) * 4);
+
+        if (m_options.packing == AtlasPacking::MaxRects)
+        {
+            // Free rectangles reaching the old edge extend into the new space, which is also free as a whole
+            for (PackRect& rect : page.freeRects)
+            {
+                if (growWidth && rect.x + rect.width == page.width)
+                    rect.width = newWidth - rect.x;
+                else if (!growWidth && rect.y + rect.height == page.height)
+                    rect.height = newHeight - rect.y;
+            }
+
+            if (growWidth)
+                page.freeRects.push_back({ page.width, 0, newWidth - page.width, newHeight });
+            else
+                page.freeRects.push_back({ 0, page.height, newWidth, newHeight - page.height });
+
+            // An empty rectangle splits nothing, so this only drops the rectangles the extended ones now contain
+            PlaceMaxRects(page, { 0, 0, 0, 0 });
+        }
+        else if (growWidth)
+        {
+            if (!page.skyline.empty() && page.skyline.back().y == 0)
+                page.skyline.back().width += newWidth - page.width;
+            else
+                page.skyline.push_back({ page.width, 0, newWidth - page.width });
+        }
+
+        page.width = newWidth;
+        page.height = newHeight;
+        page.pixels = std::move(pixels);
+        if (!UploadPage(page))
+            return false;
+
+        UpdateRegionUVs(pageIndex);
+        ++m_version;
+        return true;
+    }
+
+    void TextureAtlas::UpdateRegionUVs(int pageIndex)
+    {
+        const Page& page = *m_pages[pageIndex];
+        for (auto& [name, region] : m_regions)
+        {
+            if (region.page != pageIndex)
+                continue;
+
+            region.uvMin = Vector2(float(region.x) / page.width, float(region.y) / page.height);
+            region.uvMax = Vector2(float(region.x + region.width) / page.width, float(region.y + region.height) / page.height);
+        }
+    }
+
+    bool TextureAtlas::Insert(Page& page, int width, int height, PackRect& outRect)
+    {
+        if (m_options.packing == AtlasPacking::MaxRects)
+        {
+            if (!FindMaxRectsPosition(page, width, height, outRect))
+                return false;
+
+            PlaceMaxRects(page, outRect);
+        }
+        else
+        {
+            size_t node = 0;
+            if (!FindSkylinePosition(page, width, height, outRect, node))
+                return false;
+
+            PlaceSkyline(page, outRect, node);
+        }
+
+        page.usedArea += int64_t(width) * height;
+        return true;
+    }
+
+    bool TextureAtlas::FindMaxRectsPosition(const Page& page, int width, int height, PackRect& outRect) const
+    {
+        // Best short side fit: the free rectangle that leaves the smallest gap on one side, then on the other
+        int bestShortSide = INT32_MAX;
+        int bestLongSide = INT32_MAX;
+        for (const PackRect& free : page.freeRects)
+        {
+            if (width > free.width || height > free.height)
+                continue;
+
+            const int leftoverX = free.width - width;
+            const int leftoverY = free.height - height;
+            const int shortSide = std::min(leftoverX, leftoverY);
+            const int longSide = std::max(leftoverX, leftoverY);
+            if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                outRect = { free.x, free.y, width, height };
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+            }
+        }
+
+        return bestShortSide != INT32_MAX;
+    }
+
+    void TextureAtlas::PlaceMaxRects(Page& page, const PackRect& used)
+    {
+        // Splits every free rectangle the used one overlaps into the up to four maximal rectangles around it
+        std::vector<PackRect> freeRects;
+        freeRects.reserve(page.freeRects.size() + 4);
+        for (const PackRect& free : page.freeRects)
+        {
+            if (used.x >= free.x + free.width || used.x + used.width <= free.x || used.y >= free.y + free.height || used.y + used.height <= free.y)
+            {
+                freeRects.push_back(free);
+                continue;
+            }
+
+            if (used.x > free.x)
+                freeRects.push_back({ free.x, free.y, used.x - free.x, free.height });
+            if (used.x + used.width < free.x + free.width)
+                freeRects.push_back({ used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height });
+            if (used.y > free.y)
+                freeRects.push_back({ free.x, free.y, free.width, used.y - free.y });
+            if (used.y + used.height < free.y + free.height)
+                freeRects.push_back({ free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height });
+        }
+
+        // Drops rectangles that another one contains
+        auto contains = [](const PackRect& a, const PackRect& b)
+        {
+            return b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height;
+        };
+
+        page.freeRects.clear();
+        for (size_t i = 0; i < freeRects.size(); ++i)
+        {
+            bool redundant = false;
+            for (size_t j = 0; j < freeRects.size() && !redundant; ++j)
+            {
+                // Of two equal rectangles, only the first is kept
+                if (i != j && contains(freeRects[j], freeRects[i]) && (!contains(freeRects[i], freeRects[j]) || j < i))
+                    redundant = true;
+            }
+
+            if (!redundant)
+                page.freeRects.push_back(freeRects[i]);
+        }
+    }
+
+    bool TextureAtlas::FindSkylinePosition(const Page& page, int width, int height, PackRect& outRect, size_t& outNode) const
+    {
+        // Bottom left: the lowest spot, then the one resting on the narrowest segment
+        int bestBottom = INT32_MAX;
+        int bestWidth = INT32_MAX;
+        for (size_t i = 0; i < page.skyline.size(); ++i)
+        {
+            const int x = page.skyline[i].x;
+            if (x + width > page.width)
+                break;
+
+            // The image rests on the highest segment it spans
+            int y = 0;
+            int remaining = width;
+            for (size_t j = i; remaining > 0 && j < page.skyline.size(); ++j)
+            {
+                y = std::max(y, page.skyline[j].y);
+                remaining -= page.skyline[j].width;
+            }
+
+            if (y + height > page.height)
+                continue;
+
+            if (y + height < bestBottom || (y + height == bestBottom && page.skyline[i].width < bestWidth))
+            {
+                outRect = { x, y, width, height };
+                outNode = i;
+                bestBottom = y + height;
+                bestWidth = page.skyline[i].width;
+            }
+        }
+
+        return bestBottom != INT32_MAX;
+    }
+
+    void TextureAtlas::PlaceSkyline(Page& page, const PackRect& rect, size_t node)
+    {
+        std::vector<SkylineNode>& skyline = page.skyline;
+        skyline.insert(skyline.begin() + node, { rect.x, rect.y + rect.height, rect.width });
+
+        // Trims the segments the new one now covers
+        for (size_t i = node + 1; i < skyline.size();)
+        {
+            const int coveredEnd = skyline[i - 1].x + skyline[i - 1].width;
+            if (skyline[i].x >= coveredEnd)
+                break;
+
+            const int shrink = coveredEnd - skyline[i].x;
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            if (skyline[i].width > 0)
+                break;
+
+            skyline.erase(skyline.begin() + i);
+        }
+
+        // Merges neighbours at the same height
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+                ++i;
+        }
+    }
+}
@@ -0,0 +1,403 @@
+#include "Texture.h"
+#include "JobSystem.h"
+#include <bimg.h>
+#include <decode.h>
+#include <bx/allocator.h>
+#include <bx/file.h>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace cx
+{
+    // Mips at or below this size are always resident and stay in CPU memory, so evicting a texture never needs the file
+    static constexpr int s_mipTailSize = 64;
+    static constexpr int s_maxLoadsInFlight = 8;
+    static constexpr int s_maxLoadsStartedPerFrame = 4;
+
+    struct TextureStreamingState
+    {
+        std::string path;
+        uint64_t flags = 0;
+        int width = 0; // Of mip 0
+        int height = 0;
+        int mipCount = 0;
+        int tailMip = 0; // Most detailed mip of the tail
+        std::vector<uint8_t> tailData; // Mips tailMip and below, in bimg's layout
+
+        int residentMip = 0;
+        uint64_t residentBytes = 0;
+
+        float screenPixels = 0.0f; // Largest on screen size since the last update
+        uint32_t lastUsedFrame = 0;
+
+        uint64_t pendingLoadId = 0; // 0 when no load is in flight
+        uint64_t pendingBytes = 0;
+    };
+
+    // Filled in on a worker, applied on the main thread by Texture::UpdateStreaming()
+    struct StreamingLoad
+    {
+        uint64_t id = 0;
+        std::string path;
+        bgfx::TextureFormat::Enum format = bgfx::TextureFormat::Unknown;
+        int width = 0;
+        int height = 0;
+        int mipCount = 0;
+        int firstMip = 0;
+        int tailMip = 0;
+        std::vector<uint8_t> data; // Mips firstMip to tailMip - 1
+        bool succeeded = false;
+    };
+
+    static std::vector<Texture*> s_streamedTextures;
+    static std::unordered_map<uint64_t, Texture*> s_pendingLoads;
+    static uint64_t s_nextLoadId = 1;
+    static uint32_t s_streamingFrame = 0;
+
+    static std::mutex s_completedLoadsMutex;
+    static std::vector<std::shared_ptr<StreamingLoad>> s_completedLoads;
+
+    static TextureStreamingStats s_streamingStats = { 512ull * 1024 * 1024 };
+
+    static uint64_t GetMipChainSize(int width, int height, int firstMip, bgfx::TextureFormat::Enum format)
+    {
+        return bimg::imageGetSize(nullptr, uint16_t(std::max(1, width >> firstMip)), uint16_t(std::max(1, height >> firstMip)), 1, false, true, 1, bimg::TextureFormat::Enum(format));
+    }
+
+    static bool ReadTextureFile(std::string_view path, std::vector<uint8_t>& outData)
+    {
+        bx::FileReader reader;
+        if (!bx::open(&reader, std::string(path).c_str()))
+            return false;
+
+        outData.resize(size_t(bx::getSize(&reader)));
+        bx::read(&reader, outData.data(), int32_t(outData.size()), bx::ErrorAssert{});
+        bx::close(&reader);
+        return !outData.empty();
+    }
+
+    // Appends mips [firstMip, lastMip) of the image's first layer
+    static bool CopyMips(const bimg::ImageContainer& image, const void* data, uint32_t size, int firstMip, int lastMip, std::vector<uint8_t>& out)
+    {
+        for (int lod = firstMip; lod < lastMip; ++lod)
+        {
+            bimg::ImageMip mip;
+            if (!bimg::imageGetRawData(image, 0, uint8_t(lod), data, size, mip))
+                return false;
+
+            out.insert(out.end(), mip.m_data, mip.m_data + mip.m_size);
+        }
+        return true;
+    }
+
+    static void RunStreamingLoad(const std::shared_ptr<StreamingLoad>& load)
+    {
+        bx::DefaultAllocator allocator;
+        std::vector<uint8_t> file;
+        if (ReadTextureFile(load->path, file))
+        {
+            bimg::ImageContainer* image = bimg::imageParse(&allocator, file.data(), uint32_t(file.size()));
+
+            // The file may have changed since it was registered
+            if (image && int(image->m_width) == load->width && int(image->m_height) == load->height
+                && int(image->m_numMips) == load->mipCount && bgfx::TextureFormat::Enum(image->m_format) == load->format)
+                load->succeeded = CopyMips(*image, image->m_data, image->m_size, load->firstMip, load->tailMip, load->data);
+
+            if (image)
+                bimg::imageFree(image);
+        }
+
+        std::lock_guard<std::mutex> lock(s_completedLoadsMutex);
+        s_completedLoads.push_back(load);
+    }
+
+    bool Texture::LoadStreamed(std::string_view path, bool isColorTexture)
+    {
+        Destroy();
+
+        bx::DefaultAllocator allocator;
+        std::vector<uint8_t> file;
+        if (!ReadTextureFile(path, file))
+            return false;
+
+        bimg::ImageContainer* image = bimg::imageParse(&allocator, file.data(), uint32_t(file.size()));
+        if (!image)
+            return false;
+
+        const bgfx::TextureFormat::Enum format = bgfx::TextureFormat::Enum(image->m_format);
+        const int width = int(image->m_width);
+        const int height = int(image->m_height);
+        const int mipCount = int(image->m_numMips);
+
+        // Only a stored full mip chain can be streamed, anything else is loaded whole
+        int tailMip = 0;
+        while (tailMip < mipCount - 1 && std::max(width >> tailMip, height >> tailMip) > s_mipTailSize)
+            ++tailMip;
+
+        const bool streamable = image->m_numLayers == 1 && !image->m_cubeMap && image->m_depth <= 1
+            && mipCount == bimg::imageGetNumMips(image->m_format, uint16_t(width), uint16_t(height)) && tailMip > 0;
+
+        if (!streamable)
+        {
+            bimg::imageFree(image);
+            return LoadFromFile(path, isColorTexture);
+        }
+
+        std::unique_ptr<TextureStreamingState> state = std::make_unique<TextureStreamingState>();
+        state->path = std::string(path);
+        state->flags = isColorTexture ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE;
+        state->width = width;
+        state->height = height;
+        state->mipCount = mipCount;
+        state->tailMip = tailMip;
+
+        const bool copied = CopyMips(*image, image->m_data, image->m_size, tailMip, mipCount, state->tailData);
+        bimg::imageFree(image);
+        if (!copied)
+            return false;
+
+        m_handle = bgfx::createTexture2D(uint16_t(std::max(1, width >> tailMip)), uint16_t(std::max(1, height >> tailMip)), true, 1,
+            format, state->flags, bgfx::copy(state->tailData.data(), uint32_t(state->tailData.size())));
+        if (!bgfx::isValid(m_handle))
+            return false;
+
+        state->residentMip = tailMip;
+        state->residentBytes = GetMipChainSize(width, height, tailMip, format);
+        state->lastUsedFrame = s_streamingFrame;
+
+        m_width = std::max(1, width >> tailMip);
+        m_height = std::max(1, height >> tailMip);
+        m_format = format;
+        m_channels = GetFormatChannels(m_format);
+        m_isColorTexture = isColorTexture;
+        m_hasMipmaps = true;
+        m_filePath = std::string(path);
+
+        s_streamingStats.residentBytes += state->residentBytes;
+        m_streaming = state.release();
+        s_streamedTextures.push_back(this);
+        return true;
+    }
+
+    int Texture::GetResidentMip() const
+    {
+        return m_streaming ? m_streaming->residentMip : 0;
+    }
+
+    void Texture::NoteStreamingUsage(float screenPixels)
+    {
+        if (!m_streaming)
+            return;
+
+        m_streaming->screenPixels = std::max(m_streaming->screenPixels, screenPixels);
+        m_streaming->lastUsedFrame = s_streamingFrame;
+    }
+
+    bool Texture::HasStreamedTextures()
+    {
+        return !s_streamedTextures.empty();
+    }
+
+    void Texture::ReleaseStreaming()
+    {
+        if (!m_streaming)
+            return;
+
+        if (m_streaming->pendingLoadId != 0)
+        {
+            s_pendingLoads.erase(m_streaming->pendingLoadId);
+            s_streamingStats.pendingBytes -= m_streaming->pendingBytes;
+        }
+        s_streamingStats.residentBytes -= m_streaming->residentBytes;
+
+        s_streamedTextures.erase(std::remove(s_streamedTextures.begin(), s_streamedTextures.end(), this), s_streamedTextures.end());
+
+        delete m_streaming;
+        m_streaming = nullptr;
+    }
+
+    // Replaces the GPU texture with one holding mips firstMip and below. mipData holds the mips above the tail.
+    bool Texture::SetResidentMips(int firstMip, const std::vector<uint8_t>& mipData)
+    {
+        TextureStreamingState& state = *m_streaming;
+
+        const bgfx::Memory* mem = bgfx::alloc(uint32_t(mipData.size() + state.tailData.size()));
+        std::memcpy(mem->data, mipData.data(), mipData.size());
+        std::memcpy(mem->data + mipData.size(), state.tailData.data(), state.tailData.size());
+
+        const int width = std::max(1, state.width >> firstMip);
+        const int height = std::max(1, state.height >> firstMip);
+        bgfx::TextureHandle handle = bgfx::createTexture2D(uint16_t(width), uint16_t(height), true, 1, m_format, state.flags, mem);
+        if (!bgfx::isValid(handle))
+            return false;
+
+        // Materials notice the new handle and rebind it
+        if (bgfx::isValid(m_handle))
+            bgfx::destroy(m_handle);
+        m_handle = handle;
+        m_width = width;
+        m_height = height;
+
+        const uint64_t residentBytes = GetMipChainSize(state.width, state.height, firstMip, m_format);
+        s_streamingStats.residentBytes = s_streamingStats.residentBytes - state.residentBytes + residentBytes;
+        state.residentBytes = residentBytes;
+        state.residentMip = firstMip;
+        return true;
+    }
+
+    // Drops every streamed texture that wasn't used last frame back to its mip tail, least recently used first, until bytes more fit in the budget
+    bool Texture::MakeStreamingRoom(uint64_t bytes, uint32_t lastFrame)
+    {
+        while (s_streamingStats.residentBytes + s_streamingStats.pendingBytes + bytes > s_streamingStats.budgetBytes)
+        {
+            Texture* oldest = nullptr;
+            uint32_t oldestAge = 0;
+            for (Texture* texture : s_streamedTextures)
+            {
+                const TextureStreamingState& state = *texture->m_streaming;
+                if (state.residentMip >= state.tailMip || state.lastUsedFrame == lastFrame)
+                    continue;
+
+                const uint32_t age = lastFrame - state.lastUsedFrame;
+                if (!oldest || age > oldestAge)
+                {
+                    oldest = texture;
+                    oldestAge = age;
+                }
+            }
+
+            if (!oldest || !oldest->SetResidentMips(oldest->m_streaming->tailMip, {}))
+                return false;
+
+            s_streamingStats.evictions++;
+        }
+
+        return true;
+    }
+
+    void Texture::UpdateStreaming(uint32_t currentFrame)
+    {
+        // Apply finished loads
+        std::vector<std::shared_ptr<StreamingLoad>> completed;
+        {
+            std::lock_guard<std::mutex> lock(s_completedLoadsMutex);
+            completed.swap(s_completedLoads);
+        }
+
+        for (const std::shared_ptr<StreamingLoad>& load : completed)
+        {
+            auto it = s_pendingLoads.find(load->id);
+            if (it == s_pendingLoads.end())
+                continue; // The texture was destroyed
+
+            Texture* texture = it->second;
+            TextureStreamingState& state = *texture->m_streaming;
+            s_pendingLoads.erase(it);
+            s_streamingStats.pendingBytes -= state.pendingBytes;
+            state.pendingLoadId = 0;
+            state.pendingBytes = 0;
+
+            if (!load->succeeded)
+            {
+                std::cerr << "[ERROR] Texture streaming - failed to load mip " << load->firstMip << " of \"" << load->path << "\"." << std::endl;
+                continue;
+            }
+
+            const int previousMip = state.residentMip;
+            if (load->firstMip < previousMip && texture->SetResidentMips(load->firstMip, load->data))
+                s_streamingStats.mipLoads += uint32_t(previousMip - load->firstMip);
+        }
+
+        // Pick the mip each texture needs from how large it was drawn last frame
+        const uint32_t lastFrame = s_streamingFrame;
+        std::vector<std::pair<float, Texture*>> requests;
+        for (Texture* texture : s_streamedTextures)
+        {
+            TextureStreamingState& state = *texture->m_streaming;
+            const float screenPixels = state.screenPixels;
+            state.screenPixels = 0.0f;
+
+            if (state.lastUsedFrame != lastFrame || state.pendingLoadId != 0 || screenPixels <= 0.0f)
+                continue;
+
+            const float texels = float(std::max(state.width, state.height));
+            const int wantedMip = std::clamp(int(std::floor(std::log2(texels / screenPixels))), 0, state.tailMip);
+            if (wantedMip < state.residentMip)
+                requests.push_back({ screenPixels, texture });
+        }
+
+        // Largest on screen first
+        std::sort(requests.begin(), requests.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        int started = 0;
+        for (const auto& request : requests)
+        {
+            if (started >= s_maxLoadsStartedPerFrame || s_pendingLoads.size() >= size_t(s_maxLoadsInFlight))
+                break;
+
+            Texture* texture = request.second;
+            TextureStreamingState& state = *texture->m_streaming;
+
+            const float texels = float(std::max(state.width, state.height));
+            int mip = std::clamp(int(std::floor(std::log2(texels / request.first))), 0, state.tailMip);
+
+            // Settle for fewer mips when the budget can't fit all of them
+            while (mip < state.residentMip && !MakeStreamingRoom(GetMipChainSize(state.width, state.height, mip, texture->m_format) - state.residentBytes, lastFrame))
+                ++mip;
+            if (mip >= state.residentMip)
+                continue;
+
+            std::shared_ptr<StreamingLoad> load = std::make_shared<StreamingLoad>();
+            load->id = s_nextLoadId++;
+            load->path = state.path;
+            load->format = texture->m_format;
+            load->width = state.width;
+            load->height = state.height;
+            load->mipCount = state.mipCount;
+            load->firstMip = mip;
+            load->tailMip = state.tailMip;
+
+            state.pendingLoadId = load->id;
+            state.pendingBytes = GetMipChainSize(state.width, state.height, mip, texture->m_format) - state.residentBytes;
+            s_streamingStats.pendingBytes += state.pendingBytes;
+            s_pendingLoads[load->id] = texture;
+
+            RunJobAsync([load]() { RunStreamingLoad(load); });
+            ++started;
+        }
+
+        // The budget may have been lowered
+        MakeStreamingRoom(0, lastFrame);
+
+        s_streamingFrame = currentFrame;
+    }
+
+    void SetTextureStreamingBudget(uint64_t bytes)
+    {
+        s_streamingStats.budgetBytes = bytes;
+    }
+
+    uint64_t GetTextureStreamingBudget()
+    {
+        return s_streamingStats.budgetBytes;
+    }
+
+    TextureStreamingStats GetTextureStreamingStats()
+    {
+        TextureStreamingStats stats = s_streamingStats;
+        stats.streamedTextures = uint32_t(s_streamedTextures.size());
+        stats.pendingLoads = uint32_t(s_pendingLoads.size());
+        stats.fullyResidentTextures = 0;
+        for (const Texture* texture : s_streamedTextures)
+        {
+            if (texture->GetResidentMip() == 0)
+                stats.fullyResidentTextures++;
+        }
+        return stats;
+    }
+}
@@ -12,8 +12,11 @@
 
 namespace cx
 {
-    Window* Window::Create()
+    Window* Window::Create(const Config& config)
     {
+        if (config.windowBackend == WindowBackend::Headless)
+            return new HeadlessWindow();
+
 #ifdef PLATFORM_WINDOWS
         return new WindowsWindow();
 #else
@@ -322,4 +325,233 @@ namespace cx
         return "Unknown";
     }
 #endif
+
+    // Headless window
+
+    HeadlessWindow::HeadlessWindow()
+        : m_nextEvent(0)
+        , m_frame(0)
+        , m_frameLimit(0)
+        , m_shouldClose(false)
+        , m_width(0)
+        , m_height(0)
+    {
+    }
+
+    HeadlessWindow::~HeadlessWindow()
+    {
+        Shutdown();
+    }
+
+    bool HeadlessWindow::Init(const Config& config)
+    {
+        m_width = config.windowWidth;
+        m_height = config.windowHeight;
+        m_title = config.windowTitle;
+        m_frame = 0;
+        m_nextEvent = 0;
+        m_shouldClose = false;
+
+        return m_width > 0 && m_height > 0;
+    }
+
+    void HeadlessWindow::PollEvents()
+    {
+        // Apply every scripted event that is due this frame, in the order it was queued
+        while (m_nextEvent < m_inputScript.size() && m_inputScript[m_nextEvent].frame <= m_frame)
+        {
+            const ScriptedInputEvent& event = m_inputScript[m_nextEvent++];
+
+            switch (event.type)
+            {
+            case ScriptedInputEvent::Type::Key:
+                Input::UpdateKeyState(static_cast<KeyCode>(event.code), event.pressed);
+                break;
+            case ScriptedInputEvent::Type::MouseButton:
+                Input::UpdateMouseButtonState(static_cast<MouseButton>(event.code), event.pressed);
+                break;
+            case ScriptedInputEvent::Type::MousePosition:
+                Input::UpdateMousePosition(event.x, event.y);
+                break;
+            case ScriptedInputEvent::Type::MouseWheel:
+                Input::UpdateMouseWheel(event.x);
+                break;
+            }
+        }
+
+        m_frame++;
+
+        if (m_frameLimit > 0 && m_frame >= m_frameLimit)
+            m_shouldClose = true;
+    }
+
+    bool HeadlessWindow::ShouldClose() const
+    {
+        return m_shouldClose;
+    }
+
+    void HeadlessWindow::Shutdown()
+    {
+        m_inputScript.clear();
+        m_nextEvent = 0;
+    }
+
+    void* HeadlessWindow::GetNativeWindowHandle() const
+    {
+        return nullptr;
+    }
+
+    void HeadlessWindow::GetWindowSize(int& width, int& height) const
+    {
+        width = m_width;
+        height = m_height;
+    }
+
+    void HeadlessWindow::SetWindowTitle(std::string_view title)
+    {
+        m_title = title;
+    }
+
+    bool HeadlessWindow::IsFullscreen() const
+    {
+        return false;
+    }
+
+    bool HeadlessWindow::IsHidden() const
+    {
+        return true;
+    }
+
+    bool HeadlessWindow::IsMinimized() const
+    {
+        return false;
+    }
+
+    bool HeadlessWindow::IsMaximized() const
+    {
+        return false;
+    }
+
+    bool HeadlessWindow::IsFocused() const
+    {
+        return true;
+    }
+
+    void HeadlessWindow::ToggleFullscreen()
+    {
+    }
+
+    void HeadlessWindow::Maximize()
+    {
+    }
+
+    void HeadlessWindow::Minimize()
+    {
+    }
+
+    void HeadlessWindow::Restore()
+    {
+    }
+
+    void HeadlessWindow::SetOpacity(float)
+    {
+    }
+
+    void HeadlessWindow::SetIcon(std::string_view)
+    {
+    }
+
+    int HeadlessWindow::GetMonitorCount() const
+    {
+        return 1;
+    }
+
+    int HeadlessWindow::GetCurrentMonitor() const
+    {
+        return 0;
+    }
+
+    void HeadlessWindow::GetMonitorSize(int monitor, int& width, int& height) const
+    {
+        if (monitor == 0)
+        {
+            width = m_width;
+            height = m_height;
+        }
+        else
+        {
+            width = 0;
+            height = 0;
+        }
+    }
+
+    int HeadlessWindow::GetMonitorRefreshRate(int monitor) const
+    {
+        return monitor == 0 ? 60 : 0;
+    }
+
+    void HeadlessWindow::GetMonitorPosition(int, int& x, int& y) const
+    {
+        x = 0;
+        y = 0;
+    }
+
+    std::string HeadlessWindow::GetMonitorName(int monitor) const
+    {
+        return monitor == 0 ? "Headless" : "Unknown";
+    }
+
+    void HeadlessWindow::QueueInputEvent(const ScriptedInputEvent& event)
+    {
+        // Keep the script sorted by frame while preserving queue order for events on the same frame
+        auto it = std::upper_bound(m_inputScript.begin() + m_nextEvent, m_inputScript.end(), event.frame, [](int frame, const ScriptedInputEvent& e)
+            { return frame < e.frame; });
+
+        m_inputScript.insert(it, event);
+    }
+
+    void HeadlessWindow::QueueKey(int frame, KeyCode key, bool pressed)
+    {
+        ScriptedInputEvent event;
+        event.frame = frame;
+        event.type = ScriptedInputEvent::Type::Key;
+        event.code = static_cast<int>(key);
+        event.pressed = pressed;
+        QueueInputEvent(event);
+    }
+
+    void HeadlessWindow::QueueMouseButton(int frame, MouseButton button, bool pressed)
+    {
+        ScriptedInputEvent event;
+        event.frame = frame;
+        event.type = ScriptedInputEvent::Type::MouseButton;
+        event.code = static_cast<int>(button);
+        event.pressed = pressed;
+        QueueInputEvent(event);
+    }
+
+    void HeadlessWindow::QueueMousePosition(int frame, float x, float y)
+    {
+        ScriptedInputEvent event;
+        event.frame = frame;
+        event.type = ScriptedInputEvent::Type::MousePosition;
+        event.x = x;
+        event.y = y;
+        QueueInputEvent(event);
+    }
+
+    void HeadlessWindow::QueueMouseWheel(int frame, float delta)
+    {
+        ScriptedInputEvent event;
+        event.frame = frame;
+        event.type = ScriptedInputEvent::Type::MouseWheel;
+        event.x = delta;
+        QueueInputEvent(event);
+    }
+
+    void HeadlessWindow::ClearInputScript()
+    {
+        m_inputScript.clear();
+        m_nextEvent = 0;
+    }
 }
\ No newline at end of file
@@ -1,11 +1,10 @@
 #include "loaders/FBXLoader.h"
+#include "loaders/ModelLoader.h"
 #include "Maths.h"
 #include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
-#include <stb_image.h>
-#include "basis universal/basisu_transcoder.h"
 #include "ufbx/ufbx.h"
 #include <set>
 
@@ -415,6 +414,9 @@ namespace cx
                 }
             }
 
+            // Flatten the hierarchy once so evaluation is a linear pass from here on
+            skeleton->Flatten();
+
             model->SetSkeleton(skeleton);
             model->SetSkinned(true);
         }
@@ -694,54 +696,16 @@ namespace cx
                                             return;
                                         }
                                         Texture* texture = new Texture();
+                                        bool isColorTexture = (type == MaterialMapType::Albedo || type == MaterialMapType::Emissive);
+                                        const MipGenerationOptions* mipOptions = GetTextureMipGenerationOptions(type == MaterialMapType::Normal);
+
                                         bool success = false;
-                                        if (mime == "image/png" || mime == "image/jpeg")
-                                        {
-                                            int width, height, channels;
-                                            unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4);
-                                            if (pixels)
-                                            {
-                                                bool isColorTexture = (type == MaterialMapType::Albedo || type == MaterialMapType::Emissive);
-                                                success = texture->LoadFromMemory(pixels, width, height, 4, isColorTexture);
-                                                stbi_image_free(pixels);
-                                            }
-                                            else
-                                                std::cerr << "[ERROR] Failed to load texture for " << mime << ": " << stbi_failure_reason() << std::endl;
-                                        }
-                                        else if (mime == "image/ktx2")
-                                        {
-                                            basist::ktx2_transcoder transcoder;
-                                            if (transcoder.init(data, static_cast<uint32_t>(size)))
-                                            {
-                                                if (transcoder.start_transcoding())
-                                                {
-                                                    uint32_t width = transcoder.get_width();
-                                                    uint32_t height = transcoder.get_height();
-                                                    if (width > 0 && height > 0)
-                                                    {
-                                                        uint32_t dst_size = width * height * 4;
-                                                        uint8_t* dst = new uint8_t[dst_size];
-                                                        if (transcoder.transcode_image_level(0, 0, 0, dst, width * height, basist::transcoder_texture_format::cTFRGBA32))
-                                                        {
-                                                            bool isColorTexture = (type == MaterialMapType::Albedo || type == MaterialMapType::Emissive);
-                                                            success = texture->LoadFromMemory(dst, width, height, 4, isColorTexture);
-                                                        }
-                                                        else
-                                                            std::cerr << "[ERROR] BasisU transcode_image_level failed." << std::endl;
-                                                        delete[] dst;
-                                                    }
-                                                    else
-                                                        std::cerr << "[ERROR] Invalid dimensions from BasisU: " << width << "x" << height << std::endl;
-                                                    transcoder.clear();
-                                                }
-                                                else
-                                                    std::cerr << "[ERROR] BasisU start_transcoding failed." << std::endl;
-                                            }
-                                            else
-                                                std::cerr << "[ERROR] BasisU init failed." << std::endl;
-                                        }
-                                        else
+                                        if (mime != "image/png" && mime != "image/jpeg" && mime != "image/ktx2")
                                             std::cerr << "[ERROR] Unsupported mime type: " << mime << std::endl;
+                                        else if (IsAsyncTextureLoadingEnabled())
+                                            success = texture->LoadFromEncodedMemoryAsync(std::vector<uint8_t>(data, data + size), isColorTexture, mipOptions, GetTexturePlaceholder(type)).IsValid();
+                                        else
+                                            success = texture->LoadFromEncodedMemory(data, size, isColorTexture, mipOptions);
 
                                         if (isExternal)
                                             delete[] data;
@@ -1,12 +1,11 @@
 #include "loaders/GLTFLoader.h"
+#include "loaders/ModelLoader.h"
 #include "Maths.h"
 #include "Config.h"
 #include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
-#include <stb_image.h>
-#include "basis universal/basisu_transcoder.h"
 #include <draco/compression/decode.h>
 #include <draco/core/decoder_buffer.h>
 #include <draco/mesh/mesh.h>
@@ -706,34 +705,18 @@ namespace cx
                     skeleton->bones[i].inverseBindMatrix = Matrix4(m);
                 }
             }
-            else
-            {
-                std::vector<std::vector<int>> children;
-                children.resize(jointCount);
-                for (size_t i = 0; i < jointCount; ++i)
-                {
-                    int p = skeleton->bones[i].parentIndex;
-                    if (p >= 0 && static_cast<size_t>(p) < jointCount)
-                        children[p].push_back((int)i);
-                }
-
-                std::vector<Matrix4> bindPoseGlobal(jointCount, Matrix4::Identity());
-
-                std::function<void(int, const Matrix4&)> computeBindPose = [&](int index, const Matrix4& parentTransform)
-                {
-                    const Matrix4& local = skeleton->bones[index].localTransform;
-                    Matrix4 global = parentTransform * local;
-                    bindPoseGlobal[index] = global;
 
-                    for (int childIdx : children[index])
-                        computeBindPose(childIdx, global);
-                };
+            // Flatten the hierarchy once so evaluation is a linear pass from here on
+            skeleton->Flatten();
 
+            if (!hasInverseBind)
+            {
+                std::vector<Matrix4> bindPoseLocal(jointCount);
+                std::vector<Matrix4> bindPoseGlobal(jointCount, Matrix4::Identity());
                 for (size_t i = 0; i < jointCount; ++i)
-                {
-                    if (skeleton->bones[i].parentIndex == -1)
-                        computeBindPose((int)i, Matrix4::Identity());
-                }
+                    bindPoseLocal[i] = skeleton->bones[i].localTransform;
+
+                skeleton->ComputeGlobalTransforms(bindPoseLocal.data(), bindPoseGlobal.data());
 
                 // invert to get inverse bind matrices
                 for (size_t i = 0; i < jointCount; ++i)
@@ -835,47 +818,14 @@ namespace cx
             }
 
             Texture* texture = new Texture();
-            bool success = false;
             bool isColorTexture = (type == MaterialMapType::Albedo || type == MaterialMapType::Emissive);
+            const MipGenerationOptions* mipOptions = GetTextureMipGenerationOptions(type == MaterialMapType::Normal);
 
-            if (mime == "image/png" || mime == "image/jpeg")
-            {
-                int width, height, channels;
-                unsigned char* pixels = stbi_load_from_memory(imageData, static_cast<int>(size), &width, &height, &channels, 4);
-                if (pixels)
-                {
-                    success = texture->LoadFromMemory(pixels, width, height, 4, isColorTexture);
-                    stbi_image_free(pixels);
-                }
-                else
-                    std::cerr << "[ERROR] Failed to load texture: " << stbi_failure_reason() << std::endl;
-            }
-            else if (mime == "image/ktx2")
-            {
-                basist::ktx2_transcoder transcoder;
-                if (transcoder.init(imageData, static_cast<uint32_t>(size)))
-                {
-                    if (transcoder.start_transcoding())
-                    {
-                        uint32_t width = transcoder.get_width();
-                        uint32_t height = transcoder.get_height();
-
-                        if (width > 0 && height > 0)
-                        {
-                            uint32_t dst_size = width * height * 4;
-                            uint8_t* dst = new uint8_t[dst_size];
-
-                            if (transcoder.transcode_image_level(0, 0, 0, dst, width * height, basist::transcoder_texture_format::cTFRGBA32))
-                                success = texture->LoadFromMemory(dst, width, height, 4, isColorTexture);
-                            else
-                                std::cerr << "[ERROR] BasisU transcode_image_level failed" << std::endl;
-
-                            delete[] dst;
-                        }
-                        transcoder.clear();
-                    }
-                }
-            }
+            bool success = false;
+            if (IsAsyncTextureLoadingEnabled())
+                success = texture->LoadFromEncodedMemoryAsync(std::vector<uint8_t>(imageData, imageData + size), isColorTexture, mipOptions, GetTexturePlaceholder(type)).IsValid();
+            else
+                success = texture->LoadFromEncodedMemory(imageData, size, isColorTexture, mipOptions);
 
             if (isExternal)
                 delete[] imageData;
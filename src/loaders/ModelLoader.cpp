@@ -13,6 +13,57 @@
 
 namespace cx
 {
+    static bool s_asyncTextureLoading = false;
+
+    void SetAsyncTextureLoading(bool enabled)
+    {
+        s_asyncTextureLoading = enabled;
+    }
+
+    bool IsAsyncTextureLoadingEnabled()
+    {
+        return s_asyncTextureLoading;
+    }
+
+    static bool s_generateTextureMips = false;
+    static MipGenerationOptions s_textureMipOptions;
+    static MipGenerationOptions s_normalMapMipOptions;
+
+    void SetTextureMipGeneration(bool enabled, const MipGenerationOptions& options)
+    {
+        s_generateTextureMips = enabled;
+        s_textureMipOptions = options;
+        s_normalMapMipOptions = options;
+        s_normalMapMipOptions.isNormalMap = true;
+    }
+
+    bool IsTextureMipGenerationEnabled()
+    {
+        return s_generateTextureMips;
+    }
+
+    const MipGenerationOptions* GetTextureMipGenerationOptions(bool isNormalMap)
+    {
+        if (!s_generateTextureMips)
+            return nullptr;
+
+        return isNormalMap ? &s_normalMapMipOptions : &s_textureMipOptions;
+    }
+
+    TexturePlaceholder GetTexturePlaceholder(MaterialMapType type)
+    {
+        switch (type)
+        {
+            case MaterialMapType::Normal:
+                return TexturePlaceholder::FlatNormal;
+            case MaterialMapType::Emissive:
+            case MaterialMapType::Height:
+                return TexturePlaceholder::Black;
+            default:
+                return TexturePlaceholder::White;
+        }
+    }
+
     Model* LoadModel(std::string_view filePath, bool mergeMeshes)
     {
         std::filesystem::path path = filePath;
@@ -1,4 +1,5 @@
 #include "loaders/OBJLoader.h"
+#include "loaders/ModelLoader.h"
 #include "Maths.h"
 #include <filesystem>
 #include <iostream>
@@ -112,11 +113,21 @@ namespace cx
         TextureCache textureCache;
 
         // Helper to synchronously load an image from disk
-        auto loadTextureFromFile = [&](const std::filesystem::path& fullPath, bool isColorTexture) -> std::optional<Texture*>
+        auto loadTextureFromFile = [&](const std::filesystem::path& fullPath, bool isColorTexture, bool isNormalMap, TexturePlaceholder placeholder) -> std::optional<Texture*>
             {
                 if (!std::filesystem::exists(fullPath))
                     return std::nullopt;
 
+                const MipGenerationOptions* mipOptions = GetTextureMipGenerationOptions(isNormalMap);
+
+                // Decoded on the job pool, the texture shows a placeholder until then
+                if (IsAsyncTextureLoadingEnabled())
+                {
+                    Texture* tex = new Texture();
+                    tex->LoadAsync(fullPath.string(), isColorTexture, mipOptions, placeholder);
+                    return tex;
+                }
+
                 int width = 0, height = 0, channels = 0;
                 // prefer 4 channels for color textures
                 int desired = isColorTexture ? 4 : 0;
@@ -138,7 +149,7 @@ namespace cx
 
                 // Create Texture
                 Texture* tex = new Texture();
-                bool ok = tex->LoadFromMemory(pixels, width, height, (desired == 0 ? channels : desired), isColorTexture);
+                bool ok = tex->LoadFromMemory(pixels, width, height, (desired == 0 ? channels : desired), isColorTexture, mipOptions);
 
                 stbi_image_free(pixels);
 
@@ -151,7 +162,7 @@ namespace cx
                 return tex;
             };
 
-        auto loadTextureWithCache = [&](std::string_view texPath, bool isColorTexture) -> Texture*
+        auto loadTextureWithCache = [&](std::string_view texPath, MaterialMapType type, bool isNormalMap = false) -> Texture*
             {
                 if (texPath.empty())
                     return nullptr;
@@ -164,7 +175,8 @@ namespace cx
                 std::filesystem::path fullPath = objDir / texPath;
 
                 // Load image then insert into cache.
-                auto loaded = loadTextureFromFile(fullPath, isColorTexture);
+                bool isColorTexture = (type == MaterialMapType::Albedo || type == MaterialMapType::Emissive);
+                auto loaded = loadTextureFromFile(fullPath, isColorTexture, isNormalMap, GetTexturePlaceholder(type));
 
                 if (!loaded.has_value())
                     return nullptr;
@@ -223,44 +235,44 @@ namespace cx
                     // Texture loading
                     if (!objMat.diffuse_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.diffuse_texname, true))
+                        if (Texture* t = loadTextureWithCache(objMat.diffuse_texname, MaterialMapType::Albedo))
                             material->SetMaterialMap(MaterialMapType::Albedo, t);
                     }
 
                     // Metallic-roughness // Todo: Need to separate these 
                     if (!objMat.roughness_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.roughness_texname, false))
+                        if (Texture* t = loadTextureWithCache(objMat.roughness_texname, MaterialMapType::MetallicRoughness))
                             material->SetMaterialMap(MaterialMapType::MetallicRoughness, t);
                     }
 
                     if (!objMat.specular_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.specular_texname, false))
+                        if (Texture* t = loadTextureWithCache(objMat.specular_texname, MaterialMapType::MetallicRoughness))
                             material->SetMaterialMap(MaterialMapType::MetallicRoughness, t);
                     }
 
                     // Normal map
                     if (!objMat.normal_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.normal_texname, false))
+                        if (Texture* t = loadTextureWithCache(objMat.normal_texname, MaterialMapType::Normal, true))
                             material->SetMaterialMap(MaterialMapType::Normal, t);
                     }
                     else if (!objMat.bump_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.bump_texname, false))
+                        if (Texture* t = loadTextureWithCache(objMat.bump_texname, MaterialMapType::Normal))
                             material->SetMaterialMap(MaterialMapType::Normal, t);
                     }
 
                     if (!objMat.ambient_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.ambient_texname, false))
+                        if (Texture* t = loadTextureWithCache(objMat.ambient_texname, MaterialMapType::AO))
                             material->SetMaterialMap(MaterialMapType::AO, t);
                     }
 
                     if (!objMat.emissive_texname.empty())
                     {
-                        if (Texture* t = loadTextureWithCache(objMat.emissive_texname, true))
+                        if (Texture* t = loadTextureWithCache(objMat.emissive_texname, MaterialMapType::Emissive))
                             material->SetMaterialMap(MaterialMapType::Emissive, t);
                     }
 